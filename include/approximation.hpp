@@ -0,0 +1,43 @@
+/**
+ * @file approximation.hpp
+ * @brief Sustitución de subexpresiones costosas de una sola variable por tablas de aproximación polinómica.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "range_analysis.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+
+namespace clex {
+
+/**
+ * @brief Devuelve una copia de una expresión con las subexpresiones costosas de una variable sustituidas por
+ * tablas de aproximación (`ApproximationExpression`).
+ *
+ * Se sustituyen las subexpresiones más grandes que cumplen:
+ * - Su única variable tiene un rango finito declarado en `ranges`; el resto de identificadores son constantes de `constants`.
+ * - Son suaves: no tienen condicionales, comparaciones, operadores lógicos ni llamadas a `rand`, `randn`, `mc` o `mcerr`.
+ * - Su coste justifica la tabla: al menos dos funciones trascendentes (`log`, `sin`, `cos`, `tan`, `asin`,
+ *   `acos`, `atan` o `^` con exponente no entero literal), contando `sqrt` como media.
+ *
+ * Para cada una se prueba con 1, 2, 4, ... tramos, hasta 4096, y polinomios de grado 4, 6 y 8 en cada tramo,
+ * ajustados por interpolación en los nodos de Chebyshev, y se elige la primera tabla cuyo error absoluto en una
+ * malla uniforme de puntos de cada tramo no supera `tolerance`. Si ninguna lo consigue, o si la subexpresión da
+ * un error de evaluación o un valor no finito en algún punto de la malla, se deja como está.
+ *
+ * Las tablas se construyen al llamar a esta función, así que su coste se paga una vez por expresión y no por
+ * evaluación. Fuera del rango declarado, la expresión devuelta evalúa la original.
+ *
+ * @param expr Expresión a transformar.
+ * @param constants Tabla de símbolos con los valores fijos de las variables que no aparecen en `ranges`.
+ * @param ranges Rangos declarados para las variables cuyo valor cambia entre evaluaciones.
+ * @param tolerance Error absoluto máximo de las tablas, positivo.
+ * @return La expresión transformada.
+ */
+Expression approximate_univariate(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges,
+                                  double tolerance);
+
+} // namespace clex
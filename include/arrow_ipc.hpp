@@ -0,0 +1,169 @@
+/**
+ * @file arrow_ipc.hpp
+ * @brief Lectura y escritura del formato de flujo IPC de Apache Arrow, sin depender de la biblioteca de Arrow.
+ *
+ * Un flujo IPC de Arrow es una secuencia de mensajes: primero un esquema con los nombres y tipos de las columnas,
+ * y después lotes de filas (*record batches*) con los valores de cada columna guardados seguidos en memoria. Los
+ * metadatos de cada mensaje están codificados con FlatBuffers, que aquí se leen y escriben directamente.
+ *
+ * Solo se interpretan columnas `float64` e `int64` (con su mapa de bits de validez); las columnas de otros tipos
+ * planos, como texto, se leen pero no se puede acceder a sus valores. No se admiten columnas anidadas, diccionarios
+ * ni cuerpos comprimidos.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Tipo de una columna de Arrow.
+ */
+enum class ArrowType : uint8_t {
+    FLOAT64, /**< `double` de 64 bits. */
+    INT64,   /**< Entero con signo de 64 bits. */
+    OTHER,   /**< Cualquier otro tipo plano, cuyos valores no se interpretan. */
+};
+
+/**
+ * @brief Descripción de una columna en el esquema de un flujo.
+ */
+struct ArrowField {
+    std::string name; /**< Nombre de la columna. */
+    ArrowType type;   /**< Tipo de la columna. */
+    bool nullable;    /**< Si la columna puede tener valores nulos. */
+};
+
+/**
+ * @brief Vista de los valores de una columna dentro del cuerpo de un lote, sin copiarlos.
+ */
+class ArrowColumn {
+  private:
+    ArrowType m_type;          /**< Tipo de la columna. */
+    const uint8_t* m_validity; /**< Mapa de bits de validez (un bit por fila, 1 si no es nula), o nulo si no hay nulos. */
+    const uint8_t* m_data;     /**< Valores de la columna, o nulo si su tipo es `ArrowType::OTHER`. */
+  public:
+    /**
+     * @brief Construye una vista de columna.
+     *
+     * @param type Tipo de la columna.
+     * @param validity Mapa de bits de validez, o nulo si ninguna fila es nula.
+     * @param data Valores de la columna, 8 bytes por fila.
+     */
+    ArrowColumn(ArrowType type, const uint8_t* validity, const uint8_t* data) noexcept;
+
+    /**
+     * @brief Devuelve el tipo de la columna.
+     */
+    ArrowType type() const noexcept;
+
+    /**
+     * @brief Indica si el valor de la fila `row` no es nulo.
+     */
+    bool is_valid(size_t row) const noexcept;
+
+    /**
+     * @brief Devuelve el mapa de bits de validez, con el bit `row % 8` del byte `row / 8` a 1 si la fila `row` no es
+     * nula, o nulo si ninguna fila es nula.
+     */
+    const uint8_t* validity() const noexcept;
+
+    /**
+     * @brief Devuelve el valor de la fila `row` como `double`.
+     *
+     * @pre El tipo de la columna es `ArrowType::FLOAT64` o `ArrowType::INT64`, y la fila existe.
+     */
+    double value(size_t row) const noexcept;
+};
+
+/**
+ * @brief Lote de filas leído de un flujo.
+ *
+ * Las columnas son vistas sobre `body`, así que solo son válidas mientras el lote exista y no se sobrescriba.
+ */
+struct ArrowRecordBatch {
+    int64_t length = 0;                /**< Número de filas. */
+    std::vector<ArrowColumn> columns;  /**< Columnas, en el orden del esquema. */
+    std::vector<uint64_t> body;        /**< Cuerpo del mensaje, alineado a 8 bytes. */
+};
+
+/**
+ * @brief Lector de un flujo IPC de Arrow.
+ */
+class ArrowStreamReader {
+  private:
+    std::istream& m_in;               /**< Flujo de entrada. */
+    std::vector<ArrowField> m_fields; /**< Esquema del flujo. */
+    std::vector<int> m_buffer_counts; /**< Número de búferes de cada columna en los lotes, según su tipo. */
+  public:
+    /**
+     * @brief Empieza a leer un flujo, leyendo su esquema.
+     *
+     * @param in Flujo de entrada, en modo binario.
+     * @exception Lanza `std::runtime_error` si el flujo no empieza con un esquema válido o el esquema tiene
+     * columnas de tipos no admitidos.
+     */
+    explicit ArrowStreamReader(std::istream& in);
+
+    /**
+     * @brief Devuelve el esquema del flujo.
+     */
+    const std::vector<ArrowField>& fields() const noexcept;
+
+    /**
+     * @brief Lee el siguiente lote de filas.
+     *
+     * Los mensajes que no son lotes ni diccionarios se saltan. El cuerpo de cada mensaje se lee por trozos, así que una
+     * longitud de cuerpo mayor que lo que queda del flujo se detecta como un cuerpo cortado sin reservarla entera.
+     *
+     * @param batch Donde guardar el lote leído. Su cuerpo anterior se reutiliza.
+     * @return `true` si se ha leído un lote, o `false` si el flujo ha terminado.
+     * @exception Lanza `std::runtime_error` si el mensaje no es válido, es un diccionario o está comprimido.
+     */
+    bool next(ArrowRecordBatch& batch);
+};
+
+/**
+ * @brief Escritor de un flujo IPC de Arrow con columnas `float64`.
+ */
+class ArrowStreamWriter {
+  private:
+    std::ostream& m_out;             /**< Flujo de salida. */
+    std::vector<std::string> m_names; /**< Nombres de las columnas. */
+  public:
+    /**
+     * @brief Empieza a escribir un flujo, escribiendo su esquema.
+     *
+     * Todas las columnas son de tipo `float64` y admiten nulos.
+     *
+     * @param out Flujo de salida, en modo binario.
+     * @param names Nombres de las columnas.
+     */
+    ArrowStreamWriter(std::ostream& out, std::vector<std::string> names);
+
+    /**
+     * @brief Escribe un lote de filas.
+     *
+     * @param length Número de filas.
+     * @param columns Valores de cada columna, `length` por columna.
+     * @param validity Validez de cada fila de cada columna (distinto de cero si no es nula). Si está vacío, ninguna
+     * fila es nula.
+     */
+    void write_batch(size_t length, const std::vector<const double*>& columns,
+                     const std::vector<const uint8_t*>& validity = {});
+
+    /**
+     * @brief Escribe la marca de final del flujo.
+     */
+    void finish();
+};
+
+} // namespace clex
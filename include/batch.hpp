@@ -0,0 +1,503 @@
+/**
+ * @file batch.hpp
+ * @brief Evaluación de una expresión sobre todas las filas de una entrada CSV o sobre una malla de parámetros.
+ *
+ * La primera línea de la entrada es una cabecera con los nombres de las columnas, que deben ser
+ * identificadores válidos; cada una de las líneas siguientes es una fila de valores numéricos
+ * separados por comas, en la que un campo vacío es un valor nulo. Las líneas en blanco se ignoran, salvo si la
+ * entrada tiene una sola columna: ahí una línea en blanco es el único modo de escribir un nulo, así que es una fila
+ * más, con un valor nulo. Para cada fila, la expresión se evalúa con cada columna asignada a la variable
+ * del mismo nombre. Las filas se leen por bloques y cada bloque se reparte entre todos los núcleos
+ * disponibles, así que la entrada nunca se carga entera en memoria.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "range_analysis.hpp"
+#include "statistics.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Estadísticas de los valores de una expresión sobre todas las filas de una entrada.
+ *
+ * Los acumuladores son combinables, así que cada hilo mantiene su propio `BatchAggregate` y todos
+ * se combinan al final de la entrada.
+ */
+class BatchAggregate {
+  private:
+    RunningStats m_stats; /**< Número de filas, media, varianza, mínimo y máximo. */
+    TDigest m_digest;     /**< Resumen para estimar cuantiles. */
+    uint64_t m_errors;    /**< Número de filas inválidas o cuya evaluación ha fallado. */
+    uint64_t m_nans;      /**< Número de filas evaluadas con éxito cuyo resultado es NaN. */
+  public:
+    /**
+     * @brief Constructor por defecto, construye un agregado vacío.
+     */
+    BatchAggregate() noexcept;
+
+    /**
+     * @brief Añade el resultado de una fila evaluada con éxito.
+     *
+     * Un resultado NaN no tiene orden, así que no entra en las estadísticas ni en los cuantiles: solo se cuenta.
+     *
+     * @param value Resultado de la fila.
+     */
+    void push(double value) noexcept;
+
+    /**
+     * @brief Cuenta una fila inválida o cuya evaluación ha fallado.
+     */
+    void push_error() noexcept;
+
+    /**
+     * @brief Combina otro agregado con éste.
+     *
+     * @param other Agregado a combinar.
+     */
+    void merge(const BatchAggregate& other) noexcept;
+
+    /**
+     * @brief Devuelve las estadísticas de los resultados de las filas evaluadas con éxito.
+     */
+    const RunningStats& stats() const noexcept;
+
+    /**
+     * @brief Estima el cuantil `q` de los resultados de las filas evaluadas con éxito.
+     *
+     * @param q Cuantil a estimar, entre `0.0` y `1.0`.
+     */
+    double quantile(double q) const noexcept;
+
+    /**
+     * @brief Devuelve el número de filas inválidas o cuya evaluación ha fallado.
+     */
+    uint64_t errors() const noexcept;
+
+    /**
+     * @brief Devuelve el número de filas evaluadas con éxito cuyo resultado es NaN.
+     */
+    uint64_t nans() const noexcept;
+
+    /**
+     * @brief Escribe el agregado en un flujo de salida, con una línea `nombre,valor` por estadística.
+     *
+     * @param os Flujo de salida.
+     */
+    void print_to(std::ostream& os) const;
+
+    /**
+     * @brief Escribe el estado completo del agregado en un flujo, para combinarlo en otro proceso.
+     *
+     * @param os Flujo de salida.
+     */
+    void write_to(std::ostream& os) const;
+
+    /**
+     * @brief Lee un agregado escrito con `write_to()`.
+     *
+     * @param is Flujo de entrada.
+     * @return El agregado leído. Si el formato no es válido, se activa `std::ios::failbit` en `is`.
+     */
+    static BatchAggregate read_from(std::istream& is);
+};
+
+/**
+ * @brief Opciones de la evaluación por lotes.
+ */
+struct BatchOptions {
+    VariableRanges ranges;  /**< Rangos declarados para las columnas. Las columnas sin rango pueden tomar cualquier valor. */
+    std::string native_dir; /**< Directorio de caché para compilar la expresión a código nativo, o vacío para usar el intérprete. */
+    size_t processes = 1;   /**< Número de procesos entre los que se reparte un fichero de entrada. */
+    bool float32 = false;   /**< Si los resultados se calculan en precisión simple (ver `evaluate_csv()`). */
+    double approximation_tolerance = 0.0; /**< Error absoluto de las tablas de `approximate_univariate()`, o 0 para no usarlas. */
+    const Expression* filter = nullptr;   /**< Predicado que deben cumplir las filas para evaluarlas (ver `evaluate_csv()`), o
+                                               nulo para evaluarlas todas. No se copia, así que debe existir durante la evaluación. */
+};
+
+/**
+ * @brief Evalúa una expresión para cada fila de una entrada CSV y escribe un resultado por línea.
+ *
+ * Los resultados se escriben en el mismo orden que las filas de la entrada, con la precisión necesaria para
+ * que al volver a leerlos se obtenga exactamente el mismo `double`. Si una fila es inválida o su evaluación
+ * falla, se escribe `nan` en su lugar y el error se indica en `err` junto al número de fila.
+ *
+ * Si una fila tiene un valor nulo en alguna columna que usa la expresión, su resultado también es nulo y se escribe
+ * una línea vacía, sin error y sin llegar a evaluarla. Los nulos de cada bloque se guardan en un mapa de bits por
+ * columna, y las filas que se pueden evaluar se obtienen combinando con `&` los mapas de las columnas que se usan,
+ * de 64 en 64 filas, así que los nulos apenas cuestan y las columnas sin nulos no cuestan nada.
+ *
+ * La fila número `i` se evalúa con su propio flujo aleatorio, igual que las muestras de `mc`, así que
+ * el resultado no depende del número de hilos.
+ *
+ * Antes de evaluar las filas, la expresión se optimiza con `rewrite_polynomials()` y `elide_domain_checks()`, usando
+ * los rangos declarados para las columnas. Las filas con algún valor fuera de su rango declarado se tratan como inválidas.
+ *
+ * Si `options.approximation_tolerance` es positivo, antes de esas optimizaciones las subexpresiones costosas de una
+ * sola columna con rango declarado se sustituyen por tablas de aproximación con `approximate_univariate()`. Las tablas
+ * se construyen una vez, antes de evaluar ninguna fila, y los resultados pueden diferir de los exactos en hasta esa
+ * tolerancia.
+ *
+ * Si `options.native_dir` no está vacío, la expresión optimizada se compila con `NativeFormula::build()` y las filas
+ * se evalúan por bloques de unos pocos miles, que caben en la caché, con el núcleo por columnas de
+ * `NativeFormula::evaluate_columns()`; solo las filas en las que éste falla se vuelven a evaluar con el intérprete,
+ * para obtener el mismo error. Si la expresión no se puede compilar, se indica en `err` y se usa el intérprete.
+ *
+ * Con `options.float32`, los resultados se redondean a `float` y se escriben con la precisión de `float`. Si además
+ * hay código nativo, los bloques se evalúan con el núcleo vectorizado en precisión simple de
+ * `NativeFormula::evaluate_float()`, y solo las filas en las que éste falla se evalúan en precisión doble.
+ *
+ * Si `options.filter` no es nulo, la expresión solo se evalúa en las filas en las que el predicado da un valor distinto
+ * de cero, como la condición de `if`; las demás tienen un resultado nulo. Las columnas que usa el predicado cuentan
+ * como usadas por la expresión para los nulos. El predicado se prepara como la
+ * expresión, pero siempre en precisión doble y sin tablas de aproximación, y tiene sus propios flujos aleatorios. Si
+ * falla en una fila, el error se indica como los de la expresión. Con código nativo, el predicado se calcula antes
+ * para todo un grupo de filas con su propio núcleo, y la expresión se evalúa después solo en las filas que lo cumplen:
+ * si son pocas, se reúnen en columnas aparte para el núcleo de la expresión; si son muchas, el núcleo evalúa el grupo
+ * entero con las columnas del predicado y los resultados de las filas descartadas se ignoran.
+ *
+ * La expresión y el predicado pueden usar las funciones de ventana `rolling_sum(x, n)`, `rolling_mean(x, n)`,
+ * `rolling_min(x, n)`, `rolling_max(x, n)`, `ema(x, alpha)` y `lag(x, k)`, que recorren los valores de `x` en el orden
+ * de las filas con un `StreamWindow` (ver su documentación para el resultado de cada una). Su segundo argumento debe
+ * ser constante. Cada llamada se sustituye por una columna más: en cada bloque, su argumento se evalúa primero en
+ * todas las filas (como la expresión, pero sin filtro) y sus valores pasan por la ventana, cuyo estado continúa de un
+ * bloque al siguiente, con un coste por fila que no depende del tamaño de la ventana. Las filas en las que el
+ * argumento es nulo o da un error cuentan como nulas para la ventana, y un resultado nulo de la ventana hace nula la
+ * fila como cualquier otra columna.
+ *
+ * @param in Flujo de entrada en formato CSV con cabecera.
+ * @param out Flujo donde escribir los resultados.
+ * @param err Flujo donde escribir los errores de las filas.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación.
+ * @exception Lanza `std::runtime_error` si la cabecera de la entrada no existe o es inválida, o si se declara el
+ * rango de una variable que no es una columna, o si una función de ventana tiene un segundo argumento que no es
+ * constante o no es válido.
+ */
+void evaluate_csv(std::istream& in, std::ostream& out, std::ostream& err, const Expression& expr,
+                  const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Evalúa una expresión para cada fila de una entrada CSV y devuelve las estadísticas de los resultados.
+ *
+ * Las estadísticas se calculan a medida que se evalúan las filas, sin guardar los resultados: cada hilo
+ * acumula las filas que le tocan y los acumuladores de todos los hilos se combinan al final. Las filas con un
+ * resultado nulo, por sus valores nulos o por no cumplir `options.filter`, no cuentan, ni siquiera como errores.
+ * Los resultados NaN (de `inf - inf`, o de un campo `nan`) se cuentan aparte, fuera de las estadísticas y los cuantiles.
+ *
+ * @param in Flujo de entrada en formato CSV con cabecera.
+ * @param err Flujo donde indicar si la expresión no se ha podido compilar.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación, como en `evaluate_csv()`.
+ * @return Las estadísticas de los resultados de todas las filas.
+ * @exception Lanza `std::runtime_error` si la cabecera de la entrada no existe o es inválida, o si se declara el
+ * rango de una variable que no es una columna.
+ */
+BatchAggregate aggregate_csv(std::istream& in, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                             const BatchOptions& options = {});
+
+/**
+ * @brief Como `evaluate_csv()`, pero leyendo la entrada de un fichero y repartiéndola entre varios procesos.
+ *
+ * Si `options.processes` es mayor que 1, el fichero se divide en ese número de partes de tamaño parecido, cortando
+ * siempre al final de una línea, y cada parte se evalúa en un proceso hijo con `fork()`. Cada hijo deja su salida
+ * en memoria compartida y, cuando todos terminan, las salidas se escriben en orden, así que el resultado es el
+ * mismo que con `evaluate_csv()`. La expresión se prepara (y, si se ha pedido, se compila) antes de crear los hijos.
+ * Si la expresión o el filtro usan funciones de ventana, que necesitan las filas en orden, se evalúa en un solo proceso.
+ *
+ * @param path Ruta del fichero CSV con cabecera.
+ * @param out Flujo donde escribir los resultados.
+ * @param err Flujo donde escribir los errores de las filas.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `evaluate_csv()`, si no se puede abrir el fichero o
+ * si algún proceso hijo falla.
+ */
+void evaluate_csv_file(const std::string& path, std::ostream& out, std::ostream& err, const Expression& expr,
+                       const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Como `aggregate_csv()`, pero leyendo la entrada de un fichero y repartiéndola entre varios procesos.
+ *
+ * Las partes del fichero se reparten como en `evaluate_csv_file()`. Cada proceso hijo envía su agregado con
+ * `BatchAggregate::write_to()` y el proceso padre los combina.
+ *
+ * @param path Ruta del fichero CSV con cabecera.
+ * @param err Flujo donde indicar si la expresión no se ha podido compilar.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación.
+ * @return Las estadísticas de los resultados de todas las filas.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `evaluate_csv_file()`.
+ */
+BatchAggregate aggregate_csv_file(const std::string& path, std::ostream& err, const Expression& expr,
+                                  const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Filas leídas y evaluadas por `update_csv_file()`.
+ */
+struct DeltaUpdate {
+    uint64_t rows;      /**< Filas de la entrada. */
+    uint64_t evaluated; /**< Filas evaluadas, por ser nuevas o haber cambiado desde la actualización anterior. */
+};
+
+/**
+ * @brief Actualiza los resultados de una evaluación anterior de la misma expresión volviendo a evaluar solo las filas
+ * de la entrada que han cambiado.
+ *
+ * El fichero de resultados tiene una línea por fila, como la salida de `evaluate_csv()`, pero con cada resultado
+ * completado con espacios hasta una anchura fija. Así, el resultado de cada fila está en una posición conocida y se
+ * puede sobrescribir en su sitio. El fichero de resúmenes guarda un resumen de 64 bits del contenido de cada fila,
+ * calculado a partir de sus valores ya leídos, y una huella de las columnas, la expresión, el filtro y las opciones.
+ *
+ * Las filas se comparan por posición con las de la actualización anterior. Solo se evalúan, y se escriben en los dos
+ * ficheros, las filas cuyo resumen ha cambiado y las que no existían; si la entrada tiene menos filas que antes, los
+ * ficheros se recortan. La entrada se sigue leyendo entera para calcular los resúmenes, pero el coste de evaluar y de
+ * escribir es proporcional a las filas cambiadas. Los errores se indican en `err` solo para las filas evaluadas.
+ *
+ * Si alguno de los ficheros no existe, está incompleto o es de otra expresión u otras opciones, o si la actualización
+ * anterior se interrumpió, se evalúan todas las filas. Los ficheros usan el orden de bytes de la máquina, y
+ * `symbols` debe ser el mismo en todas las actualizaciones, ya que no forma parte de la huella.
+ *
+ * @param input_path Ruta del fichero CSV con cabecera.
+ * @param result_path Ruta del fichero de resultados. Se crea si no existe.
+ * @param hash_path Ruta del fichero de resúmenes. Se crea si no existe.
+ * @param err Flujo donde escribir los errores de las filas evaluadas.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación, como en `evaluate_csv()`. `options.processes` se ignora.
+ * @return Las filas de la entrada y las que se han evaluado.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `evaluate_csv()`, si no se pueden abrir o escribir
+ * los ficheros, o si la expresión o el filtro usan funciones de ventana, cuyo resultado depende de otras filas.
+ */
+DeltaUpdate update_csv_file(const std::string& input_path, const std::string& result_path, const std::string& hash_path,
+                            std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                            const BatchOptions& options = {});
+
+/**
+ * @brief Evalúa varias expresiones para cada fila de una entrada CSV, leyéndola una sola vez, y escribe una tabla CSV
+ * con una columna de resultados por expresión.
+ *
+ * La tabla empieza con una cabecera con los nombres de las expresiones, seguida de una línea por fila de la entrada,
+ * en el mismo orden. Cada expresión se prepara y se evalúa como en `evaluate_csv()`, con su propio flujo aleatorio
+ * por fila, así que cada columna tiene los mismos valores y los mismos nulos que se obtendrían evaluando su expresión
+ * sola (con `options.float32`, salvo quizá en el último bit, según qué funciones vectorice el compilador en cada
+ * núcleo). Si una expresión falla en una fila, se escribe `nan` en su lugar y el error se indica en `err` junto al
+ * número de línea y al nombre de la expresión.
+ *
+ * La diferencia está en el código nativo: si `options.native_dir` no está vacío, todas las expresiones se compilan
+ * juntas con `NativeProgram`, y cada bloque de filas se pasa a columnas una sola vez y se evalúa con un único núcleo
+ * que calcula todas las expresiones y comparte entre ellas las subexpresiones comunes. Las expresiones que no se
+ * pueden compilar, y las filas en las que el núcleo falla, se evalúan con el intérprete.
+ *
+ * @param in Flujo de entrada en formato CSV con cabecera.
+ * @param out Flujo donde escribir la tabla de resultados.
+ * @param err Flujo donde escribir los errores de las filas.
+ * @param names Nombre de cada expresión, para la cabecera de la tabla. Deben ser identificadores distintos.
+ * @param exprs Expresiones a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación. `options.processes` se ignora.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `evaluate_csv()`, si no hay expresiones, si no hay
+ * un nombre por expresión o si algún nombre no es un identificador o está repetido.
+ */
+void evaluate_csv_fused(std::istream& in, std::ostream& out, std::ostream& err, const std::vector<std::string>& names,
+                        const std::vector<Expression>& exprs, const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Evalúa una expresión para cada fila de un flujo IPC de Apache Arrow y escribe los resultados como otro flujo.
+ *
+ * Las columnas `float64` e `int64` cuyo nombre es un identificador son las variables de la expresión; las demás
+ * columnas se ignoran. Por cada lote de la entrada se escribe un lote con el mismo número de filas y una única
+ * columna `float64` llamada `result`.
+ *
+ * Si alguna variable que usa la expresión es nula en una fila, el resultado de esa fila es nulo. Si una fila tiene
+ * un valor fuera de su rango declarado o su evaluación falla, el resultado también es nulo y el error se indica en
+ * `err` junto al número de fila (desde 1). Las filas que no cumplen `options.filter` también dan un resultado nulo,
+ * sin error. Por lo demás, la evaluación es como en `evaluate_csv()`, y las funciones de ventana recorren las filas de
+ * todos los lotes seguidas.
+ *
+ * @param in Flujo de entrada en formato IPC de Arrow, en modo binario.
+ * @param out Flujo donde escribir los resultados, en modo binario.
+ * @param err Flujo donde escribir los errores de las filas.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación. `options.processes` se ignora.
+ * @exception Lanza `std::runtime_error` si la entrada no es un flujo de Arrow válido o tiene columnas no admitidas por
+ * `ArrowStreamReader`, o si se declara el rango de una variable que no es una columna.
+ */
+void evaluate_arrow(std::istream& in, std::ostream& out, std::ostream& err, const Expression& expr,
+                    const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Evalúa una expresión para cada fila de un flujo IPC de Apache Arrow y devuelve las estadísticas de los resultados.
+ *
+ * Las filas con alguna variable nula no se cuentan ni como resultados ni como errores.
+ *
+ * @param in Flujo de entrada en formato IPC de Arrow, en modo binario.
+ * @param err Flujo donde indicar si la expresión no se ha podido compilar.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son columnas de la entrada. Solo se lee.
+ * @param options Opciones de la evaluación, como en `evaluate_arrow()`.
+ * @return Las estadísticas de los resultados de todas las filas.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `evaluate_arrow()`.
+ */
+BatchAggregate aggregate_arrow(std::istream& in, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                               const BatchOptions& options = {});
+
+/**
+ * @brief Eje de una malla de parámetros: `points` valores equiespaciados de una variable entre `lo` y `hi`, ambos incluidos.
+ */
+struct SweepAxis {
+    std::string name; /**< Nombre de la variable. */
+    double lo;        /**< Primer valor. */
+    double hi;        /**< Último valor. */
+    uint64_t points;  /**< Número de valores, al menos 1. Con 1, el único valor es `lo`. */
+
+    /**
+     * @brief Devuelve el valor número `i` (desde 0) del eje.
+     *
+     * @pre `i < points`.
+     */
+    double value(uint64_t i) const noexcept;
+};
+
+/**
+ * @brief Punto de una malla de parámetros junto al valor de la expresión en él.
+ */
+struct SweepPoint {
+    uint64_t index; /**< Posición del punto en el orden de la malla (el último eje es el que varía más rápido). */
+    double value;   /**< Valor de la expresión en el punto. */
+};
+
+/**
+ * @brief Resumen de los valores de una expresión sobre una malla de parámetros: estadísticas, puntos del mínimo y
+ * del máximo y los `k` mejores puntos.
+ *
+ * Como `BatchAggregate`, los resúmenes son combinables y ocupan una memoria acotada, independiente del tamaño de la malla.
+ */
+class SweepSummary {
+  private:
+    BatchAggregate m_aggregate;     /**< Estadísticas de los valores. */
+    std::vector<SweepPoint> m_best; /**< Hasta `m_top_k` mejores puntos, como montículo con el peor de ellos en cabeza. */
+    size_t m_top_k;                 /**< Número de mejores puntos que se guardan. */
+    bool m_maximize;                /**< Si los mejores puntos son los de mayor valor en lugar de los de menor. */
+    std::optional<SweepPoint> m_argmin; /**< Punto del menor valor, el primero en caso de empate. */
+    std::optional<SweepPoint> m_argmax; /**< Punto del mayor valor, el primero en caso de empate. */
+
+    bool better(const SweepPoint& a, const SweepPoint& b) const noexcept;
+    void offer(const SweepPoint& point);
+  public:
+    /**
+     * @brief Construye un resumen vacío.
+     *
+     * @param top_k Número de mejores puntos que se guardan.
+     * @param maximize Si los mejores puntos son los de mayor valor en lugar de los de menor.
+     */
+    explicit SweepSummary(size_t top_k = 0, bool maximize = false);
+
+    /**
+     * @brief Añade el valor de un punto. Los valores NaN solo se cuentan, como en `BatchAggregate::push()`.
+     */
+    void push(uint64_t index, double value);
+
+    /**
+     * @brief Cuenta un punto cuya evaluación ha fallado.
+     */
+    void push_error() noexcept;
+
+    /**
+     * @brief Combina otro resumen, del mismo número de mejores puntos y sentido, con éste.
+     */
+    void merge(const SweepSummary& other);
+
+    /**
+     * @brief Devuelve las estadísticas de los valores.
+     */
+    const BatchAggregate& aggregate() const noexcept;
+
+    /**
+     * @brief Devuelve el punto del menor valor, o `std::nullopt` si no hay ninguno.
+     */
+    std::optional<SweepPoint> argmin() const noexcept;
+
+    /**
+     * @brief Devuelve el punto del mayor valor, o `std::nullopt` si no hay ninguno.
+     */
+    std::optional<SweepPoint> argmax() const noexcept;
+
+    /**
+     * @brief Devuelve los mejores puntos, del mejor al peor (a igual valor, por orden en la malla).
+     */
+    std::vector<SweepPoint> best() const;
+
+    /**
+     * @brief Escribe el resumen como líneas `clave,valor`: las de `BatchAggregate::print_to()`, seguidas de
+     * `argmin` y `argmax` con las coordenadas de su punto (`argmin,x=1,y=2`) y de `top1`, `top2`, ... con el valor
+     * y las coordenadas de cada uno de los mejores puntos.
+     *
+     * @param os Flujo de salida.
+     * @param axes Ejes de la malla, para calcular las coordenadas de los puntos.
+     */
+    void print_to(std::ostream& os, const std::vector<SweepAxis>& axes) const;
+};
+
+/**
+ * @brief Evalúa una expresión en todos los puntos de una malla de parámetros y escribe una tabla CSV con los resultados.
+ *
+ * La malla es el producto cartesiano de los ejes, recorrido con el último eje variando más rápido. Los puntos se 
+ * generan a medida que se evalúan, por bloques que se reparten entre todos los hilos, así que la memoria usada no
+ * depende del tamaño de la malla. La tabla tiene una columna por eje y una columna `result`, y una fila por punto,
+ * en el orden de la malla.
+ *
+ * Los valores de cada eje se declaran como rango de su variable, en lugar de `options.ranges`, así que la expresión se
+ * optimiza, se compila y se evalúa igual que en `evaluate_csv()`. Si la evaluación de un punto falla, se escribe `nan`
+ * en su lugar y el error se indica en `err` junto al número de punto (desde 1). Con `options.filter`, los puntos que no
+ * lo cumplen tienen un resultado nulo, que se deja vacío.
+ *
+ * @param axes Ejes de la malla.
+ * @param out Flujo donde escribir la tabla.
+ * @param err Flujo donde escribir los errores de los puntos.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son ejes de la malla. Solo se lee.
+ * @param options Opciones de la evaluación. `options.ranges` y `options.processes` se ignoran.
+ * @exception Lanza `std::runtime_error` si no hay ejes, si algún eje no tiene puntos, tiene extremos no finitos o
+ * un nombre que no es un identificador o está repetido, si la malla tiene más de 2^63 puntos, o si la expresión o
+ * el filtro usan funciones de ventana.
+ */
+void sweep_table(const std::vector<SweepAxis>& axes, std::ostream& out, std::ostream& err, const Expression& expr,
+                 const SymbolTable& symbols, const BatchOptions& options = {});
+
+/**
+ * @brief Evalúa una expresión en todos los puntos de una malla de parámetros y devuelve solo su resumen.
+ *
+ * La malla se recorre como en `sweep_table()`, y cada hilo acumula su propio `SweepSummary`.
+ *
+ * @param axes Ejes de la malla.
+ * @param err Flujo donde indicar si la expresión no se ha podido compilar.
+ * @param expr Expresión a evaluar.
+ * @param symbols Tabla de símbolos con las variables que no son ejes de la malla. Solo se lee.
+ * @param options Opciones de la evaluación, como en `sweep_table()`.
+ * @param top_k Número de mejores puntos que se guardan.
+ * @param maximize Si los mejores puntos son los de mayor valor en lugar de los de menor.
+ * @return El resumen de los valores en todos los puntos.
+ * @exception Lanza `std::runtime_error` en los mismos casos que `sweep_table()`.
+ */
+SweepSummary sweep_summary(const std::vector<SweepAxis>& axes, std::ostream& err, const Expression& expr,
+                           const SymbolTable& symbols, const BatchOptions& options = {}, size_t top_k = 0,
+                           bool maximize = false);
+
+} // namespace clex
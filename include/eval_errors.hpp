@@ -127,4 +127,26 @@ class ComplexResultError : public EvalError {
     virtual void print_to(std::ostream& out) const noexcept override;
 };
 
+/**
+ * @brief Error producido por un argumento inválido en una llamada a función.
+ *
+ * Este error se lanza cuando un argumento de una función tiene un valor fuera de
+ * los permitidos, por ejemplo un número de muestras no entero o negativo en `mc`.
+ */
+class InvalidArgument : public EvalError {
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param message Mensaje descriptivo del problema con el argumento.
+     * @param call Expresión de la llamada que recibió el argumento inválido.
+     */
+    InvalidArgument(std::string&& message, std::unique_ptr<Expression>&& call) noexcept;
+
+    /**
+     * @brief Sobrecarga de `EvalError::print_to()`
+     */
+    virtual void print_to(std::ostream& out) const noexcept override;
+};
+
 } // namespace clex
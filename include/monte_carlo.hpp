@@ -0,0 +1,42 @@
+/**
+ * @file monte_carlo.hpp
+ * @brief Estimación de Monte Carlo en paralelo, usada por las funciones `mc` y `mcerr`.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include <cstdint>
+
+namespace clex {
+
+/**
+ * @brief Resultado de una estimación de Monte Carlo.
+ */
+struct MonteCarloResult {
+    double mean;      /**< Media de las muestras. */
+    double std_error; /**< Error estándar de la media (desviación típica muestral entre $\sqrt{n}$). */
+};
+
+/**
+ * @brief Evalúa una expresión `samples` veces y devuelve la media y su error estándar.
+ *
+ * La muestra número `i` se evalúa con su propio flujo aleatorio (`RandomStream` con número de flujo `i`),
+ * y las muestras se agrupan en bloques de tamaño fijo que se reparten entre todos los núcleos disponibles.
+ * Como las estadísticas de cada bloque se combinan siempre en el mismo orden, el resultado es idéntico bit
+ * a bit sea cual sea el número de hilos. La clave de los flujos se extrae del flujo aleatorio activo al
+ * llamar a esta función, así que llamadas sucesivas usan muestras distintas.
+ *
+ * @param body Expresión a evaluar en cada muestra, normalmente con llamadas a `rand()` o `randn()`.
+ * @param symbols Tabla de símbolos usada para la evaluación. Solo se lee, nunca se modifica.
+ * @param samples Número de muestras.
+ * @return La media de las muestras y su error estándar.
+ * @exception Lanza el `EvalError` producido por la primera muestra que falle, si alguna lo hace.
+ * @pre `samples > 0`
+ */
+MonteCarloResult monte_carlo(const Expression& body, const SymbolTable& symbols, uint64_t samples);
+
+} // namespace clex
@@ -0,0 +1,270 @@
+/**
+ * @file native.hpp
+ * @brief Compilación anticipada de expresiones a bibliotecas compartidas nativas.
+ *
+ * Una expresión se traduce a código C++ de una sola función, con las variables que cambian entre evaluaciones
+ * leídas de un vector de valores por posición y las demás sustituidas por su valor. Ese código se compila con el
+ * compilador instalado en el sistema a una biblioteca compartida que se guarda en un directorio de caché, así que
+ * solo se compila la primera vez que se usa cada expresión.
+ *
+ * Opcionalmente, la biblioteca incluye también un núcleo en precisión simple que evalúa muchas filas a la vez,
+ * con las variables dispuestas por columnas y sin saltos, para que el compilador lo vectorice con el doble de
+ * valores por registro que en precisión doble.
+ *
+ * Varias expresiones sobre las mismas variables se pueden compilar también juntas con `NativeProgram`, a un único
+ * núcleo por columnas que las calcula todas en cada fila y comparte las subexpresiones comunes.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Expresión compilada a código nativo y cargada desde una biblioteca compartida.
+ *
+ * El código generado hace las mismas comprobaciones de dominio que `Expression::evaluate()`, pero en lugar de
+ * lanzar una excepción indica que la evaluación ha fallado. En ese caso se debe evaluar la expresión original
+ * para obtener el error concreto (o el resultado, en los casos poco habituales en los que el código nativo
+ * se rinde antes que el intérprete, como un polinomio que da NaN).
+ */
+class NativeFormula {
+  public:
+    /// Función generada para una evaluación, que devuelve `0` si tiene éxito.
+    using Function = int (*)(const double*, double*);
+    /// Núcleo generado en precisión simple: columnas, número de filas, resultados y filas fallidas.
+    using FloatKernel = void (*)(const float* const*, std::size_t, float*, unsigned char*);
+    /// Núcleo generado en precisión doble, con los mismos argumentos que `FloatKernel`.
+    using DoubleKernel = void (*)(const double* const*, std::size_t, double*, unsigned char*);
+  private:
+    void* m_handle;              /**< Biblioteca compartida abierta con `dlopen`. */
+    Function m_function;         /**< Función generada. */
+    FloatKernel m_kernel;        /**< Núcleo en precisión simple, o nulo si no se ha pedido. */
+    DoubleKernel m_double_kernel; /**< Núcleo por columnas en precisión doble, o nulo si no se ha pedido. */
+
+    NativeFormula(void* handle, Function function, FloatKernel kernel, DoubleKernel double_kernel) noexcept;
+  public:
+    /**
+     * @brief Compila una expresión, o carga la biblioteca ya compilada si está en la caché.
+     *
+     * La biblioteca se identifica por una suma de comprobación del código generado, que también se guarda dentro
+     * de la propia biblioteca. Si la biblioteca de la caché no contiene la suma esperada, se descarta y se vuelve
+     * a compilar. El compilador usado es el de la variable de entorno `CXX`, o `c++` si no está definida.
+     *
+     * @param expr Expresión a compilar.
+     * @param slots Variables que cambian entre evaluaciones, en el orden en que se pasan a `evaluate()`.
+     * @param constants Tabla de símbolos con los valores de las demás variables, que se copian en el código.
+     * @param cache_dir Directorio donde se guardan el código generado y las bibliotecas compiladas. Debe existir.
+     * @param float_kernel Si se genera también el núcleo en precisión simple de `evaluate_float()`.
+     * @param double_kernel Si se genera también el núcleo por columnas en precisión doble de `evaluate_columns()`.
+     * @return La expresión compilada.
+     * @exception Lanza `std::runtime_error` si la expresión contiene llamadas a `rand`, `randn`, `mc` o `mcerr`,
+     * que no se pueden compilar, o si la compilación o la carga de la biblioteca fallan.
+     */
+    static NativeFormula build(const Expression& expr, const std::vector<Token>& slots, const SymbolTable& constants,
+                               const std::string& cache_dir, bool float_kernel = false, bool double_kernel = false);
+
+    NativeFormula(const NativeFormula&) = delete;
+    NativeFormula& operator=(const NativeFormula&) = delete;
+
+    /// Constructor de movimiento.
+    NativeFormula(NativeFormula&& other) noexcept;
+
+    /// Asignación por movimiento.
+    NativeFormula& operator=(NativeFormula&& other) noexcept;
+
+    /// Destructor, cierra la biblioteca compartida.
+    ~NativeFormula();
+
+    /**
+     * @brief Evalúa la expresión compilada.
+     *
+     * @param slots Valores de las variables, en el orden de `slots` en `build()`.
+     * @param result Donde escribir el resultado si la evaluación tiene éxito.
+     * @return `true` si la evaluación tiene éxito, o `false` si la expresión original se debe evaluar con el intérprete.
+     */
+    bool evaluate(const double* slots, double& result) const noexcept;
+
+    /**
+     * @brief Indica si la biblioteca tiene el núcleo en precisión simple.
+     */
+    bool has_float_kernel() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión en precisión simple para varias filas.
+     *
+     * Todas las operaciones se hacen en `float`, incluidas las constantes, así que los resultados pueden diferir de
+     * los de `evaluate()` en el redondeo, y una fila puede fallar (por ejemplo, por un valor que se redondea a cero)
+     * aunque en precisión doble no falle. Las filas fallidas se deben evaluar de nuevo por otra vía.
+     *
+     * @param columns Valores de cada variable, en el orden de `slots` en `build()`, uno por fila.
+     * @param rows Número de filas.
+     * @param results Donde escribir el resultado de cada fila. Solo es válido en las filas que no han fallado.
+     * @param failed Donde indicar, con un valor distinto de cero, las filas en las que la evaluación ha fallado.
+     * @pre `has_float_kernel()`.
+     */
+    void evaluate_float(const float* const* columns, size_t rows, float* results, uint8_t* failed) const noexcept;
+
+    /**
+     * @brief Indica si la biblioteca tiene el núcleo por columnas en precisión doble.
+     */
+    bool has_double_kernel() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión en precisión doble para varias filas, con el mismo bucle sin saltos que
+     * `evaluate_float()`.
+     *
+     * Cada fila da exactamente el mismo resultado que `evaluate()`: las operaciones aritméticas son las mismas y las
+     * funciones matemáticas se llaman con sus variantes escalares. Las filas que fallan, y las que pasan por una
+     * tabla de aproximación, se deben evaluar de nuevo con `evaluate()` o con el intérprete.
+     *
+     * @param columns Valores de cada variable, en el orden de `slots` en `build()`, uno por fila.
+     * @param rows Número de filas.
+     * @param results Donde escribir el resultado de cada fila. Solo es válido en las filas que no han fallado.
+     * @param failed Donde indicar, con un valor distinto de cero, las filas en las que la evaluación ha fallado.
+     * @pre `has_double_kernel()`.
+     */
+    void evaluate_columns(const double* const* columns, size_t rows, double* results, uint8_t* failed) const noexcept;
+};
+
+/**
+ * @brief Genera el código C++ que `NativeFormula::build()` compila para una expresión.
+ *
+ * @param expr Expresión a traducir.
+ * @param slots Variables que cambian entre evaluaciones, como en `NativeFormula::build()`.
+ * @param constants Tabla de símbolos con los valores de las demás variables.
+ * @param float_kernel Si se incluye el núcleo en precisión simple.
+ * @param double_kernel Si se incluye el núcleo por columnas en precisión doble.
+ * @return El código fuente de la biblioteca, sin la suma de comprobación.
+ * @exception Lanza `std::runtime_error` si la expresión contiene llamadas a `rand`, `randn`, `mc` o `mcerr`.
+ */
+std::string native_source(const Expression& expr, const std::vector<Token>& slots, const SymbolTable& constants,
+                          bool float_kernel = false, bool double_kernel = false);
+
+/**
+ * @brief Varias expresiones sobre las mismas variables compiladas juntas a un único núcleo por columnas.
+ *
+ * El núcleo recorre las filas una sola vez y, en cada una, calcula todas las expresiones y escribe sus resultados
+ * seguidos, así que los valores de las variables se leen una vez en lugar de una por expresión.
+ * Los cálculos que se repiten, dentro de una expresión o entre varias (como `x*y` o `log(z)` en muchas de ellas),
+ * se hacen una sola vez por fila. Las comprobaciones de dominio se siguen haciendo en cada expresión que las
+ * necesita, de modo que cada expresión falla exactamente en las mismas filas y da los mismos resultados que con
+ * `NativeFormula::evaluate_columns()` o `NativeFormula::evaluate_float()`.
+ *
+ * Las expresiones con llamadas a `rand`, `randn`, `mc` o `mcerr` no se pueden compilar, pero no impiden compilar las
+ * demás: se incluyen en el núcleo como expresiones que fallan en todas las filas.
+ */
+class NativeProgram {
+  public:
+    /// Núcleo generado en precisión simple: columnas, número de filas, y resultados y fallos por filas.
+    using FloatKernel = void (*)(const float* const*, std::size_t, float*, unsigned char*);
+    /// Núcleo generado en precisión doble, con los mismos argumentos que `FloatKernel`.
+    using DoubleKernel = void (*)(const double* const*, std::size_t, double*, unsigned char*);
+  private:
+    void* m_handle;                 /**< Biblioteca compartida abierta con `dlopen`. */
+    FloatKernel m_kernel;           /**< Núcleo en precisión simple, o nulo si es de precisión doble. */
+    DoubleKernel m_double_kernel;   /**< Núcleo en precisión doble, o nulo si es de precisión simple. */
+    std::vector<uint8_t> m_compiled; /**< Si cada expresión se ha compilado. */
+    size_t m_reused;                /**< Valores que se reutilizan en cada fila en lugar de volver a calcularlos. */
+
+    NativeProgram(void* handle, FloatKernel kernel, DoubleKernel double_kernel, std::vector<uint8_t>&& compiled,
+                  size_t reused) noexcept;
+  public:
+    /**
+     * @brief Compila varias expresiones juntas, o carga la biblioteca ya compilada si está en la caché.
+     *
+     * La caché y el compilador son los mismos que en `NativeFormula::build()`.
+     *
+     * @param exprs Expresiones a compilar, en el orden de las columnas de resultados.
+     * @param slots Variables que cambian entre filas, en el orden de las columnas de entrada.
+     * @param constants Tabla de símbolos con los valores de las demás variables, que se copian en el código.
+     * @param cache_dir Directorio donde se guardan el código generado y las bibliotecas compiladas. Debe existir.
+     * @param single Si el núcleo es de precisión simple, para `evaluate_float()`, en lugar de precisión doble.
+     * @return Las expresiones compiladas.
+     * @exception Lanza `std::invalid_argument` si `exprs` está vacío, o `std::runtime_error` si la compilación o la
+     * carga de la biblioteca fallan.
+     */
+    static NativeProgram build(const std::vector<Expression>& exprs, const std::vector<Token>& slots,
+                               const SymbolTable& constants, const std::string& cache_dir, bool single = false);
+
+    NativeProgram(const NativeProgram&) = delete;
+    NativeProgram& operator=(const NativeProgram&) = delete;
+
+    /// Constructor de movimiento.
+    NativeProgram(NativeProgram&& other) noexcept;
+
+    /// Asignación por movimiento.
+    NativeProgram& operator=(NativeProgram&& other) noexcept;
+
+    /// Destructor, cierra la biblioteca compartida.
+    ~NativeProgram();
+
+    /**
+     * @brief Devuelve el número de expresiones.
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @brief Indica si la expresión número `k` se ha compilado; si no, falla en todas las filas.
+     */
+    bool is_compiled(size_t k) const noexcept;
+
+    /**
+     * @brief Devuelve el número de valores que el núcleo reutiliza en cada fila en lugar de volver a calcularlos.
+     */
+    size_t reused_values() const noexcept;
+
+    /**
+     * @brief Indica si el núcleo es de precisión simple.
+     */
+    bool has_float_kernel() const noexcept;
+
+    /**
+     * @brief Evalúa todas las expresiones en precisión simple para varias filas, como `NativeFormula::evaluate_float()`.
+     *
+     * @param columns Valores de cada variable, en el orden de `slots` en `build()`, uno por fila.
+     * @param rows Número de filas.
+     * @param results Donde escribir los resultados por filas: `results[row * size() + k]` es el de la expresión `k`
+     * en la fila `row`. Solo son válidos los que no han fallado.
+     * @param failed Donde indicar, con un valor distinto de cero y en el mismo orden que `results`, las expresiones
+     * que fallan en cada fila.
+     * @pre `has_float_kernel()`.
+     */
+    void evaluate_float(const float* const* columns, size_t rows, float* results, uint8_t* failed) const noexcept;
+
+    /**
+     * @brief Evalúa todas las expresiones en precisión doble para varias filas, como
+     * `NativeFormula::evaluate_columns()`.
+     *
+     * @param columns Valores de cada variable, en el orden de `slots` en `build()`, uno por fila.
+     * @param rows Número de filas.
+     * @param results Donde escribir los resultados por filas, como en `evaluate_float()`.
+     * @param failed Donde indicar las expresiones que fallan en cada fila, como en `evaluate_float()`.
+     * @pre `!has_float_kernel()`.
+     */
+    void evaluate_columns(const double* const* columns, size_t rows, double* results, uint8_t* failed) const noexcept;
+};
+
+/**
+ * @brief Genera el código C++ que `NativeProgram::build()` compila para varias expresiones.
+ *
+ * @param exprs Expresiones a traducir.
+ * @param slots Variables que cambian entre filas, como en `NativeProgram::build()`.
+ * @param constants Tabla de símbolos con los valores de las demás variables.
+ * @param single Si el núcleo es de precisión simple.
+ * @param reused Si no es nulo, donde escribir el número de valores que se reutilizan en cada fila.
+ * @return El código fuente de la biblioteca, sin la suma de comprobación.
+ */
+std::string native_program_source(const std::vector<Expression>& exprs, const std::vector<Token>& slots,
+                                  const SymbolTable& constants, bool single = false, size_t* reused = nullptr);
+
+} // namespace clex
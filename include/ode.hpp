@@ -0,0 +1,122 @@
+/**
+ * @file ode.hpp
+ * @brief Integración numérica de sistemas de ecuaciones diferenciales ordinarias, usada por la función `ode` y
+ * por el modo `--ode` de la línea de órdenes.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "native.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Sistema de ecuaciones diferenciales `y' = f(t, y)` con los lados derechos preparados para evaluarse
+ * muchas veces.
+ *
+ * Los lados derechos se reescriben con `rewrite_polynomials()` al construir el sistema y, si se indica un
+ * directorio de caché, se compilan con `NativeFormula::build()`, así que cada evaluación se hace directamente
+ * sobre el árbol ya optimizado o sobre el código nativo, sin volver a analizar ningún texto.
+ */
+class OdeSystem {
+  private:
+    std::vector<Expression> m_rhs;                   /**< Lados derechos optimizados, uno por variable de estado. */
+    std::vector<std::optional<NativeFormula>> m_native; /**< Código nativo de cada lado derecho, si se ha compilado. */
+    std::vector<Token> m_slots;                      /**< Variables de estado seguidas de la variable de tiempo. */
+    std::vector<double> m_slot_values;               /**< Valores de `m_slots` en la evaluación actual. */
+    SymbolTable m_symbols;                           /**< Constantes, donde se asignan las variables para el intérprete. */
+  public:
+    /**
+     * @brief Prepara un sistema de ecuaciones.
+     *
+     * @param rhs Lados derechos: `rhs[i]` es la derivada de `states[i]` respecto del tiempo.
+     * @param states Tokens identificadores de las variables de estado.
+     * @param time Token identificador de la variable de tiempo.
+     * @param symbols Tabla de símbolos con los valores de los parámetros que no son estado ni tiempo.
+     * @param native_dir Directorio de caché para compilar los lados derechos, o vacío para usar el intérprete. Si
+     * alguno no se puede compilar, ése se evalúa con el intérprete.
+     * @exception Lanza `std::invalid_argument` si `rhs` y `states` no tienen el mismo tamaño o están vacíos.
+     */
+    OdeSystem(const std::vector<Expression>& rhs, const std::vector<Token>& states, const Token& time,
+              const SymbolTable& symbols, const std::string& native_dir = "");
+
+    /**
+     * @brief Devuelve el número de variables de estado.
+     */
+    size_t dimension() const noexcept;
+
+    /**
+     * @brief Indica si todos los lados derechos se han compilado a código nativo.
+     */
+    bool is_native() const noexcept;
+
+    /**
+     * @brief Evalúa los lados derechos.
+     *
+     * @param t Valor de la variable de tiempo.
+     * @param y Valores de las variables de estado, `dimension()` elementos.
+     * @param dy Donde escribir las derivadas, `dimension()` elementos.
+     * @exception Lanza el `EvalError` producido por el primer lado derecho que falle.
+     */
+    void derivatives(double t, const double* y, double* dy);
+};
+
+/**
+ * @brief Método de integración.
+ */
+enum class OdeMethod {
+    RK45, /**< Dormand–Prince 5(4) con paso adaptativo y salida densa. */
+    RK4,  /**< Runge–Kutta clásico de orden 4 con paso fijo. */
+};
+
+/**
+ * @brief Opciones de `integrate_ode()`.
+ */
+struct OdeOptions {
+    OdeMethod method = OdeMethod::RK45; /**< Método de integración. */
+    double relative_tolerance = 1e-8;   /**< Tolerancia relativa del error local de RK45. */
+    double absolute_tolerance = 1e-10;  /**< Tolerancia absoluta del error local de RK45. */
+    double step = 0.0;                  /**< Paso máximo de RK4, o 0 para dar un solo paso entre dos tiempos de salida. */
+    uint64_t max_steps = 10'000'000;    /**< Número máximo de pasos, aceptados o no. */
+};
+
+/**
+ * @brief Integra un sistema de ecuaciones desde `t0` y entrega el estado en una lista de tiempos de salida.
+ *
+ * Con `OdeMethod::RK45`, el tamaño del paso se ajusta para que el error local estimado de cada componente no
+ * supere `absolute_tolerance + relative_tolerance * |y|` (en media cuadrática), y el estado en los tiempos de
+ * salida que caen dentro de un paso se obtiene con la interpolación de orden 4 propia del método, sin acortar el
+ * paso. Con `OdeMethod::RK4`, cada intervalo entre tiempos de salida consecutivos se divide en el menor número de
+ * pasos iguales que no superan `step`, así que los tiempos de salida se alcanzan exactamente.
+ *
+ * El estado se entrega a `on_output` a medida que se calcula, en el orden de `times`, sin guardar la trayectoria.
+ *
+ * Con RK45, si un lado derecho falla en una etapa intermedia, el paso se rechaza y se reintenta con uno más corto;
+ * el error solo se propaga si falla en el estado inicial, y si el paso se hace demasiado pequeño se incluye en el
+ * mensaje del `std::runtime_error`.
+ *
+ * @param system Sistema a integrar.
+ * @param t0 Tiempo inicial.
+ * @param y0 Estado en `t0`, `system.dimension()` elementos.
+ * @param times Tiempos de salida, ordenados en el sentido de la integración (crecientes o decrecientes) y sin
+ * quedar antes de `t0` en ese sentido. El último es el tiempo final.
+ * @param options Opciones de la integración.
+ * @param on_output Función llamada con cada tiempo de salida y el estado en él.
+ * @exception Lanza el `EvalError` producido por los lados derechos, si alguno falla, o `std::runtime_error` si
+ * `times` no está ordenado, si algún tiempo o el estado inicial no es finito, si el paso de RK45 se hace demasiado
+ * pequeño (normalmente porque la solución explota) o si se supera `max_steps`.
+ */
+void integrate_ode(OdeSystem& system, double t0, const std::vector<double>& y0, const std::vector<double>& times,
+                   const OdeOptions& options, const std::function<void(double, const std::vector<double>&)>& on_output);
+
+} // namespace clex
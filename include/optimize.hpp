@@ -0,0 +1,65 @@
+/**
+ * @file optimize.hpp
+ * @brief Minimización numérica de expresiones, usada por las funciones `minimize` y `argmin`.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Método con el que se ha obtenido el mínimo.
+ */
+enum class MinimizationMethod {
+    LBFGS,       /**< L-BFGS con gradientes por diferenciación automática. */
+    NELDER_MEAD, /**< Nelder–Mead, que solo usa valores de la expresión. */
+};
+
+/**
+ * @brief Resultado de una minimización.
+ */
+struct MinimizationResult {
+    std::vector<double> point;  /**< Valores de las variables en el mínimo, en el orden en que se pasaron. */
+    double value;               /**< Valor de la expresión en `point`. */
+    MinimizationMethod method;  /**< Último método usado. */
+    size_t iterations;          /**< Número de iteraciones, sumando las de ambos métodos. */
+    bool converged;             /**< `false` si se ha agotado el límite de iteraciones antes de converger. */
+};
+
+/**
+ * @brief Busca un mínimo local de una expresión respecto de algunas de sus variables.
+ *
+ * El punto inicial es el valor de cada variable en `symbols`, o 0 si no está definida; el resto de identificadores
+ * se leen de `symbols` y se tratan como constantes.
+ *
+ * Si la expresión es suave (solo tiene `+`, `-`, `*`, `/`, `^` y operadores unarios distintos de `not`), se
+ * minimiza con L-BFGS, calculando el gradiente por diferenciación automática en modo inverso sobre el árbol de
+ * sintaxis. Si tiene condicionales, comparaciones, operadores lógicos o llamadas a función, o si L-BFGS no puede
+ * avanzar sin haber llegado a un punto de gradiente nulo (por ejemplo, porque el gradiente no es finito), se usa
+ * Nelder–Mead, que no necesita derivadas. También se usa si el gradiente ya es nulo en el punto inicial, que
+ * podría ser un punto de silla. Los puntos en los que la expresión da un error de evaluación o un valor
+ * no finito se descartan durante la búsqueda.
+ *
+ * La búsqueda no depende del orden de `variables`: internamente se ordenan por nombre, así que dos llamadas que
+ * solo difieren en ese orden llegan al mismo punto bit a bit.
+ *
+ * @param objective Expresión a minimizar.
+ * @param symbols Tabla de símbolos con los valores iniciales y las constantes. Solo se lee, nunca se modifica.
+ * @param variables Tokens identificadores de las variables respecto de las que se minimiza, sin repetir.
+ * @return El mejor punto encontrado y el valor de la expresión en él.
+ * @exception Lanza el `EvalError` producido al evaluar la expresión en el punto inicial, si lo hay.
+ * @exception Lanza `std::runtime_error` si la expresión no está acotada inferiormente, lo que se detecta porque la
+ * búsqueda acaba con alguna variable más de 1e100 veces más lejos de 0 que la mayor del punto inicial (o que 1).
+ * @pre `variables` no está vacío, y sus elementos son identificadores distintos.
+ */
+MinimizationResult minimize(const Expression& objective, const SymbolTable& symbols, const std::vector<Token>& variables);
+
+} // namespace clex
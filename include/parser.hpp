@@ -2,6 +2,9 @@
 #include "tokens.hpp"
 #include "syntax_tree.hpp"
 #include "token_list.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace clex {
@@ -9,11 +12,17 @@ namespace clex {
 class Parser {
   private:  
     TokenList m_tokens;
+    std::vector<std::string> m_locals; // nombres definidos por los `let` que contienen la posición actual, del más exterior al más interior
 
     Expression parse_expression_recursive(int minimal_binding_power);
     Token expect_operand_token();
     Expression parse_expression();
+    std::vector<std::unique_ptr<Expression>> parse_argument_list(size_t arg_count, bool variadic = false);
+    Expression parse_conditional(Token&& consumed_if_token);
+    Expression parse_call(Token&& consumed_func_token);
+    Expression parse_let();
     Assignment parse_assignment(Token&& consumed_var_token);
+    void expect_end_of_statement();
   public:
     Parser(TokenList&& tokens) noexcept;
     Parser(std::vector<Token>&& tokens) noexcept;
@@ -0,0 +1,35 @@
+/**
+ * @file polynomial.hpp
+ * @brief Detección de polinomios en una variable y reescritura a `PolynomialExpression`.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "syntax_tree.hpp"
+
+namespace clex {
+
+/**
+ * @brief Devuelve una copia de una expresión con los polinomios en una variable reescritos como `PolynomialExpression`.
+ *
+ * Se reconocen como polinomios en `x` las sumas y restas de monomios, como `3*x^3 - x^2/2 + 5`, siempre que el
+ * grado resultante sea al menos 2. Los monomios pueden estar formados por productos, cambios de signo, potencias de 
+ * exponente entero literal y divisiones entre una constante numérica, y sus coeficientes pueden ser numéricos o 
+ * subexpresiones que no dependen de `x`, como en `a*x^2 + b*x + c`. Si una subexpresión es un polinomio en varias 
+ * variables, se elige la de mayor grado.
+ *
+ * Solo se reconocen polinomios ya desarrollados: `(x - 1)^3` o `x*(x + 1)` se dejan como están, porque desarrollarlos
+ * perdería precisión cerca de sus raíces. Las subexpresiones con llamadas a `rand`, `randn`, `mc` o `mcerr` tampoco se
+ * reescriben, ya que sus términos podrían evaluarse un número distinto de veces.
+ *
+ * El resultado de la expresión reescrita puede diferir del de la original en los últimos bits, al cambiar el
+ * orden de las operaciones, pero los errores de evaluación son los mismos.
+ *
+ * @param expr Expresión a reescribir.
+ * @return La expresión reescrita.
+ */
+Expression rewrite_polynomials(const Expression& expr);
+
+} // namespace clex
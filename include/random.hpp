@@ -0,0 +1,97 @@
+/**
+ * @file random.hpp
+ * @brief Generador de números aleatorios basado en contador (Philox4x32-10) usado por `rand()` y `randn()`.
+ *
+ * Un generador basado en contador calcula cada número aleatorio como una función pura de una clave y
+ * un contador, sin estado oculto. Esto permite que cada muestra de una simulación de Monte Carlo tenga
+ * su propio flujo independiente, de forma que los resultados son reproducibles sea cual sea el número
+ * de hilos que se usen para calcularlos.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace clex {
+
+/**
+ * @brief Aplica la función de bloque Philox4x32 con 10 rondas.
+ *
+ * @param counter Contador de 128 bits, como cuatro palabras de 32 bits.
+ * @param key Clave de 64 bits, como dos palabras de 32 bits.
+ * @return Cuatro palabras de 32 bits pseudoaleatorias, determinadas únicamente por `counter` y `key`.
+ */
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) noexcept;
+
+/**
+ * @brief Flujo de números aleatorios identificado por una clave y un número de flujo.
+ *
+ * El n-ésimo número que produce un `RandomStream` depende solo de la clave, del número de flujo y de `n`,
+ * por lo que dos flujos construidos con los mismos parámetros producen exactamente la misma secuencia.
+ */
+class RandomStream {
+  private:
+    uint64_t m_key;     /**< Clave del generador. */
+    uint64_t m_stream;  /**< Número de flujo (mitad alta del contador). */
+    uint64_t m_counter; /**< Número de bloques ya consumidos (mitad baja del contador). */
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param key Clave del generador.
+     * @param stream Número de flujo. Flujos distintos con la misma clave son independientes entre sí.
+     */
+    RandomStream(uint64_t key, uint64_t stream) noexcept;
+
+    /**
+     * @brief Devuelve los siguientes 64 bits aleatorios del flujo y avanza el contador.
+     */
+    uint64_t next_u64() noexcept;
+
+    /**
+     * @brief Devuelve un número aleatorio uniforme en el intervalo `[0, 1)`.
+     */
+    double uniform() noexcept;
+
+    /**
+     * @brief Devuelve un número aleatorio con distribución normal estándar (media 0, desviación típica 1).
+     *
+     * Se calcula con la transformación de Box-Muller a partir de dos números uniformes.
+     */
+    double normal() noexcept;
+};
+
+/**
+ * @brief Obtiene el flujo aleatorio activo en el hilo actual.
+ *
+ * Es el flujo del que leen `rand()` y `randn()`. Fuera de una simulación de Monte Carlo corresponde a un
+ * flujo de sesión con clave fija, así que una misma secuencia de sentencias produce siempre los mismos valores.
+ *
+ * @return Referencia al flujo activo del hilo actual.
+ */
+RandomStream& current_random_stream() noexcept;
+
+/**
+ * @brief Sustituye el flujo aleatorio activo del hilo actual durante su tiempo de vida.
+ *
+ * Al destruirse, restaura el flujo que estaba activo al construirse.
+ */
+class ScopedRandomStream {
+  private:
+    RandomStream m_previous; /**< Flujo activo antes de la sustitución. */
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param stream Flujo que pasa a estar activo en el hilo actual.
+     */
+    explicit ScopedRandomStream(RandomStream stream) noexcept;
+    ~ScopedRandomStream();
+    ScopedRandomStream(const ScopedRandomStream&) = delete;
+    ScopedRandomStream& operator=(const ScopedRandomStream&) = delete;
+};
+
+} // namespace clex
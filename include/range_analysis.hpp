@@ -0,0 +1,82 @@
+/**
+ * @file range_analysis.hpp
+ * @brief Análisis estático de intervalos para demostrar que una operación no puede salirse de su dominio.
+ *
+ * A partir de los rangos declarados para las variables y de los valores de las constantes, se calcula para
+ * cada subexpresión un intervalo que contiene todos sus valores posibles. Con esos intervalos se puede demostrar,
+ * por ejemplo, que en `log(x^2 + 1)` el argumento del logaritmo siempre es positivo, y evaluar esa operación sin
+ * comprobar su dominio.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace clex {
+
+/**
+ * @brief Intervalo cerrado `[lo, hi]` de valores posibles de una expresión.
+ *
+ * Los extremos pueden ser infinitos. Además de los valores del intervalo, la expresión puede valer NaN si
+ * `maybe_nan` es cierto.
+ */
+struct Interval {
+    double lo;       /**< Extremo inferior. */
+    double hi;       /**< Extremo superior. */
+    bool maybe_nan;  /**< Si la expresión puede valer NaN. */
+
+    /**
+     * @brief Devuelve el intervalo que contiene únicamente `value`.
+     */
+    static Interval point(double value) noexcept;
+
+    /**
+     * @brief Devuelve el intervalo de todos los valores posibles, incluido NaN.
+     */
+    static Interval unbounded() noexcept;
+
+    /**
+     * @brief Indica si `value` pertenece al intervalo (NaN solo pertenece si `maybe_nan` es cierto).
+     */
+    bool contains(double value) const noexcept;
+};
+
+/**
+ * @brief Rangos declarados para las variables, por nombre.
+ */
+using VariableRanges = std::unordered_map<std::string, Interval>;
+
+/**
+ * @brief Calcula un intervalo que contiene todos los valores que puede tomar una expresión evaluada con éxito.
+ *
+ * Cada identificador toma el rango declarado en `ranges` si lo hay; si no, el valor que tenga en `constants`
+ * como intervalo de un solo punto; y si tampoco, cualquier valor.
+ *
+ * @param expr Expresión a analizar.
+ * @param constants Tabla de símbolos con los valores fijos de las variables que no aparecen en `ranges`.
+ * @param ranges Rangos declarados para las variables cuyo valor cambia entre evaluaciones.
+ * @return Un intervalo que contiene todos los valores posibles de `expr`.
+ */
+Interval range_of(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges);
+
+/**
+ * @brief Devuelve una copia de una expresión en la que las operaciones que no pueden salirse de su dominio no lo comprueban.
+ *
+ * Las operaciones afectadas son la división (entre un divisor que no puede ser cero), `^` (cuando el resultado no puede
+ * ser complejo), `sqrt`, `log`, `asin` y `acos`. El resultado de evaluar la expresión devuelta es el mismo que el de
+ * la original siempre que las variables de `ranges` tomen valores dentro de su rango y las demás tengan los valores de
+ * `constants`.
+ *
+ * @param expr Expresión a transformar.
+ * @param constants Tabla de símbolos con los valores fijos de las variables que no aparecen en `ranges`.
+ * @param ranges Rangos declarados para las variables cuyo valor cambia entre evaluaciones.
+ * @return La expresión transformada.
+ */
+Expression elide_domain_checks(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges);
+
+} // namespace clex
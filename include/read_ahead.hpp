@@ -0,0 +1,91 @@
+/**
+ * @file read_ahead.hpp
+ * @brief Lectura anticipada de ficheros en un hilo aparte, para solapar la lectura con la evaluación.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief `std::streambuf` de lectura que lee un descriptor de fichero por bloques grandes en un hilo aparte.
+ *
+ * Un hilo lector mantiene hasta `depth` bloques leídos por adelantado, así que mientras se procesa un bloque
+ * el siguiente ya se está leyendo. Un descriptor propio que admite `pread` se lee desde la posición indicada, sin
+ * depender de la posición del descriptor. Uno ajeno (como la entrada estándar), o uno que no admite `pread` (como
+ * una tubería), se lee con `read` desde su posición actual, que avanza con lo que se lee, como con cualquier otro
+ * lector del descriptor.
+ *
+ * Antes de cada `read`, el hilo lector espera con `poll` a que haya datos o a que el destructor le pida parar, así
+ * que destruir el búfer no se queda esperando a una tubería que no recibe datos ni se cierra. Un bloque leído con
+ * `read` se entrega en cuanto el descriptor se queda sin datos, aunque no esté lleno.
+ *
+ * Si una lectura falla, el flujo que usa este búfer pasa a estado `bad()`.
+ */
+class ReadAheadBuffer : public std::streambuf {
+  private:
+    int m_fd;                               /**< Descriptor del que se lee. */
+    bool m_owns_fd;                         /**< Si el descriptor se cierra al destruir el búfer. */
+    std::mutex m_mutex;                     /**< Protege todos los campos compartidos con el hilo lector. */
+    std::condition_variable m_changed;      /**< Avisa de bloques leídos, bloques libres o de que hay que parar. */
+    std::deque<std::vector<char>> m_ready;  /**< Bloques leídos pendientes de consumir, en orden. */
+    std::vector<std::vector<char>> m_free;  /**< Bloques ya consumidos que el hilo lector puede reutilizar. */
+    std::vector<char> m_current;            /**< Bloque que se está consumiendo. */
+    bool m_finished;                        /**< Si el hilo lector ha llegado al final o ha fallado. */
+    bool m_failed;                          /**< Si alguna lectura ha fallado. */
+    bool m_stop;                            /**< Si el hilo lector debe terminar. */
+    int m_wake[2];                          /**< Tubería con la que el destructor despierta al hilo lector. */
+    std::thread m_reader;                   /**< Hilo lector. */
+
+    void read_loop(uint64_t offset, size_t block_size);
+  protected:
+    int_type underflow() override;
+  public:
+    /// Tamaño de bloque por defecto (1 MiB).
+    static constexpr size_t DEFAULT_BLOCK_SIZE = size_t(1) << 20;
+    /// Número de bloques leídos por adelantado por defecto.
+    static constexpr size_t DEFAULT_DEPTH = 4;
+
+    /**
+     * @brief Empieza a leer un descriptor de fichero.
+     *
+     * @param fd Descriptor a leer.
+     * @param owns_fd Si el descriptor se debe cerrar al destruir el búfer.
+     * @param offset Posición desde la que se lee, si el descriptor es propio y admite `pread`. Los demás se leen
+     * desde su posición actual.
+     * @param block_size Tamaño de cada lectura.
+     * @param depth Número máximo de bloques leídos por adelantado.
+     * @exception Lanza `std::runtime_error` si no se puede crear la tubería para despertar al hilo lector.
+     */
+    ReadAheadBuffer(int fd, bool owns_fd, uint64_t offset = 0, size_t block_size = DEFAULT_BLOCK_SIZE, size_t depth = DEFAULT_DEPTH);
+
+    /**
+     * @brief Abre un fichero y empieza a leerlo.
+     *
+     * @param path Ruta del fichero.
+     * @param offset Posición desde la que se lee.
+     * @exception Lanza `std::runtime_error` si no se puede abrir el fichero.
+     */
+    static std::unique_ptr<ReadAheadBuffer> open(const std::string& path, uint64_t offset = 0);
+
+    ReadAheadBuffer(const ReadAheadBuffer&) = delete;
+    ReadAheadBuffer& operator=(const ReadAheadBuffer&) = delete;
+
+    /// Destructor, detiene el hilo lector y cierra el descriptor si es suyo.
+    ~ReadAheadBuffer();
+};
+
+} // namespace clex
@@ -0,0 +1,204 @@
+/**
+ * @file shm_transport.hpp
+ * @brief Evaluación de expresiones para otros procesos de la misma máquina a través de memoria compartida.
+ *
+ * Un servidor prepara una lista de expresiones y crea un segmento de memoria compartida (`shm_open`) con dos colas
+ * circulares sin bloqueos de un productor y un consumidor: una de peticiones y otra de respuestas. Un cliente se
+ * conecta al segmento por su nombre y pide evaluar una de las expresiones, identificada por su posición en la lista,
+ * pasando los valores de sus variables directamente como `double`. Quien espera a la otra parte da unas cuantas
+ * vueltas comprobando la cola y, si no llega nada, se duerme en un *futex* hasta que la otra parte lo despierte.
+ *
+ * Cada segmento admite un único cliente a la vez, pero ese cliente puede tener varias peticiones en vuelo (por
+ * ejemplo, en nombre de muchos usuarios) con `ShmClient::evaluate_many()`. El servidor recoge en lotes las peticiones
+ * que encuentra en la cola y evalúa a la vez las que piden la misma expresión (ver `ShmBatching`).
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tiered.hpp"
+#include "tokens.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+struct ShmSegment;
+
+/**
+ * @brief Resultado de una petición de evaluación por memoria compartida.
+ */
+enum class ShmStatus : int32_t {
+    OK = 0,               /**< La evaluación ha tenido éxito. */
+    EVAL_ERROR = 1,       /**< La evaluación ha dado un error, como una división entre cero. */
+    INVALID_FORMULA = 2,  /**< No hay ninguna expresión con ese identificador. */
+    INVALID_ARGUMENTS = 3 /**< El número de valores no coincide con el número de variables de la expresión. */
+};
+
+/**
+ * @brief Opciones con que el servidor agrupa las peticiones en lotes.
+ *
+ * Al recibir una petición, el servidor sigue recogiendo las que llegan hasta tener `max_size` o hasta que pasan
+ * `max_delay_us` microsegundos, y evalúa juntas, con `TieredFormula::evaluate_batch()`, las que piden la misma
+ * expresión. Con `max_delay_us` a 0 solo se agrupan las peticiones que ya estaban esperando en la cola, así que no se
+ * añade latencia; con un valor mayor los lotes son más grandes, y la evaluación más eficiente, a cambio de retrasar
+ * las primeras peticiones de cada lote.
+ */
+struct ShmBatching {
+    uint32_t max_size = 64;    /**< Peticiones por lote, como mucho 64 (la capacidad de la cola); 1 desactiva los lotes. */
+    uint64_t max_delay_us = 0; /**< Tiempo máximo de espera para completar un lote, en microsegundos. */
+};
+
+/**
+ * @brief Estadísticas de los lotes de un servidor.
+ */
+struct ShmBatchStatistics {
+    uint64_t requests;     /**< Peticiones de evaluación atendidas. */
+    uint64_t batches;      /**< Lotes atendidos. */
+    uint64_t largest;      /**< Número de peticiones del mayor lote. */
+    uint64_t grouped;      /**< Peticiones evaluadas junto con otras de la misma expresión. */
+    double wait_seconds;   /**< Tiempo total esperando a completar lotes, en segundos. */
+};
+
+/**
+ * @brief Servidor que evalúa las peticiones que llegan por un segmento de memoria compartida.
+ */
+class ShmServer {
+  public:
+    /**
+     * @brief Expresión preparada para atender peticiones.
+     */
+    struct Formula {
+        std::vector<Token> variables;          /**< Variables cuyos valores se pasan en cada petición, en orden. */
+        std::unique_ptr<TieredFormula> engine; /**< Expresión, que sube de nivel de ejecución a medida que se pide. */
+    };
+  private:
+    std::string m_name;              /**< Nombre del segmento. */
+    ShmSegment* m_segment;           /**< Segmento proyectado en memoria. */
+    uint64_t m_inode;                /**< Nodo del segmento, para saber si otro servidor ha reemplazado el nombre. */
+    SymbolTable m_symbols;           /**< Tabla de símbolos con las constantes, donde se asignan las variables al evaluar. */
+    std::vector<Formula> m_formulas; /**< Expresiones que se pueden pedir, por identificador. */
+    ShmBatching m_batching;          /**< Opciones de los lotes. */
+    ShmBatchStatistics m_statistics; /**< Estadísticas de los lotes atendidos. */
+  public:
+    /**
+     * @brief Prepara las expresiones y crea el segmento de memoria compartida.
+     *
+     * Las variables de cada expresión son sus identificadores que no están en `symbols`, en el orden en que aparecen
+     * por primera vez. Cada expresión empieza en el intérprete y sube de nivel según `thresholds` (ver
+     * `TieredFormula`); si `native_dir` no está vacío, las que más se piden llegan a compilarse a código nativo.
+     *
+     * @param name Nombre del segmento, que debe empezar por `/`, como en `shm_open`. Si ya existe, se reemplaza.
+     * @param exprs Expresiones que se pueden pedir. El identificador de cada una es su posición.
+     * @param symbols Tabla de símbolos con las constantes de las expresiones.
+     * @param native_dir Directorio de caché para compilar las expresiones, o vacío para usar el intérprete.
+     * @param thresholds Umbrales de promoción de nivel de las expresiones.
+     * @param batching Opciones de los lotes.
+     * @exception Lanza `std::runtime_error` si no se puede crear el segmento, o si alguna expresión tiene más
+     * variables de las que caben en una petición.
+     * @exception Lanza `std::invalid_argument` si `batching.max_size` es 0 o mayor que la capacidad de la cola.
+     */
+    ShmServer(const std::string& name, const std::vector<Expression>& exprs, const SymbolTable& symbols,
+              const std::string& native_dir = "", const TierThresholds& thresholds = {}, const ShmBatching& batching = {});
+
+    ShmServer(const ShmServer&) = delete;
+    ShmServer& operator=(const ShmServer&) = delete;
+
+    /// Destructor, elimina el segmento de memoria compartida, salvo si otro servidor ya ha reemplazado su nombre.
+    ~ShmServer();
+
+    /**
+     * @brief Devuelve las expresiones preparadas, en orden de identificador.
+     */
+    const std::vector<Formula>& formulas() const noexcept;
+
+    /**
+     * @brief Devuelve las estadísticas de los lotes atendidos hasta el momento. Solo se debe llamar cuando `serve()`
+     * no está en marcha.
+     */
+    ShmBatchStatistics batch_statistics() const noexcept;
+
+    /**
+     * @brief Atiende peticiones hasta que un cliente llama a `ShmClient::shutdown()`.
+     */
+    void serve();
+};
+
+/**
+ * @brief Cliente de un `ShmServer`.
+ */
+class ShmClient {
+  private:
+    ShmSegment* m_segment; /**< Segmento proyectado en memoria. */
+
+    explicit ShmClient(ShmSegment* segment) noexcept;
+  public:
+    /**
+     * @brief Se conecta al segmento de un servidor.
+     *
+     * @param name Nombre del segmento, el mismo que se pasó al servidor.
+     * @return El cliente conectado.
+     * @exception Lanza `std::runtime_error` si el segmento no existe o no es de un servidor compatible.
+     */
+    static ShmClient connect(const std::string& name);
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    /// Constructor de movimiento.
+    ShmClient(ShmClient&& other) noexcept;
+
+    /// Destructor, libera la proyección del segmento.
+    ~ShmClient();
+
+    /**
+     * @brief Pide evaluar una expresión y espera al resultado.
+     *
+     * @param formula Identificador de la expresión.
+     * @param args Valores de las variables de la expresión, en el orden indicado por el servidor.
+     * @param n_args Número de valores.
+     * @param result Donde escribir el resultado si la evaluación tiene éxito.
+     * @return El resultado de la petición.
+     */
+    ShmStatus evaluate(uint32_t formula, const double* args, size_t n_args, double& result);
+
+    /**
+     * @brief Pide evaluar una expresión para varios conjuntos de valores, manteniendo varias peticiones en vuelo
+     * para que el servidor las pueda evaluar en lotes, y espera a todos los resultados.
+     *
+     * @param formula Identificador de la expresión.
+     * @param args Valores de las variables de cada petición, `n_args` por petición, una petición tras otra.
+     * @param n_args Número de valores por petición.
+     * @param count Número de peticiones.
+     * @param results Donde escribir el resultado de cada petición que tiene éxito.
+     * @param statuses Donde escribir el resultado de cada petición.
+     */
+    void evaluate_many(uint32_t formula, const double* args, size_t n_args, size_t count, double* results, ShmStatus* statuses);
+
+    /**
+     * @brief Como `evaluate_many()`, pero cada petición puede pedir una expresión distinta, así que un mismo lote del
+     * servidor puede mezclar varias expresiones.
+     *
+     * @param formulas Identificador de la expresión de cada petición.
+     * @param args Valores de las variables de cada petición, `n_args` por petición, una petición tras otra.
+     * @param n_args Número de valores por petición.
+     * @param count Número de peticiones.
+     * @param results Donde escribir el resultado de cada petición que tiene éxito.
+     * @param statuses Donde escribir el resultado de cada petición.
+     */
+    void evaluate_mixed(const uint32_t* formulas, const double* args, size_t n_args, size_t count, double* results,
+                        ShmStatus* statuses);
+
+    /**
+     * @brief Pide al servidor que deje de atender peticiones.
+     */
+    void shutdown();
+};
+
+} // namespace clex
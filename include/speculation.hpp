@@ -0,0 +1,125 @@
+/**
+ * @file speculation.hpp
+ * @brief Especialización especulativa de expresiones sobre las variables cuyo valor no cambia entre evaluaciones.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Devuelve una copia de una expresión especializada para unos valores concretos de algunas de sus variables.
+ *
+ * Las apariciones de las variables de `fixed` se sustituyen por su valor en `symbols`, y después:
+ * - Las subexpresiones que quedan sin variables se calculan de antemano, salvo las que darían un error de
+ *   evaluación, que se conservan para que el error se siga produciendo al evaluar.
+ * - Los condicionales con condición constante se sustituyen por la rama elegida, y `and` y `or` con el lado
+ *   izquierdo constante, por su resultado cuando el lado derecho no llegaría a evaluarse.
+ * - Se eliminan las operaciones que no cambian el resultado, como `x*1`, `x/1` o `x - 0`, y las divisiones entre
+ *   potencias de dos pasan a ser productos por su inverso, que dan exactamente el mismo resultado.
+ * - Por último, se reescriben los polinomios con `rewrite_polynomials()` y se quitan las comprobaciones de dominio
+ *   que los valores sustituidos hacen innecesarias con `elide_domain_checks()`.
+ *
+ * Los argumentos de las llamadas a función no se especializan, ya que algunas (como `minimize` u `ode`) asignan
+ * sus propios valores a las variables, y otras (como `rand`) no dan siempre el mismo resultado. Los polinomios ya
+ * reescritos se especializan a partir de su expresión original, así que `expr` puede venir del nivel optimizado de
+ * una `TieredFormula`.
+ *
+ * La expresión especializada da los mismos errores de evaluación que la original, aunque en los mensajes aparecen
+ * los valores sustituidos, y solo puede diferir en los últimos bits por la reescritura de los polinomios.
+ *
+ * @param expr Expresión a especializar.
+ * @param symbols Tabla de símbolos con los valores de las variables de `fixed`.
+ * @param fixed Tokens identificadores de las variables a sustituir. Las que no están definidas en `symbols` no se
+ * sustituyen.
+ * @return La expresión especializada.
+ */
+Expression specialize(const Expression& expr, const SymbolTable& symbols, const std::vector<Token>& fixed);
+
+/**
+ * @brief Estadísticas de una `SpeculativeFormula`.
+ */
+struct SpeculationStatistics {
+    uint64_t generic_evaluations;     /**< Evaluaciones hechas con la expresión original. */
+    uint64_t specialized_evaluations; /**< Evaluaciones hechas con una expresión especializada. */
+    uint64_t specializations;         /**< Veces que se ha especializado la expresión. */
+    uint64_t deoptimizations;         /**< Veces que se ha descartado una especialización por cambiar una variable. */
+};
+
+/**
+ * @brief Expresión que se especializa sola para las variables que llevan muchas evaluaciones sin cambiar.
+ *
+ * Mientras no está especializada, cada evaluación usa la expresión original y después compara el valor de cada
+ * variable (fuera de las llamadas a función) con el de la evaluación anterior. Cuando alguna lleva `threshold`
+ * evaluaciones seguidas con el mismo valor, la expresión se especializa con `specialize()` para todas las que
+ * cumplen lo mismo, y esas variables se vigilan en la tabla de símbolos con `SymbolTable::watch()`.
+ *
+ * Antes de cada evaluación especializada se comprueba que la tabla es la misma y sigue en la misma época, así que
+ * basta con cambiar el valor de una de las variables sustituidas con `SymbolTable::set()` (o reiniciar la tabla, o
+ * evaluar con otra) para que la especialización se descarte y esa misma evaluación, y las siguientes, vuelvan a usar la
+ * expresión original. Tras descartarla, hacen falta otras `threshold` evaluaciones sin cambios para volver a
+ * especializar, de modo que una variable que cambia de vez en cuando no obliga a especializar en cada evaluación.
+ *
+ * No se puede evaluar desde varios hilos a la vez.
+ */
+class SpeculativeFormula {
+  private:
+    Expression m_source;                         /**< Expresión original. */
+    std::vector<Token> m_variables;              /**< Variables de la expresión fuera de las llamadas, sin repetir. */
+    std::vector<std::optional<double>> m_values; /**< Valor de cada variable en la última evaluación genérica. */
+    std::vector<uint64_t> m_stable;              /**< Evaluaciones seguidas en que cada variable ha tenido ese valor. */
+    uint64_t m_threshold;                        /**< Evaluaciones sin cambios necesarias para especializar. */
+    std::optional<Expression> m_specialized;     /**< Expresión especializada, si la hay. */
+    std::vector<Token> m_fixed;                  /**< Variables sustituidas en `m_specialized`. */
+    const SymbolTable* m_table;                  /**< Tabla para la que vale `m_specialized`. */
+    uint64_t m_epoch;                            /**< Época de `m_table` para la que vale `m_specialized`. */
+    SpeculationStatistics m_statistics;          /**< Estadísticas hasta el momento. */
+
+    void observe(SymbolTable& symbols);
+    void deoptimize() noexcept;
+  public:
+    /**
+     * @brief Crea una expresión sin especializar.
+     *
+     * @param expr Expresión a evaluar.
+     * @param threshold Evaluaciones seguidas sin cambios en una variable para especializar la expresión.
+     */
+    explicit SpeculativeFormula(const Expression& expr, uint64_t threshold = 100);
+
+    /**
+     * @brief Evalúa la expresión, con la especialización si sigue siendo válida para `symbols` y con la expresión
+     * original si no.
+     *
+     * @param symbols Tabla de símbolos con los valores de las variables. Se marcan como vigiladas las variables
+     * sobre las que se especializa la expresión.
+     * @return El resultado de la evaluación.
+     * @exception Lanza el `EvalError` de la evaluación, si falla.
+     */
+    double evaluate(SymbolTable& symbols);
+
+    /**
+     * @brief Indica si la expresión tiene una especialización, que se usará si la tabla de símbolos no ha cambiado.
+     */
+    bool is_specialized() const noexcept;
+
+    /**
+     * @brief Devuelve las variables sustituidas en la especialización actual, o una lista vacía si no la hay.
+     */
+    const std::vector<Token>& specialized_on() const noexcept;
+
+    /**
+     * @brief Devuelve las estadísticas de evaluación hasta el momento.
+     */
+    SpeculationStatistics statistics() const noexcept;
+};
+
+} // namespace clex
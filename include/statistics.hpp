@@ -0,0 +1,172 @@
+/**
+ * @file statistics.hpp
+ * @brief Acumuladores estadísticos incrementales y combinables.
+ *
+ * Los acumuladores de este archivo procesan los valores de uno en uno, sin almacenarlos, y dos
+ * acumuladores construidos por separado (por ejemplo, en hilos distintos) se pueden combinar en uno
+ * solo con el mismo resultado que si hubieran procesado todos los valores juntos.
+ *
+ * Los acumuladores también se pueden escribir en un flujo y volver a leer, para combinar acumuladores
+ * construidos en procesos distintos. El formato es texto con los números en hexadecimal, así que se
+ * leen exactamente iguales en cualquier máquina.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Acumulador de media, varianza, mínimo y máximo con el algoritmo de Welford.
+ *
+ * A diferencia de acumular la suma y la suma de cuadrados, el algoritmo de Welford es numéricamente
+ * estable incluso cuando la media es grande en comparación con la desviación típica.
+ */
+class RunningStats {
+  private:
+    uint64_t m_count; /**< Número de valores acumulados. */
+    double m_mean;    /**< Media de los valores acumulados. */
+    double m_m2;      /**< Suma de los cuadrados de las desviaciones respecto a la media. */
+    double m_min;     /**< Mínimo de los valores acumulados. */
+    double m_max;     /**< Máximo de los valores acumulados. */
+  public:
+    /**
+     * @brief Constructor por defecto, construye un acumulador vacío.
+     */
+    RunningStats() noexcept;
+
+    /**
+     * @brief Añade un valor al acumulador.
+     *
+     * @param value Valor a añadir.
+     */
+    void push(double value) noexcept;
+
+    /**
+     * @brief Combina otro acumulador con éste (algoritmo paralelo de Chan et al.).
+     *
+     * Tras la llamada, `*this` contiene las estadísticas de la unión de ambos conjuntos de valores.
+     *
+     * @param other Acumulador a combinar.
+     */
+    void merge(const RunningStats& other) noexcept;
+
+    /**
+     * @brief Devuelve el número de valores acumulados.
+     */
+    uint64_t count() const noexcept;
+
+    /**
+     * @brief Devuelve la media de los valores acumulados, o `0.0` si no hay ninguno.
+     */
+    double mean() const noexcept;
+
+    /**
+     * @brief Devuelve la varianza muestral (con denominador $n - 1$), o `0.0` si hay menos de dos valores.
+     */
+    double variance() const noexcept;
+
+    /**
+     * @brief Devuelve el mínimo de los valores acumulados, o `+inf` si no hay ninguno.
+     */
+    double min() const noexcept;
+
+    /**
+     * @brief Devuelve el máximo de los valores acumulados, o `-inf` si no hay ninguno.
+     */
+    double max() const noexcept;
+
+    /**
+     * @brief Escribe el estado del acumulador en un flujo, en una sola línea.
+     *
+     * @param os Flujo de salida.
+     */
+    void write_to(std::ostream& os) const;
+
+    /**
+     * @brief Lee un acumulador escrito con `write_to()`.
+     *
+     * @param is Flujo de entrada.
+     * @return El acumulador leído. Si el formato no es válido, se activa `std::ios::failbit` en `is`.
+     */
+    static RunningStats read_from(std::istream& is);
+};
+
+/**
+ * @brief Resumen aproximado de una distribución para calcular cuantiles (*t-digest* con fusión).
+ *
+ * Agrupa los valores en centroides (media y peso) cuyo tamaño máximo depende del cuantil en el que se
+ * encuentran: los centroides de las colas son pequeños y los del centro grandes, de forma que los cuantiles
+ * extremos como el 1% o el 99% se estiman con mucha precisión. La memoria usada está acotada por el parámetro
+ * de compresión, independientemente del número de valores.
+ */
+class TDigest {
+  private:
+    /**
+     * @brief Centroide del resumen: media de un grupo de valores y número de valores del grupo.
+     */
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double m_compression;              /**< Parámetro de compresión (aproximadamente, número máximo de centroides). */
+    std::vector<Centroid> m_centroids; /**< Centroides ya compactados, ordenados por media. */
+    std::vector<Centroid> m_buffer;    /**< Valores recibidos pendientes de compactar. */
+    double m_min;                      /**< Mínimo exacto de los valores recibidos. */
+    double m_max;                      /**< Máximo exacto de los valores recibidos. */
+
+    void compress() noexcept;
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param compression Parámetro de compresión. Valores mayores dan más precisión a cambio de más memoria.
+     */
+    explicit TDigest(double compression = 100.0) noexcept;
+
+    /**
+     * @brief Añade un valor al resumen. Los valores NaN se ignoran, ya que no tienen orden.
+     *
+     * @param value Valor a añadir.
+     */
+    void push(double value) noexcept;
+
+    /**
+     * @brief Combina otro resumen con éste.
+     *
+     * @param other Resumen a combinar.
+     */
+    void merge(const TDigest& other) noexcept;
+
+    /**
+     * @brief Estima el cuantil `q` de los valores recibidos.
+     *
+     * @param q Cuantil a estimar, entre `0.0` y `1.0` (por ejemplo, `0.5` para la mediana).
+     * @return El valor estimado del cuantil, o NaN si el resumen está vacío.
+     */
+    double quantile(double q) const noexcept;
+
+    /**
+     * @brief Escribe el resumen en un flujo, en una sola línea.
+     *
+     * @param os Flujo de salida.
+     */
+    void write_to(std::ostream& os) const;
+
+    /**
+     * @brief Lee un resumen escrito con `write_to()`.
+     *
+     * @param is Flujo de entrada.
+     * @return El resumen leído. Si el formato no es válido, se activa `std::ios::failbit` en `is`.
+     */
+    static TDigest read_from(std::istream& is);
+};
+
+} // namespace clex
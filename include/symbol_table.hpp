@@ -13,6 +13,7 @@
 #pragma once
 
 #include "tokens.hpp"
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -24,10 +25,22 @@ namespace clex {
  *
  * `SymbolTable` mantiene una correspondencia entre nombres de identificadores
  * y valores numéricos (`double`).
+ *
+ * Además, algunas variables se pueden marcar como vigiladas con `watch()`: la tabla tiene una época, un número que
+ * cambia cada vez que cambia el valor de una variable vigilada, y que nunca se repite entre tablas distintas, así que
+ * quien haya hecho cálculos suponiendo fijos los valores de esas variables puede saber si siguen siendo válidos
+ * comparando una sola vez la época, sin consultar cada variable.
  */
 class SymbolTable {
   private:  
-    std::unordered_map<std::string, double> m_vars; /**< Mapa interno de variables y valores. */
+    /// Valor de una variable y si está vigilada.
+    struct Variable {
+        double value;
+        bool watched;
+    };
+
+    std::unordered_map<std::string, Variable> m_vars; /**< Mapa interno de variables y valores. */
+    uint64_t m_epoch;                                 /**< Época actual, ver `epoch()`. */
 
   public:
     /**
@@ -42,11 +55,17 @@ class SymbolTable {
      */
     SymbolTable();
 
-    /// Constructor de copia (por defecto).
-    SymbolTable(const SymbolTable&) = default;
+    /// Constructor de copia. La copia empieza en una época nueva.
+    SymbolTable(const SymbolTable& other);
+
+    /// Constructor de movimiento. La tabla construida empieza en una época nueva.
+    SymbolTable(SymbolTable&& other) noexcept;
+
+    /// Asignación por copia. Cambia la época de la tabla asignada.
+    SymbolTable& operator=(const SymbolTable& other);
 
-    /// Constructor de movimiento (por defecto).
-    SymbolTable(SymbolTable&&) = default;
+    /// Asignación por movimiento. Cambia la época de la tabla asignada.
+    SymbolTable& operator=(SymbolTable&& other) noexcept;
 
     /**
      * @brief Construye una tabla de símbolos a partir de un mapa existente.
@@ -77,7 +96,9 @@ class SymbolTable {
     /**
      * @brief Asocia un valor a un identificador.
      *
-     * Si el identificador ya existe en la tabla, su valor será sobrescrito.
+     * Si el identificador ya existe en la tabla, su valor será sobrescrito. Si además está vigilado y el valor nuevo
+     * es distinto (comparando los bits, así que 0 y -0 son distintos y un NaN es igual a sí mismo), la tabla pasa a una
+     * época nueva; quien escribe los mismos valores una y otra vez no invalida los cálculos que dependen de ellos.
      *
      * @param ident Token del identificador.
      * @param value Valor numérico a asociar.
@@ -89,9 +110,29 @@ class SymbolTable {
      * @brief Elimina todas las variables almacenadas en la tabla.
      *
      * Tras la llamada, la tabla de símbolos queda con las mismas definiciones que 
-     * una `SymbolTable` construida por defecto (las constantes matemáticas comunes).
+     * una `SymbolTable` construida por defecto (las constantes matemáticas comunes), sin variables vigiladas y en
+     * una época nueva.
      */
     void reset() noexcept;
+
+    /**
+     * @brief Marca una variable como vigilada, de modo que cualquier cambio posterior de su valor con `set()` cambie la
+     * época.
+     *
+     * No hace nada si el identificador no está en la tabla.
+     *
+     * @param ident Token del identificador.
+     * @pre `ident` debe de ser un token de tipo `TokenType::IDENTIFIER`.
+     */
+    void watch(const Token& ident) noexcept;
+
+    /**
+     * @brief Devuelve la época actual de la tabla.
+     *
+     * Si dos llamadas sobre la misma tabla devuelven lo mismo, entre ellas no ha cambiado ninguna variable vigilada
+     * ni se ha reiniciado o asignado la tabla. Dos tablas distintas nunca pasan por la misma época.
+     */
+    uint64_t epoch() const noexcept;
 };
 
 } // namespace clex
@@ -13,6 +13,7 @@
 #include <ostream>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace clex {
 
@@ -27,6 +28,12 @@ enum class ExpressionType : uint8_t {
     OPERAND,   /**< Representa una expresión que consiste únicamente en un operando. */
     BIN_OP,    /**< Representa una expresión de operador binario. */
     UNARY_OP,  /**< Representa una expresión de operador unario o función. */
+    CONDITIONAL, /**< Representa una expresión condicional `if(c, a, b)`. */
+    CALL,      /**< Representa una llamada a función con lista de argumentos, como `mc(rand(), 1000)`. */
+    POLYNOMIAL, /**< Representa un polinomio en una variable, generado por `rewrite_polynomials()`. */
+    APPROXIMATION, /**< Representa una aproximación polinómica a trozos de una subexpresión, generada por `approximate_univariate()`. */
+    LET,       /**< Representa una definición local `let nombre = valor in cuerpo`. */
+    LOCAL,     /**< Representa una referencia a un nombre definido por un `let` que la contiene. */
 };
 
 /**
@@ -105,6 +112,7 @@ class BinOpExpression {
     Token m_operator; /**< Token que representa el operador binario. */
     std::unique_ptr<Expression> m_lhs; /**< Puntero al operando izquierdo. */
     std::unique_ptr<Expression> m_rhs; /**< Puntero al operando derecho. */
+    bool m_domain_checked; /**< Si es `false`, se ha demostrado que la operación no puede fallar y no se comprueba su dominio. */
   public:
     /**
      * @brief Construye una expresión binaria.
@@ -112,11 +120,14 @@ class BinOpExpression {
      * @param oper Token que representa el operador.
      * @param lhs Puntero a la expresión del lado izquierdo.
      * @param rhs Puntero a la expresión del lado derecho.
+     * @param domain_checked Si es `false`, la evaluación no comprueba la división entre cero ni los resultados complejos 
+     * de `^`. Solo debe usarse cuando se ha demostrado que esos errores son imposibles (ver `elide_domain_checks()`).
      * @exception Lanza `std::invalid_argument` si o bien `oper` no es un token de tipo operador binario, o bien `lhs` ó `rhs` son punteros nulos.
      */
     BinOpExpression(Token&& oper,
                     std::unique_ptr<Expression>&& lhs,
-                    std::unique_ptr<Expression>&& rhs);
+                    std::unique_ptr<Expression>&& rhs,
+                    bool domain_checked = true);
 
     /**
      * @brief Obtiene el token del operador binario.
@@ -132,6 +143,11 @@ class BinOpExpression {
      */
     std::pair<const Expression&, const Expression&> get_operands() const noexcept;
 
+    /**
+     * @brief Indica si la evaluación comprueba el dominio de la operación (división entre cero, resultados complejos).
+     */
+    bool is_domain_checked() const noexcept;
+
     /**
      * @brief Crea una copia profunda de esta expresión binaria.
      *
@@ -185,15 +201,18 @@ class UnaryOpExpression {
   private:
     Token m_operator; /**< Token que representa el operador unario o función. */
     std::unique_ptr<Expression> m_operand; /**< Expresión correspondiente al operando. */
+    bool m_domain_checked; /**< Si es `false`, se ha demostrado que la función no puede fallar y no se comprueba su dominio. */
   public:
     /**
      * @brief Construye una expresión unaria o función.
      *
      * @param oper Token que representa el operador.
      * @param operand Puntero a la expresión sobre la que actúa el operador.
+     * @param domain_checked Si es `false`, la evaluación no comprueba que el operando esté en el dominio de la función 
+     * (`sqrt`, `log`, `arcsin`, `arccos`). Solo debe usarse cuando se ha demostrado que lo está (ver `elide_domain_checks()`).
      * @exception Lanza `std::invalid_argument` si o bien `oper` no es un token de operador unario o función, o bien `operand` es un puntero nulo.
      */
-    UnaryOpExpression(Token&& oper, std::unique_ptr<Expression>&& operand);
+    UnaryOpExpression(Token&& oper, std::unique_ptr<Expression>&& operand, bool domain_checked = true);
 
     /**
      * @brief Obtiene el token del operador unario.
@@ -209,6 +228,11 @@ class UnaryOpExpression {
      */
     const Expression& get_operand() const noexcept;
 
+    /**
+     * @brief Indica si la evaluación comprueba que el operando está en el dominio de la función.
+     */
+    bool is_domain_checked() const noexcept;
+
     /**
      * @brief Crea una copia profunda de esta expresión binaria.
      *
@@ -249,21 +273,595 @@ class UnaryOpExpression {
  */
 std::ostream& operator<<(std::ostream& out, const UnaryOpExpression& expr);
 
+/**
+ * @brief Expresión condicional `if(condición, si_cierto, si_falso)`.
+ *
+ * Un `ConditionalExpression` contiene tres subexpresiones: la condición, que se considera cierta si su 
+ * valor es distinto de `0.0`, y las dos ramas. Solo se evalúa la rama seleccionada, de forma que la rama 
+ * descartada no puede provocar errores de evaluación (por ejemplo, `if(x > 0, log(x), 0)` es válido con `x = -1`).
+ */
+class ConditionalExpression {
+  private:
+    Token m_tok; /**< Token de la función `if`. */
+    std::unique_ptr<Expression> m_condition; /**< Expresión de la condición. */
+    std::unique_ptr<Expression> m_if_true; /**< Expresión evaluada si la condición es cierta. */
+    std::unique_ptr<Expression> m_if_false; /**< Expresión evaluada si la condición es falsa. */
+  public:
+    /**
+     * @brief Construye una expresión condicional.
+     *
+     * @param if_tok Token de la función `if`.
+     * @param condition Puntero a la expresión de la condición.
+     * @param if_true Puntero a la expresión evaluada si la condición es cierta.
+     * @param if_false Puntero a la expresión evaluada si la condición es falsa.
+     * @exception Lanza `std::invalid_argument` si o bien `if_tok` no es un token de tipo `TokenType::FUNC_IF`, o bien alguno de los punteros es nulo.
+     */
+    ConditionalExpression(Token&& if_tok,
+                          std::unique_ptr<Expression>&& condition,
+                          std::unique_ptr<Expression>&& if_true,
+                          std::unique_ptr<Expression>&& if_false);
+
+    /**
+     * @brief Obtiene la expresión de la condición.
+     *
+     * @return Referencia constante a la condición.
+     */
+    const Expression& get_condition() const noexcept;
+
+    /**
+     * @brief Obtiene las expresiones de las ramas como un `std::pair`.
+     *
+     * @return Un `std::pair` de referencias constantes a la rama cierta y la rama falsa, en ese orden.
+     */
+    std::pair<const Expression&, const Expression&> get_branches() const noexcept;
+
+    /**
+     * @brief Crea una copia profunda de esta expresión condicional.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `ConditionalExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión utilizando una tabla de símbolos.
+     *
+     * Evalúa la condición y, según su valor, únicamente una de las dos ramas.
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación.
+     * @return Resultado numérico de la evaluación.
+     * @exception Lanza un `EvalError` si ha habido problemas en la evaluación de la condición o de la rama seleccionada.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const ConditionalExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte la expresión condicional a una cadena con información sobre la condición y las ramas y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const ConditionalExpression& expr);
+
+/**
+ * @brief Expresión que representa una llamada a función con lista de argumentos.
+ *
+ * Las funciones de este tipo (`rand`, `randn`, `mc`, `mcerr`, `minimize`, `argmin`, `ode`) se escriben siempre con
+ * paréntesis y argumentos separados por comas, y su número de argumentos viene dado por `Token::get_call_arity()`
+ * (el mínimo, en las funciones para las que `Token::is_variadic_call()` es cierto).
+ * Cada función decide cuándo y cuántas veces evalúa sus argumentos; por ejemplo, `mc(expr, n)` evalúa
+ * `expr` `n` veces.
+ */
+class CallExpression {
+  private:
+    Token m_func; /**< Token de la función llamada. */
+    std::vector<std::unique_ptr<Expression>> m_args; /**< Argumentos de la llamada, en orden. */
+  public:
+    /**
+     * @brief Construye una llamada a función.
+     *
+     * @param func Token de la función.
+     * @param args Punteros a las expresiones de los argumentos, en orden.
+     * @exception Lanza `std::invalid_argument` si `func` no es un token de función con lista de argumentos, si
+     * el número de argumentos no coincide con `func.get_call_arity()` (o es menor, si `func.is_variadic_call()`) o si
+     * alguno de los punteros es nulo.
+     */
+    CallExpression(Token&& func, std::vector<std::unique_ptr<Expression>>&& args);
+
+    /**
+     * @brief Obtiene el token de la función llamada.
+     *
+     * @return Referencia constante al token de la función.
+     */
+    const Token& get_function() const noexcept;
+
+    /**
+     * @brief Obtiene los argumentos de la llamada.
+     *
+     * @return Referencia constante al vector de argumentos.
+     */
+    const std::vector<std::unique_ptr<Expression>>& get_args() const noexcept;
+
+    /**
+     * @brief Crea una copia profunda de esta llamada.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `CallExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa la llamada utilizando una tabla de símbolos.
+     *
+     * `rand()` y `randn()` leen del flujo aleatorio activo (ver `current_random_stream()`), así que dos 
+     * evaluaciones de la misma llamada devuelven, en general, valores distintos.
+     *
+     * `minimize(expr, x1, ..., xn)` devuelve el mínimo local de `expr` respecto de las variables `x1`, ..., `xn`
+     * encontrado partiendo de sus valores actuales (ver `clex::minimize()`), y `argmin` con los mismos argumentos
+     * devuelve el valor de `x1` en ese mínimo.
+     *
+     * `ode(f1, ..., fn, y1, ..., yn, t, t1)` integra el sistema `y1' = f1`, ..., `yn' = fn` con RK45 (ver
+     * `clex::integrate_ode()`) desde los valores actuales de `y1`, ..., `yn` y `t` hasta `t = t1`, y devuelve el
+     * valor de `y1` en `t1`.
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación.
+     * @return Resultado numérico de la evaluación.
+     * @exception Lanza un `EvalError` si ha habido problemas en la evaluación de algún argumento, o un 
+     * `InvalidArgument` si el valor de algún argumento no es válido para la función.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const CallExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte la llamada a una cadena con información sobre la función y los argumentos y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const CallExpression& expr);
+
+/**
+ * @brief Expresión que representa un polinomio en una variable, evaluado por el método de Horner o de Estrin.
+ *
+ * Estas expresiones no las genera el analizador sintáctico, sino `rewrite_polynomials()` a partir de 
+ * subexpresiones como `3*x^3 + 2*x^2 - x + 5`, que se evalúan así con un solo nodo y sin llamadas a `std::pow`.
+ * Cada coeficiente es la suma de una parte numérica y, opcionalmente, de una subexpresión que no depende de la 
+ * variable (como `a` en `a*x^2`). Los polinomios de grado alto se evalúan por el método de Estrin, que 
+ * tiene menos dependencias entre operaciones que el de Horner y aprovecha mejor el paralelismo del procesador.
+ *
+ * La expresión original se conserva para reproducir exactamente sus errores de evaluación: si la variable no 
+ * está definida o el resultado es NaN, se evalúa la expresión original en su lugar.
+ */
+class PolynomialExpression {
+  public:
+    static constexpr size_t MAX_DEGREE = 32; /**< Grado máximo de los polinomios representables. */
+    static constexpr size_t ESTRIN_MIN_DEGREE = 8; /**< Grado a partir del cual se evalúa por el método de Estrin. */
+  private:
+    Token m_var; /**< Token del identificador de la variable del polinomio. */
+    std::vector<double> m_coefficients; /**< Parte numérica de los coeficientes, empezando por el término independiente. */
+    std::vector<std::pair<size_t, std::unique_ptr<Expression>>> m_symbolic_coefficients; /**< Parte no numérica de los coeficientes, con su grado. */
+    std::unique_ptr<Expression> m_original; /**< Expresión original de la que procede el polinomio. */
+  public:
+    /**
+     * @brief Construye una expresión de polinomio.
+     *
+     * @param var Token del identificador de la variable.
+     * @param coefficients Parte numérica de los coeficientes; `coefficients[k]` acompaña a `var^k`.
+     * @param symbolic_coefficients Pares `(k, expr)` que suman `expr` al coeficiente de `var^k`. `expr` no puede depender de `var`.
+     * @param original Expresión original equivalente al polinomio.
+     * @exception Lanza `std::invalid_argument` si `var` no es un identificador, si no hay coeficientes o hay más de
+     * `MAX_DEGREE + 1`, si algún grado de `symbolic_coefficients` no tiene coeficiente numérico o si algún puntero es nulo.
+     */
+    PolynomialExpression(Token&& var,
+                         std::vector<double>&& coefficients,
+                         std::vector<std::pair<size_t, std::unique_ptr<Expression>>>&& symbolic_coefficients,
+                         std::unique_ptr<Expression>&& original);
+
+    /**
+     * @brief Obtiene el token de la variable del polinomio.
+     *
+     * @return Referencia constante al token del identificador.
+     */
+    const Token& get_variable() const noexcept;
+
+    /**
+     * @brief Obtiene la parte numérica de los coeficientes, empezando por el término independiente.
+     *
+     * @return Referencia constante al vector de coeficientes.
+     */
+    const std::vector<double>& get_coefficients() const noexcept;
+
+    /**
+     * @brief Obtiene la parte no numérica de los coeficientes, como pares `(grado, expresión)`.
+     *
+     * @return Referencia constante al vector de pares.
+     */
+    const std::vector<std::pair<size_t, std::unique_ptr<Expression>>>& get_symbolic_coefficients() const noexcept;
+
+    /**
+     * @brief Obtiene la expresión original de la que procede el polinomio.
+     *
+     * @return Referencia constante a la expresión original.
+     */
+    const Expression& get_original() const noexcept;
+
+    /**
+     * @brief Crea una copia profunda de este polinomio.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `PolynomialExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa el polinomio utilizando una tabla de símbolos.
+     *
+     * Usa FMA (`std::fma`) si el procesador lo soporta en hardware (macro `FP_FAST_FMA`).
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación.
+     * @return Resultado numérico de la evaluación.
+     * @exception Lanza los mismos `EvalError` que la expresión original.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const PolynomialExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte el polinomio a una cadena con información sobre la variable y los coeficientes y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const PolynomialExpression& expr);
+
+/**
+ * @brief Polinomio a trozos sobre un intervalo `[lo, hi]` dividido en tramos de igual anchura.
+ *
+ * Cada tramo tiene `degree + 1` coeficientes, empezando por el término independiente, de un polinomio en la
+ * variable local `t ∈ [-1, 1]` del tramo. Evaluarlo en un punto cuesta un cálculo de índice y `degree` FMA.
+ */
+class PiecewisePolynomial {
+  private:
+    double m_lo; /**< Extremo inferior del intervalo. */
+    double m_hi; /**< Extremo superior del intervalo. */
+    double m_scale; /**< Número de tramos entre la anchura del intervalo. */
+    size_t m_degree; /**< Grado de los polinomios de cada tramo. */
+    std::vector<double> m_coefficients; /**< Coeficientes de todos los tramos, seguidos. */
+    double m_min; /**< Cota inferior de los valores del polinomio en `[lo, hi]`. */
+    double m_max; /**< Cota superior de los valores del polinomio en `[lo, hi]`. */
+  public:
+    /**
+     * @brief Construye un polinomio a trozos y calcula cotas de sus valores.
+     *
+     * @param lo Extremo inferior del intervalo.
+     * @param hi Extremo superior del intervalo.
+     * @param degree Grado de los polinomios de cada tramo.
+     * @param coefficients Coeficientes de cada tramo, `degree + 1` por tramo y seguidos.
+     * @exception Lanza `std::invalid_argument` si el intervalo no es finito y no vacío, o si el número de coeficientes
+     * no es un múltiplo no nulo de `degree + 1`.
+     */
+    PiecewisePolynomial(double lo, double hi, size_t degree, std::vector<double>&& coefficients);
+
+    double lo() const noexcept; /**< Extremo inferior del intervalo. */
+    double hi() const noexcept; /**< Extremo superior del intervalo. */
+    double scale() const noexcept; /**< Número de tramos entre la anchura del intervalo. */
+    size_t degree() const noexcept; /**< Grado de los polinomios de cada tramo. */
+    size_t pieces() const noexcept; /**< Número de tramos. */
+    const std::vector<double>& coefficients() const noexcept; /**< Coeficientes de todos los tramos, seguidos. */
+
+    /**
+     * @brief Cotas de los valores del polinomio en `[lo, hi]`.
+     *
+     * Se calculan acotando cada tramo por su término independiente más la suma de los valores absolutos del resto
+     * de coeficientes, con margen para el redondeo de la evaluación, así que contienen cualquier valor que pueda
+     * devolver `evaluate()`.
+     *
+     * @return Par con la cota inferior y la superior.
+     */
+    std::pair<double, double> bounds() const noexcept;
+
+    /**
+     * @brief Evalúa el polinomio en un punto.
+     *
+     * @param x Punto donde evaluar.
+     * @return Valor del polinomio del tramo que contiene a `x`.
+     * @pre `lo <= x <= hi`.
+     */
+    double evaluate(double x) const noexcept;
+};
+
+/**
+ * @brief Expresión que sustituye una subexpresión costosa de una sola variable por una tabla de aproximación.
+ *
+ * Estas expresiones no las genera el analizador sintáctico, sino `approximate_univariate()` a partir de
+ * subexpresiones como `log(1 + x^2) * sin(x)` cuya única variable tiene un rango conocido: dentro de ese rango se 
+ * evalúan con un polinomio a trozos, con un error acotado por la tolerancia indicada al construirlas.
+ *
+ * La expresión original se conserva: si la variable no está definida, es NaN o queda fuera del rango de la tabla,
+ * se evalúa la expresión original en su lugar.
+ */
+class ApproximationExpression {
+  private:
+    Token m_var; /**< Token del identificador de la variable. */
+    PiecewisePolynomial m_table; /**< Tabla de aproximación de la expresión original. */
+    std::unique_ptr<Expression> m_original; /**< Expresión original aproximada. */
+  public:
+    /**
+     * @brief Construye una expresión de aproximación.
+     *
+     * @param var Token del identificador de la variable.
+     * @param table Polinomio a trozos que aproxima la expresión original en su intervalo.
+     * @param original Expresión original.
+     * @exception Lanza `std::invalid_argument` si `var` no es un identificador o si `original` es un puntero nulo.
+     */
+    ApproximationExpression(Token&& var, PiecewisePolynomial&& table, std::unique_ptr<Expression>&& original);
+
+    /**
+     * @brief Obtiene el token de la variable.
+     *
+     * @return Referencia constante al token del identificador.
+     */
+    const Token& get_variable() const noexcept;
+
+    /**
+     * @brief Obtiene la tabla de aproximación.
+     *
+     * @return Referencia constante al polinomio a trozos.
+     */
+    const PiecewisePolynomial& get_table() const noexcept;
+
+    /**
+     * @brief Obtiene la expresión original aproximada.
+     *
+     * @return Referencia constante a la expresión original.
+     */
+    const Expression& get_original() const noexcept;
+
+    /**
+     * @brief Crea una copia profunda de esta aproximación.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `ApproximationExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa la aproximación utilizando una tabla de símbolos.
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación.
+     * @return Valor de la tabla si la variable está en su intervalo, o de la expresión original si no.
+     * @exception Lanza los mismos `EvalError` que la expresión original fuera del intervalo de la tabla.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const ApproximationExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte la aproximación a una cadena con información sobre la variable, la tabla y la expresión original y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const ApproximationExpression& expr);
+
+/**
+ * @brief Expresión `let nombre = valor in cuerpo`, que da nombre a un valor intermedio dentro de una expresión.
+ *
+ * El valor se evalúa una sola vez por evaluación, antes que el cuerpo, y se guarda en una posición local del hilo
+ * actual (ver `current_local_slots()`) en lugar de en la tabla de símbolos: las referencias al nombre dentro del
+ * cuerpo son `LocalExpression`s que leen esa posición, así que no se escribe ni se busca nada en la tabla.
+ *
+ * El analizador numera las posiciones según la profundidad de anidamiento, de modo que en cada camino desde la raíz
+ * hasta una hoja los `let` usan posiciones distintas, y dos `let` que no se contienen pueden compartir la misma.
+ */
+class LetExpression {
+  private:
+    Token m_name; /**< Token del identificador definido. */
+    size_t m_slot; /**< Posición local donde se guarda el valor. */
+    std::unique_ptr<Expression> m_value; /**< Expresión del valor definido. */
+    std::unique_ptr<Expression> m_body; /**< Expresión en la que el nombre está definido. */
+  public:
+    /**
+     * @brief Construye una definición local.
+     *
+     * @param name Token del identificador definido.
+     * @param slot Posición local donde se guarda el valor.
+     * @param value Puntero a la expresión del valor.
+     * @param body Puntero a la expresión del cuerpo.
+     * @exception Lanza `std::invalid_argument` si `name` no es un identificador o alguno de los punteros es nulo.
+     */
+    LetExpression(Token&& name, size_t slot, std::unique_ptr<Expression>&& value, std::unique_ptr<Expression>&& body);
+
+    /**
+     * @brief Obtiene el token del identificador definido.
+     *
+     * @return Referencia constante al token del identificador.
+     */
+    const Token& get_name() const noexcept;
+
+    /**
+     * @brief Obtiene la posición local donde se guarda el valor.
+     */
+    size_t get_slot() const noexcept;
+
+    /**
+     * @brief Obtiene la expresión del valor definido.
+     *
+     * @return Referencia constante al valor.
+     */
+    const Expression& get_value() const noexcept;
+
+    /**
+     * @brief Obtiene la expresión del cuerpo.
+     *
+     * @return Referencia constante al cuerpo.
+     */
+    const Expression& get_body() const noexcept;
+
+    /**
+     * @brief Crea una copia profunda de esta definición local.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `LetExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión utilizando una tabla de símbolos.
+     *
+     * Evalúa el valor, lo guarda en su posición local y evalúa el cuerpo.
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación.
+     * @return Resultado numérico del cuerpo.
+     * @exception Lanza un `EvalError` si ha habido problemas en la evaluación del valor o del cuerpo.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const LetExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte la definición local a una cadena con información sobre el nombre, el valor y el cuerpo y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const LetExpression& expr);
+
+/**
+ * @brief Expresión que lee el valor de un nombre definido por un `LetExpression` que la contiene.
+ *
+ * Estas expresiones las genera el analizador sintáctico para los identificadores que aparecen dentro del cuerpo de
+ * un `let` con su mismo nombre (el más interior, si hay varios), y solo tienen sentido dentro de ese cuerpo.
+ */
+class LocalExpression {
+  private:
+    Token m_name; /**< Token del identificador. */
+    size_t m_slot; /**< Posición local de la que se lee el valor. */
+  public:
+    /**
+     * @brief Construye una referencia a un nombre local.
+     *
+     * @param name Token del identificador.
+     * @param slot Posición local del `let` que define el nombre.
+     * @exception Lanza `std::invalid_argument` si `name` no es un identificador.
+     */
+    LocalExpression(Token&& name, size_t slot);
+
+    /**
+     * @brief Obtiene el token del identificador.
+     *
+     * @return Referencia constante al token del identificador.
+     */
+    const Token& get_name() const noexcept;
+
+    /**
+     * @brief Obtiene la posición local de la que se lee el valor.
+     */
+    size_t get_slot() const noexcept;
+
+    /**
+     * @brief Crea una copia de esta expresión.
+     *
+     * Devuelve la expresión clonada como instancia de `Expression`, no de `LocalExpression`.
+     * 
+     * @return Una nueva instancia de `Expression` equivalente a ésta.
+     */
+    Expression clone() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión, leyendo el valor de su posición local en el hilo actual.
+     *
+     * @param symbol_table Tabla de símbolos usada para la evaluación (no se consulta).
+     * @return El valor guardado por el `let` que define el nombre.
+     */
+    double evaluate(const SymbolTable& symbols) const;
+
+    friend class Expression;
+    friend std::ostream& operator<<(std::ostream& out, const LocalExpression& expr);
+};
+
+/**
+ * @brief Operador de inserción en flujo de salida (para uso con 
+ * `std::cout` y similares)
+ *
+ * Convierte la referencia local a una cadena con el nombre y su posición y la imprime.
+ * 
+ * @param out El flujo de salida.
+ * @param expr La expresión a imprimir.
+ * @return Referencia a `out` después de la operación.
+ */
+std::ostream& operator<<(std::ostream& out, const LocalExpression& expr);
+
+/**
+ * @brief Obtiene las posiciones locales del hilo actual, donde los `let` guardan sus valores.
+ *
+ * Quien evalúa en otro hilo una subexpresión que puede contener referencias a nombres locales definidos fuera de
+ * ella (como los hilos de `mc`) debe copiar antes en ese hilo las posiciones del hilo que la evalúa.
+ *
+ * @return Referencia a las posiciones locales del hilo actual.
+ */
+std::vector<double>& current_local_slots() noexcept;
+
 /**
  * @brief Representa una expresión genérica.
  *
  * Esta clase actúa como una variante que puede almacenar
  * cualquiera de los tipos concretos de expresión soportados 
- * (`OperandExpression`, `UnaryOpExpression` ó `BinaryOpExpression`).
+ * (`OperandExpression`, `UnaryOpExpression`, `BinaryOpExpression`, `ConditionalExpression`, `CallExpression`, `PolynomialExpression`,
+ * `ApproximationExpression`, `LetExpression` ó `LocalExpression`).
  */
 class Expression {
   private:
-    std::variant<BinOpExpression, OperandExpression, UnaryOpExpression> m_data;
+    std::variant<BinOpExpression, OperandExpression, UnaryOpExpression, ConditionalExpression, CallExpression, PolynomialExpression,
+                 ApproximationExpression, LetExpression, LocalExpression> m_data;
     ExpressionType m_type;  
 
     Expression(OperandExpression&& operand) noexcept;
     Expression(BinOpExpression&& bin_op) noexcept;
     Expression(UnaryOpExpression&& unary_op) noexcept;
+    Expression(ConditionalExpression&& conditional) noexcept;
+    Expression(CallExpression&& call) noexcept;
+    Expression(PolynomialExpression&& polynomial) noexcept;
+    Expression(ApproximationExpression&& approximation) noexcept;
+    Expression(LetExpression&& let) noexcept;
+    Expression(LocalExpression&& local) noexcept;
     Expression() = delete;
   public: 
     /**
@@ -281,23 +879,100 @@ class Expression {
      * @param oper Token del operador.
      * @param lhs Puntero al operando izquierdo.
      * @param rhs Puntero al operando derecho.
+     * @param domain_checked Si la evaluación comprueba el dominio de la operación.
      * @return Nueva expresión de tipo `ExpressionType::BIN_OP`.
      * @pre Los argumentos pasados deben ser válidos para construir un `BinOpExpression`.
      */
     static Expression bin_op(Token&& oper,
                              std::unique_ptr<Expression>&& lhs,
-                             std::unique_ptr<Expression>&& rhs);
+                             std::unique_ptr<Expression>&& rhs,
+                             bool domain_checked = true);
 
     /**
      * @brief Crea una expresión de operador unario o función.
      *
      * @param oper Token del operador.
      * @param operand Expresión operando.
+     * @param domain_checked Si la evaluación comprueba el dominio de la función.
      * @return Nueva expresión de tipo UNARY_OP.
      * @pre Los argumentos pasados deben ser válidos para construir un `UnaryOpExpression`.
      */
     static Expression unary_op(Token&& oper,
-                               std::unique_ptr<Expression>&& operand);
+                               std::unique_ptr<Expression>&& operand,
+                               bool domain_checked = true);
+
+    /**
+     * @brief Crea una expresión condicional.
+     *
+     * @param if_tok Token de la función `if`.
+     * @param condition Expresión de la condición.
+     * @param if_true Expresión de la rama cierta.
+     * @param if_false Expresión de la rama falsa.
+     * @return Nueva expresión de tipo `ExpressionType::CONDITIONAL`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `ConditionalExpression`.
+     */
+    static Expression conditional(Token&& if_tok,
+                                  std::unique_ptr<Expression>&& condition,
+                                  std::unique_ptr<Expression>&& if_true,
+                                  std::unique_ptr<Expression>&& if_false);
+
+    /**
+     * @brief Crea una expresión de llamada a función.
+     *
+     * @param func Token de la función.
+     * @param args Expresiones de los argumentos, en orden.
+     * @return Nueva expresión de tipo `ExpressionType::CALL`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `CallExpression`.
+     */
+    static Expression call(Token&& func, std::vector<std::unique_ptr<Expression>>&& args);
+
+    /**
+     * @brief Crea una expresión de polinomio.
+     *
+     * @param var Token de la variable.
+     * @param coefficients Parte numérica de los coeficientes.
+     * @param symbolic_coefficients Parte no numérica de los coeficientes, con su grado.
+     * @param original Expresión original equivalente al polinomio.
+     * @return Nueva expresión de tipo `ExpressionType::POLYNOMIAL`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `PolynomialExpression`.
+     */
+    static Expression polynomial(Token&& var,
+                                 std::vector<double>&& coefficients,
+                                 std::vector<std::pair<size_t, std::unique_ptr<Expression>>>&& symbolic_coefficients,
+                                 std::unique_ptr<Expression>&& original);
+
+    /**
+     * @brief Crea una expresión de aproximación.
+     *
+     * @param var Token de la variable.
+     * @param table Polinomio a trozos que aproxima la expresión original.
+     * @param original Expresión original.
+     * @return Nueva expresión de tipo `ExpressionType::APPROXIMATION`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `ApproximationExpression`.
+     */
+    static Expression approximation(Token&& var, PiecewisePolynomial&& table, std::unique_ptr<Expression>&& original);
+
+    /**
+     * @brief Crea una definición local.
+     *
+     * @param name Token del identificador definido.
+     * @param slot Posición local donde se guarda el valor.
+     * @param value Expresión del valor.
+     * @param body Expresión del cuerpo.
+     * @return Nueva expresión de tipo `ExpressionType::LET`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `LetExpression`.
+     */
+    static Expression let(Token&& name, size_t slot, std::unique_ptr<Expression>&& value, std::unique_ptr<Expression>&& body);
+
+    /**
+     * @brief Crea una referencia a un nombre local.
+     *
+     * @param name Token del identificador.
+     * @param slot Posición local del `let` que define el nombre.
+     * @return Nueva expresión de tipo `ExpressionType::LOCAL`.
+     * @pre Los argumentos pasados deben ser válidos para construir un `LocalExpression`.
+     */
+    static Expression local(Token&& name, size_t slot);
     
     /**
      * @brief Obtiene el tipo de la expresión.
@@ -314,6 +989,11 @@ class Expression {
      * - Para expresiones de tipo `ExpressionType::OPERAND`, el token devuelto corresponde al operando (número o identificador)
      * - Para expresiones de tipo `ExpressionType::BIN_OP`, el token devuelto es el operador binario.
      * - Para expresiones de tipo `ExpressionType::UNARY_OP`, el token devuelto es el operador unario o función.
+     * - Para expresiones de tipo `ExpressionType::CONDITIONAL`, el token devuelto es el de la función `if`.
+     * - Para expresiones de tipo `ExpressionType::CALL`, el token devuelto es el de la función llamada.
+     * - Para expresiones de tipo `ExpressionType::POLYNOMIAL`, el token devuelto es el de la variable del polinomio.
+     * - Para expresiones de tipo `ExpressionType::APPROXIMATION`, el token devuelto es el de la variable aproximada.
+     * - Para expresiones de tipo `ExpressionType::LET` y `ExpressionType::LOCAL`, el token devuelto es el del nombre local.
      *
      * @return Referencia constante al token correspondiente.
      */
@@ -343,6 +1023,54 @@ class Expression {
      */
     const UnaryOpExpression& as_unary_op() const;
 
+    /**
+     * @brief Accede a la expresión como condicional.
+     *
+     * @return Referencia constante a la expresión como instancia de `ConditionalExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::CONDITIONAL`
+     */
+    const ConditionalExpression& as_conditional() const;
+
+    /**
+     * @brief Accede a la expresión como llamada a función.
+     *
+     * @return Referencia constante a la expresión como instancia de `CallExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::CALL`
+     */
+    const CallExpression& as_call() const;
+
+    /**
+     * @brief Accede a la expresión como polinomio.
+     *
+     * @return Referencia constante a la expresión como instancia de `PolynomialExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::POLYNOMIAL`
+     */
+    const PolynomialExpression& as_polynomial() const;
+
+    /**
+     * @brief Accede a la expresión como aproximación.
+     *
+     * @return Referencia constante a la expresión como instancia de `ApproximationExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::APPROXIMATION`
+     */
+    const ApproximationExpression& as_approximation() const;
+
+    /**
+     * @brief Accede a la expresión como definición local.
+     *
+     * @return Referencia constante a la expresión como instancia de `LetExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::LET`
+     */
+    const LetExpression& as_let() const;
+
+    /**
+     * @brief Accede a la expresión como referencia a un nombre local.
+     *
+     * @return Referencia constante a la expresión como instancia de `LocalExpression`.
+     * @pre El tipo de la expresión debe ser `ExpressionType::LOCAL`
+     */
+    const LocalExpression& as_local() const;
+
     /**
      * @brief Crea una copia profunda de esta expresión.
      *
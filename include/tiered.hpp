@@ -0,0 +1,178 @@
+/**
+ * @file tiered.hpp
+ * @brief Ejecución por niveles: las expresiones empiezan en el intérprete y pasan a formas optimizadas y
+ * compiladas a medida que se evalúan más veces.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "native.hpp"
+#include "speculation.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Nivel de ejecución de una expresión, de menor a mayor coste de preparación.
+ */
+enum class ExecutionTier : uint8_t {
+    INTERPRETED = 0, /**< Recorrido del árbol tal y como sale del analizador. */
+    OPTIMIZED = 1,   /**< Árbol reescrito con `rewrite_polynomials()` y `elide_domain_checks()`. */
+    NATIVE = 2,      /**< Código nativo de `NativeFormula` (con el núcleo por columnas en precisión doble), con el árbol
+                          optimizado para los casos en que falla. */
+};
+
+/**
+ * @brief Número de evaluaciones a partir del cual una expresión sube de nivel.
+ *
+ * Si `optimize` es 0, la optimización se hace al construir la expresión, y si además `native` es 0, también la
+ * compilación. Para llegar al nivel nativo hace falta pasar antes por el optimizado, así que si `native` no es
+ * mayor que `optimize` la compilación empieza con la primera evaluación en el nivel optimizado.
+ */
+struct TierThresholds {
+    uint64_t optimize = 100;  /**< Evaluaciones para pasar al nivel optimizado. */
+    uint64_t native = 10000;  /**< Evaluaciones, contando todas las anteriores, para pasar al nivel nativo. */
+    uint64_t speculate = 100; /**< Evaluaciones seguidas con el mismo valor de una variable para especializar sobre él
+                                   los niveles interpretado y optimizado (ver `SpeculativeFormula`), o 0 para no hacerlo. */
+};
+
+/**
+ * @brief Estadísticas de ejecución de una expresión por niveles.
+ */
+struct TierStatistics {
+    ExecutionTier tier;                  /**< Nivel actual. */
+    std::array<uint64_t, 3> evaluations; /**< Evaluaciones hechas en cada nivel, indexadas por `ExecutionTier`. */
+    std::array<double, 3> build_seconds; /**< Tiempo empleado en preparar cada nivel, en segundos (0 si no se ha preparado). */
+    bool native_failed;                  /**< Si se ha intentado compilar la expresión y no se ha podido. */
+    SpeculationStatistics speculation;   /**< Estadísticas de las especializaciones, sumando las de todos los niveles. */
+};
+
+/**
+ * @brief Expresión que cuenta sus evaluaciones y sube de nivel de ejecución cuando se usa lo suficiente.
+ *
+ * Cada expresión empieza en el intérprete, que no necesita ninguna preparación. Al llegar a los umbrales de
+ * `TierThresholds`, un hilo en segundo plano prepara el siguiente nivel mientras las evaluaciones siguen usando el
+ * actual, y al terminar lo publica con una única escritura atómica: quien evalúa nunca espera a la preparación. Los
+ * niveles anteriores se conservan hasta destruir la expresión, así que una evaluación que empezó con uno de ellos
+ * puede terminar sin problemas.
+ *
+ * El nivel nativo solo se alcanza si se indica un directorio de caché; si la compilación falla, la expresión se
+ * queda en el nivel optimizado. Todos los niveles dan los mismos errores de evaluación.
+ *
+ * En los niveles interpretado y optimizado, el árbol se evalúa con una `SpeculativeFormula`, que se especializa sola
+ * para las variables que llevan `TierThresholds::speculate` evaluaciones sin cambiar de valor (como los parámetros
+ * que un cliente del servidor por memoria compartida repite en todas sus peticiones) y se descarta en cuanto una de
+ * ellas cambia.
+ *
+ * Se puede evaluar desde varios hilos a la vez, siempre que cada uno use su propia tabla de símbolos. Solo un hilo a
+ * la vez usa la especialización; los demás evalúan el árbol del nivel sin especializar.
+ */
+class TieredFormula {
+  private:
+    /// Forma ejecutable de un nivel.
+    struct Engine {
+        Expression expr;                    /**< Árbol que evalúa el intérprete. */
+        std::optional<NativeFormula> native; /**< Código nativo, solo en el nivel nativo. */
+        std::unique_ptr<SpeculativeFormula> speculative; /**< Especialización de `expr`, salvo en el nivel nativo. */
+    };
+
+    Expression m_source;                   /**< Expresión original, de la que se preparan los niveles. */
+    std::vector<Token> m_variables;        /**< Variables cuyos valores se pasan en cada evaluación, en orden. */
+    SymbolTable m_constants;               /**< Constantes de la expresión. */
+    std::string m_native_dir;              /**< Directorio de caché para compilar, o vacío para no pasar del nivel optimizado. */
+    std::array<uint64_t, 3> m_budgets;     /**< Evaluaciones en cada nivel antes de pasar al siguiente. */
+    uint64_t m_speculate;                  /**< Umbral de especialización, o 0 para no especializar. */
+    std::array<std::unique_ptr<Engine>, 3> m_engines; /**< Forma de cada nivel ya preparado, indexada por `ExecutionTier`. */
+    std::atomic<uint8_t> m_tier;           /**< Nivel publicado; `m_engines[m_tier]` ya está preparado. */
+    std::array<std::atomic<uint64_t>, 3> m_evaluations;   /**< Evaluaciones hechas en cada nivel. */
+    std::array<std::atomic<uint64_t>, 3> m_build_nanoseconds; /**< Tiempo de preparación de cada nivel. */
+    std::atomic<bool> m_native_failed;     /**< Si la compilación ha fallado. */
+    std::atomic<bool> m_promoting;         /**< Si hay una preparación en marcha. */
+    std::thread m_worker;                  /**< Hilo de la última preparación. */
+    std::mutex m_worker_mutex;             /**< Protege `m_worker`, que su hilo puede dejar de necesitar antes de que se
+                                                haya terminado de asignar. */
+    mutable std::mutex m_speculation_mutex; /**< Protege la `SpeculativeFormula` de cada nivel. */
+
+    std::unique_ptr<Engine> make_engine(Expression&& expr, std::optional<NativeFormula>&& native) const;
+    double interpret(const Engine& engine, const double* args, SymbolTable& symbols);
+    void promote(ExecutionTier from);
+    void maybe_promote(ExecutionTier from);
+  public:
+    /**
+     * @brief Crea una expresión en el nivel interpretado, o en el que indiquen los umbrales que valen 0.
+     *
+     * @param expr Expresión a evaluar.
+     * @param variables Tokens identificadores de las variables cuyos valores se pasan a `evaluate()`, en orden.
+     * @param constants Tabla de símbolos con las constantes de la expresión. Se copia.
+     * @param native_dir Directorio de caché para compilar la expresión, o vacío para no pasar del nivel optimizado.
+     * @param thresholds Umbrales de promoción.
+     */
+    TieredFormula(const Expression& expr, const std::vector<Token>& variables, const SymbolTable& constants,
+                  const std::string& native_dir = "", const TierThresholds& thresholds = {});
+
+    TieredFormula(const TieredFormula&) = delete;
+    TieredFormula& operator=(const TieredFormula&) = delete;
+
+    /// Destructor, espera a que termine la preparación en marcha, si la hay.
+    ~TieredFormula();
+
+    /**
+     * @brief Devuelve las variables de la expresión, en el orden en que se pasan a `evaluate()`.
+     */
+    const std::vector<Token>& variables() const noexcept;
+
+    /**
+     * @brief Evalúa la expresión con el nivel actual y cuenta la evaluación, lanzando la preparación del siguiente
+     * nivel si se ha llegado a su umbral.
+     *
+     * @param args Valores de las variables, en el orden de `variables()`.
+     * @param symbols Tabla de símbolos con las constantes, donde se asignan las variables si hay que usar el intérprete.
+     * Se marcan como vigiladas las variables sobre las que se especializa la expresión.
+     * @return El resultado de la evaluación.
+     * @exception Lanza el `EvalError` de la evaluación, si falla.
+     */
+    double evaluate(const double* args, SymbolTable& symbols);
+
+    /**
+     * @brief Evalúa la expresión para varias filas con el nivel actual y cuenta una evaluación por fila, igual que
+     * si se llamase a `evaluate()` con cada una.
+     *
+     * En el nivel nativo se usa el núcleo por columnas de `NativeFormula::evaluate_columns()`, que da los mismos
+     * resultados que la evaluación fila a fila; las filas en las que falla, y todas en los demás niveles, se evalúan
+     * como en `evaluate()`.
+     *
+     * @param columns Valores de cada variable, en el orden de `variables()`, uno por fila.
+     * @param rows Número de filas.
+     * @param symbols Tabla de símbolos con las constantes, donde se asignan las variables si hay que usar el intérprete.
+     * Se marcan como vigiladas las variables sobre las que se especializa la expresión.
+     * @param results Donde escribir el resultado de cada fila. Solo es válido en las filas que no han fallado.
+     * @param failed Donde indicar, con un valor distinto de cero, las filas cuya evaluación da un `EvalError`.
+     */
+    void evaluate_batch(const double* const* columns, size_t rows, SymbolTable& symbols, double* results, uint8_t* failed);
+
+    /**
+     * @brief Devuelve el nivel actual.
+     */
+    ExecutionTier tier() const noexcept;
+
+    /**
+     * @brief Devuelve las estadísticas de ejecución hasta el momento.
+     */
+    TierStatistics statistics() const;
+};
+
+} // namespace clex
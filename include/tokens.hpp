@@ -31,6 +31,15 @@ enum class TokenType {
     OP_ASTERISK,    // Operador "*"
     OP_SLASH,       // Operador "/"
     OP_CARET,       // Operador "^"
+    OP_LESS,        // Operador "<"
+    OP_LESS_EQ,     // Operador "<="
+    OP_GREATER,     // Operador ">"
+    OP_GREATER_EQ,  // Operador ">="
+    OP_EQUAL,       // Operador "=="
+    OP_NOT_EQUAL,   // Operador "!="
+    OP_AND,         // Operador lógico "and"
+    OP_OR,          // Operador lógico "or"
+    OP_NOT,         // Operador lógico "not"
     OP_FUNC_SQRT,   // Función "sqrt"
     OP_FUNC_LOG,    // Función "log"
     OP_FUNC_SIN,    // Función "sin"
@@ -39,9 +48,26 @@ enum class TokenType {
     OP_FUNC_ARCSIN, // Función "arcsin"
     OP_FUNC_ARCCOS, // Función "arccos"
     OP_FUNC_ARCTAN, // Función "arctan"
+    FUNC_IF,        // Función condicional "if"
+    FUNC_RAND,      // Función "rand" (número aleatorio uniforme en [0, 1))
+    FUNC_RANDN,     // Función "randn" (número aleatorio normal estándar)
+    FUNC_MC,        // Función "mc" (media de Monte Carlo)
+    FUNC_MCERR,     // Función "mcerr" (error estándar de Monte Carlo)
+    FUNC_MINIMIZE,  // Función "minimize" (valor mínimo de una expresión)
+    FUNC_ARGMIN,    // Función "argmin" (punto en el que se alcanza el mínimo)
+    FUNC_ODE,       // Función "ode" (integración de ecuaciones diferenciales)
+    FUNC_ROLLING_SUM,  // Función "rolling_sum" (suma de las últimas filas de un flujo)
+    FUNC_ROLLING_MEAN, // Función "rolling_mean" (media de las últimas filas de un flujo)
+    FUNC_ROLLING_MIN,  // Función "rolling_min" (mínimo de las últimas filas de un flujo)
+    FUNC_ROLLING_MAX,  // Función "rolling_max" (máximo de las últimas filas de un flujo)
+    FUNC_EMA,          // Función "ema" (media móvil exponencial de un flujo)
+    FUNC_LAG,          // Función "lag" (valor de una fila anterior de un flujo)
     ASSIGN,         // Operador de asignación "="  
     PAREN_L,        // Paréntesis "("
     PAREN_R,        // Paréntesis ")"
+    COMMA,          // Separador de argumentos ","
+    LET,            // Palabra clave "let" de las definiciones locales
+    IN,             // Palabra clave "in" de las definiciones locales
 };
 
 /**
@@ -100,6 +126,17 @@ class Token {
     */
     static Token number(const std::string& num) noexcept;
 
+    /**
+    * @brief Construye y devuelve un token numérico a partir de un valor ya calculado.
+    *
+    * Pensada para las transformaciones del árbol de sintaxis que generan constantes nuevas, que así no 
+    * pierden precisión al pasar el valor por una cadena.
+    *
+    * @param value Valor numérico del token.
+    * @return El token numérico construido.
+    */
+    static Token number(double value) noexcept;
+
     /**
     * @brief Construye y devuelve un token de identificador a partir de un `std::string` que contiene un nombre.
     *
@@ -152,6 +189,40 @@ class Token {
     */
     std::optional<int> get_unary_binding_power() const noexcept;
 
+    /**
+    * @brief Obtiene el número de argumentos de un token de función con lista de argumentos entre paréntesis.
+    *
+    * Este método devuelve un `std::optional` vacío si el token sobre el que se llama no es una función de ese tipo.
+    * A diferencia de las funciones matemáticas como `sqrt`, que se analizan como operadores unarios, estas funciones
+    * requieren siempre paréntesis y sus argumentos se separan por comas, como en `mc(rand(), 1000)`.
+    *
+    * Para las funciones con número variable de argumentos (ver `is_variadic_call()`) devuelve el número mínimo.
+    *
+    * @return un `std::optional<size_t>` que contiene el número de argumentos de la función si el token lo es, y vacío si no.
+    */
+    std::optional<size_t> get_call_arity() const noexcept;
+
+    /**
+    * @brief Comprueba si el token es una función que admite más argumentos que los indicados por `get_call_arity()`.
+    *
+    * Es el caso de `minimize` y `argmin`, que reciben la expresión a minimizar seguida de una o más variables,
+    * como en `minimize((x - 1)^2 + y^2, x, y)`, y de `ode`, que recibe tantos lados derechos como variables de
+    * estado, como en `ode(v, -y, y, v, t, 10)`.
+    *
+    * @return `true` si el token es una función con número variable de argumentos, `false` si no.
+    */
+    bool is_variadic_call() const noexcept;
+
+    /**
+    * @brief Comprueba si el token es un operador de comparación.
+    *
+    * Los operadores de comparación son los de tipo (`TokenType::`) `OP_LESS`, `OP_LESS_EQ`, `OP_GREATER`, 
+    * `OP_GREATER_EQ`, `OP_EQUAL` y `OP_NOT_EQUAL`. Al evaluarse, devuelven `1.0` si la comparación es cierta y `0.0` si no.
+    * .
+    * @return `true` si el token sobre el que se llama es un operador de comparación, `false` si no.
+    */
+    bool is_comparison_token() const noexcept;
+
     /**
     * @brief Devuelve el tipo del token.
     * .
@@ -162,7 +233,7 @@ class Token {
     /**
     * @brief Comprueba si el token actúa como operador unario o función.
     *
-    * Los tokens que actúan como operadores unarios son los de tipo (`TokenType::`) `OP_PLUS`, `OP_MINUS`, `OP_FUNC_SQRT`,
+    * Los tokens que actúan como operadores unarios son los de tipo (`TokenType::`) `OP_PLUS`, `OP_MINUS`, `OP_NOT`, `OP_FUNC_SQRT`,
     * `OP_FUNC_LOG`, `OP_FUNC_SIN`, `OP_FUNC_COS`, `OP_FUNC_TAN`, `OP_FUNC_ARCSIN`, `OP_FUNC_ARCCOS` y `OP_FUNC_ARCTAN`.
     * .
     * @return `true` si el token sobre el que se llama es de uno de los tipos mencionados anteriormente, `false` si no.
@@ -173,7 +244,8 @@ class Token {
     * @brief Comprueba si el token actúa como operador binario.
     *
     * Los tokens que actúan como operadores binarios son los de tipo (`TokenType::`) `OP_PLUS`, `OP_MINUS`, `OP_ASTERISK`,
-    * `OP_SLASH` y `OP_CARET`.
+    * `OP_SLASH`, `OP_CARET`, los operadores de comparación (`OP_LESS`, `OP_LESS_EQ`, `OP_GREATER`, `OP_GREATER_EQ`, 
+    * `OP_EQUAL` y `OP_NOT_EQUAL`) y los operadores lógicos `OP_AND` y `OP_OR`.
     * .
     * @return `true` si el token sobre el que se llama es de uno de los tipos mencionados anteriormente, `false` si no.
     */
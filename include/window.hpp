@@ -0,0 +1,109 @@
+/**
+ * @file window.hpp
+ * @brief Funciones de ventana sobre un flujo de valores: sumas, medias, mínimos y máximos de las últimas filas,
+ * medias móviles exponenciales y retardos.
+ *
+ * Cada función se calcula de forma incremental, con un coste constante (amortizado) por fila e independiente del
+ * tamaño de la ventana, guardando solo el estado imprescindible del flujo en lugar de volver a recorrer la ventana.
+ *
+ * @author Eduardo Rodríguez, Raúl Gabaldón
+ * @date 2025-12
+ */
+#pragma once
+
+#include "tokens.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+/**
+ * @brief Función de ventana de un `StreamWindow`.
+ */
+enum class WindowFunction : uint8_t {
+    ROLLING_SUM,  /**< Suma de las últimas `n` filas. */
+    ROLLING_MEAN, /**< Media de las últimas `n` filas. */
+    ROLLING_MIN,  /**< Mínimo de las últimas `n` filas. */
+    ROLLING_MAX,  /**< Máximo de las últimas `n` filas. */
+    EMA,          /**< Media móvil exponencial con factor de suavizado `alpha`. */
+    LAG,          /**< Valor de `k` filas antes. */
+};
+
+/**
+ * @brief Devuelve la función de ventana que corresponde a un tipo de token de llamada, si la hay.
+ *
+ * @param type Tipo del token de la función.
+ * @return La función de ventana, o `std::nullopt` si `type` no es una función de ventana.
+ */
+std::optional<WindowFunction> window_function(TokenType type) noexcept;
+
+/**
+ * @brief Estado de una función de ventana sobre un flujo de valores que llegan de uno en uno.
+ *
+ * Cada fila del flujo tiene un valor o es nula. El resultado para una fila es:
+ * - En `ROLLING_SUM` y `ROLLING_MEAN`, la suma o la media de las `n` últimas filas, incluida ella, con una suma
+ *   acumulada a la que se suma el valor que entra y se resta el que sale. Para que el error de redondeo no crezca
+ *   con la longitud del flujo, la suma se vuelve a calcular desde cero cada `n` filas. Los valores infinitos y NaN
+ *   se cuentan aparte, así que el resultado es el mismo que daría sumar la ventana (salvo en los últimos bits).
+ * - En `ROLLING_MIN` y `ROLLING_MAX`, el mínimo o el máximo de las `n` últimas filas, que se obtienen de una cola
+ *   monótona con las filas que aún pueden llegar a ser el extremo. Si hay algún NaN en la ventana, el resultado es NaN.
+ * - En `EMA`, `alpha * x + (1 - alpha) * anterior`, empezando por el primer valor del flujo. Las filas nulas dan un
+ *   resultado nulo y no cambian la media.
+ * - En `LAG`, el valor de la fila `k` posiciones antes.
+ *
+ * En las funciones de ventana deslizante el resultado es nulo mientras no han llegado `n` filas, o si alguna de las
+ * filas de la ventana es nula; en `LAG`, mientras no han llegado `k + 1` filas, o si la fila de `k` posiciones antes
+ * es nula.
+ */
+class StreamWindow {
+  private:
+    WindowFunction m_function;  /**< Función de ventana. */
+    size_t m_size;              /**< Filas que se guardan: `n` en las ventanas deslizantes y `k + 1` en `LAG`. */
+    double m_alpha;             /**< Factor de suavizado de `EMA`. */
+    uint64_t m_rows;            /**< Filas recibidas hasta el momento. */
+    uint64_t m_null_end;        /**< Índice más uno de la última fila nula, o 0 si no ha habido ninguna. */
+    uint64_t m_nan_end;         /**< Índice más uno de la última fila con un NaN, o 0 (en `ROLLING_MIN` y `ROLLING_MAX`). */
+    std::vector<double> m_values;  /**< Últimos valores del flujo, en un búfer circular de `m_size` posiciones. */
+    std::vector<uint8_t> m_valid;  /**< Si cada posición de `m_values` tiene un valor (en `LAG`). */
+    double m_sum;               /**< Suma de los valores finitos de la ventana. */
+    size_t m_nan;               /**< Valores NaN en la ventana. */
+    size_t m_pos_inf;           /**< Valores `+inf` en la ventana. */
+    size_t m_neg_inf;           /**< Valores `-inf` en la ventana. */
+    std::deque<std::pair<uint64_t, double>> m_extrema; /**< Cola monótona de (índice, valor) para el mínimo o el máximo. */
+    std::optional<double> m_average; /**< Media exponencial hasta el momento, si ya ha llegado algún valor. */
+
+    std::optional<double> push_sum(double value, bool valid) noexcept;
+    std::optional<double> push_extremum(double value, bool valid);
+    std::optional<double> push_lag(double value, bool valid) noexcept;
+    std::optional<double> push_ema(double value, bool valid) noexcept;
+  public:
+    /**
+     * @brief Crea el estado de una función de ventana para un flujo vacío.
+     *
+     * @param function Función de ventana.
+     * @param parameter Número de filas `n` de las ventanas deslizantes (entero positivo), retardo `k` de `LAG`
+     * (entero no negativo) o factor de suavizado `alpha` de `EMA` (en `(0, 1]`).
+     * @exception Lanza `std::invalid_argument` si `parameter` no es válido para `function`.
+     */
+    StreamWindow(WindowFunction function, double parameter);
+
+    /**
+     * @brief Añade la siguiente fila del flujo y devuelve el resultado de la función para ella.
+     *
+     * @param value Valor de la fila. Se ignora si `valid` es falso.
+     * @param valid Si la fila tiene valor, o es nula.
+     * @return El resultado para la fila, o `std::nullopt` si es nulo.
+     */
+    std::optional<double> push(double value, bool valid);
+
+    /**
+     * @brief Devuelve el número de filas recibidas hasta el momento.
+     */
+    uint64_t rows() const noexcept;
+};
+
+} // namespace clex
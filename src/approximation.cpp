@@ -0,0 +1,248 @@
+#include "approximation.hpp"
+#include "eval_errors.hpp"
+#include "range_analysis.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr size_t MAX_PIECES = 4096;
+constexpr size_t DEGREES[] = {4, 6, 8};
+constexpr size_t MAX_DEGREE = 8;
+constexpr size_t SAMPLES_PER_PIECE = 4 * (MAX_DEGREE + 1); // intervalos de la malla de comprobación en cada tramo
+constexpr int MIN_COST = 4; // dos funciones trascendentes
+
+// Coste aproximado de evaluar `expr`, en mitades de una función trascendente.
+int cost(const Expression& expr) {
+    switch(expr.type()) {
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        bool integer_power = rhs.type() == ExpressionType::OPERAND && rhs.get_token().type() == TokenType::NUMBER
+                             && *rhs.get_token().get_num() == std::floor(*rhs.get_token().get_num());
+        int own = expr.get_token().type() == TokenType::OP_CARET && !integer_power ? 2 : 0;
+        return own + cost(lhs) + cost(rhs);
+      }
+      case ExpressionType::UNARY_OP: {
+        TokenType oper = expr.get_token().type();
+        int own = oper == TokenType::OP_FUNC_SQRT ? 1 : (oper == TokenType::OP_PLUS || oper == TokenType::OP_MINUS ? 0 : 2);
+        return own + cost(expr.as_unary_op().get_operand());
+      }
+      default: return 0;
+    }
+}
+
+/**
+ * Analiza si `expr` es una función suave de una sola variable de `ranges`. `var` recoge el nombre de la variable,
+ * si ya se ha encontrado alguna; se devuelve `false` si aparecen dos variables, un identificador sin valor o una
+ * operación no admitida.
+ */
+bool is_smooth_univariate(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges,
+                          std::optional<std::string>& var) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: {
+        const Token& tok = expr.get_token();
+        if(tok.type() != TokenType::IDENTIFIER) {
+            return true;
+        }
+        std::string name = *tok.get_ident();
+        if(ranges.find(name) == ranges.end()) {
+            return constants.get(tok).has_value();
+        }
+        if(var.has_value() && *var != name) {
+            return false;
+        }
+        var = name;
+        return true;
+      }
+      case ExpressionType::BIN_OP: {
+        switch(expr.get_token().type()) {
+          case TokenType::OP_PLUS: case TokenType::OP_MINUS: case TokenType::OP_ASTERISK:
+          case TokenType::OP_SLASH: case TokenType::OP_CARET: break;
+          default: return false; // comparaciones y operadores lógicos
+        }
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        return is_smooth_univariate(lhs, constants, ranges, var) && is_smooth_univariate(rhs, constants, ranges, var);
+      }
+      case ExpressionType::UNARY_OP: {
+        if(expr.get_token().type() == TokenType::OP_NOT) {
+            return false;
+        }
+        return is_smooth_univariate(expr.as_unary_op().get_operand(), constants, ranges, var);
+      }
+      default: return false;
+    }
+}
+
+// Evalúa una subexpresión de una variable; devuelve `std::nullopt` si da un error de evaluación o un valor no finito.
+class Sampler {
+  private:
+    const Expression& m_expr;
+    SymbolTable m_symbols;
+    Token m_var;
+  public:
+    Sampler(const Expression& expr, const SymbolTable& constants, const std::string& var)
+        : m_expr(expr), m_symbols(constants), m_var(Token::identifier(var)) {};
+
+    std::optional<double> operator()(double x) {
+        m_symbols.set(m_var, x);
+        try {
+            double value = m_expr.evaluate(m_symbols);
+            return std::isfinite(value) ? std::optional<double>(value) : std::nullopt;
+        } catch(const EvalError&) {
+            return std::nullopt;
+        }
+    }
+};
+
+// Coeficientes en la base de monomios de `t` de los polinomios de Chebyshev T_0, ..., T_degree.
+std::vector<std::vector<double>> chebyshev_basis(size_t degree) {
+    std::vector<std::vector<double>> basis(degree + 1, std::vector<double>(degree + 1, 0.0));
+    basis[0][0] = 1.0;
+    if(degree >= 1) {
+        basis[1][1] = 1.0;
+    }
+    for(size_t j = 2; j <= degree; j++) { // T_j = 2t T_{j-1} - T_{j-2}
+        for(size_t k = 0; k <= degree; k++) {
+            basis[j][k] = (k > 0 ? 2.0 * basis[j - 1][k - 1] : 0.0) - basis[j - 2][k];
+        }
+    }
+    return basis;
+}
+
+/**
+ * Interpola `f` en los nodos de Chebyshev de cada tramo y devuelve los coeficientes de todos los tramos en la base
+ * de monomios de la variable local `t`, o `std::nullopt` si `f` falla en algún nodo.
+ */
+std::optional<std::vector<double>> fit(Sampler& f, double lo, double hi, size_t pieces, size_t degree) {
+    size_t n = degree + 1;
+    std::vector<std::vector<double>> basis = chebyshev_basis(degree);
+    std::vector<double> nodes(n);
+    for(size_t k = 0; k < n; k++) {
+        nodes[k] = std::cos(std::numbers::pi * (static_cast<double>(k) + 0.5) / static_cast<double>(n));
+    }
+    std::vector<double> coefficients;
+    coefficients.reserve(pieces * n);
+    std::vector<double> values(n);
+    double width = (hi - lo) / static_cast<double>(pieces);
+    for(size_t piece = 0; piece < pieces; piece++) {
+        double center = lo + width * (static_cast<double>(piece) + 0.5);
+        for(size_t k = 0; k < n; k++) {
+            std::optional<double> value = f(center + 0.5 * width * nodes[k]);
+            if(!value.has_value()) {
+                return std::nullopt;
+            }
+            values[k] = *value;
+        }
+        std::vector<double> monomial(n, 0.0);
+        for(size_t j = 0; j < n; j++) {
+            double c = 0.0;
+            for(size_t k = 0; k < n; k++) {
+                c += values[k] * std::cos(std::numbers::pi * static_cast<double>(j) * (static_cast<double>(k) + 0.5) / static_cast<double>(n));
+            }
+            c *= (j == 0 ? 1.0 : 2.0) / static_cast<double>(n);
+            for(size_t k = 0; k <= j; k++) {
+                monomial[k] += c * basis[j][k];
+            }
+        }
+        coefficients.insert(coefficients.end(), monomial.begin(), monomial.end());
+    }
+    return coefficients;
+}
+
+std::optional<Expression> try_approximation(const Expression& expr, const SymbolTable& constants,
+                                            const VariableRanges& ranges, double tolerance) {
+    std::optional<std::string> var;
+    if(expr.type() == ExpressionType::OPERAND || cost(expr) < MIN_COST
+       || !is_smooth_univariate(expr, constants, ranges, var) || !var.has_value()) {
+        return std::nullopt;
+    }
+    const Interval& range = ranges.at(*var);
+    if(!(std::isfinite(range.lo) && std::isfinite(range.hi) && range.lo < range.hi)) {
+        return std::nullopt;
+    }
+    Sampler f(expr, constants, *var);
+    for(size_t pieces = 1; pieces <= MAX_PIECES; pieces *= 2) {
+        // valores exactos en la malla de comprobación, compartidos por todos los grados
+        size_t samples = pieces * SAMPLES_PER_PIECE;
+        std::vector<double> grid(samples + 1), exact(samples + 1);
+        for(size_t s = 0; s <= samples; s++) {
+            grid[s] = std::min(range.hi, range.lo + (range.hi - range.lo) * static_cast<double>(s) / static_cast<double>(samples));
+            std::optional<double> value = f(grid[s]);
+            if(!value.has_value()) {
+                return std::nullopt;
+            }
+            exact[s] = *value;
+        }
+        for(size_t degree : DEGREES) {
+            std::optional<std::vector<double>> coefficients = fit(f, range.lo, range.hi, pieces, degree);
+            if(!coefficients.has_value()) {
+                return std::nullopt;
+            }
+            PiecewisePolynomial table(range.lo, range.hi, degree, std::move(*coefficients));
+            bool accurate = true;
+            for(size_t s = 0; s <= samples && accurate; s++) {
+                accurate = std::abs(table.evaluate(grid[s]) - exact[s]) <= tolerance;
+            }
+            if(accurate) {
+                return Expression::approximation(Token::identifier(*var), std::move(table), std::make_unique<Expression>(expr.clone()));
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+}
+
+Expression approximate_univariate(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges,
+                                  double tolerance) {
+    if(std::optional<Expression> approximation = try_approximation(expr, constants, ranges, tolerance)) {
+        return std::move(*approximation);
+    }
+    auto recurse = [&](const Expression& child) {
+        return std::make_unique<Expression>(approximate_univariate(child, constants, ranges, tolerance));
+    };
+    switch(expr.type()) {
+      case ExpressionType::BIN_OP: {
+        const BinOpExpression& bin_op = expr.as_bin_op();
+        auto [lhs, rhs] = bin_op.get_operands();
+        return Expression::bin_op(Token(bin_op.get_operator()), recurse(lhs), recurse(rhs), bin_op.is_domain_checked());
+      }
+      case ExpressionType::UNARY_OP: {
+        const UnaryOpExpression& unary = expr.as_unary_op();
+        return Expression::unary_op(Token(unary.get_operator()), recurse(unary.get_operand()), unary.is_domain_checked());
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        return Expression::conditional(Token(expr.get_token()), recurse(conditional.get_condition()), recurse(if_true), recurse(if_false));
+      }
+      case ExpressionType::CALL: {
+        const CallExpression& call = expr.as_call();
+        std::vector<std::unique_ptr<Expression>> args;
+        for(const std::unique_ptr<Expression>& arg : call.get_args()) {
+            args.push_back(recurse(*arg));
+        }
+        return Expression::call(Token(call.get_function()), std::move(args));
+      }
+      case ExpressionType::LET: {
+        const LetExpression& let = expr.as_let();
+        return Expression::let(Token(let.get_name()), let.get_slot(), recurse(let.get_value()), recurse(let.get_body()));
+      }
+      default: {
+        return expr.clone();
+      }
+    }
+}
+
+} // namespace clex
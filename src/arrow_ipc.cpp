@@ -0,0 +1,591 @@
+#include "arrow_ipc.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+constexpr int16_t METADATA_V5 = 4;
+
+// Tipos de la unión `MessageHeader`
+constexpr uint8_t HEADER_SCHEMA = 1;
+constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+
+// Tipos de la unión `Type`
+constexpr uint8_t TYPE_NULL = 1;
+constexpr uint8_t TYPE_INT = 2;
+constexpr uint8_t TYPE_FLOATING_POINT = 3;
+constexpr uint8_t TYPE_BINARY = 4;
+constexpr uint8_t TYPE_UTF8 = 5;
+constexpr uint8_t TYPE_BOOL = 6;
+constexpr uint8_t TYPE_DECIMAL = 7;
+constexpr uint8_t TYPE_DATE = 8;
+constexpr uint8_t TYPE_TIME = 9;
+constexpr uint8_t TYPE_TIMESTAMP = 10;
+constexpr uint8_t TYPE_INTERVAL = 11;
+constexpr uint8_t TYPE_FIXED_SIZE_BINARY = 15;
+constexpr uint8_t TYPE_DURATION = 18;
+constexpr uint8_t TYPE_LARGE_BINARY = 19;
+constexpr uint8_t TYPE_LARGE_UTF8 = 20;
+
+constexpr int16_t PRECISION_DOUBLE = 2;
+
+// Bytes de los metadatos o del cuerpo de un mensaje que se leen de una vez
+constexpr uint64_t READ_CHUNK = uint64_t(1) << 24;
+
+[[noreturn]] void invalid(const std::string& what) {
+    throw std::runtime_error("Flujo Arrow inválido: " + what);
+}
+
+size_t padded(size_t size) noexcept {
+    return (size + 7) / 8 * 8;
+}
+
+/**
+ * Tabla de un FlatBuffer: empieza con la distancia (con signo) a su *vtable*, que da la posición de cada campo
+ * dentro de la tabla, o 0 si el campo no está y vale su valor por defecto.
+ */
+class FlatTable {
+  private:
+    const uint8_t* m_buf;
+    size_t m_size;
+    size_t m_pos;
+    size_t m_vtable;
+    uint16_t m_vtable_size;
+
+    // Posición del campo `id`, o 0 si no está.
+    size_t field(int id) const {
+        size_t entry = 4 + 2 * static_cast<size_t>(id);
+        if(entry + 2 > m_vtable_size) {
+            return 0;
+        }
+        uint16_t offset = read<uint16_t>(m_buf, m_size, m_vtable + entry);
+        return offset == 0 ? 0 : m_pos + offset;
+    }
+
+    // Destino del desplazamiento guardado en el campo `id`, o 0 si el campo no está.
+    size_t target(int id) const {
+        size_t at = field(id);
+        if(at == 0) {
+            return 0;
+        }
+        size_t result = at + read<uint32_t>(m_buf, m_size, at);
+        if(result >= m_size) {
+            invalid("desplazamiento fuera del mensaje");
+        }
+        return result;
+    }
+  public:
+    template<typename T>
+    static T read(const uint8_t* buf, size_t size, size_t pos) {
+        if(pos > size || size - pos < sizeof(T)) {
+            invalid("lectura fuera del mensaje");
+        }
+        T value;
+        std::memcpy(&value, buf + pos, sizeof(T));
+        return value;
+    }
+
+    FlatTable(const uint8_t* buf, size_t size, size_t pos) : m_buf(buf), m_size(size), m_pos(pos), m_vtable(0), m_vtable_size(0) {
+        int64_t vtable = static_cast<int64_t>(pos) - read<int32_t>(buf, size, pos);
+        if(vtable < 0 || static_cast<size_t>(vtable) >= size) {
+            invalid("vtable fuera del mensaje");
+        }
+        m_vtable = static_cast<size_t>(vtable);
+        m_vtable_size = read<uint16_t>(buf, size, m_vtable);
+    }
+
+    static FlatTable root(const uint8_t* buf, size_t size) {
+        return FlatTable(buf, size, read<uint32_t>(buf, size, 0));
+    }
+
+    template<typename T>
+    T scalar(int id, T default_value) const {
+        size_t at = field(id);
+        return at == 0 ? default_value : read<T>(m_buf, m_size, at);
+    }
+
+    bool has(int id) const {
+        return field(id) != 0;
+    }
+
+    FlatTable table(int id) const {
+        size_t at = target(id);
+        if(at == 0) {
+            invalid("falta una tabla obligatoria");
+        }
+        return FlatTable(m_buf, m_size, at);
+    }
+
+    std::string string(int id) const {
+        size_t at = target(id);
+        if(at == 0) {
+            return "";
+        }
+        uint32_t length = read<uint32_t>(m_buf, m_size, at);
+        if(m_size - at - 4 < length) {
+            invalid("cadena fuera del mensaje");
+        }
+        return std::string(reinterpret_cast<const char*>(m_buf + at + 4), length);
+    }
+
+    // Número de elementos del vector del campo `id` y posición del primero; `{0, 0}` si no está.
+    std::pair<uint32_t, size_t> vector(int id, size_t element_size) const {
+        size_t at = target(id);
+        if(at == 0) {
+            return {0, 0};
+        }
+        uint32_t length = read<uint32_t>(m_buf, m_size, at);
+        if((m_size - at - 4) / element_size < length) {
+            invalid("vector fuera del mensaje");
+        }
+        return {length, at + 4};
+    }
+
+    // Tabla número `index` de un vector de tablas que empieza en `first`.
+    FlatTable element(size_t first, size_t index) const {
+        size_t at = first + 4 * index;
+        return FlatTable(m_buf, m_size, at + read<uint32_t>(m_buf, m_size, at));
+    }
+
+    template<typename T>
+    T element_scalar(size_t first, size_t index) const {
+        return read<T>(m_buf, m_size, first + sizeof(T) * index);
+    }
+};
+
+/**
+ * Construye un FlatBuffer de principio a fin. Los campos que apuntan a otras tablas, vectores o cadenas se
+ * reservan al escribir la tabla y se rellenan con `point()` al escribir su destino, que siempre va después.
+ */
+class FlatBuilder {
+  private:
+    std::vector<uint8_t> m_buf;
+  public:
+    struct Table {
+        size_t start;
+        std::vector<std::pair<int, size_t>> fields; // identificador y posición de cada campo escrito
+    };
+
+    size_t size() const noexcept {
+        return m_buf.size();
+    }
+
+    void align(size_t n) {
+        while(m_buf.size() % n != 0) {
+            m_buf.push_back(0);
+        }
+    }
+
+    template<typename T>
+    size_t put(T value) {
+        size_t at = m_buf.size();
+        m_buf.resize(at + sizeof(T));
+        std::memcpy(m_buf.data() + at, &value, sizeof(T));
+        return at;
+    }
+
+    template<typename T>
+    void put_at(size_t at, T value) {
+        std::memcpy(m_buf.data() + at, &value, sizeof(T));
+    }
+
+    size_t offset_slot() {
+        align(4);
+        return put<uint32_t>(0);
+    }
+
+    void point(size_t slot, size_t target) {
+        put_at<uint32_t>(slot, static_cast<uint32_t>(target - slot));
+    }
+
+    Table begin_table() {
+        align(4);
+        return Table{put<int32_t>(0), {}};
+    }
+
+    template<typename T>
+    void field(Table& table, int id, T value) {
+        align(sizeof(T));
+        table.fields.emplace_back(id, put<T>(value));
+    }
+
+    size_t offset_field(Table& table, int id) {
+        size_t slot = offset_slot();
+        table.fields.emplace_back(id, slot);
+        return slot;
+    }
+
+    // La vtable se escribe justo después de la tabla, así que la distancia guardada en la tabla es negativa.
+    void end_table(const Table& table) {
+        size_t table_size = size() - table.start;
+        int max_id = -1;
+        for(const auto& [id, at] : table.fields) {
+            max_id = std::max(max_id, id);
+        }
+        align(2);
+        size_t vtable = put<uint16_t>(static_cast<uint16_t>(4 + 2 * (max_id + 1)));
+        put<uint16_t>(static_cast<uint16_t>(table_size));
+        for(int id = 0; id <= max_id; id++) {
+            uint16_t offset = 0;
+            for(const auto& [field_id, at] : table.fields) {
+                if(field_id == id) {
+                    offset = static_cast<uint16_t>(at - table.start);
+                }
+            }
+            put<uint16_t>(offset);
+        }
+        put_at<int32_t>(table.start, static_cast<int32_t>(static_cast<int64_t>(table.start) - static_cast<int64_t>(vtable)));
+    }
+
+    // Escribe la longitud de un vector de forma que sus elementos queden alineados a `element_align` bytes.
+    size_t begin_vector(size_t length, size_t element_align) {
+        align(4);
+        while((size() + 4) % element_align != 0) {
+            put<uint8_t>(0);
+        }
+        return put<uint32_t>(static_cast<uint32_t>(length));
+    }
+
+    size_t string(const std::string& text) {
+        align(4);
+        size_t at = put<uint32_t>(static_cast<uint32_t>(text.size()));
+        m_buf.insert(m_buf.end(), text.begin(), text.end());
+        m_buf.push_back(0);
+        return at;
+    }
+
+    std::vector<uint8_t> finish() {
+        align(8);
+        return std::move(m_buf);
+    }
+};
+
+// Número de búferes de una columna de tipo plano en un lote, o -1 si el tipo no se admite.
+int buffer_count(uint8_t type) noexcept {
+    switch(type) {
+      case TYPE_NULL: return 0;
+      case TYPE_INT: case TYPE_FLOATING_POINT: case TYPE_BOOL: case TYPE_DECIMAL: case TYPE_DATE: case TYPE_TIME:
+      case TYPE_TIMESTAMP: case TYPE_INTERVAL: case TYPE_FIXED_SIZE_BINARY: case TYPE_DURATION: return 2;
+      case TYPE_BINARY: case TYPE_UTF8: case TYPE_LARGE_BINARY: case TYPE_LARGE_UTF8: return 3;
+      default: return -1;
+    }
+}
+
+/**
+ * Lee el siguiente mensaje encapsulado: la marca de continuación, la longitud de los metadatos y los metadatos.
+ * Devuelve `false` al final del flujo. Los metadatos se leen por trozos, como el cuerpo en `read_body()`.
+ */
+bool read_message(std::istream& in, std::vector<uint8_t>& metadata) {
+    uint32_t word = 0;
+    if(!in.read(reinterpret_cast<char*>(&word), 4)) {
+        return false; // flujo terminado sin marca de final
+    }
+    if(word == CONTINUATION && !in.read(reinterpret_cast<char*>(&word), 4)) {
+        invalid("mensaje cortado");
+    }
+    // sin marca de continuación, la primera palabra ya es la longitud (formato anterior a Arrow 0.15)
+    if(word == 0) {
+        return false;
+    }
+    metadata.clear();
+    uint64_t done = 0;
+    while(done < word) {
+        uint64_t chunk = std::min(word - done, READ_CHUNK);
+        metadata.resize(static_cast<size_t>(done + chunk));
+        if(!in.read(reinterpret_cast<char*>(metadata.data()) + done, static_cast<std::streamsize>(chunk))) {
+            invalid("metadatos cortados");
+        }
+        done += chunk;
+    }
+    return true;
+}
+
+/**
+ * Lee un cuerpo de `length` bytes en `body`, por trozos. La longitud viene del propio flujo, así que no se reserva
+ * toda de una vez: con una longitud errónea, el flujo se acaba antes y solo se ha reservado lo que se ha leído.
+ */
+void read_body(std::istream& in, int64_t length, std::vector<uint64_t>& body) {
+    body.clear();
+    uint64_t done = 0;
+    while(done < static_cast<uint64_t>(length)) {
+        uint64_t chunk = std::min(static_cast<uint64_t>(length) - done, READ_CHUNK);
+        body.resize(static_cast<size_t>((done + chunk + 7) / 8), 0);
+        if(!in.read(reinterpret_cast<char*>(body.data()) + done, static_cast<std::streamsize>(chunk))) {
+            invalid("cuerpo cortado");
+        }
+        done += chunk;
+    }
+}
+
+/**
+ * Descarta un cuerpo de `length` bytes, por trozos como en `read_body()`.
+ */
+void skip_body(std::istream& in, int64_t length) {
+    uint64_t done = 0;
+    while(done < static_cast<uint64_t>(length)) {
+        uint64_t chunk = std::min(static_cast<uint64_t>(length) - done, READ_CHUNK);
+        if(in.ignore(static_cast<std::streamsize>(chunk)).gcount() != static_cast<std::streamsize>(chunk)) {
+            invalid("cuerpo cortado");
+        }
+        done += chunk;
+    }
+}
+
+void write_message(std::ostream& out, const std::vector<uint8_t>& metadata) {
+    uint32_t header[2] = {CONTINUATION, static_cast<uint32_t>(metadata.size())};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(metadata.data()), static_cast<std::streamsize>(metadata.size()));
+}
+
+// Empieza un mensaje con la cabecera de tipo `header_type` y devuelve el hueco donde apuntar a la cabecera.
+size_t begin_message(FlatBuilder& b, uint8_t header_type, int64_t body_length) {
+    size_t root = b.offset_slot();
+    FlatBuilder::Table message = b.begin_table();
+    b.point(root, message.start);
+    b.field<int64_t>(message, 3, body_length);
+    b.field<int16_t>(message, 0, METADATA_V5);
+    b.field<uint8_t>(message, 1, header_type);
+    size_t header = b.offset_field(message, 2);
+    b.end_table(message);
+    return header;
+}
+
+}
+
+ArrowColumn::ArrowColumn(ArrowType type, const uint8_t* validity, const uint8_t* data) noexcept
+    : m_type(type), m_validity(validity), m_data(data) {};
+
+ArrowType ArrowColumn::type() const noexcept {
+    return m_type;
+}
+
+const uint8_t* ArrowColumn::validity() const noexcept {
+    return m_validity;
+}
+
+bool ArrowColumn::is_valid(size_t row) const noexcept {
+    return m_validity == nullptr || (m_validity[row / 8] >> (row % 8)) & 1;
+}
+
+double ArrowColumn::value(size_t row) const noexcept {
+    if(m_type == ArrowType::INT64) {
+        int64_t value;
+        std::memcpy(&value, m_data + 8 * row, 8);
+        return static_cast<double>(value);
+    }
+    double value;
+    std::memcpy(&value, m_data + 8 * row, 8);
+    return value;
+}
+
+ArrowStreamReader::ArrowStreamReader(std::istream& in) : m_in(in), m_fields(), m_buffer_counts() {
+    std::vector<uint8_t> metadata;
+    if(!read_message(in, metadata)) {
+        invalid("el flujo está vacío");
+    }
+    FlatTable message = FlatTable::root(metadata.data(), metadata.size());
+    if(message.scalar<uint8_t>(1, 0) != HEADER_SCHEMA) {
+        invalid("el primer mensaje no es un esquema");
+    }
+    FlatTable schema = message.table(2);
+    if(schema.scalar<int16_t>(0, 0) != 0) {
+        invalid("solo se admiten datos little-endian");
+    }
+    auto [n_fields, first] = schema.vector(1, 4);
+    for(uint32_t i = 0; i < n_fields; i++) {
+        FlatTable field = schema.element(first, i);
+        std::string name = field.string(0);
+        uint8_t type = field.scalar<uint8_t>(2, 0);
+        int buffers = buffer_count(type);
+        if(buffers < 0 || field.vector(5, 4).first > 0 || field.has(4)) {
+            throw std::runtime_error("La columna Arrow '" + name + "' es de un tipo anidado o de diccionario, que no se admite");
+        }
+        ArrowType column_type = ArrowType::OTHER;
+        if(type == TYPE_FLOATING_POINT && field.table(3).scalar<int16_t>(0, 0) == PRECISION_DOUBLE) {
+            column_type = ArrowType::FLOAT64;
+        } else if(type == TYPE_INT && field.table(3).scalar<int32_t>(0, 0) == 64 && field.table(3).scalar<uint8_t>(1, 0) != 0) {
+            column_type = ArrowType::INT64;
+        }
+        m_fields.push_back(ArrowField{name, column_type, field.scalar<uint8_t>(1, 0) != 0});
+        m_buffer_counts.push_back(buffers);
+    }
+}
+
+const std::vector<ArrowField>& ArrowStreamReader::fields() const noexcept {
+    return m_fields;
+}
+
+bool ArrowStreamReader::next(ArrowRecordBatch& batch) {
+    std::vector<uint8_t> metadata;
+    int64_t body_length;
+    while(true) {
+        if(!read_message(m_in, metadata)) {
+            return false;
+        }
+        FlatTable message = FlatTable::root(metadata.data(), metadata.size());
+        body_length = message.scalar<int64_t>(3, 0);
+        if(body_length < 0) {
+            invalid("longitud del cuerpo negativa");
+        }
+        uint8_t header_type = message.scalar<uint8_t>(1, 0);
+        if(header_type == HEADER_DICTIONARY_BATCH) {
+            throw std::runtime_error("Los diccionarios de Arrow no se admiten");
+        }
+        if(header_type == HEADER_RECORD_BATCH) {
+            break;
+        }
+        skip_body(m_in, body_length); // otros mensajes, como tensores, se ignoran
+    }
+    FlatTable message = FlatTable::root(metadata.data(), metadata.size());
+    read_body(m_in, body_length, batch.body);
+
+    FlatTable record_batch = message.table(2);
+    if(record_batch.has(3)) {
+        throw std::runtime_error("Los lotes de Arrow comprimidos no se admiten");
+    }
+    batch.length = record_batch.scalar<int64_t>(0, 0);
+    auto [n_nodes, nodes] = record_batch.vector(1, 16);
+    auto [n_buffers, buffers] = record_batch.vector(2, 16);
+    if(batch.length < 0 || n_nodes != m_fields.size()) {
+        invalid("el lote no coincide con el esquema");
+    }
+    const uint8_t* body = reinterpret_cast<const uint8_t*>(batch.body.data());
+    uint64_t rows = static_cast<uint64_t>(batch.length);
+    batch.columns.clear();
+    size_t buffer_index = 0;
+    for(size_t i = 0; i < m_fields.size(); i++) {
+        int64_t node_length = record_batch.element_scalar<int64_t>(nodes, 2 * i);
+        int64_t null_count = record_batch.element_scalar<int64_t>(nodes, 2 * i + 1);
+        if(node_length != batch.length) {
+            invalid("la columna '" + m_fields[i].name + "' no tiene el mismo número de filas que el lote");
+        }
+        const uint8_t* pointers[3] = {nullptr, nullptr, nullptr};
+        for(int k = 0; k < m_buffer_counts[i]; k++, buffer_index++) {
+            if(buffer_index >= n_buffers) {
+                invalid("faltan búferes en el lote");
+            }
+            int64_t offset = record_batch.element_scalar<int64_t>(buffers, 2 * buffer_index);
+            int64_t length = record_batch.element_scalar<int64_t>(buffers, 2 * buffer_index + 1);
+            if(offset < 0 || length < 0 || offset > body_length || length > body_length - offset) {
+                invalid("búfer fuera del cuerpo");
+            }
+            uint64_t needed = k == 0 ? (rows + 7) / 8 : 8 * rows;
+            if(length == 0 && (k > 0 || null_count == 0)) {
+                continue; // sin mapa de validez, ninguna fila es nula
+            }
+            if(m_fields[i].type != ArrowType::OTHER && static_cast<uint64_t>(length) < needed) {
+                invalid("búfer demasiado corto en la columna '" + m_fields[i].name + "'");
+            }
+            pointers[k] = body + offset;
+        }
+        bool numeric = m_fields[i].type != ArrowType::OTHER;
+        if(numeric && rows > 0 && pointers[1] == nullptr) {
+            invalid("faltan los valores de la columna '" + m_fields[i].name + "'");
+        }
+        batch.columns.emplace_back(m_fields[i].type, null_count > 0 ? pointers[0] : nullptr, numeric ? pointers[1] : nullptr);
+    }
+    return true;
+}
+
+ArrowStreamWriter::ArrowStreamWriter(std::ostream& out, std::vector<std::string> names) : m_out(out), m_names(std::move(names)) {
+    FlatBuilder b;
+    size_t header = begin_message(b, HEADER_SCHEMA, 0);
+    FlatBuilder::Table schema = b.begin_table();
+    b.point(header, schema.start);
+    size_t fields_slot = b.offset_field(schema, 1);
+    b.end_table(schema);
+
+    b.point(fields_slot, b.begin_vector(m_names.size(), 4));
+    std::vector<size_t> field_slots;
+    for(size_t i = 0; i < m_names.size(); i++) {
+        field_slots.push_back(b.offset_slot());
+    }
+    for(size_t i = 0; i < m_names.size(); i++) {
+        FlatBuilder::Table field = b.begin_table();
+        b.point(field_slots[i], field.start);
+        size_t name_slot = b.offset_field(field, 0);
+        size_t type_slot = b.offset_field(field, 3);
+        size_t children_slot = b.offset_field(field, 5);
+        b.field<uint8_t>(field, 1, 1);
+        b.field<uint8_t>(field, 2, TYPE_FLOATING_POINT);
+        b.end_table(field);
+        b.point(name_slot, b.string(m_names[i]));
+        FlatBuilder::Table floating_point = b.begin_table();
+        b.point(type_slot, floating_point.start);
+        b.field<int16_t>(floating_point, 0, PRECISION_DOUBLE);
+        b.end_table(floating_point);
+        b.point(children_slot, b.begin_vector(0, 4));
+    }
+    write_message(m_out, b.finish());
+}
+
+void ArrowStreamWriter::write_batch(size_t length, const std::vector<const double*>& columns,
+                                    const std::vector<const uint8_t*>& validity) {
+    size_t bitmap_size = padded((length + 7) / 8), values_size = padded(8 * length);
+    std::vector<uint8_t> body;
+    std::vector<std::pair<int64_t, int64_t>> nodes, buffers; // (filas, nulos) y (posición, longitud)
+    for(size_t c = 0; c < columns.size(); c++) {
+        int64_t null_count = 0;
+        std::vector<uint8_t> bitmap(bitmap_size, 0);
+        for(size_t r = 0; r < length; r++) {
+            if(validity.empty() || validity[c][r] != 0) {
+                bitmap[r / 8] |= static_cast<uint8_t>(1u << (r % 8));
+            } else {
+                null_count++;
+            }
+        }
+        nodes.emplace_back(static_cast<int64_t>(length), null_count);
+        if(null_count > 0) {
+            buffers.emplace_back(static_cast<int64_t>(body.size()), static_cast<int64_t>(bitmap.size()));
+            body.insert(body.end(), bitmap.begin(), bitmap.end());
+        } else {
+            buffers.emplace_back(static_cast<int64_t>(body.size()), 0);
+        }
+        buffers.emplace_back(static_cast<int64_t>(body.size()), static_cast<int64_t>(8 * length));
+        size_t at = body.size();
+        body.resize(at + values_size, 0);
+        std::memcpy(body.data() + at, columns[c], 8 * length);
+    }
+
+    FlatBuilder b;
+    size_t header = begin_message(b, HEADER_RECORD_BATCH, static_cast<int64_t>(body.size()));
+    FlatBuilder::Table record_batch = b.begin_table();
+    b.point(header, record_batch.start);
+    b.field<int64_t>(record_batch, 0, static_cast<int64_t>(length));
+    size_t nodes_slot = b.offset_field(record_batch, 1);
+    size_t buffers_slot = b.offset_field(record_batch, 2);
+    b.end_table(record_batch);
+    b.point(nodes_slot, b.begin_vector(nodes.size(), 8));
+    for(const auto& [rows, nulls] : nodes) {
+        b.put<int64_t>(rows);
+        b.put<int64_t>(nulls);
+    }
+    b.point(buffers_slot, b.begin_vector(buffers.size(), 8));
+    for(const auto& [offset, size] : buffers) {
+        b.put<int64_t>(offset);
+        b.put<int64_t>(size);
+    }
+    write_message(m_out, b.finish());
+    m_out.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+}
+
+void ArrowStreamWriter::finish() {
+    uint32_t end[2] = {CONTINUATION, 0};
+    m_out.write(reinterpret_cast<const char*>(end), sizeof(end));
+    m_out.flush();
+}
+
+} // namespace clex
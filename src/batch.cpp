@@ -0,0 +1,2141 @@
+#include "batch.hpp"
+#include "approximation.hpp"
+#include "arrow_ipc.hpp"
+#include "eval_errors.hpp"
+#include "native.hpp"
+#include "polynomial.hpp"
+#include "random.hpp"
+#include "range_analysis.hpp"
+#include "read_ahead.hpp"
+#include "statistics.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include "window.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr size_t CHUNK_ROWS = 16384; // filas leídas antes de repartirlas entre los hilos
+// Filas que cada hilo pasa a columnas y evalúa de una vez con un núcleo nativo: incluso con decenas de columnas, sus
+// valores y resultados caben en la caché L2, así que el núcleo los lee de ahí justo después de haberlos escrito
+constexpr size_t TILE_ROWS = 2048;
+// Con un filtro, si en un grupo de filas pasan menos de esta fracción, el núcleo se ejecuta solo sobre las que pasan,
+// reunidas en columnas aparte; si pasan más, sale más barato ejecutarlo sobre el grupo entero y descartar el resto
+constexpr double GATHER_SELECTIVITY = 0.5;
+
+constexpr double PRINTED_QUANTILES[] = {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+
+/**
+ * Bloque de filas leídas de la entrada, con los valores de todas las filas seguidos en un mismo vector.
+ */
+struct CsvChunk {
+    uint64_t first_row = 0;             // índice (desde 0) de la primera fila del bloque en toda la entrada
+    std::vector<double> values;         // `n_columns` valores por fila
+    std::vector<uint64_t> line_numbers; // línea de la entrada de cada fila, para los mensajes de error
+    std::vector<std::string> invalid;   // motivo por el que cada fila es inválida, o vacío si es válida
+    std::vector<uint64_t> validity;     // mapa de bits de los valores no nulos de cada columna, con `words()` palabras por
+                                        // columna y el bit `r % 64` de la palabra `r / 64` para la fila `r`; vacío si no hay nulos
+    std::vector<uint64_t> indices;      // índice en toda la entrada de cada fila, si no son consecutivas desde `first_row`
+
+    size_t rows() const noexcept {
+        return line_numbers.size();
+    }
+
+    uint64_t row_index(size_t r) const noexcept {
+        return indices.empty() ? first_row + r : indices[r];
+    }
+
+    size_t words() const noexcept {
+        return (rows() + 63) / 64;
+    }
+};
+
+// Mapa de bits con los bits de las filas `[0, rows)` a 1, y los sobrantes de la última palabra a 0.
+void fill_bitmap(std::vector<uint64_t>& bitmap, size_t rows) {
+    bitmap.assign((rows + 63) / 64, ~uint64_t(0));
+    if(rows % 64 != 0) {
+        bitmap.back() = (uint64_t(1) << (rows % 64)) - 1;
+    }
+}
+
+// Deja en `present` el mapa de bits de las filas del bloque en las que no es nula ninguna de las columnas marcadas en
+// `used`, combinando sus mapas de validez palabra a palabra, 64 filas cada vez.
+void present_rows(const CsvChunk& chunk, const std::vector<uint8_t>& used, std::vector<uint64_t>& present) {
+    fill_bitmap(present, chunk.rows());
+    if(chunk.validity.empty()) {
+        return;
+    }
+    size_t words = chunk.words();
+    for(size_t j = 0; j < used.size(); j++) {
+        if(!used[j]) {
+            continue;
+        }
+        const uint64_t* column = &chunk.validity[j * words];
+        for(size_t w = 0; w < words; w++) {
+            present[w] &= column[w];
+        }
+    }
+}
+
+bool is_present(const std::vector<uint64_t>& present, size_t r) noexcept {
+    return (present[r / 64] >> (r % 64)) & 1;
+}
+
+std::string trim(const std::string& str) {
+    size_t begin = 0, end = str.size();
+    while(begin < end && std::isspace(static_cast<unsigned char>(str[begin]))) begin++;
+    while(end > begin && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
+    return str.substr(begin, end - begin);
+}
+
+std::vector<std::string> split_fields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t begin = 0;
+    while(true) {
+        size_t comma = line.find(',', begin);
+        if(comma == std::string::npos) {
+            fields.push_back(trim(line.substr(begin)));
+            return fields;
+        }
+        fields.push_back(trim(line.substr(begin, comma - begin)));
+        begin = comma + 1;
+    }
+}
+
+bool is_identifier(const std::string& name) noexcept {
+    if(name.empty() || !std::isalpha(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)); });
+}
+
+std::vector<Token> read_header(std::istream& in) {
+    std::string line;
+    if(!std::getline(in, line)) {
+        throw std::runtime_error("La entrada CSV no tiene cabecera");
+    }
+    std::vector<Token> columns;
+    for(std::string& name : split_fields(line)) {
+        if(!is_identifier(name)) {
+            throw std::runtime_error("El nombre de columna '" + name + "' no es un identificador válido");
+        }
+        columns.push_back(Token::identifier(name));
+    }
+    return columns;
+}
+
+/**
+ * Rango de cada columna: el declarado en `ranges` o, si no hay, cualquier valor. Las columnas tapan a las 
+ * variables de la tabla de símbolos con el mismo nombre, así que todas deben tener rango en el análisis.
+ */
+std::vector<Interval> column_ranges(const std::vector<Token>& columns, const VariableRanges& ranges) {
+    for(const auto& [name, range] : ranges) {
+        bool is_column = std::any_of(columns.begin(), columns.end(), [&](const Token& col) { return *col.get_ident() == name; });
+        if(!is_column) {
+            throw std::runtime_error("Se ha declarado un rango para '" + name + "', que no es una columna de la entrada");
+        }
+    }
+    std::vector<Interval> result;
+    for(const Token& col : columns) {
+        auto it = ranges.find(*col.get_ident());
+        result.push_back(it != ranges.end() ? it->second : Interval::unbounded());
+    }
+    return result;
+}
+
+// Si `name` aparece como identificador en `expr`.
+bool uses_identifier(const Expression& expr, const std::string& name) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: {
+        const Token& tok = expr.get_token();
+        return tok.type() == TokenType::IDENTIFIER && *tok.get_ident() == name;
+      }
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        return uses_identifier(lhs, name) || uses_identifier(rhs, name);
+      }
+      case ExpressionType::UNARY_OP:
+        return uses_identifier(expr.as_unary_op().get_operand(), name);
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        return uses_identifier(conditional.get_condition(), name) || uses_identifier(if_true, name) 
+               || uses_identifier(if_false, name);
+      }
+      case ExpressionType::CALL: {
+        const auto& args = expr.as_call().get_args();
+        return std::any_of(args.begin(), args.end(), [&](const std::unique_ptr<Expression>& arg) { return uses_identifier(*arg, name); });
+      }
+      case ExpressionType::POLYNOMIAL:
+        return uses_identifier(expr.as_polynomial().get_original(), name);
+      case ExpressionType::APPROXIMATION:
+        return uses_identifier(expr.as_approximation().get_original(), name);
+      case ExpressionType::LET: {
+        const LetExpression& let = expr.as_let();
+        return uses_identifier(let.get_value(), name) || uses_identifier(let.get_body(), name);
+      }
+      case ExpressionType::LOCAL:
+        return false; // un nombre local no es una columna, aunque se llame igual
+    }
+    return false;
+}
+
+/**
+ * Expresión lista para evaluar todas las filas: optimizada y, si se ha pedido y se puede, compilada a código nativo.
+ * Con `float32`, los resultados se redondean a `float` y, si hay código nativo, se calculan con su núcleo en
+ * precisión simple. `used[j]` indica si la expresión usa la columna `j`, para saber qué valores nulos hacen nulo
+ * el resultado.
+ */
+struct PreparedExpression {
+    Expression expr;
+    std::optional<NativeFormula> native;
+    bool float32 = false;
+    std::vector<uint8_t> used;
+};
+
+// La expresión se evalúa una vez por fila, así que merece la pena optimizarla antes.
+PreparedExpression prepare_expression(const Expression& expr, const std::vector<Token>& columns, const std::vector<Interval>& ranges, 
+                                      const SymbolTable& symbols, const BatchOptions& options, std::ostream& err) {
+    VariableRanges all_ranges;
+    for(size_t j = 0; j < columns.size(); j++) {
+        all_ranges.emplace(*columns[j].get_ident(), ranges[j]);
+    }
+    Expression source = options.approximation_tolerance > 0.0 
+        ? approximate_univariate(expr, symbols, all_ranges, options.approximation_tolerance) : expr.clone();
+    PreparedExpression prepared{elide_domain_checks(rewrite_polynomials(source), symbols, all_ranges), std::nullopt, options.float32, {}};
+    for(const Token& column : columns) {
+        prepared.used.push_back(uses_identifier(expr, *column.get_ident()));
+    }
+    if(!options.native_dir.empty()) {
+        try {
+            prepared.native.emplace(NativeFormula::build(prepared.expr, columns, symbols, options.native_dir, 
+                                                         options.float32, !options.float32));
+        } catch(const std::runtime_error& e) {
+            err << "Aviso: " << e.what() << "; se usa el intérprete\n";
+        }
+    }
+    return prepared;
+}
+
+/**
+ * Filtro de las filas: su predicado, preparado como las expresiones pero siempre en precisión doble y sin tablas de
+ * aproximación, para que las filas que pasan sean exactamente las mismas que con el intérprete, y la clave de los
+ * flujos aleatorios con que se evalúa en cada fila.
+ */
+struct PreparedFilter {
+    PreparedExpression predicate;
+    uint64_t key;
+};
+
+std::optional<PreparedFilter> prepare_filter(const Expression* filter, const std::vector<Token>& columns,
+                                             const std::vector<Interval>& ranges, const SymbolTable& symbols,
+                                             const BatchOptions& options, std::ostream& err) {
+    if(filter == nullptr) {
+        return std::nullopt;
+    }
+    BatchOptions exact = options;
+    exact.float32 = false;
+    exact.approximation_tolerance = 0.0;
+    PreparedExpression predicate = prepare_expression(*filter, columns, ranges, symbols, exact, err);
+    return PreparedFilter{std::move(predicate), current_random_stream().next_u64()};
+}
+
+// Lee hasta `CHUNK_ROWS` filas, sin pasar de `bytes_left` bytes; devuelve `false` si la entrada ya se había terminado. 
+// Los campos vacíos son valores nulos, que se marcan en `chunk.validity`. Las líneas en blanco se ignoran, salvo si
+// hay una sola columna, en cuyo caso son filas con un nulo: si no, los resultados de las filas siguientes se moverían.
+// Las filas con algún valor fuera del rango declarado de su columna se marcan como inválidas, ya que la expresión 
+// preparada puede no comprobar el dominio de operaciones que solo son seguras dentro de esos rangos.
+bool read_chunk(std::istream& in, const std::vector<Token>& columns, const std::vector<Interval>& ranges,
+                uint64_t& line_number, uint64_t& bytes_left, CsvChunk& chunk) {
+    size_t n_columns = columns.size();
+    chunk.first_row += chunk.rows();
+    chunk.values.clear();
+    chunk.line_numbers.clear();
+    chunk.invalid.clear();
+    chunk.validity.clear();
+    std::vector<size_t> nulls; // posiciones en `chunk.values` de los valores nulos
+    std::string line;
+    while(chunk.rows() < CHUNK_ROWS && bytes_left > 0 && std::getline(in, line)) {
+        bytes_left -= std::min<uint64_t>(bytes_left, line.size() + 1);
+        line_number++;
+        if(n_columns > 1 && trim(line).empty()) {
+            continue;
+        }
+        std::vector<std::string> fields = split_fields(line);
+        std::string problem;
+        if(fields.size() != n_columns) {
+            problem = "se esperaban " + std::to_string(n_columns) + " campos y hay " + std::to_string(fields.size());
+        }
+        for(size_t j = 0; j < n_columns; j++) {
+            double value = std::numeric_limits<double>::quiet_NaN();
+            if(problem.empty() && fields[j].empty()) {
+                nulls.push_back(chunk.values.size());
+            } else if(problem.empty()) {
+                char* end = nullptr;
+                value = std::strtod(fields[j].c_str(), &end);
+                if(*end != '\0') {
+                    problem = "el campo '" + fields[j] + "' no es un número";
+                } else if(!ranges[j].contains(value)) {
+                    problem = "el valor " + fields[j] + " de la columna '" + *columns[j].get_ident() + "' está fuera del rango declarado";
+                }
+            }
+            chunk.values.push_back(value);
+        }
+        chunk.line_numbers.push_back(line_number);
+        chunk.invalid.push_back(std::move(problem));
+    }
+    if(!nulls.empty()) {
+        size_t words = chunk.words();
+        chunk.validity.resize(n_columns * words);
+        for(size_t j = 0; j < n_columns; j++) {
+            std::vector<uint64_t> column;
+            fill_bitmap(column, chunk.rows());
+            std::copy(column.begin(), column.end(), chunk.validity.begin() + j * words);
+        }
+        for(size_t position : nulls) {
+            size_t r = position / n_columns, j = position % n_columns;
+            chunk.validity[j * words + r / 64] &= ~(uint64_t(1) << (r % 64));
+        }
+    }
+    return chunk.rows() > 0;
+}
+
+// Pasa las filas `[first, last)` de un bloque a columnas de `T` en `values`, y apunta `columns` a cada una. Las
+// columnas se separan una línea de caché más de lo necesario: si no, con grupos de filas de tamaño potencia de dos,
+// todas empiezan en el mismo conjunto de la caché y se expulsan unas a otras al escribirlas fila a fila.
+template<typename T>
+void transpose_tile(const CsvChunk& chunk, size_t n_columns, size_t first, size_t last, 
+                    std::vector<T>& values, std::vector<const T*>& columns) {
+    size_t rows = last - first, stride = rows + 64 / sizeof(T);
+    values.resize(stride * n_columns);
+    columns.resize(n_columns);
+    for(size_t j = 0; j < n_columns; j++) {
+        columns[j] = &values[j * stride];
+    }
+    for(size_t r = 0; r < rows; r++) {
+        const double* row = &chunk.values[(first + r) * n_columns];
+        for(size_t j = 0; j < n_columns; j++) {
+            values[j * stride + r] = static_cast<T>(row[j]);
+        }
+    }
+}
+
+// Como `transpose_tile()`, pero solo con las filas `first + selection[i]` del bloque, que quedan seguidas.
+template<typename T>
+void gather_tile(const CsvChunk& chunk, size_t n_columns, size_t first, const std::vector<uint32_t>& selection,
+                 std::vector<T>& values, std::vector<const T*>& columns) {
+    size_t rows = selection.size(), stride = rows + 64 / sizeof(T);
+    values.resize(stride * n_columns);
+    columns.resize(n_columns);
+    for(size_t j = 0; j < n_columns; j++) {
+        columns[j] = &values[j * stride];
+    }
+    for(size_t i = 0; i < rows; i++) {
+        const double* row = &chunk.values[(first + selection[i]) * n_columns];
+        for(size_t j = 0; j < n_columns; j++) {
+            values[j * stride + i] = static_cast<T>(row[j]);
+        }
+    }
+}
+
+std::string error_message(const EvalError& e) {
+    std::ostringstream message;
+    e.print_to(message);
+    return trim(message.str());
+}
+
+// Evalúa la fila `r` de un bloque sin el núcleo por columnas: con el código nativo si lo hay y no falla, y si no con
+// el intérprete, asignando las columnas en `symbols` y con el flujo aleatorio de la fila. Lanza el `EvalError` si falla.
+double evaluate_row(const CsvChunk& chunk, size_t r, const std::vector<Token>& columns, const PreparedExpression& prepared,
+                    uint64_t key, SymbolTable& symbols) {
+    double value;
+    if(prepared.native.has_value() && prepared.native->evaluate(&chunk.values[r * columns.size()], value)) {
+        return value;
+    }
+    for(size_t j = 0; j < columns.size(); j++) {
+        symbols.set(columns[j], chunk.values[r * columns.size() + j]);
+    }
+    ScopedRandomStream stream(RandomStream(key, chunk.row_index(r)));
+    return prepared.expr.evaluate(symbols);
+}
+
+/**
+ * Memoria que reutiliza cada hilo para elegir las filas de sus grupos con `select_rows()`.
+ */
+struct TileSelection {
+    std::vector<uint32_t> rows;          // filas elegidas, relativas al principio del grupo y en orden
+    std::vector<double> values;          // el grupo entero pasado a columnas, si el filtro tiene núcleo
+    std::vector<const double*> columns;
+    std::vector<double> results;         // resultado del núcleo del filtro en cada fila del grupo
+    std::vector<uint8_t> failed;
+};
+
+/**
+ * Elige las filas del grupo `[first, last)` de un bloque que hay que evaluar y deja sus índices en `selection.rows`:
+ * las que están en el mapa de bits `present` (las que no tienen nulos en las columnas que se usan), no son inválidas
+ * (para éstas se llama a `on_invalid(fila, mensaje)`) y, si hay filtro, en las que su predicado da un valor distinto
+ * de cero, como la condición de `if`. Si el predicado falla en una fila, también se llama a `on_invalid`, y la fila
+ * no se evalúa. El mapa se recorre palabra a palabra, así que las filas nulas no cuestan nada.
+ *
+ * El predicado se calcula primero para todo el grupo con su núcleo por columnas, si lo tiene, de modo que quien
+ * elige las filas solo tiene que mirar un resultado por fila. Devuelve si `selection.columns` queda con el grupo
+ * entero pasado a columnas en precisión doble, para no tener que volver a hacerlo.
+ */
+template<typename OnInvalid>
+bool select_rows(const CsvChunk& chunk, const std::vector<Token>& columns, const std::optional<PreparedFilter>& filter,
+                 const std::vector<uint64_t>& present, size_t first, size_t last, SymbolTable& symbols,
+                 TileSelection& selection, OnInvalid&& on_invalid) {
+    const PreparedExpression* predicate = filter.has_value() ? &filter->predicate : nullptr;
+    bool kernel = predicate != nullptr && predicate->native.has_value() && predicate->native->has_double_kernel();
+    if(kernel) {
+        transpose_tile(chunk, columns.size(), first, last, selection.values, selection.columns);
+        selection.results.resize(last - first);
+        selection.failed.resize(last - first);
+        predicate->native->evaluate_columns(selection.columns.data(), last - first, selection.results.data(), selection.failed.data());
+    }
+    selection.rows.clear();
+    for(size_t w = first / 64; w * 64 < last; w++) {
+        uint64_t bits = present[w];
+        if(w * 64 < first) {
+            bits &= ~uint64_t(0) << (first - w * 64);
+        }
+        if(last - w * 64 < 64) {
+            bits &= (uint64_t(1) << (last - w * 64)) - 1;
+        }
+        for(; bits != 0; bits &= bits - 1) {
+            size_t r = w * 64 + static_cast<size_t>(std::countr_zero(bits));
+            if(!chunk.invalid[r].empty()) {
+                on_invalid(r, "Fila inválida: " + chunk.invalid[r]);
+                continue;
+            }
+            if(predicate != nullptr) {
+                try {
+                    double condition = kernel && !selection.failed[r - first] 
+                        ? selection.results[r - first] : evaluate_row(chunk, r, columns, *predicate, filter->key, symbols);
+                    if(condition == 0.0) {
+                        continue;
+                    }
+                } catch(const EvalError& e) {
+                    on_invalid(r, "Filtro: " + error_message(e));
+                    continue;
+                }
+            }
+            selection.rows.push_back(static_cast<uint32_t>(r - first));
+        }
+    }
+    return kernel;
+}
+
+/**
+ * Evalúa todas las filas de un bloque repartiéndolas en tramos contiguos entre `thread_symbols.size()` hilos.
+ * Para cada fila se llama a `on_value(hilo, fila, valor)` si se evalúa con éxito, o a `on_error(hilo, fila, mensaje)`
+ * si no; para las filas con algún valor nulo que usan la expresión o el filtro, y las que no pasan el filtro, no se
+ * llama a ninguna de las dos.
+ * Cada hilo usa su propia tabla de símbolos, en la que se asignan las columnas de la fila cuando no hay código
+ * nativo o éste falla.
+ *
+ * Con código nativo, cada hilo recorre su tramo en grupos de `TILE_ROWS` filas: pasa cada grupo a columnas (de
+ * `float` en precisión simple, de `double` si no) en una memoria que reutiliza, lo evalúa entero con el núcleo
+ * por columnas y entrega sus resultados antes de pasar al siguiente. Las filas en las que el núcleo falla se
+ * evalúan como en precisión doble sin núcleo, y en precisión simple su resultado se redondea.
+ *
+ * Con filtro, en cada grupo se eligen primero las filas con `select_rows()`. Si quedan pocas, solo ésas se reúnen
+ * en columnas y se pasan al núcleo; si no, el núcleo evalúa el grupo entero (aprovechando las columnas del filtro,
+ * si las hay) y los resultados de las filas descartadas se ignoran.
+ */
+template<typename OnValue, typename OnError>
+void evaluate_chunk(const CsvChunk& chunk, const std::vector<Token>& columns, const PreparedExpression& prepared, uint64_t key,
+                    const std::optional<PreparedFilter>& filter, std::vector<SymbolTable>& thread_symbols,
+                    OnValue&& on_value, OnError&& on_error) {
+    size_t n_threads = std::min(thread_symbols.size(), chunk.rows());
+    size_t rows_per_thread = (chunk.rows() + n_threads - 1) / n_threads;
+    std::vector<uint8_t> used = prepared.used;
+    for(size_t j = 0; filter.has_value() && j < used.size(); j++) {
+        used[j] |= filter->predicate.used[j];
+    }
+    std::vector<uint64_t> present;
+    present_rows(chunk, used, present);
+
+    auto worker = [&](size_t thread_idx) {
+        SymbolTable& symbols = thread_symbols[thread_idx];
+        size_t first = thread_idx * rows_per_thread;
+        size_t last = std::min(first + rows_per_thread, chunk.rows());
+        size_t n_columns = columns.size();
+        bool use_float = prepared.native.has_value() && prepared.native->has_float_kernel();
+        bool use_double = !use_float && prepared.native.has_value() && prepared.native->has_double_kernel();
+        std::vector<float> float_values, float_results;
+        std::vector<const float*> float_columns;
+        std::vector<double> double_values, double_results;
+        std::vector<const double*> double_columns;
+        std::vector<uint8_t> failed;
+        TileSelection selection;
+        auto accept = [&](size_t r, double value) {
+            on_value(thread_idx, r, prepared.float32 ? static_cast<double>(static_cast<float>(value)) : value);
+        };
+        for(size_t tile = first; tile < last; tile += TILE_ROWS) {
+            size_t tile_last = std::min(tile + TILE_ROWS, last), tile_rows = tile_last - tile;
+            bool transposed = select_rows(chunk, columns, filter, present, tile, tile_last, symbols, selection,
+                [&](size_t r, std::string&& message) { on_error(thread_idx, r, std::move(message)); });
+            bool gathered = filter.has_value() && selection.rows.size() < GATHER_SELECTIVITY * tile_rows;
+            size_t kernel_rows = gathered ? selection.rows.size() : tile_rows;
+            failed.resize(kernel_rows);
+            if(use_float) {
+                if(gathered) {
+                    gather_tile(chunk, n_columns, tile, selection.rows, float_values, float_columns);
+                } else {
+                    transpose_tile(chunk, n_columns, tile, tile_last, float_values, float_columns);
+                }
+                float_results.resize(kernel_rows);
+                prepared.native->evaluate_float(float_columns.data(), kernel_rows, float_results.data(), failed.data());
+            } else if(use_double) {
+                const std::vector<const double*>* kernel_columns = &double_columns;
+                if(gathered) {
+                    gather_tile(chunk, n_columns, tile, selection.rows, double_values, double_columns);
+                } else if(transposed) {
+                    kernel_columns = &selection.columns;
+                } else {
+                    transpose_tile(chunk, n_columns, tile, tile_last, double_values, double_columns);
+                }
+                double_results.resize(kernel_rows);
+                prepared.native->evaluate_columns(kernel_columns->data(), kernel_rows, double_results.data(), failed.data());
+            }
+            for(size_t i = 0; i < selection.rows.size(); i++) {
+                size_t r = tile + selection.rows[i], k = gathered ? i : selection.rows[i];
+                if(use_float && !failed[k]) {
+                    on_value(thread_idx, r, float_results[k]);
+                    continue;
+                }
+                if(use_double && !failed[k]) {
+                    accept(r, double_results[k]);
+                    continue;
+                }
+                try {
+                    accept(r, evaluate_row(chunk, r, columns, prepared, key, symbols));
+                } catch(const EvalError& e) {
+                    on_error(thread_idx, r, error_message(e));
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t t = 1; t < n_threads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t batch_thread_count() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Llamada a una función de ventana sacada de una expresión: su parámetro constante y el argumento cuyos valores
+ * recorre, que se evalúa por separado en cada fila y por eso lleva delante las definiciones locales que usa.
+ */
+struct WindowCall {
+    WindowFunction function;
+    double parameter;
+    Expression argument;
+};
+
+// Marca en `used` las posiciones locales a las que se refiere `expr` sin definirlas ella misma.
+void collect_locals(const Expression& expr, std::vector<uint8_t>& used) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND:
+      case ExpressionType::POLYNOMIAL:
+      case ExpressionType::APPROXIMATION: return;
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        collect_locals(lhs, used);
+        collect_locals(rhs, used);
+        return;
+      }
+      case ExpressionType::UNARY_OP: {
+        collect_locals(expr.as_unary_op().get_operand(), used);
+        return;
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        collect_locals(conditional.get_condition(), used);
+        collect_locals(if_true, used);
+        collect_locals(if_false, used);
+        return;
+      }
+      case ExpressionType::CALL: {
+        for(const std::unique_ptr<Expression>& arg : expr.as_call().get_args()) {
+            collect_locals(*arg, used);
+        }
+        return;
+      }
+      case ExpressionType::LET: {
+        // las posiciones de los `let` interiores son mayores que las de fuera, así que no se confunden con ellas
+        collect_locals(expr.as_let().get_value(), used);
+        collect_locals(expr.as_let().get_body(), used);
+        return;
+      }
+      case ExpressionType::LOCAL: {
+        size_t slot = expr.as_local().get_slot();
+        if(slot < used.size()) {
+            used[slot] = 1;
+        }
+        return;
+      }
+    }
+}
+
+/**
+ * Sustituye cada llamada a una función de ventana por el identificador de una columna nueva, `ventana#k`, que no
+ * puede coincidir con una columna de la entrada. Las llamadas dentro del argumento de otra se sacan antes, así que
+ * el argumento de la ventana `k` solo usa columnas de la entrada y de ventanas anteriores.
+ */
+class WindowExtractor {
+  private:
+    const SymbolTable& m_symbols;
+    std::vector<std::pair<Token, Expression>> m_bound; // nombre y valor de cada `let` que contiene el nodo actual, por posición
+    std::vector<WindowCall> m_calls;
+
+    static std::unique_ptr<Expression> boxed(Expression&& expr) {
+        return std::make_unique<Expression>(std::move(expr));
+    }
+
+    // `expr` precedida de los `let` de fuera de la llamada cuyos nombres usa, para poder evaluarla por separado.
+    Expression standalone(Expression&& expr) const {
+        std::vector<uint8_t> used(m_bound.size(), 0);
+        collect_locals(expr, used);
+        for(size_t slot = m_bound.size(); slot-- > 0;) {
+            if(used[slot]) {
+                const auto& [name, value] = m_bound[slot];
+                collect_locals(value, used); // solo usa posiciones menores que la suya
+                expr = Expression::let(Token(name), slot, boxed(value.clone()), boxed(std::move(expr)));
+            }
+        }
+        return expr;
+    }
+
+    Expression extract_window(const CallExpression& call, WindowFunction function) {
+        const std::vector<std::unique_ptr<Expression>>& args = call.get_args();
+        Expression argument = standalone(extract(*args[0]));
+        double parameter;
+        try {
+            parameter = standalone(args[1]->clone()).evaluate(m_symbols);
+        } catch(const EvalError&) {
+            throw std::runtime_error("El segundo argumento de las funciones de ventana debe ser una constante");
+        }
+        try {
+            StreamWindow check(function, parameter);
+        } catch(const std::invalid_argument&) {
+            switch(function) {
+              case WindowFunction::EMA:
+                throw std::runtime_error("El factor de suavizado de ema debe estar en (0, 1]");
+              case WindowFunction::LAG:
+                throw std::runtime_error("El retardo de lag debe ser un entero entre 0 y 2^24");
+              default:
+                throw std::runtime_error("El número de filas de una ventana deslizante debe ser un entero entre 1 y 2^24");
+            }
+        }
+        Token column = Token::identifier("ventana#" + std::to_string(m_calls.size()));
+        m_calls.push_back(WindowCall{function, parameter, std::move(argument)});
+        return Expression::operand(std::move(column));
+    }
+  public:
+    explicit WindowExtractor(const SymbolTable& symbols) : m_symbols(symbols) {}
+
+    Expression extract(const Expression& expr) {
+        switch(expr.type()) {
+          case ExpressionType::OPERAND:
+          case ExpressionType::POLYNOMIAL:
+          case ExpressionType::APPROXIMATION:
+          case ExpressionType::LOCAL: return expr.clone();
+          case ExpressionType::BIN_OP: {
+            const BinOpExpression& bin_op = expr.as_bin_op();
+            auto [lhs, rhs] = bin_op.get_operands();
+            Expression new_lhs = extract(lhs);
+            return Expression::bin_op(Token(bin_op.get_operator()), boxed(std::move(new_lhs)), boxed(extract(rhs)),
+                                      bin_op.is_domain_checked());
+          }
+          case ExpressionType::UNARY_OP: {
+            const UnaryOpExpression& unary = expr.as_unary_op();
+            return Expression::unary_op(Token(unary.get_operator()), boxed(extract(unary.get_operand())), unary.is_domain_checked());
+          }
+          case ExpressionType::CONDITIONAL: {
+            const ConditionalExpression& conditional = expr.as_conditional();
+            auto [if_true, if_false] = conditional.get_branches();
+            Expression condition = extract(conditional.get_condition());
+            Expression new_true = extract(if_true);
+            return Expression::conditional(Token(expr.get_token()), boxed(std::move(condition)), boxed(std::move(new_true)),
+                                           boxed(extract(if_false)));
+          }
+          case ExpressionType::CALL: {
+            const CallExpression& call = expr.as_call();
+            std::optional<WindowFunction> function = window_function(call.get_function().type());
+            if(function.has_value()) {
+                return extract_window(call, *function);
+            }
+            std::vector<std::unique_ptr<Expression>> args;
+            for(const std::unique_ptr<Expression>& arg : call.get_args()) {
+                args.push_back(boxed(extract(*arg)));
+            }
+            return Expression::call(Token(call.get_function()), std::move(args));
+          }
+          case ExpressionType::LET: {
+            const LetExpression& let = expr.as_let();
+            Expression value = extract(let.get_value());
+            m_bound.emplace_back(Token(let.get_name()), value.clone()); // la posición de un `let` es su profundidad
+            Expression body = extract(let.get_body());
+            m_bound.pop_back();
+            return Expression::let(Token(let.get_name()), let.get_slot(), boxed(std::move(value)), boxed(std::move(body)));
+          }
+        }
+        __builtin_unreachable();
+    }
+
+    std::vector<WindowCall>& calls() noexcept {
+        return m_calls;
+    }
+};
+
+/**
+ * Función de ventana lista para calcular su columna: su argumento preparado sobre todas las columnas, aunque solo use
+ * las de la entrada y las de ventanas anteriores, y la clave de sus flujos aleatorios.
+ */
+struct WindowColumn {
+    WindowFunction function;
+    double parameter;
+    PreparedExpression argument;
+    uint64_t key;
+};
+
+/**
+ * Columnas que se evalúan en cada fila: las de la entrada seguidas de una por cada función de ventana.
+ */
+struct WindowColumns {
+    std::vector<Token> columns;
+    std::vector<WindowColumn> windows;
+};
+
+// Prepara las funciones de ventana sacadas con `WindowExtractor` y añade sus columnas, sin acotar, a `ranges`.
+WindowColumns prepare_windows(std::vector<WindowCall>&& calls, const std::vector<Token>& inputs, std::vector<Interval>& ranges,
+                              const SymbolTable& symbols, const BatchOptions& options, std::ostream& err) {
+    WindowColumns result{inputs, {}};
+    for(size_t k = 0; k < calls.size(); k++) {
+        result.columns.push_back(Token::identifier("ventana#" + std::to_string(k)));
+        ranges.push_back(Interval::unbounded());
+    }
+    for(WindowCall& call : calls) {
+        PreparedExpression argument = prepare_expression(call.argument, result.columns, ranges, symbols, options, err);
+        result.windows.push_back(WindowColumn{call.function, call.parameter, std::move(argument), current_random_stream().next_u64()});
+    }
+    return result;
+}
+
+// Estado inicial de las funciones de ventana para un flujo nuevo.
+std::vector<StreamWindow> start_windows(const WindowColumns& windows) {
+    std::vector<StreamWindow> state;
+    for(const WindowColumn& window : windows.windows) {
+        state.emplace_back(window.function, window.parameter);
+    }
+    return state;
+}
+
+/**
+ * Añade a cada fila de un bloque, tras las columnas de la entrada, las de las funciones de ventana. El argumento de
+ * cada una se evalúa en todas las filas, sin filtro, repartiéndolas entre los hilos como en `evaluate_chunk()`, y
+ * sus valores pasan por `state` en el orden de las filas, continuando desde el bloque anterior del mismo flujo. Las
+ * filas en las que el argumento es nulo o da un error cuentan como nulas para la ventana.
+ */
+void append_windows(CsvChunk& chunk, const WindowColumns& windows, std::vector<StreamWindow>& state,
+                    std::vector<SymbolTable>& thread_symbols) {
+    size_t n_windows = windows.windows.size(), rows = chunk.rows();
+    if(n_windows == 0 || rows == 0) {
+        return;
+    }
+    size_t n_columns = windows.columns.size(), n_inputs = n_columns - n_windows, words = chunk.words();
+    std::vector<double> widened(rows * n_columns, std::numeric_limits<double>::quiet_NaN());
+    for(size_t r = 0; r < rows; r++) {
+        std::copy_n(chunk.values.begin() + r * n_inputs, n_inputs, widened.begin() + r * n_columns);
+    }
+    chunk.values = std::move(widened);
+    std::vector<uint64_t> all;
+    fill_bitmap(all, rows);
+    if(chunk.validity.empty()) {
+        for(size_t j = 0; j < n_inputs; j++) {
+            chunk.validity.insert(chunk.validity.end(), all.begin(), all.end());
+        }
+    }
+    for(size_t k = 0; k < n_windows; k++) {
+        chunk.validity.insert(chunk.validity.end(), all.begin(), all.end());
+    }
+
+    std::vector<double> values;
+    std::vector<uint8_t> valid;
+    for(size_t k = 0; k < n_windows; k++) {
+        const WindowColumn& window = windows.windows[k];
+        values.assign(rows, std::numeric_limits<double>::quiet_NaN());
+        valid.assign(rows, 0);
+        evaluate_chunk(chunk, windows.columns, window.argument, window.key, std::nullopt, thread_symbols,
+            [&](size_t, size_t row, double value) { values[row] = value; valid[row] = 1; },
+            [](size_t, size_t, std::string&&) {}
+        );
+        size_t j = n_inputs + k;
+        for(size_t r = 0; r < rows; r++) {
+            std::optional<double> result = state[k].push(values[r], valid[r]);
+            if(result.has_value()) {
+                chunk.values[r * n_columns + j] = *result;
+            } else {
+                chunk.validity[j * words + r / 64] &= ~(uint64_t(1) << (r % 64));
+            }
+        }
+    }
+}
+
+/**
+ * Todo lo necesario para evaluar las filas de una entrada, una vez leída su cabecera. `columns` y `declared` son las
+ * columnas de la entrada y sus rangos; la expresión y el filtro se preparan sobre `windows.columns`.
+ */
+struct BatchSetup {
+    std::vector<Token> columns;
+    std::vector<Interval> declared; // rango de cada columna
+    WindowColumns windows;
+    PreparedExpression prepared;
+    uint64_t key;                   // clave de los flujos aleatorios de las filas
+    std::optional<PreparedFilter> filter;
+};
+
+// Prepara la expresión y el filtro de `options` sobre las columnas de una entrada, con sus funciones de ventana.
+BatchSetup prepare_batch(std::vector<Token>&& columns, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                         const BatchOptions& options) {
+    std::vector<Interval> declared = column_ranges(columns, options.ranges);
+    WindowExtractor extractor(symbols);
+    Expression rewritten = extractor.extract(expr);
+    std::optional<Expression> filter_expr;
+    if(options.filter != nullptr) {
+        filter_expr.emplace(extractor.extract(*options.filter));
+    }
+    std::vector<Interval> ranges = declared;
+    WindowColumns windows = prepare_windows(std::move(extractor.calls()), columns, ranges, symbols, options, err);
+    PreparedExpression prepared = prepare_expression(rewritten, windows.columns, ranges, symbols, options, err);
+    uint64_t key = current_random_stream().next_u64();
+    std::optional<PreparedFilter> filter = prepare_filter(filter_expr.has_value() ? &*filter_expr : nullptr, windows.columns,
+                                                          ranges, symbols, options, err);
+    return BatchSetup{std::move(columns), std::move(declared), std::move(windows), std::move(prepared), key, std::move(filter)};
+}
+
+BatchSetup setup_batch(std::istream& in, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                       const BatchOptions& options) {
+    return prepare_batch(read_header(in), err, expr, symbols, options);
+}
+
+/**
+ * Parte de las filas de una entrada: sus bytes en el fichero, el índice de su primera fila y el número de líneas
+ * anteriores a ella (incluida la cabecera).
+ */
+struct CsvShard {
+    uint64_t begin = 0;
+    uint64_t end = std::numeric_limits<uint64_t>::max();
+    uint64_t first_row = 0;
+    uint64_t lines_before = 1;
+};
+
+// Escribe el resultado de una fila: su valor, `nan` si ha habido un error, o nada si es nulo.
+void write_result(std::ostream& out, double value, bool valid, const std::string& error) {
+    if(valid) {
+        out << value;
+    } else if(!error.empty()) {
+        out << std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+// Evalúa las filas de `shard`, leídas desde la posición actual de `in`, y escribe un resultado por fila.
+void write_shard(std::istream& in, const BatchSetup& setup, const CsvShard& shard, const SymbolTable& symbols,
+                 size_t n_threads, std::ostream& out, std::ostream& err) {
+    std::vector<SymbolTable> thread_symbols(n_threads, symbols);
+    std::vector<double> results;
+    std::vector<uint8_t> valid;
+    std::vector<std::string> errors;
+
+    std::streamsize old_precision = out.precision(setup.prepared.float32 ? std::numeric_limits<float>::max_digits10 
+                                                                          : std::numeric_limits<double>::max_digits10);
+    uint64_t line_number = shard.lines_before;
+    uint64_t bytes_left = shard.end - shard.begin;
+    std::vector<StreamWindow> windows = start_windows(setup.windows);
+    CsvChunk chunk;
+    chunk.first_row = shard.first_row;
+    while(read_chunk(in, setup.columns, setup.declared, line_number, bytes_left, chunk)) {
+        results.assign(chunk.rows(), std::numeric_limits<double>::quiet_NaN());
+        valid.assign(chunk.rows(), 0);
+        errors.assign(chunk.rows(), std::string());
+        append_windows(chunk, setup.windows, windows, thread_symbols);
+        evaluate_chunk(chunk, setup.windows.columns, setup.prepared, setup.key, setup.filter, thread_symbols,
+            [&](size_t, size_t row, double value) { results[row] = value; valid[row] = 1; },
+            [&](size_t, size_t row, std::string&& message) { errors[row] = std::move(message); }
+        );
+        for(size_t r = 0; r < chunk.rows(); r++) {
+            write_result(out, results[r], valid[r], errors[r]);
+            out << "\n";
+            if(!errors[r].empty()) {
+                err << "Línea " << chunk.line_numbers[r] << ": " << errors[r] << "\n";
+            }
+        }
+    }
+    out.precision(old_precision);
+    if(in.bad()) {
+        throw std::runtime_error("Error al leer la entrada");
+    }
+}
+
+// Evalúa las filas de `shard`, leídas desde la posición actual de `in`, y devuelve sus estadísticas.
+BatchAggregate aggregate_shard(std::istream& in, const BatchSetup& setup, const CsvShard& shard, const SymbolTable& symbols,
+                               size_t n_threads) {
+    std::vector<SymbolTable> thread_symbols(n_threads, symbols);
+    std::vector<BatchAggregate> thread_aggregates(n_threads);
+
+    uint64_t line_number = shard.lines_before;
+    uint64_t bytes_left = shard.end - shard.begin;
+    std::vector<StreamWindow> windows = start_windows(setup.windows);
+    CsvChunk chunk;
+    chunk.first_row = shard.first_row;
+    while(read_chunk(in, setup.columns, setup.declared, line_number, bytes_left, chunk)) {
+        append_windows(chunk, setup.windows, windows, thread_symbols);
+        evaluate_chunk(chunk, setup.windows.columns, setup.prepared, setup.key, setup.filter, thread_symbols,
+            [&](size_t thread_idx, size_t, double value) { thread_aggregates[thread_idx].push(value); },
+            [&](size_t thread_idx, size_t, std::string&&) { thread_aggregates[thread_idx].push_error(); }
+        );
+    }
+    if(in.bad()) {
+        throw std::runtime_error("Error al leer la entrada");
+    }
+
+    BatchAggregate total;
+    for(const BatchAggregate& aggregate : thread_aggregates) {
+        total.merge(aggregate);
+    }
+    return total;
+}
+
+/**
+ * Reparte los bytes de `[data_begin, size)` en `n` partes de tamaño parecido, cortando siempre tras un salto de
+ * línea, y cuenta las filas y líneas anteriores a cada parte para que los índices y números de línea sean los
+ * mismos que al leer la entrada de principio a fin. Como en `read_chunk()`, las líneas en blanco solo cuentan como
+ * filas (nulas) si la entrada tiene una sola columna.
+ */
+std::vector<CsvShard> split_shards(std::istream& in, uint64_t data_begin, uint64_t size, size_t n, size_t n_columns) {
+    std::vector<uint64_t> bounds{data_begin};
+    for(size_t k = 1; k < n; k++) {
+        uint64_t target = std::max(bounds.back(), data_begin + (size - data_begin) * k / n);
+        if(target == data_begin || target >= size) {
+            bounds.push_back(std::min(target, size));
+            continue;
+        }
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(target - 1));
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        bounds.push_back(in ? static_cast<uint64_t>(in.tellg()) : size);
+    }
+    bounds.push_back(size);
+
+    std::vector<CsvShard> shards(n);
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(data_begin));
+    uint64_t rows = 0, lines = 1;
+    bool blank = true;
+    char buffer[1 << 16];
+    uint64_t position = data_begin;
+    for(size_t k = 0; k < n; k++) {
+        shards[k] = CsvShard{bounds[k], bounds[k + 1], rows, lines};
+        if(k + 1 == n) {
+            break; // las filas de la última parte no hace falta contarlas
+        }
+        // las partes terminan en un salto de línea, así que cada una empieza con `blank` a `true`
+        while(position < bounds[k + 1]) {
+            size_t wanted = static_cast<size_t>(std::min<uint64_t>(sizeof(buffer), bounds[k + 1] - position));
+            in.read(buffer, static_cast<std::streamsize>(wanted));
+            size_t got = static_cast<size_t>(in.gcount());
+            if(got == 0) {
+                break;
+            }
+            for(size_t i = 0; i < got; i++) {
+                if(buffer[i] == '\n') {
+                    lines++;
+                    rows += blank && n_columns > 1 ? 0 : 1;
+                    blank = true;
+                } else if(!std::isspace(static_cast<unsigned char>(buffer[i]))) {
+                    blank = false;
+                }
+            }
+            position += got;
+        }
+    }
+    return shards;
+}
+
+// Fichero en memoria anónimo donde un proceso hijo deja su salida.
+int shared_output() {
+    int fd = memfd_create("clex-shard", MFD_CLOEXEC);
+    if(fd < 0) {
+        throw std::runtime_error("No se ha podido crear la memoria compartida para los procesos");
+    }
+    return fd;
+}
+
+void copy_output(int fd, std::ostream& os) {
+    char buffer[1 << 16];
+    off_t offset = 0;
+    ssize_t got;
+    while((got = pread(fd, buffer, sizeof(buffer), offset)) > 0) {
+        os.write(buffer, got);
+        offset += got;
+    }
+}
+
+/**
+ * Reparte las filas de un fichero CSV de `n_columns` columnas entre `n_processes` procesos hijos. Cada hijo ejecuta 
+ * `work(in, shard, out, err)` sobre su parte, con `in` leyendo por adelantado desde el principio de la parte, y escribe en `out` y 
+ * `err`, que son memoria compartida con el proceso padre. Al terminar todos los hijos, se llama a
+ * `collect(out, err)` con la salida de cada parte, en orden.
+ */
+template<typename Work, typename Collect>
+void run_shards(const std::string& path, std::istream& in, uint64_t data_begin, size_t n_columns, size_t n_processes,
+                std::ostream& out, std::ostream& err, Work&& work, Collect&& collect) {
+    in.clear();
+    in.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    std::vector<CsvShard> shards = split_shards(in, data_begin, size, n_processes, n_columns);
+
+    std::vector<int> out_fds, err_fds;
+    for(size_t k = 0; k < n_processes; k++) {
+        out_fds.push_back(shared_output());
+        err_fds.push_back(shared_output());
+    }
+    out.flush();
+    err.flush();
+    std::vector<pid_t> children;
+    for(size_t k = 0; k < n_processes; k++) {
+        pid_t pid = fork();
+        if(pid < 0) {
+            err << "No se ha podido crear el proceso " << k << "\n";
+            break;
+        }
+        if(pid == 0) {
+            int status = 0;
+            {
+                std::ofstream shard_out("/proc/self/fd/" + std::to_string(out_fds[k]), std::ios::binary);
+                std::ofstream shard_err("/proc/self/fd/" + std::to_string(err_fds[k]), std::ios::binary);
+                try {
+                    std::unique_ptr<ReadAheadBuffer> buffer = ReadAheadBuffer::open(path, shards[k].begin);
+                    std::istream shard_in(buffer.get());
+                    work(shard_in, shards[k], shard_out, shard_err);
+                } catch(const std::exception& e) {
+                    shard_err << "ERROR: " << e.what() << "\n";
+                    status = 1;
+                }
+                shard_out.flush();
+                shard_err.flush();
+                if(!shard_out || !shard_err) {
+                    status = 1;
+                }
+            }
+            _exit(status);
+        }
+        children.push_back(pid);
+    }
+
+    bool failed = children.size() < n_processes;
+    for(pid_t pid : children) {
+        int status = 0;
+        if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+        }
+    }
+    for(size_t k = 0; k < n_processes; k++) {
+        if(!failed) {
+            collect(out_fds[k], err_fds[k]);
+        } else {
+            copy_output(err_fds[k], err);
+        }
+        close(out_fds[k]);
+        close(err_fds[k]);
+    }
+    if(failed) {
+        throw std::runtime_error("Algún proceso de la evaluación por lotes ha fallado");
+    }
+}
+
+size_t threads_per_process(size_t n_processes) noexcept {
+    return std::max<size_t>(1, batch_thread_count() / n_processes);
+}
+
+/**
+ * Como `BatchSetup`, pero para un flujo Arrow: las variables son las columnas numéricas cuyo nombre es un
+ * identificador, y `fields[j]` es la posición en el esquema de la variable `j`.
+ */
+struct ArrowSetup {
+    BatchSetup batch;
+    std::vector<size_t> fields;
+};
+
+ArrowSetup setup_arrow(const ArrowStreamReader& reader, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                       const BatchOptions& options) {
+    std::vector<Token> columns;
+    std::vector<size_t> fields;
+    const std::vector<ArrowField>& schema = reader.fields();
+    for(size_t i = 0; i < schema.size(); i++) {
+        if(schema[i].type != ArrowType::OTHER && is_identifier(schema[i].name)) {
+            columns.push_back(Token::identifier(schema[i].name));
+            fields.push_back(i);
+        }
+    }
+    return ArrowSetup{prepare_batch(std::move(columns), err, expr, symbols, options), std::move(fields)};
+}
+
+// Pasa un lote Arrow a un bloque de filas. Los valores se leen directamente del cuerpo del lote y solo se copian
+// los de las columnas que son variables, ya dispuestos por filas como los espera el código nativo. Los mapas de
+// validez de Arrow tienen el mismo orden de bits que los de `CsvChunk`, así que se copian de 64 en 64 filas.
+void arrow_chunk(const ArrowRecordBatch& batch, const ArrowSetup& setup, CsvChunk& chunk) {
+    size_t n_columns = setup.fields.size(), rows = static_cast<size_t>(batch.length);
+    chunk.first_row += chunk.rows();
+    chunk.values.resize(rows * n_columns);
+    chunk.line_numbers.resize(rows);
+    chunk.invalid.assign(rows, std::string());
+    chunk.validity.clear();
+    size_t words = chunk.words(), bytes = (rows + 7) / 8;
+    for(size_t j = 0; j < n_columns; j++) {
+        const uint8_t* validity = batch.columns[setup.fields[j]].validity();
+        if(validity == nullptr) {
+            continue;
+        }
+        if(chunk.validity.empty()) {
+            std::vector<uint64_t> all;
+            fill_bitmap(all, rows);
+            for(size_t k = 0; k < n_columns; k++) {
+                chunk.validity.insert(chunk.validity.end(), all.begin(), all.end());
+            }
+        }
+        for(size_t w = 0; w < words; w++) {
+            uint64_t word = 0;
+            std::memcpy(&word, validity + 8 * w, std::min<size_t>(8, bytes - 8 * w));
+            chunk.validity[j * words + w] &= word;
+        }
+    }
+    for(size_t j = 0; j < n_columns; j++) {
+        const ArrowColumn& column = batch.columns[setup.fields[j]];
+        const Interval& range = setup.batch.declared[j];
+        for(size_t r = 0; r < rows; r++) {
+            if(!column.is_valid(r)) {
+                chunk.values[r * n_columns + j] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            double value = column.value(r);
+            chunk.values[r * n_columns + j] = value;
+            if(!range.contains(value) && chunk.invalid[r].empty()) {
+                std::ostringstream problem;
+                problem.precision(std::numeric_limits<double>::max_digits10);
+                problem << "el valor " << value << " de la columna '" << *setup.batch.columns[j].get_ident()
+                        << "' está fuera del rango declarado";
+                chunk.invalid[r] = problem.str();
+            }
+        }
+    }
+    for(size_t r = 0; r < rows; r++) {
+        chunk.line_numbers[r] = chunk.first_row + r + 1; // en Arrow no hay líneas; se indica el número de fila
+    }
+}
+
+
+/**
+ * Como `BatchSetup`, pero para una malla de parámetros: las variables son los ejes, y `total` es el número de puntos.
+ */
+struct SweepSetup {
+    std::vector<Token> columns;
+    std::vector<Interval> declared; // valores mínimo y máximo de cada eje
+    PreparedExpression prepared;
+    uint64_t key;
+    std::optional<PreparedFilter> filter;
+    uint64_t total;
+};
+
+SweepSetup setup_sweep(const std::vector<SweepAxis>& axes, std::ostream& err, const Expression& expr, 
+                       const SymbolTable& symbols, const BatchOptions& options) {
+    if(axes.empty()) {
+        throw std::runtime_error("La malla no tiene ejes");
+    }
+    std::vector<Token> columns;
+    std::vector<Interval> declared;
+    uint64_t total = 1;
+    for(const SweepAxis& axis : axes) {
+        if(!is_identifier(axis.name)) {
+            throw std::runtime_error("Nombre de eje inválido: '" + axis.name + "'");
+        }
+        for(const Token& column : columns) {
+            if(*column.get_ident() == axis.name) {
+                throw std::runtime_error("Eje repetido: '" + axis.name + "'");
+            }
+        }
+        if(axis.points == 0) {
+            throw std::runtime_error("El eje '" + axis.name + "' no tiene puntos");
+        }
+        if(!std::isfinite(axis.lo) || !std::isfinite(axis.hi)) {
+            throw std::runtime_error("El eje '" + axis.name + "' tiene extremos no finitos");
+        }
+        if(total > (uint64_t(1) << 63) / axis.points) {
+            throw std::runtime_error("La malla tiene demasiados puntos");
+        }
+        total *= axis.points;
+        columns.push_back(Token::identifier(axis.name));
+        declared.push_back(Interval{std::min(axis.lo, axis.hi), std::max(axis.lo, axis.hi), false});
+    }
+    WindowExtractor extractor(symbols);
+    extractor.extract(expr);
+    if(options.filter != nullptr) {
+        extractor.extract(*options.filter);
+    }
+    if(!extractor.calls().empty()) {
+        throw std::runtime_error("Las funciones de ventana solo se pueden usar sobre las filas de un CSV o de un flujo Arrow");
+    }
+    PreparedExpression prepared = prepare_expression(expr, columns, declared, symbols, options, err);
+    uint64_t key = current_random_stream().next_u64();
+    std::optional<PreparedFilter> filter = prepare_filter(options.filter, columns, declared, symbols, options, err);
+    return SweepSetup{std::move(columns), std::move(declared), std::move(prepared), key, std::move(filter), total};
+}
+
+// Sustituye `current` por `point` si éste tiene menor valor (mayor, con `maximize`) o el mismo y va antes en la malla.
+void keep_extreme(std::optional<SweepPoint>& current, const SweepPoint& point, bool maximize) noexcept {
+    bool replace = !current.has_value() || (maximize ? point.value > current->value : point.value < current->value)
+                   || (point.value == current->value && point.index < current->index);
+    if(replace) {
+        current = point;
+    }
+}
+
+// Posición en cada eje del punto número `index` de la malla.
+std::vector<uint64_t> sweep_digits(const std::vector<SweepAxis>& axes, uint64_t index) {
+    std::vector<uint64_t> digits(axes.size());
+    for(size_t j = axes.size(); j-- > 0;) {
+        digits[j] = index % axes[j].points;
+        index /= axes[j].points;
+    }
+    return digits;
+}
+
+// Llena `chunk` con los siguientes `CHUNK_ROWS` puntos de la malla como máximo; devuelve `false` si ya no quedan.
+bool sweep_chunk(const std::vector<SweepAxis>& axes, uint64_t total, CsvChunk& chunk) {
+    chunk.first_row += chunk.rows();
+    size_t rows = static_cast<size_t>(std::min<uint64_t>(CHUNK_ROWS, total - chunk.first_row));
+    size_t n_axes = axes.size();
+    chunk.values.resize(rows * n_axes);
+    chunk.line_numbers.resize(rows);
+    chunk.invalid.assign(rows, std::string());
+    std::vector<uint64_t> digits = sweep_digits(axes, chunk.first_row);
+    for(size_t r = 0; r < rows; r++) {
+        chunk.line_numbers[r] = chunk.first_row + r + 1;
+        for(size_t j = 0; j < n_axes; j++) {
+            chunk.values[r * n_axes + j] = axes[j].value(digits[j]);
+        }
+        for(size_t j = n_axes; j-- > 0;) { // siguiente punto, con el último eje variando más rápido
+            if(++digits[j] < axes[j].points) {
+                break;
+            }
+            digits[j] = 0;
+        }
+    }
+    return rows > 0;
+}
+
+/**
+ * Varias expresiones listas para evaluar las filas de una entrada en una sola pasada: cada una optimizada por su
+ * lado como en `prepare_expression()` y, si se ha pedido y se puede, todas compiladas juntas con `NativeProgram`.
+ * Cada expresión tiene su propia clave para los flujos aleatorios de las filas.
+ */
+struct FusedSetup {
+    std::vector<Token> columns;
+    std::vector<Interval> declared;
+    WindowColumns windows;
+    std::vector<PreparedExpression> prepared;
+    std::optional<NativeProgram> program;
+    std::vector<uint64_t> keys;
+    std::optional<PreparedFilter> filter;
+    bool float32;
+};
+
+FusedSetup setup_fused(std::istream& in, std::ostream& err, const std::vector<Expression>& exprs, const SymbolTable& symbols,
+                       const BatchOptions& options) {
+    std::vector<Token> columns = read_header(in);
+    std::vector<Interval> declared = column_ranges(columns, options.ranges);
+    WindowExtractor extractor(symbols);
+    std::vector<Expression> rewritten;
+    for(const Expression& expr : exprs) {
+        rewritten.push_back(extractor.extract(expr));
+    }
+    std::optional<Expression> filter_expr;
+    if(options.filter != nullptr) {
+        filter_expr.emplace(extractor.extract(*options.filter));
+    }
+    std::vector<Interval> ranges = declared;
+    WindowColumns windows = prepare_windows(std::move(extractor.calls()), columns, ranges, symbols, options, err);
+    BatchOptions separate = options;
+    separate.native_dir.clear(); // las expresiones se compilan todas juntas, no cada una por su lado
+    std::vector<PreparedExpression> prepared;
+    std::vector<Expression> optimized;
+    std::vector<uint64_t> keys;
+    for(const Expression& expr : rewritten) {
+        prepared.push_back(prepare_expression(expr, windows.columns, ranges, symbols, separate, err));
+        optimized.push_back(prepared.back().expr.clone());
+        keys.push_back(current_random_stream().next_u64());
+    }
+    std::optional<NativeProgram> program;
+    if(!options.native_dir.empty()) {
+        try {
+            program.emplace(NativeProgram::build(optimized, windows.columns, symbols, options.native_dir, options.float32));
+        } catch(const std::runtime_error& e) {
+            err << "Aviso: " << e.what() << "; se usa el intérprete\n";
+        }
+    }
+    std::optional<PreparedFilter> filter = prepare_filter(filter_expr.has_value() ? &*filter_expr : nullptr, windows.columns,
+                                                          ranges, symbols, options, err);
+    return FusedSetup{std::move(columns), std::move(declared), std::move(windows), std::move(prepared), std::move(program),
+                      std::move(keys), std::move(filter), options.float32};
+}
+
+/**
+ * Como `evaluate_chunk()`, pero con todas las expresiones de `setup`: se llama a `on_value(hilo, fila, expresión, valor)`
+ * o a `on_error(hilo, fila, expresión, mensaje)` para cada expresión de cada fila.
+ *
+ * Con código nativo, cada grupo de `TILE_ROWS` filas se pasa a columnas una sola vez y el núcleo de `NativeProgram`
+ * calcula con él todas las expresiones. Las expresiones que fallan en una fila se evalúan en ella con el intérprete,
+ * con las columnas asignadas en la tabla de símbolos del hilo una sola vez para todas. Con filtro, las filas se eligen
+ * y se pasan al núcleo igual que en `evaluate_chunk()`, y los errores del filtro se indican en todas las expresiones.
+ * Los nulos se tratan por separado en cada expresión: una fila solo es nula en las que usan una columna nula en ella.
+ */
+template<typename OnValue, typename OnError>
+void evaluate_fused_chunk(const CsvChunk& chunk, const FusedSetup& setup, std::vector<SymbolTable>& thread_symbols,
+                          OnValue&& on_value, OnError&& on_error) {
+    size_t n_threads = std::min(thread_symbols.size(), chunk.rows());
+    size_t rows_per_thread = (chunk.rows() + n_threads - 1) / n_threads;
+    size_t n_outputs = setup.prepared.size(), n_columns = setup.windows.columns.size();
+    bool use_float = setup.program.has_value() && setup.program->has_float_kernel();
+    bool use_double = setup.program.has_value() && !use_float;
+    // las filas se eligen con los nulos del filtro, y cada expresión descarta después las suyas
+    std::vector<uint64_t> selectable;
+    present_rows(chunk, setup.filter.has_value() ? setup.filter->predicate.used : std::vector<uint8_t>(), selectable);
+    std::vector<std::vector<uint64_t>> present(n_outputs);
+    for(size_t k = 0; k < n_outputs; k++) {
+        present_rows(chunk, setup.prepared[k].used, present[k]);
+    }
+
+    auto worker = [&](size_t thread_idx) {
+        SymbolTable& symbols = thread_symbols[thread_idx];
+        size_t first = thread_idx * rows_per_thread;
+        size_t last = std::min(first + rows_per_thread, chunk.rows());
+        std::vector<float> float_values, float_results;
+        std::vector<const float*> float_columns;
+        std::vector<double> double_values, double_results;
+        std::vector<const double*> double_columns;
+        std::vector<uint8_t> failed;
+        TileSelection selection;
+        for(size_t tile = first; tile < last; tile += TILE_ROWS) {
+            size_t tile_last = std::min(tile + TILE_ROWS, last), tile_rows = tile_last - tile;
+            bool transposed = select_rows(chunk, setup.windows.columns, setup.filter, selectable, tile, tile_last, symbols, selection,
+                [&](size_t r, const std::string& message) {
+                    for(size_t k = 0; k < n_outputs; k++) {
+                        on_error(thread_idx, r, k, std::string(message));
+                    }
+                });
+            bool gathered = setup.filter.has_value() && selection.rows.size() < GATHER_SELECTIVITY * tile_rows;
+            size_t kernel_rows = gathered ? selection.rows.size() : tile_rows;
+            failed.resize(n_outputs * kernel_rows);
+            if(use_float) {
+                if(gathered) {
+                    gather_tile(chunk, n_columns, tile, selection.rows, float_values, float_columns);
+                } else {
+                    transpose_tile(chunk, n_columns, tile, tile_last, float_values, float_columns);
+                }
+                float_results.resize(n_outputs * kernel_rows);
+                setup.program->evaluate_float(float_columns.data(), kernel_rows, float_results.data(), failed.data());
+            } else if(use_double) {
+                const std::vector<const double*>* kernel_columns = &double_columns;
+                if(gathered) {
+                    gather_tile(chunk, n_columns, tile, selection.rows, double_values, double_columns);
+                } else if(transposed) {
+                    kernel_columns = &selection.columns;
+                } else {
+                    transpose_tile(chunk, n_columns, tile, tile_last, double_values, double_columns);
+                }
+                double_results.resize(n_outputs * kernel_rows);
+                setup.program->evaluate_columns(kernel_columns->data(), kernel_rows, double_results.data(), failed.data());
+            }
+            for(size_t i = 0; i < selection.rows.size(); i++) {
+                size_t r = tile + selection.rows[i];
+                bool assigned = false;
+                size_t offset = (gathered ? i : selection.rows[i]) * n_outputs;
+                for(size_t k = 0; k < n_outputs; k++) {
+                    if(!is_present(present[k], r)) {
+                        continue;
+                    }
+                    if(use_float && !failed[offset + k]) {
+                        on_value(thread_idx, r, k, float_results[offset + k]);
+                        continue;
+                    }
+                    if(use_double && !failed[offset + k]) {
+                        on_value(thread_idx, r, k, double_results[offset + k]);
+                        continue;
+                    }
+                    if(!assigned) {
+                        for(size_t j = 0; j < n_columns; j++) {
+                            symbols.set(setup.windows.columns[j], chunk.values[r * n_columns + j]);
+                        }
+                        assigned = true;
+                    }
+                    ScopedRandomStream stream(RandomStream(setup.keys[k], chunk.row_index(r)));
+                    try {
+                        double value = setup.prepared[k].expr.evaluate(symbols);
+                        on_value(thread_idx, r, k, setup.float32 ? static_cast<double>(static_cast<float>(value)) : value);
+                    } catch(const EvalError& e) {
+                        on_error(thread_idx, r, k, error_message(e));
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t t = 1; t < n_threads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+// Caracteres de cada resultado en los ficheros de `update_csv_file()`: los de "-1.2345678901234567e-308", el más largo
+// que se escribe en precisión doble. Así, el resultado de la fila `i` empieza siempre en `i * (RESULT_WIDTH + 1)`.
+constexpr size_t RESULT_WIDTH = 24;
+constexpr char DELTA_MAGIC[8] = {'C', 'L', 'E', 'X', 'D', 'L', 'T', '1'};
+constexpr uint64_t DELTA_HEADER = 24; // marca, huella y número de filas del fichero de resúmenes
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+// FNV-1a de 64 bits de `size` bytes, continuando desde `hash`.
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size) noexcept {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Huella de todo lo que, además de cada fila, determina su resultado: columnas, rangos, expresión, filtro y opciones.
+// Con el código nativo los resultados en precisión simple pueden diferir en el último bit, así que también cuenta.
+uint64_t delta_fingerprint(const BatchSetup& setup, const Expression& expr, const BatchOptions& options) {
+    std::ostringstream description;
+    description << std::hexfloat;
+    for(size_t j = 0; j < setup.columns.size(); j++) {
+        const Interval& range = setup.declared[j];
+        description << *setup.columns[j].get_ident() << ' ' << range.lo << ' ' << range.hi << ' ' << range.maybe_nan << '\n';
+    }
+    description << expr << '\n';
+    if(options.filter != nullptr) {
+        description << *options.filter << '\n';
+    }
+    description << options.float32 << ' ' << options.approximation_tolerance << ' ' << options.native_dir.empty();
+    std::string text = description.str();
+    return fnv1a(FNV_OFFSET, text.data(), text.size());
+}
+
+// Resumen del contenido de cada fila de un bloque: sus valores, con los nulos como tales, y el motivo por el que es
+// inválida, si lo es. Dos filas con los mismos valores escritos de forma distinta (como `1` y `1.0`) son iguales.
+void row_hashes(const CsvChunk& chunk, size_t n_columns, std::vector<uint64_t>& hashes) {
+    size_t words = chunk.words();
+    hashes.resize(chunk.rows());
+    for(size_t r = 0; r < chunk.rows(); r++) {
+        uint64_t hash = FNV_OFFSET;
+        for(size_t j = 0; j < n_columns; j++) {
+            uint8_t present = chunk.validity.empty() || ((chunk.validity[j * words + r / 64] >> (r % 64)) & 1);
+            double value = present ? chunk.values[r * n_columns + j] : 0.0;
+            hash = fnv1a(hash, &present, sizeof(present));
+            hash = fnv1a(hash, &value, sizeof(value));
+        }
+        hashes[r] = fnv1a(hash, chunk.invalid[r].data(), chunk.invalid[r].size());
+    }
+}
+
+// Copia en `out` las filas `rows` de `chunk`, en orden creciente, con su índice en toda la entrada.
+void gather_rows(const CsvChunk& chunk, size_t n_columns, const std::vector<size_t>& rows, CsvChunk& out) {
+    out.first_row = chunk.first_row;
+    out.values.clear();
+    out.line_numbers.clear();
+    out.invalid.clear();
+    out.validity.clear();
+    out.indices.clear();
+    for(size_t r : rows) {
+        out.values.insert(out.values.end(), chunk.values.begin() + r * n_columns, chunk.values.begin() + (r + 1) * n_columns);
+        out.line_numbers.push_back(chunk.line_numbers[r]);
+        out.invalid.push_back(chunk.invalid[r]);
+        out.indices.push_back(chunk.row_index(r));
+    }
+    if(!chunk.validity.empty()) {
+        size_t words = chunk.words(), out_words = out.words();
+        out.validity.assign(n_columns * out_words, 0);
+        for(size_t j = 0; j < n_columns; j++) {
+            for(size_t i = 0; i < rows.size(); i++) {
+                uint64_t bit = (chunk.validity[j * words + rows[i] / 64] >> (rows[i] % 64)) & 1;
+                out.validity[j * out_words + i / 64] |= bit << (i % 64);
+            }
+        }
+    }
+}
+
+/**
+ * Ficheros de resultados y de resúmenes de `update_csv_file()`, que se cierran al destruirse.
+ */
+struct DeltaFiles {
+    int results = -1;
+    int hashes = -1;
+
+    DeltaFiles() = default;
+    DeltaFiles(const DeltaFiles&) = delete;
+    DeltaFiles& operator=(const DeltaFiles&) = delete;
+
+    ~DeltaFiles() {
+        if(results >= 0) {
+            close(results);
+        }
+        if(hashes >= 0) {
+            close(hashes);
+        }
+    }
+};
+
+int open_delta_file(const std::string& path) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        throw std::runtime_error("No se ha podido abrir " + path);
+    }
+    return fd;
+}
+
+// Lee `size` bytes desde `offset`; devuelve `false` si el fichero se termina antes.
+bool read_at(int fd, uint64_t offset, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while(size > 0) {
+        ssize_t n = pread(fd, bytes, size, static_cast<off_t>(offset));
+        if(n <= 0) {
+            return false;
+        }
+        bytes += n;
+        offset += static_cast<uint64_t>(n);
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void write_at(int fd, uint64_t offset, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while(size > 0) {
+        ssize_t n = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if(n <= 0) {
+            throw std::runtime_error("Error al escribir los resultados");
+        }
+        bytes += n;
+        offset += static_cast<uint64_t>(n);
+        size -= static_cast<size_t>(n);
+    }
+}
+
+uint64_t file_size(int fd) {
+    off_t size = lseek(fd, 0, SEEK_END);
+    if(size < 0) {
+        throw std::runtime_error("Error al leer los resultados anteriores");
+    }
+    return static_cast<uint64_t>(size);
+}
+
+void write_delta_header(int fd, const char* magic, uint64_t fingerprint, uint64_t rows) {
+    char header[DELTA_HEADER];
+    std::memcpy(header, magic, 8);
+    std::memcpy(header + 8, &fingerprint, 8);
+    std::memcpy(header + 16, &rows, 8);
+    write_at(fd, 0, header, sizeof(header));
+}
+
+// Filas de la actualización anterior que siguen valiendo: todas si los dos ficheros están completos y se
+// calcularon con la misma huella, y ninguna si no.
+uint64_t previous_rows(const DeltaFiles& files, uint64_t fingerprint) {
+    char header[DELTA_HEADER];
+    if(!read_at(files.hashes, 0, header, sizeof(header)) || std::memcmp(header, DELTA_MAGIC, 8) != 0) {
+        return 0;
+    }
+    uint64_t previous, rows;
+    std::memcpy(&previous, header + 8, 8);
+    std::memcpy(&rows, header + 16, 8);
+    bool complete = rows <= (std::numeric_limits<uint64_t>::max() - DELTA_HEADER) / (RESULT_WIDTH + 1)
+                    && file_size(files.hashes) == DELTA_HEADER + 8 * rows
+                    && file_size(files.results) == rows * (RESULT_WIDTH + 1);
+    return previous == fingerprint && complete ? rows : 0;
+}
+
+}
+
+BatchAggregate::BatchAggregate() noexcept : m_stats(), m_digest(), m_errors(0), m_nans(0) {};
+
+void BatchAggregate::push(double value) noexcept {
+    if(std::isnan(value)) {
+        m_nans++;
+        return;
+    }
+    m_stats.push(value);
+    m_digest.push(value);
+}
+
+void BatchAggregate::push_error() noexcept {
+    m_errors++;
+}
+
+void BatchAggregate::merge(const BatchAggregate& other) noexcept {
+    m_stats.merge(other.m_stats);
+    m_digest.merge(other.m_digest);
+    m_errors += other.m_errors;
+    m_nans += other.m_nans;
+}
+
+const RunningStats& BatchAggregate::stats() const noexcept {
+    return m_stats;
+}
+
+double BatchAggregate::quantile(double q) const noexcept {
+    return m_digest.quantile(q);
+}
+
+uint64_t BatchAggregate::errors() const noexcept {
+    return m_errors;
+}
+
+uint64_t BatchAggregate::nans() const noexcept {
+    return m_nans;
+}
+
+void BatchAggregate::print_to(std::ostream& os) const {
+    std::streamsize old_precision = os.precision(std::numeric_limits<double>::max_digits10);
+    os << "count," << m_stats.count() << "\n";
+    os << "errors," << m_errors << "\n";
+    os << "nan," << m_nans << "\n";
+    if(m_stats.count() > 0) {
+        os << "mean," << m_stats.mean() << "\n";
+        os << "variance," << m_stats.variance() << "\n";
+        os << "stddev," << std::sqrt(m_stats.variance()) << "\n";
+        os << "min," << m_stats.min() << "\n";
+        os << "max," << m_stats.max() << "\n";
+        for(double q : PRINTED_QUANTILES) {
+            os << "p" << q * 100.0 << "," << m_digest.quantile(q) << "\n";
+        }
+    }
+    os.precision(old_precision);
+}
+
+void BatchAggregate::write_to(std::ostream& os) const {
+    os << "aggregate " << m_errors << " " << m_nans << "\n";
+    m_stats.write_to(os);
+    m_digest.write_to(os);
+}
+
+BatchAggregate BatchAggregate::read_from(std::istream& is) {
+    BatchAggregate aggregate;
+    std::string tag;
+    if(is >> tag && tag == "aggregate" && is >> aggregate.m_errors >> aggregate.m_nans) {
+        aggregate.m_stats = RunningStats::read_from(is);
+        aggregate.m_digest = TDigest::read_from(is);
+    } else {
+        is.setstate(std::ios::failbit);
+    }
+    return aggregate;
+}
+
+double SweepAxis::value(uint64_t i) const noexcept {
+    if(points == 1) {
+        return lo;
+    }
+    if(i + 1 == points) {
+        return hi;
+    }
+    // el redondeo no puede sacar el valor de [lo, hi], que es el rango declarado para la variable
+    double value = lo + (hi - lo) * (static_cast<double>(i) / static_cast<double>(points - 1));
+    return std::clamp(value, std::min(lo, hi), std::max(lo, hi));
+}
+
+SweepSummary::SweepSummary(size_t top_k, bool maximize) 
+    : m_aggregate(), m_best(), m_top_k(top_k), m_maximize(maximize), m_argmin(), m_argmax() {};
+
+bool SweepSummary::better(const SweepPoint& a, const SweepPoint& b) const noexcept {
+    if(a.value != b.value) {
+        return m_maximize ? a.value > b.value : a.value < b.value;
+    }
+    return a.index < b.index;
+}
+
+// Añade un punto a los mejores puntos si está entre ellos.
+void SweepSummary::offer(const SweepPoint& point) {
+    // montículo de los mejores puntos con el peor en cabeza, para descartarlo en O(log k)
+    auto worse_first = [this](const SweepPoint& a, const SweepPoint& b) { return better(a, b); };
+    if(m_best.size() < m_top_k) {
+        m_best.push_back(point);
+        std::push_heap(m_best.begin(), m_best.end(), worse_first);
+    } else if(m_top_k > 0 && better(point, m_best.front())) {
+        std::pop_heap(m_best.begin(), m_best.end(), worse_first);
+        m_best.back() = point;
+        std::push_heap(m_best.begin(), m_best.end(), worse_first);
+    }
+}
+
+void SweepSummary::push(uint64_t index, double value) {
+    m_aggregate.push(value);
+    if(!std::isnan(value)) {
+        SweepPoint point{index, value};
+        keep_extreme(m_argmin, point, false);
+        keep_extreme(m_argmax, point, true);
+        offer(point);
+    }
+}
+
+void SweepSummary::push_error() noexcept {
+    m_aggregate.push_error();
+}
+
+void SweepSummary::merge(const SweepSummary& other) {
+    m_aggregate.merge(other.m_aggregate);
+    if(other.m_argmin.has_value()) {
+        keep_extreme(m_argmin, *other.m_argmin, false);
+        keep_extreme(m_argmax, *other.m_argmax, true);
+    }
+    for(const SweepPoint& point : other.m_best) {
+        offer(point);
+    }
+}
+
+const BatchAggregate& SweepSummary::aggregate() const noexcept {
+    return m_aggregate;
+}
+
+std::optional<SweepPoint> SweepSummary::argmin() const noexcept {
+    return m_argmin;
+}
+
+std::optional<SweepPoint> SweepSummary::argmax() const noexcept {
+    return m_argmax;
+}
+
+std::vector<SweepPoint> SweepSummary::best() const {
+    std::vector<SweepPoint> best = m_best;
+    std::sort(best.begin(), best.end(), [this](const SweepPoint& a, const SweepPoint& b) { return better(a, b); });
+    return best;
+}
+
+void SweepSummary::print_to(std::ostream& os, const std::vector<SweepAxis>& axes) const {
+    m_aggregate.print_to(os);
+    std::streamsize old_precision = os.precision(std::numeric_limits<double>::max_digits10);
+    auto print_point = [&](const SweepPoint& point) {
+        std::vector<uint64_t> digits = sweep_digits(axes, point.index);
+        for(size_t j = 0; j < axes.size(); j++) {
+            os << "," << axes[j].name << "=" << axes[j].value(digits[j]);
+        }
+        os << "\n";
+    };
+    if(m_argmin.has_value()) {
+        os << "argmin";
+        print_point(*m_argmin);
+        os << "argmax";
+        print_point(*m_argmax);
+    }
+    std::vector<SweepPoint> points = best();
+    for(size_t i = 0; i < points.size(); i++) {
+        os << "top" << i + 1 << "," << points[i].value;
+        print_point(points[i]);
+    }
+    os.precision(old_precision);
+}
+
+void evaluate_csv(std::istream& in, std::ostream& out, std::ostream& err, const Expression& expr, 
+                  const SymbolTable& symbols, const BatchOptions& options) {
+    BatchSetup setup = setup_batch(in, err, expr, symbols, options);
+    write_shard(in, setup, CsvShard{}, symbols, batch_thread_count(), out, err);
+}
+
+BatchAggregate aggregate_csv(std::istream& in, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                             const BatchOptions& options) {
+    BatchSetup setup = setup_batch(in, err, expr, symbols, options);
+    return aggregate_shard(in, setup, CsvShard{}, symbols, batch_thread_count());
+}
+
+void evaluate_csv_file(const std::string& path, std::ostream& out, std::ostream& err, const Expression& expr,
+                       const SymbolTable& symbols, const BatchOptions& options) {
+    if(options.processes <= 1) {
+        std::unique_ptr<ReadAheadBuffer> buffer = ReadAheadBuffer::open(path);
+        std::istream buffered(buffer.get());
+        evaluate_csv(buffered, out, err, expr, symbols, options);
+        return;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw std::runtime_error("No se ha podido abrir " + path);
+    }
+    BatchSetup setup = setup_batch(in, err, expr, symbols, options);
+    if(!setup.windows.windows.empty()) { // las ventanas recorren las filas en orden, así que no se pueden repartir
+        write_shard(in, setup, CsvShard{}, symbols, batch_thread_count(), out, err);
+        return;
+    }
+    size_t n_threads = threads_per_process(options.processes);
+    run_shards(path, in, static_cast<uint64_t>(in.tellg()), setup.columns.size(), options.processes, out, err,
+        [&](std::istream& shard_in, const CsvShard& shard, std::ostream& shard_out, std::ostream& shard_err) {
+            write_shard(shard_in, setup, shard, symbols, n_threads, shard_out, shard_err);
+        },
+        [&](int out_fd, int err_fd) {
+            copy_output(out_fd, out);
+            copy_output(err_fd, err);
+        }
+    );
+}
+
+BatchAggregate aggregate_csv_file(const std::string& path, std::ostream& err, const Expression& expr,
+                                  const SymbolTable& symbols, const BatchOptions& options) {
+    if(options.processes <= 1) {
+        std::unique_ptr<ReadAheadBuffer> buffer = ReadAheadBuffer::open(path);
+        std::istream buffered(buffer.get());
+        return aggregate_csv(buffered, err, expr, symbols, options);
+    }
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw std::runtime_error("No se ha podido abrir " + path);
+    }
+    BatchSetup setup = setup_batch(in, err, expr, symbols, options);
+    if(!setup.windows.windows.empty()) {
+        return aggregate_shard(in, setup, CsvShard{}, symbols, batch_thread_count());
+    }
+    size_t n_threads = threads_per_process(options.processes);
+    BatchAggregate total;
+    std::ostringstream ignored;
+    run_shards(path, in, static_cast<uint64_t>(in.tellg()), setup.columns.size(), options.processes, ignored, err,
+        [&](std::istream& shard_in, const CsvShard& shard, std::ostream& shard_out, std::ostream&) {
+            aggregate_shard(shard_in, setup, shard, symbols, n_threads).write_to(shard_out);
+        },
+        [&](int out_fd, int) {
+            std::stringstream serialized;
+            copy_output(out_fd, serialized);
+            BatchAggregate aggregate = BatchAggregate::read_from(serialized);
+            if(!serialized) {
+                throw std::runtime_error("El resultado de un proceso de la evaluación por lotes no es válido");
+            }
+            total.merge(aggregate);
+        }
+    );
+    return total;
+}
+
+DeltaUpdate update_csv_file(const std::string& input_path, const std::string& result_path, const std::string& hash_path,
+                            std::ostream& err, const Expression& expr, const SymbolTable& symbols, const BatchOptions& options) {
+    std::unique_ptr<ReadAheadBuffer> buffer = ReadAheadBuffer::open(input_path);
+    std::istream in(buffer.get());
+    BatchSetup setup = setup_batch(in, err, expr, symbols, options);
+    if(!setup.windows.windows.empty()) {
+        throw std::runtime_error("Las funciones de ventana dependen de las filas anteriores, así que no se pueden usar "
+                                 "al volver a evaluar solo las filas cambiadas");
+    }
+    uint64_t fingerprint = delta_fingerprint(setup, expr, options);
+    DeltaFiles files;
+    files.results = open_delta_file(result_path);
+    files.hashes = open_delta_file(hash_path);
+    uint64_t old_rows = previous_rows(files, fingerprint);
+    // sin la marca, los ficheros no valen para la siguiente actualización hasta que ésta termine: si se interrumpe,
+    // la siguiente vuelve a evaluar todas las filas
+    const char unfinished[8] = {};
+    write_delta_header(files.hashes, unfinished, fingerprint, old_rows);
+
+    size_t n_columns = setup.columns.size();
+    std::vector<SymbolTable> thread_symbols(batch_thread_count(), symbols);
+    std::vector<uint64_t> hashes, old_hashes;
+    std::vector<size_t> changed;
+    std::vector<double> results;
+    std::vector<uint8_t> valid;
+    std::vector<std::string> errors;
+    std::string records;
+    std::vector<uint64_t> run_hashes;
+    std::ostringstream record;
+    record.precision(options.float32 ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::max_digits10);
+    DeltaUpdate update{0, 0};
+
+    uint64_t line_number = 1;
+    uint64_t bytes_left = std::numeric_limits<uint64_t>::max();
+    CsvChunk chunk, gathered;
+    while(read_chunk(in, setup.columns, setup.declared, line_number, bytes_left, chunk)) {
+        row_hashes(chunk, n_columns, hashes);
+        size_t known = chunk.first_row < old_rows ? static_cast<size_t>(std::min<uint64_t>(chunk.rows(), old_rows - chunk.first_row)) : 0;
+        old_hashes.resize(known);
+        if(!read_at(files.hashes, DELTA_HEADER + 8 * chunk.first_row, old_hashes.data(), 8 * known)) {
+            throw std::runtime_error("Error al leer los resultados anteriores");
+        }
+        changed.clear();
+        for(size_t r = 0; r < chunk.rows(); r++) {
+            if(r >= known || hashes[r] != old_hashes[r]) {
+                changed.push_back(r);
+            }
+        }
+        if(changed.empty()) {
+            continue;
+        }
+        const CsvChunk* evaluated = &chunk;
+        if(changed.size() < chunk.rows()) {
+            gather_rows(chunk, n_columns, changed, gathered);
+            evaluated = &gathered;
+        }
+        results.assign(changed.size(), std::numeric_limits<double>::quiet_NaN());
+        valid.assign(changed.size(), 0);
+        errors.assign(changed.size(), std::string());
+        evaluate_chunk(*evaluated, setup.windows.columns, setup.prepared, setup.key, setup.filter, thread_symbols,
+            [&](size_t, size_t row, double value) { results[row] = value; valid[row] = 1; },
+            [&](size_t, size_t row, std::string&& message) { errors[row] = std::move(message); }
+        );
+        // las filas cambiadas seguidas se escriben de una vez, tanto sus resultados como sus resúmenes
+        for(size_t i = 0; i < changed.size(); i++) {
+            record.str("");
+            write_result(record, results[i], valid[i], errors[i]);
+            std::string text = record.str();
+            text.resize(RESULT_WIDTH, ' ');
+            records += text;
+            records += '\n';
+            run_hashes.push_back(hashes[changed[i]]);
+            if(i + 1 == changed.size() || changed[i + 1] != changed[i] + 1) {
+                uint64_t first = chunk.first_row + changed[i] + 1 - run_hashes.size();
+                write_at(files.results, first * (RESULT_WIDTH + 1), records.data(), records.size());
+                write_at(files.hashes, DELTA_HEADER + 8 * first, run_hashes.data(), 8 * run_hashes.size());
+                records.clear();
+                run_hashes.clear();
+            }
+            if(!errors[i].empty()) {
+                err << "Línea " << chunk.line_numbers[changed[i]] << ": " << errors[i] << "\n";
+            }
+        }
+        update.evaluated += changed.size();
+    }
+    if(in.bad()) {
+        throw std::runtime_error("Error al leer la entrada");
+    }
+    update.rows = chunk.first_row;
+    if(ftruncate(files.results, static_cast<off_t>(update.rows * (RESULT_WIDTH + 1))) != 0
+       || ftruncate(files.hashes, static_cast<off_t>(DELTA_HEADER + 8 * update.rows)) != 0) {
+        throw std::runtime_error("Error al escribir los resultados");
+    }
+    write_delta_header(files.hashes, DELTA_MAGIC, fingerprint, update.rows);
+    return update;
+}
+
+void evaluate_csv_fused(std::istream& in, std::ostream& out, std::ostream& err, const std::vector<std::string>& names,
+                        const std::vector<Expression>& exprs, const SymbolTable& symbols, const BatchOptions& options) {
+    if(exprs.empty() || names.size() != exprs.size()) {
+        throw std::runtime_error("Hace falta un nombre por expresión, y al menos una expresión");
+    }
+    for(size_t k = 0; k < names.size(); k++) {
+        if(!is_identifier(names[k])) {
+            throw std::runtime_error("Nombre de resultado inválido: '" + names[k] + "'");
+        }
+        if(std::find(names.begin(), names.begin() + k, names[k]) != names.begin() + k) {
+            throw std::runtime_error("Nombre de resultado repetido: '" + names[k] + "'");
+        }
+    }
+    FusedSetup setup = setup_fused(in, err, exprs, symbols, options);
+    std::vector<SymbolTable> thread_symbols(batch_thread_count(), symbols);
+    size_t n_outputs = exprs.size();
+    std::vector<double> results;
+    std::vector<uint8_t> valid;
+    std::vector<std::string> errors;
+
+    for(size_t k = 0; k < n_outputs; k++) {
+        out << (k > 0 ? "," : "") << names[k];
+    }
+    out << "\n";
+    std::streamsize old_precision = out.precision(options.float32 ? std::numeric_limits<float>::max_digits10 
+                                                                  : std::numeric_limits<double>::max_digits10);
+    uint64_t line_number = 1;
+    uint64_t bytes_left = std::numeric_limits<uint64_t>::max();
+    std::vector<StreamWindow> windows = start_windows(setup.windows);
+    CsvChunk chunk;
+    while(read_chunk(in, setup.columns, setup.declared, line_number, bytes_left, chunk)) {
+        append_windows(chunk, setup.windows, windows, thread_symbols);
+        results.assign(chunk.rows() * n_outputs, std::numeric_limits<double>::quiet_NaN());
+        valid.assign(chunk.rows() * n_outputs, 0);
+        errors.assign(chunk.rows() * n_outputs, std::string());
+        evaluate_fused_chunk(chunk, setup, thread_symbols,
+            [&](size_t, size_t row, size_t k, double value) { results[row * n_outputs + k] = value; valid[row * n_outputs + k] = 1; },
+            [&](size_t, size_t row, size_t k, std::string&& message) { errors[row * n_outputs + k] = std::move(message); }
+        );
+        for(size_t r = 0; r < chunk.rows(); r++) {
+            for(size_t k = 0; k < n_outputs; k++) {
+                out << (k > 0 ? "," : "");
+                write_result(out, results[r * n_outputs + k], valid[r * n_outputs + k], errors[r * n_outputs + k]);
+            }
+            out << "\n";
+            for(size_t k = 0; k < n_outputs; k++) {
+                if(!errors[r * n_outputs + k].empty()) {
+                    err << "Línea " << chunk.line_numbers[r] << " (" << names[k] << "): " << errors[r * n_outputs + k] << "\n";
+                }
+            }
+        }
+    }
+    out.precision(old_precision);
+    if(in.bad()) {
+        throw std::runtime_error("Error al leer la entrada");
+    }
+}
+
+void evaluate_arrow(std::istream& in, std::ostream& out, std::ostream& err, const Expression& expr,
+                    const SymbolTable& symbols, const BatchOptions& options) {
+    ArrowStreamReader reader(in);
+    ArrowSetup setup = setup_arrow(reader, err, expr, symbols, options);
+    ArrowStreamWriter writer(out, {"result"});
+    std::vector<SymbolTable> thread_symbols(batch_thread_count(), symbols);
+    std::vector<double> results;
+    std::vector<uint8_t> valid;
+    std::vector<std::string> errors;
+
+    std::vector<StreamWindow> windows = start_windows(setup.batch.windows);
+    ArrowRecordBatch batch;
+    CsvChunk chunk;
+    while(reader.next(batch)) {
+        arrow_chunk(batch, setup, chunk);
+        append_windows(chunk, setup.batch.windows, windows, thread_symbols);
+        results.assign(chunk.rows(), std::numeric_limits<double>::quiet_NaN());
+        valid.assign(chunk.rows(), 0);
+        errors.assign(chunk.rows(), std::string());
+        if(chunk.rows() > 0) {
+            evaluate_chunk(chunk, setup.batch.windows.columns, setup.batch.prepared, setup.batch.key, setup.batch.filter, thread_symbols,
+                [&](size_t, size_t row, double value) { results[row] = value; valid[row] = 1; },
+                [&](size_t, size_t row, std::string&& message) { errors[row] = std::move(message); }
+            );
+        }
+        for(size_t r = 0; r < chunk.rows(); r++) {
+            if(!errors[r].empty()) {
+                err << "Fila " << chunk.line_numbers[r] << ": " << errors[r] << "\n";
+            }
+        }
+        writer.write_batch(chunk.rows(), {results.data()}, {valid.data()});
+    }
+    writer.finish();
+}
+
+BatchAggregate aggregate_arrow(std::istream& in, std::ostream& err, const Expression& expr, const SymbolTable& symbols,
+                               const BatchOptions& options) {
+    ArrowStreamReader reader(in);
+    ArrowSetup setup = setup_arrow(reader, err, expr, symbols, options);
+    size_t n_threads = batch_thread_count();
+    std::vector<SymbolTable> thread_symbols(n_threads, symbols);
+    std::vector<BatchAggregate> thread_aggregates(n_threads);
+
+    std::vector<StreamWindow> windows = start_windows(setup.batch.windows);
+    ArrowRecordBatch batch;
+    CsvChunk chunk;
+    while(reader.next(batch)) {
+        arrow_chunk(batch, setup, chunk);
+        append_windows(chunk, setup.batch.windows, windows, thread_symbols);
+        if(chunk.rows() > 0) {
+            evaluate_chunk(chunk, setup.batch.windows.columns, setup.batch.prepared, setup.batch.key, setup.batch.filter, thread_symbols,
+                [&](size_t thread_idx, size_t, double value) { thread_aggregates[thread_idx].push(value); },
+                [&](size_t thread_idx, size_t, std::string&&) { thread_aggregates[thread_idx].push_error(); }
+            );
+        }
+    }
+
+    BatchAggregate total;
+    for(const BatchAggregate& aggregate : thread_aggregates) {
+        total.merge(aggregate);
+    }
+    return total;
+}
+
+void sweep_table(const std::vector<SweepAxis>& axes, std::ostream& out, std::ostream& err, const Expression& expr,
+                 const SymbolTable& symbols, const BatchOptions& options) {
+    SweepSetup setup = setup_sweep(axes, err, expr, symbols, options);
+    std::vector<SymbolTable> thread_symbols(batch_thread_count(), symbols);
+    std::vector<double> results;
+    std::vector<uint8_t> valid;
+    std::vector<std::string> errors;
+
+    for(const SweepAxis& axis : axes) {
+        out << axis.name << ",";
+    }
+    out << "result\n";
+    std::streamsize old_precision = out.precision();
+    std::streamsize coordinate_precision = std::numeric_limits<double>::max_digits10;
+    std::streamsize result_precision = setup.prepared.float32 ? std::numeric_limits<float>::max_digits10 : coordinate_precision;
+    CsvChunk chunk;
+    while(sweep_chunk(axes, setup.total, chunk)) {
+        results.assign(chunk.rows(), std::numeric_limits<double>::quiet_NaN());
+        valid.assign(chunk.rows(), 0);
+        errors.assign(chunk.rows(), std::string());
+        evaluate_chunk(chunk, setup.columns, setup.prepared, setup.key, setup.filter, thread_symbols,
+            [&](size_t, size_t row, double value) { results[row] = value; valid[row] = 1; },
+            [&](size_t, size_t row, std::string&& message) { errors[row] = std::move(message); }
+        );
+        for(size_t r = 0; r < chunk.rows(); r++) {
+            out.precision(coordinate_precision);
+            for(size_t j = 0; j < axes.size(); j++) {
+                out << chunk.values[r * axes.size() + j] << ",";
+            }
+            out.precision(result_precision);
+            write_result(out, results[r], valid[r], errors[r]);
+            out << "\n";
+            if(!errors[r].empty()) {
+                err << "Punto " << chunk.line_numbers[r] << ": " << errors[r] << "\n";
+            }
+        }
+    }
+    out.precision(old_precision);
+}
+
+SweepSummary sweep_summary(const std::vector<SweepAxis>& axes, std::ostream& err, const Expression& expr,
+                           const SymbolTable& symbols, const BatchOptions& options, size_t top_k, bool maximize) {
+    SweepSetup setup = setup_sweep(axes, err, expr, symbols, options);
+    size_t n_threads = batch_thread_count();
+    std::vector<SymbolTable> thread_symbols(n_threads, symbols);
+    std::vector<SweepSummary> thread_summaries(n_threads, SweepSummary(top_k, maximize));
+
+    CsvChunk chunk;
+    while(sweep_chunk(axes, setup.total, chunk)) {
+        evaluate_chunk(chunk, setup.columns, setup.prepared, setup.key, setup.filter, thread_symbols,
+            [&](size_t thread_idx, size_t row, double value) { thread_summaries[thread_idx].push(chunk.first_row + row, value); },
+            [&](size_t thread_idx, size_t, std::string&&) { thread_summaries[thread_idx].push_error(); }
+        );
+    }
+
+    SweepSummary total(top_k, maximize);
+    for(const SweepSummary& summary : thread_summaries) {
+        total.merge(summary);
+    }
+    return total;
+}
+
+} // namespace clex
@@ -55,4 +55,14 @@ void ComplexResultError::print_to(std::ostream& out) const noexcept {
     out << "<RESULTADO COMPLEJO> " << this->what() << '\n';
 }
 
+InvalidArgument::InvalidArgument(std::string&& message, std::unique_ptr<Expression>&& call) noexcept : EvalError("", std::move(call)) {
+    std::stringstream msg;
+    msg << message << " en la expresión " << *m_problem;
+    m_message = msg.str();
+}
+
+void InvalidArgument::print_to(std::ostream& out) const noexcept {
+    out << "<ARGUMENTO INVÁLIDO> " << this->what() << '\n';
+}
+
 }
\ No newline at end of file
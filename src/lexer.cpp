@@ -355,8 +355,8 @@ static void yynoreturn yy_fatal_error ( const char* msg  );
 	(yy_hold_char) = *yy_cp; \
 	*yy_cp = '\0'; \
 	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 21
-#define YY_END_OF_BUFFER 22
+#define YY_NUM_RULES 47
+#define YY_END_OF_BUFFER 48
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -364,13 +364,21 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[48] =
+static const flex_int16_t yy_accept[115] =
     {   0,
-        0,    0,   22,   20,    1,   21,    8,    9,    4,    2,
-        3,    5,   18,    7,   19,    6,   19,   19,   19,   19,
-       19,    1,    0,   18,   19,   19,   19,   19,   19,   19,
-       19,   19,   19,   18,   19,   19,   19,   13,   11,   12,
-       19,   14,   16,   15,   17,   10,    0
+        0,    0,   48,   46,    1,   47,   46,   17,   18,    4,
+        2,   19,    3,    5,   44,    7,   16,    9,   45,    6,
+       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,    1,   12,    0,   44,    8,   11,   10,   45,   45,
+       45,   45,   45,   45,   45,   45,   28,   43,   45,   45,
+       45,   31,   45,   45,   45,   14,   45,   45,   45,   45,
+       45,   44,   45,   13,   45,   45,   45,   23,   40,   41,
+       42,   21,   45,   45,   15,   35,   45,   45,   22,   45,
+       24,   26,   45,   25,   27,   45,   45,   29,   45,   20,
+       45,   32,   45,   30,   45,   34,   45,   45,   45,   45,
+
+       33,    0,    0,    0,    0,    0,    0,    0,   39,    0,
+       38,   36,   37,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -378,17 +386,17 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1,    1,    1,    1,    2,    3,
         1,    1,    2,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    2,    1,    1,    1,    1,    1,    1,    1,    4,
-        5,    6,    7,    1,    8,    9,   10,   11,   11,   11,
-       11,   11,   11,   11,   11,   11,   11,    1,    1,    1,
-       12,    1,    1,    1,   13,   13,   13,   13,   13,   13,
-       13,   13,   13,   13,   13,   13,   13,   13,   13,   13,
-       13,   13,   13,   13,   13,   13,   13,   13,   13,   13,
-        1,    1,    1,   14,    1,    1,   15,   13,   16,   13,
-
-       13,   13,   17,   13,   18,   13,   13,   19,   13,   20,
-       21,   13,   22,   23,   24,   25,   13,   13,   13,   13,
-       13,   13,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    2,    4,    1,    1,    1,    1,    1,    1,    5,
+        6,    7,    8,    9,   10,   11,   12,   13,   13,   13,
+       13,   13,   13,   13,   13,   13,   13,    1,    1,   14,
+       15,   16,    1,    1,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+        1,    1,    1,   18,   19,    1,   20,   17,   21,   22,
+
+       23,   24,   25,   17,   26,   17,   17,   27,   28,   29,
+       30,   17,   31,   32,   33,   34,   35,   17,   17,   36,
+       17,   37,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -405,55 +413,488 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[26] =
+static const YY_CHAR yy_meta[38] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        2,    1,    2,    1,    2,    2,    2,    2,    2,    2,
-        2,    2,    2,    2,    2
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[49] =
+static const flex_int16_t yy_base[116] =
     {   0,
-        0,    0,   55,   56,   52,   56,   56,   56,   56,   56,
-       56,   56,   17,   56,    0,   56,   11,   32,   31,   11,
-       36,   48,   38,   21,    0,   27,   29,   31,   21,   27,
-       23,   19,   21,   29,   15,   18,   17,    0,    0,    0,
-        9,    0,    0,    0,    0,    0,   56,   29
+        0,   38,    1,    2,   74,    3,   62,    4,    5,    6,
+        7,    8,    9,   10,   67,   64,   66,   68,   69,   11,
+       94,  119,  144,  169,  194,  219,  244,  269,  294,  319,
+      344,   82,   12,   72,   97,   13,   14,   15,  369,  394,
+      419,  444,  469,  494,  519,  544,  569,  594,  619,  644,
+      669,  694,  719,  744,  769,  794,  819,  844,  869,  894,
+      919,   75,  944,  969,  994, 1019, 1044, 1069, 1094, 1119,
+     1144, 1169, 1194, 1219, 1244, 1269, 1294, 1319, 1344, 1369,
+     1394, 1419, 1444, 1469, 1494, 1519, 1544, 1569, 1594, 1619,
+     1644, 1669, 1694, 1719, 1744, 1769, 1794, 1819, 1844, 1869,
+
+     1894,  105, 1912,   52,   73,   92,   84,  106,   16,  108,
+       17,   18,   19, 1939,    0
     } ;
 
-static const flex_int16_t yy_def[49] =
+static const flex_int16_t yy_def[116] =
     {   0,
-       47,    1,   47,   47,   47,   47,   47,   47,   47,   47,
-       47,   47,   47,   47,   48,   47,   48,   48,   48,   48,
-       48,   47,   47,   47,   48,   48,   48,   48,   48,   48,
-       48,   48,   48,   47,   48,   48,   48,   48,   48,   48,
-       48,   48,   48,   48,   48,   48,    0,   47
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,    0,    0
     } ;
 
-static const flex_int16_t yy_nxt[82] =
-    {   0,
-        4,    5,    6,    7,    8,    9,   10,   11,    4,   12,
-       13,   14,   15,   16,   17,   18,   15,   15,   19,   15,
-       15,   15,   15,   20,   21,   23,   26,   24,   31,   23,
-       25,   24,   32,   46,   27,   28,   45,   44,   43,   34,
-       42,   41,   40,   39,   38,   37,   36,   35,   34,   22,
-       33,   30,   29,   22,   47,    3,   47,   47,   47,   47,
-       47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
-       47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
-       47
+static const flex_int16_t yy_nxt[1977] =
+    {   3,
+        4,    5,    6,    7,    8,    9,   10,   11,   12,   13,
+        4,   14,   15,   16,   17,   18,   19,   20,    4,   21,
+       22,   19,   23,   19,   19,   24,   25,   26,   27,   28,
+       19,   29,   30,   31,   19,   19,   19,    3,    4,    5,
+        6,    7,    8,    9,   10,   11,   12,   13,    4,   14,
+       15,   16,   17,   18,   19,   20,    4,   21,   22,   19,
+       23,   19,   19,   24,   25,   26,   27,   28,   19,   29,
+       30,   31,   19,   19,   19,   32,   33,   34,   36,   35,
+       37,   39,   38,   32,   62,   39,  108,   62,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,   34,  109,   35,
+       39,  110,  111,   39,   40,   39,   39,   39,   39,   39,
+       39,   39,   41,   39,   39,   42,   43,   44,   39,   39,
+       39,   39,  103,  112,    0,   39,  113,  104,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   45,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   46,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   47,   39,   39,   39,   39,   48,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   49,   39,   39,   50,   39,   39,   39,
+       39,   39,   39,   51,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   52,
+       39,   39,   39,   39,   53,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   54,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       55,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       56,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   57,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   58,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   59,   39,   39,   39,   39,   60,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   61,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   63,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       64,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   65,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   66,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   67,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   68,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   69,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   70,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   71,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   72,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   73,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   74,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   75,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   76,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   77,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       78,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   79,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   80,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   81,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   82,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   83,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   84,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   85,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   86,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   87,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   88,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   89,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   90,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   91,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       92,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   93,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   94,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   95,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   96,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   97,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   98,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       99,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,  100,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,  101,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,    0,    0,    0,   39,    0,  102,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   39,    0,    0,    0,
+       39,    0,    0,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,  105,    0,    0,  106,    0,    0,  107,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114
     } ;
 
-static const flex_int16_t yy_chk[82] =
-    {   0,
+static const flex_int16_t yy_chk[1977] =
+    {   1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,   13,   17,   13,   20,   24,
-       48,   24,   20,   41,   17,   17,   37,   36,   35,   34,
-       33,   32,   31,   30,   29,   28,   27,   26,   23,   22,
-       21,   19,   18,    5,    3,   47,   47,   47,   47,   47,
-       47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    5,    7,   15,   16,   15,
+       17,   19,   18,   32,   34,   19,  104,   62,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+
+       19,   19,   19,   19,   19,   19,   21,   35,  105,   35,
+       21,  106,  107,   21,   21,   21,   21,   21,   21,   21,
+       21,   21,   21,   21,   21,   21,   21,   21,   21,   21,
+       21,   22,  102,  108,    0,   22,  110,  102,   22,   22,
+       22,   22,   22,   22,   22,   22,   22,   22,   22,   22,
+       22,   22,   22,   22,   22,   22,   23,    0,    0,    0,
+       23,    0,    0,   23,   23,   23,   23,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
+       23,   24,    0,    0,    0,   24,    0,    0,   24,   24,
+       24,   24,   24,   24,   24,   24,   24,   24,   24,   24,
+
+       24,   24,   24,   24,   24,   24,   25,    0,    0,    0,
+       25,    0,    0,   25,   25,   25,   25,   25,   25,   25,
+       25,   25,   25,   25,   25,   25,   25,   25,   25,   25,
+       25,   26,    0,    0,    0,   26,    0,    0,   26,   26,
+       26,   26,   26,   26,   26,   26,   26,   26,   26,   26,
+       26,   26,   26,   26,   26,   26,   27,    0,    0,    0,
+       27,    0,    0,   27,   27,   27,   27,   27,   27,   27,
+       27,   27,   27,   27,   27,   27,   27,   27,   27,   27,
+       27,   28,    0,    0,    0,   28,    0,    0,   28,   28,
+       28,   28,   28,   28,   28,   28,   28,   28,   28,   28,
+
+       28,   28,   28,   28,   28,   28,   29,    0,    0,    0,
+       29,    0,    0,   29,   29,   29,   29,   29,   29,   29,
+       29,   29,   29,   29,   29,   29,   29,   29,   29,   29,
+       29,   30,    0,    0,    0,   30,    0,    0,   30,   30,
+       30,   30,   30,   30,   30,   30,   30,   30,   30,   30,
+       30,   30,   30,   30,   30,   30,   31,    0,    0,    0,
+       31,    0,    0,   31,   31,   31,   31,   31,   31,   31,
+       31,   31,   31,   31,   31,   31,   31,   31,   31,   31,
+       31,   39,    0,    0,    0,   39,    0,    0,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+
+       39,   39,   39,   39,   39,   39,   40,    0,    0,    0,
+       40,    0,    0,   40,   40,   40,   40,   40,   40,   40,
+       40,   40,   40,   40,   40,   40,   40,   40,   40,   40,
+       40,   41,    0,    0,    0,   41,    0,    0,   41,   41,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   41,   41,   41,   42,    0,    0,    0,
+       42,    0,    0,   42,   42,   42,   42,   42,   42,   42,
+       42,   42,   42,   42,   42,   42,   42,   42,   42,   42,
+       42,   43,    0,    0,    0,   43,    0,    0,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   43,
+
+       43,   43,   43,   43,   43,   43,   44,    0,    0,    0,
+       44,    0,    0,   44,   44,   44,   44,   44,   44,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+       44,   45,    0,    0,    0,   45,    0,    0,   45,   45,
+       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,   45,   45,   45,   45,   45,   46,    0,    0,    0,
+       46,    0,    0,   46,   46,   46,   46,   46,   46,   46,
+       46,   46,   46,   46,   46,   46,   46,   46,   46,   46,
+       46,   47,    0,    0,    0,   47,    0,    0,   47,   47,
        47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
-       47
+
+       47,   47,   47,   47,   47,   47,   48,    0,    0,    0,
+       48,    0,    0,   48,   48,   48,   48,   48,   48,   48,
+       48,   48,   48,   48,   48,   48,   48,   48,   48,   48,
+       48,   49,    0,    0,    0,   49,    0,    0,   49,   49,
+       49,   49,   49,   49,   49,   49,   49,   49,   49,   49,
+       49,   49,   49,   49,   49,   49,   50,    0,    0,    0,
+       50,    0,    0,   50,   50,   50,   50,   50,   50,   50,
+       50,   50,   50,   50,   50,   50,   50,   50,   50,   50,
+       50,   51,    0,    0,    0,   51,    0,    0,   51,   51,
+       51,   51,   51,   51,   51,   51,   51,   51,   51,   51,
+
+       51,   51,   51,   51,   51,   51,   52,    0,    0,    0,
+       52,    0,    0,   52,   52,   52,   52,   52,   52,   52,
+       52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
+       52,   53,    0,    0,    0,   53,    0,    0,   53,   53,
+       53,   53,   53,   53,   53,   53,   53,   53,   53,   53,
+       53,   53,   53,   53,   53,   53,   54,    0,    0,    0,
+       54,    0,    0,   54,   54,   54,   54,   54,   54,   54,
+       54,   54,   54,   54,   54,   54,   54,   54,   54,   54,
+       54,   55,    0,    0,    0,   55,    0,    0,   55,   55,
+       55,   55,   55,   55,   55,   55,   55,   55,   55,   55,
+
+       55,   55,   55,   55,   55,   55,   56,    0,    0,    0,
+       56,    0,    0,   56,   56,   56,   56,   56,   56,   56,
+       56,   56,   56,   56,   56,   56,   56,   56,   56,   56,
+       56,   57,    0,    0,    0,   57,    0,    0,   57,   57,
+       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
+       57,   57,   57,   57,   57,   57,   58,    0,    0,    0,
+       58,    0,    0,   58,   58,   58,   58,   58,   58,   58,
+       58,   58,   58,   58,   58,   58,   58,   58,   58,   58,
+       58,   59,    0,    0,    0,   59,    0,    0,   59,   59,
+       59,   59,   59,   59,   59,   59,   59,   59,   59,   59,
+
+       59,   59,   59,   59,   59,   59,   60,    0,    0,    0,
+       60,    0,    0,   60,   60,   60,   60,   60,   60,   60,
+       60,   60,   60,   60,   60,   60,   60,   60,   60,   60,
+       60,   61,    0,    0,    0,   61,    0,    0,   61,   61,
+       61,   61,   61,   61,   61,   61,   61,   61,   61,   61,
+       61,   61,   61,   61,   61,   61,   63,    0,    0,    0,
+       63,    0,    0,   63,   63,   63,   63,   63,   63,   63,
+       63,   63,   63,   63,   63,   63,   63,   63,   63,   63,
+       63,   64,    0,    0,    0,   64,    0,    0,   64,   64,
+       64,   64,   64,   64,   64,   64,   64,   64,   64,   64,
+
+       64,   64,   64,   64,   64,   64,   65,    0,    0,    0,
+       65,    0,    0,   65,   65,   65,   65,   65,   65,   65,
+       65,   65,   65,   65,   65,   65,   65,   65,   65,   65,
+       65,   66,    0,    0,    0,   66,    0,    0,   66,   66,
+       66,   66,   66,   66,   66,   66,   66,   66,   66,   66,
+       66,   66,   66,   66,   66,   66,   67,    0,    0,    0,
+       67,    0,    0,   67,   67,   67,   67,   67,   67,   67,
+       67,   67,   67,   67,   67,   67,   67,   67,   67,   67,
+       67,   68,    0,    0,    0,   68,    0,    0,   68,   68,
+       68,   68,   68,   68,   68,   68,   68,   68,   68,   68,
+
+       68,   68,   68,   68,   68,   68,   69,    0,    0,    0,
+       69,    0,    0,   69,   69,   69,   69,   69,   69,   69,
+       69,   69,   69,   69,   69,   69,   69,   69,   69,   69,
+       69,   70,    0,    0,    0,   70,    0,    0,   70,   70,
+       70,   70,   70,   70,   70,   70,   70,   70,   70,   70,
+       70,   70,   70,   70,   70,   70,   71,    0,    0,    0,
+       71,    0,    0,   71,   71,   71,   71,   71,   71,   71,
+       71,   71,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   72,    0,    0,    0,   72,    0,    0,   72,   72,
+       72,   72,   72,   72,   72,   72,   72,   72,   72,   72,
+
+       72,   72,   72,   72,   72,   72,   73,    0,    0,    0,
+       73,    0,    0,   73,   73,   73,   73,   73,   73,   73,
+       73,   73,   73,   73,   73,   73,   73,   73,   73,   73,
+       73,   74,    0,    0,    0,   74,    0,    0,   74,   74,
+       74,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+       74,   74,   74,   74,   74,   74,   75,    0,    0,    0,
+       75,    0,    0,   75,   75,   75,   75,   75,   75,   75,
+       75,   75,   75,   75,   75,   75,   75,   75,   75,   75,
+       75,   76,    0,    0,    0,   76,    0,    0,   76,   76,
+       76,   76,   76,   76,   76,   76,   76,   76,   76,   76,
+
+       76,   76,   76,   76,   76,   76,   77,    0,    0,    0,
+       77,    0,    0,   77,   77,   77,   77,   77,   77,   77,
+       77,   77,   77,   77,   77,   77,   77,   77,   77,   77,
+       77,   78,    0,    0,    0,   78,    0,    0,   78,   78,
+       78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+       78,   78,   78,   78,   78,   78,   79,    0,    0,    0,
+       79,    0,    0,   79,   79,   79,   79,   79,   79,   79,
+       79,   79,   79,   79,   79,   79,   79,   79,   79,   79,
+       79,   80,    0,    0,    0,   80,    0,    0,   80,   80,
+       80,   80,   80,   80,   80,   80,   80,   80,   80,   80,
+
+       80,   80,   80,   80,   80,   80,   81,    0,    0,    0,
+       81,    0,    0,   81,   81,   81,   81,   81,   81,   81,
+       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
+       81,   82,    0,    0,    0,   82,    0,    0,   82,   82,
+       82,   82,   82,   82,   82,   82,   82,   82,   82,   82,
+       82,   82,   82,   82,   82,   82,   83,    0,    0,    0,
+       83,    0,    0,   83,   83,   83,   83,   83,   83,   83,
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+       83,   84,    0,    0,    0,   84,    0,    0,   84,   84,
+       84,   84,   84,   84,   84,   84,   84,   84,   84,   84,
+
+       84,   84,   84,   84,   84,   84,   85,    0,    0,    0,
+       85,    0,    0,   85,   85,   85,   85,   85,   85,   85,
+       85,   85,   85,   85,   85,   85,   85,   85,   85,   85,
+       85,   86,    0,    0,    0,   86,    0,    0,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   87,    0,    0,    0,
+       87,    0,    0,   87,   87,   87,   87,   87,   87,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   87,   87,
+       87,   88,    0,    0,    0,   88,    0,    0,   88,   88,
+       88,   88,   88,   88,   88,   88,   88,   88,   88,   88,
+
+       88,   88,   88,   88,   88,   88,   89,    0,    0,    0,
+       89,    0,    0,   89,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   89,   89,   89,
+       89,   90,    0,    0,    0,   90,    0,    0,   90,   90,
+       90,   90,   90,   90,   90,   90,   90,   90,   90,   90,
+       90,   90,   90,   90,   90,   90,   91,    0,    0,    0,
+       91,    0,    0,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   92,    0,    0,    0,   92,    0,    0,   92,   92,
+       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
+
+       92,   92,   92,   92,   92,   92,   93,    0,    0,    0,
+       93,    0,    0,   93,   93,   93,   93,   93,   93,   93,
+       93,   93,   93,   93,   93,   93,   93,   93,   93,   93,
+       93,   94,    0,    0,    0,   94,    0,    0,   94,   94,
+       94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+       94,   94,   94,   94,   94,   94,   95,    0,    0,    0,
+       95,    0,    0,   95,   95,   95,   95,   95,   95,   95,
+       95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+       95,   96,    0,    0,    0,   96,    0,    0,   96,   96,
+       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
+
+       96,   96,   96,   96,   96,   96,   97,    0,    0,    0,
+       97,    0,    0,   97,   97,   97,   97,   97,   97,   97,
+       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
+       97,   98,    0,    0,    0,   98,    0,    0,   98,   98,
+       98,   98,   98,   98,   98,   98,   98,   98,   98,   98,
+       98,   98,   98,   98,   98,   98,   99,    0,    0,    0,
+       99,    0,    0,   99,   99,   99,   99,   99,   99,   99,
+       99,   99,   99,   99,   99,   99,   99,   99,   99,   99,
+       99,  100,    0,    0,    0,  100,    0,  100,  100,  100,
+      100,  100,  100,  100,  100,  100,  100,  100,  100,  100,
+
+      100,  100,  100,  100,  100,  100,  101,    0,    0,    0,
+      101,    0,    0,  101,  101,  101,  101,  101,  101,  101,
+      101,  101,  101,  101,  101,  101,  101,  101,  101,  101,
+      101,  103,    0,    0,  103,    0,    0,  103,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114
     } ;
 
 static yy_state_type yy_last_accepting_state;
@@ -480,8 +921,8 @@ char *yytext;
 using namespace clex;
 
 #define YY_DECL clex::Token yylex()
-#line 484 "lexer.cpp"
-#line 485 "lexer.cpp"
+#line 925 "lexer.cpp"
+#line 926 "lexer.cpp"
 
 #define INITIAL 0
 
@@ -701,7 +1142,7 @@ YY_DECL
 #line 19 "lexer.l"
 
 
-#line 705 "lexer.cpp"
+#line 1146 "lexer.cpp"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -728,13 +1169,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 48 )
+				if ( yy_current_state >= 115 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 56 );
+		while ( yy_base[yy_current_state] != 1939 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -791,83 +1232,213 @@ YY_RULE_SETUP
 case 7:
 YY_RULE_SETUP
 #line 27 "lexer.l"
-{ return Token(TokenType::ASSIGN); }
+{ return Token(TokenType::OP_LESS); }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
 #line 28 "lexer.l"
-{ return Token(TokenType::PAREN_L); }
+{ return Token(TokenType::OP_LESS_EQ); }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
 #line 29 "lexer.l"
-{ return Token(TokenType::PAREN_R); }
+{ return Token(TokenType::OP_GREATER); }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
 #line 30 "lexer.l"
-{ return Token(TokenType::OP_FUNC_SQRT); }
+{ return Token(TokenType::OP_GREATER_EQ); }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
 #line 31 "lexer.l"
-{ return Token(TokenType::OP_FUNC_LOG); }
+{ return Token(TokenType::OP_EQUAL); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
 #line 32 "lexer.l"
-{ return Token(TokenType::OP_FUNC_SIN); }
+{ return Token(TokenType::OP_NOT_EQUAL); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
 #line 33 "lexer.l"
-{ return Token(TokenType::OP_FUNC_COS); }
+{ return Token(TokenType::OP_AND); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
 #line 34 "lexer.l"
-{ return Token(TokenType::OP_FUNC_TAN); }
+{ return Token(TokenType::OP_OR); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
 #line 35 "lexer.l"
-{ return Token(TokenType::OP_FUNC_ARCSIN); }
+{ return Token(TokenType::OP_NOT); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
 #line 36 "lexer.l"
-{ return Token(TokenType::OP_FUNC_ARCCOS); }
+{ return Token(TokenType::ASSIGN); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
 #line 37 "lexer.l"
-{ return Token(TokenType::OP_FUNC_ARCTAN); }
+{ return Token(TokenType::PAREN_L); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
 #line 38 "lexer.l"
-{ return Token::number(std::string(yytext)); }
+{ return Token(TokenType::PAREN_R); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
 #line 39 "lexer.l"
-{ return Token::identifier(std::string(yytext)); }
+{ return Token(TokenType::COMMA); }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
 #line 40 "lexer.l"
+{ return Token(TokenType::OP_FUNC_SQRT); }
+	YY_BREAK
+case 21:
+YY_RULE_SETUP
+#line 41 "lexer.l"
+{ return Token(TokenType::OP_FUNC_LOG); }
+	YY_BREAK
+case 22:
+YY_RULE_SETUP
+#line 42 "lexer.l"
+{ return Token(TokenType::OP_FUNC_SIN); }
+	YY_BREAK
+case 23:
+YY_RULE_SETUP
+#line 43 "lexer.l"
+{ return Token(TokenType::OP_FUNC_COS); }
+	YY_BREAK
+case 24:
+YY_RULE_SETUP
+#line 44 "lexer.l"
+{ return Token(TokenType::OP_FUNC_TAN); }
+	YY_BREAK
+case 25:
+YY_RULE_SETUP
+#line 45 "lexer.l"
+{ return Token(TokenType::OP_FUNC_ARCSIN); }
+	YY_BREAK
+case 26:
+YY_RULE_SETUP
+#line 46 "lexer.l"
+{ return Token(TokenType::OP_FUNC_ARCCOS); }
+	YY_BREAK
+case 27:
+YY_RULE_SETUP
+#line 47 "lexer.l"
+{ return Token(TokenType::OP_FUNC_ARCTAN); }
+	YY_BREAK
+case 28:
+YY_RULE_SETUP
+#line 48 "lexer.l"
+{ return Token(TokenType::FUNC_IF); }
+	YY_BREAK
+case 29:
+YY_RULE_SETUP
+#line 49 "lexer.l"
+{ return Token(TokenType::FUNC_RAND); }
+	YY_BREAK
+case 30:
+YY_RULE_SETUP
+#line 50 "lexer.l"
+{ return Token(TokenType::FUNC_RANDN); }
+	YY_BREAK
+case 31:
+YY_RULE_SETUP
+#line 51 "lexer.l"
+{ return Token(TokenType::FUNC_MC); }
+	YY_BREAK
+case 32:
+YY_RULE_SETUP
+#line 52 "lexer.l"
+{ return Token(TokenType::FUNC_MCERR); }
+	YY_BREAK
+case 33:
+YY_RULE_SETUP
+#line 53 "lexer.l"
+{ return Token(TokenType::FUNC_MINIMIZE); }
+	YY_BREAK
+case 34:
+YY_RULE_SETUP
+#line 54 "lexer.l"
+{ return Token(TokenType::FUNC_ARGMIN); }
+	YY_BREAK
+case 35:
+YY_RULE_SETUP
+#line 55 "lexer.l"
+{ return Token(TokenType::FUNC_ODE); }
+	YY_BREAK
+case 36:
+YY_RULE_SETUP
+#line 56 "lexer.l"
+{ return Token(TokenType::FUNC_ROLLING_SUM); }
+	YY_BREAK
+case 37:
+YY_RULE_SETUP
+#line 57 "lexer.l"
+{ return Token(TokenType::FUNC_ROLLING_MEAN); }
+	YY_BREAK
+case 38:
+YY_RULE_SETUP
+#line 58 "lexer.l"
+{ return Token(TokenType::FUNC_ROLLING_MIN); }
+	YY_BREAK
+case 39:
+YY_RULE_SETUP
+#line 59 "lexer.l"
+{ return Token(TokenType::FUNC_ROLLING_MAX); }
+	YY_BREAK
+case 40:
+YY_RULE_SETUP
+#line 60 "lexer.l"
+{ return Token(TokenType::FUNC_EMA); }
+	YY_BREAK
+case 41:
+YY_RULE_SETUP
+#line 61 "lexer.l"
+{ return Token(TokenType::FUNC_LAG); }
+	YY_BREAK
+case 42:
+YY_RULE_SETUP
+#line 62 "lexer.l"
+{ return Token(TokenType::LET); }
+	YY_BREAK
+case 43:
+YY_RULE_SETUP
+#line 63 "lexer.l"
+{ return Token(TokenType::IN); }
+	YY_BREAK
+case 44:
+YY_RULE_SETUP
+#line 64 "lexer.l"
+{ return Token::number(std::string(yytext)); }
+	YY_BREAK
+case 45:
+YY_RULE_SETUP
+#line 65 "lexer.l"
+{ return Token::identifier(std::string(yytext)); }
+	YY_BREAK
+case 46:
+YY_RULE_SETUP
+#line 66 "lexer.l"
 { std::cerr << "Error: " << yytext << std::endl; return Token(); }
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
-#line 41 "lexer.l"
+#line 67 "lexer.l"
 { return Token(TokenType::END_OF_FILE); }
 	YY_BREAK
-case 21:
+case 47:
 YY_RULE_SETUP
-#line 43 "lexer.l"
+#line 69 "lexer.l"
 ECHO;
 	YY_BREAK
-#line 871 "lexer.cpp"
+#line 1442 "lexer.cpp"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -1162,7 +1733,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 48 )
+			if ( yy_current_state >= 115 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1190,11 +1761,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 48 )
+		if ( yy_current_state >= 115 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 47);
+	yy_is_jam = (yy_current_state == 114);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -1870,8 +2441,7 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 43 "lexer.l"
-
+#line 69 "lexer.l"
 
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 extern YY_BUFFER_STATE yy_scan_string(const char *str);
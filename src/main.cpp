@@ -1,7 +1,16 @@
 #include <cctype>
+#include <cstdlib>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
+#include "batch.hpp"
+#include "ode.hpp"
+#include "read_ahead.hpp"
+#include "shm_transport.hpp"
 #include "tokens.hpp"
 #include "parser.hpp"
 #include "symbol_table.hpp"
@@ -11,7 +20,505 @@ namespace clex {
     std::vector<Token> tokenize(const std::string& input);
 }
 
-int main() {
+// Lee una declaración de rango `nombre=min:max`, como `x=0:10`.
+bool parse_range(const std::string& text, clex::VariableRanges& ranges) {
+    size_t eq = text.find('='), colon = text.find(':');
+    if(eq == std::string::npos || colon == std::string::npos || colon < eq) {
+        return false;
+    }
+    char* end_lo = nullptr;
+    char* end_hi = nullptr;
+    std::string lo_text = text.substr(eq + 1, colon - eq - 1), hi_text = text.substr(colon + 1);
+    double lo = std::strtod(lo_text.c_str(), &end_lo), hi = std::strtod(hi_text.c_str(), &end_hi);
+    if(eq == 0 || lo_text.empty() || hi_text.empty() || *end_lo != '\0' || *end_hi != '\0' || !(lo <= hi)) {
+        return false;
+    }
+    ranges[text.substr(0, eq)] = clex::Interval{lo, hi, false};
+    return true;
+}
+
+// Lee un eje de malla `nombre=min:max:puntos`, como `x=0:10:101`.
+bool parse_axis(const std::string& text, std::vector<clex::SweepAxis>& axes) {
+    size_t last_colon = text.rfind(':');
+    clex::VariableRanges range;
+    if(last_colon == std::string::npos || !parse_range(text.substr(0, last_colon), range)) {
+        return false;
+    }
+    char* end = nullptr;
+    std::string points_text = text.substr(last_colon + 1);
+    long long points = std::strtoll(points_text.c_str(), &end, 10);
+    if(points_text.empty() || *end != '\0' || points < 1) {
+        return false;
+    }
+    const auto& [name, interval] = *range.begin();
+    axes.push_back(clex::SweepAxis{name, interval.lo, interval.hi, static_cast<uint64_t>(points)});
+    return true;
+}
+
+// Modo por lotes: `calculexdora --csv [--aggregate] [--range x=min:max ...] [--native dir] [--input fichero [--processes n]] 
+// "<expresión>"` evalúa la expresión para cada fila de la entrada CSV (la estándar, si no se indica `--input`) y escribe 
+// un resultado por fila, o solo las estadísticas con `--aggregate`. Con `--native`, la expresión se compila a código 
+// nativo y se guarda en la caché `dir`. Con `--processes`, el fichero de entrada se reparte entre `n` procesos.
+// Con `--arrow` en lugar de `--csv`, la entrada y la salida son flujos IPC de Apache Arrow. Con `--float32`, los
+// resultados se calculan en precisión simple. Con `--approximate tol`, las subexpresiones costosas de una columna con
+// `--range` se sustituyen por tablas de aproximación con error absoluto menor que `tol`.
+// Con `--sweep --grid x=min:max:n ...`, en lugar de leer una entrada se evalúa la expresión en todos los puntos de la
+// malla, y se escribe una tabla con un resultado por punto o, con `--aggregate`, las estadísticas, el mínimo, el
+// máximo y los `k` mejores puntos de `--top k` (los de menor valor, o los de mayor con `--maximize`).
+// Con `--csv --formula nombre=expresión ...`, en lugar de una sola expresión se evalúan todas las de `--formula` en
+// una sola pasada sobre la entrada, y se escribe una tabla con una columna por expresión.
+// Con `--where "<predicado>"`, en cualquiera de los modos, solo se evalúan las filas (o los puntos) en que el predicado
+// es distinto de cero; las demás dan un resultado nulo y no cuentan en las estadísticas. En CSV, los campos vacíos de
+// la entrada son valores nulos, y los resultados nulos se dejan vacíos.
+// Con `--csv --input fichero --update resultados`, los resultados se guardan en `resultados` (con los resúmenes de
+// las filas en `resultados.hash`) y, en las siguientes ejecuciones, solo se vuelven a evaluar y se sobrescriben los
+// de las filas que han cambiado; se escribe el número de filas y el de filas evaluadas.
+int run_batch(const std::vector<std::string>& args) {
+    bool csv = false, arrow = false, sweep = false, aggregate = false, maximize = false;
+    size_t top_k = 0;
+    std::vector<clex::SweepAxis> axes;
+    std::vector<std::string> formula_names, formula_texts;
+    std::string expr_text, input_path, where_text, update_path;
+    clex::BatchOptions options;
+    for(size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if(arg == "--csv") {
+            csv = true;
+        } else if(arg == "--arrow") {
+            arrow = true;
+        } else if(arg == "--sweep") {
+            sweep = true;
+        } else if(arg == "--grid") {
+            if(i + 1 == args.size() || !parse_axis(args[i + 1], axes)) {
+                std::cerr << "Eje inválido, el formato es --grid nombre=min:max:puntos\n";
+                return 2;
+            }
+            i++;
+        } else if(arg == "--formula") {
+            size_t eq = i + 1 < args.size() ? args[i + 1].find('=') : std::string::npos;
+            if(eq == std::string::npos || eq == 0 || eq + 1 == args[i + 1].size()) {
+                std::cerr << "Fórmula inválida, el formato es --formula nombre=expresión\n";
+                return 2;
+            }
+            formula_names.push_back(args[i + 1].substr(0, eq));
+            formula_texts.push_back(args[i + 1].substr(eq + 1));
+            i++;
+        } else if(arg == "--where") {
+            if(i + 1 == args.size()) {
+                std::cerr << "Falta el predicado de --where\n";
+                return 2;
+            }
+            where_text = args[++i];
+        } else if(arg == "--top") {
+            char* end = nullptr;
+            long top = i + 1 < args.size() ? std::strtol(args[i + 1].c_str(), &end, 10) : 0;
+            if(top < 1 || *end != '\0') {
+                std::cerr << "Número de puntos inválido, el formato es --top k\n";
+                return 2;
+            }
+            top_k = static_cast<size_t>(top);
+            i++;
+        } else if(arg == "--maximize") {
+            maximize = true;
+        } else if(arg == "--aggregate") {
+            aggregate = true;
+        } else if(arg == "--float32") {
+            options.float32 = true;
+        } else if(arg == "--range") {
+            if(i + 1 == args.size() || !parse_range(args[i + 1], options.ranges)) {
+                std::cerr << "Rango inválido, el formato es --range nombre=min:max\n";
+                return 2;
+            }
+            i++;
+        } else if(arg == "--native") {
+            if(i + 1 == args.size()) {
+                std::cerr << "Falta el directorio de caché de --native\n";
+                return 2;
+            }
+            options.native_dir = args[++i];
+        } else if(arg == "--approximate") {
+            char* end = nullptr;
+            double tolerance = i + 1 < args.size() ? std::strtod(args[i + 1].c_str(), &end) : 0.0;
+            if(!(tolerance > 0.0) || *end != '\0') {
+                std::cerr << "Tolerancia inválida, el formato es --approximate error_máximo\n";
+                return 2;
+            }
+            options.approximation_tolerance = tolerance;
+            i++;
+        } else if(arg == "--input") {
+            if(i + 1 == args.size()) {
+                std::cerr << "Falta el fichero de --input\n";
+                return 2;
+            }
+            input_path = args[++i];
+        } else if(arg == "--update") {
+            if(i + 1 == args.size()) {
+                std::cerr << "Falta el fichero de resultados de --update\n";
+                return 2;
+            }
+            update_path = args[++i];
+        } else if(arg == "--processes") {
+            char* end = nullptr;
+            long processes = i + 1 < args.size() ? std::strtol(args[i + 1].c_str(), &end, 10) : 0;
+            if(processes < 1 || *end != '\0') {
+                std::cerr << "Número de procesos inválido, el formato es --processes n\n";
+                return 2;
+            }
+            options.processes = static_cast<size_t>(processes);
+            i++;
+        } else if(expr_text.empty() && arg.rfind("--", 0) != 0) {
+            expr_text = arg;
+        } else {
+            std::cerr << "Argumento no reconocido: " << arg << "\n";
+            return 2;
+        }
+    }
+    bool sweep_usage = axes.empty() == !sweep && ((top_k == 0 && !maximize) || (sweep && aggregate))
+                       && (!sweep || (input_path.empty() && options.ranges.empty() && options.processes == 1));
+    bool fused = !formula_names.empty();
+    bool fused_usage = !fused || (csv && expr_text.empty() && !aggregate && options.processes == 1);
+    bool update_usage = update_path.empty() || (csv && !input_path.empty() && !fused && !aggregate && options.processes == 1);
+    if(csv + arrow + sweep != 1 || expr_text.empty() == !fused || !sweep_usage || !fused_usage || !update_usage
+       || (options.processes > 1 && (input_path.empty() || arrow))) {
+        std::cerr << "Uso: calculexdora --csv [--aggregate] [--float32] [--range nombre=min:max ...] [--approximate tol] [--native directorio] [--where \"<predicado>\"] \"<expresión>\" < entrada.csv\n";
+        std::cerr << "     calculexdora --csv [opciones] --input entrada.csv [--processes n] \"<expresión>\"\n";
+        std::cerr << "     calculexdora --csv [--float32] [--range ...] [--native directorio] [--input entrada.csv] --formula nombre=expresión ...\n";
+        std::cerr << "     calculexdora --csv [--float32] [--range ...] [--native directorio] [--where ...] --input entrada.csv --update resultados \"<expresión>\"\n";
+        std::cerr << "     calculexdora --arrow [--aggregate] [--range ...] [--native directorio] [--input entrada.arrows] \"<expresión>\" > salida.arrows\n";
+        std::cerr << "     calculexdora --sweep --grid nombre=min:max:puntos ... [--aggregate [--top k] [--maximize]] [--float32] [--approximate tol] [--native directorio] \"<expresión>\"\n";
+        return 2;
+    }
+    try {
+        std::optional<clex::Expression> filter;
+        if(!where_text.empty()) {
+            clex::Parser parser(clex::tokenize(where_text));
+            auto statement = parser.parse_next_statement();
+            if(!statement.is_expression()) {
+                std::cerr << "ERROR: el predicado de --where debe ser una expresión, no una asignación\n";
+                return 2;
+            }
+            filter.emplace(statement.move_as_expression());
+            options.filter = &*filter;
+        }
+        if(fused) {
+            std::vector<clex::Expression> exprs;
+            for(const std::string& text : formula_texts) {
+                clex::Parser parser(clex::tokenize(text));
+                auto statement = parser.parse_next_statement();
+                if(!statement.is_expression()) {
+                    std::cerr << "ERROR: el modo por lotes necesita expresiones, no asignaciones\n";
+                    return 2;
+                }
+                exprs.push_back(statement.move_as_expression());
+            }
+            std::unique_ptr<clex::ReadAheadBuffer> buffer = input_path.empty()
+                ? std::make_unique<clex::ReadAheadBuffer>(0, false) : clex::ReadAheadBuffer::open(input_path);
+            std::istream input(buffer.get());
+            clex::evaluate_csv_fused(input, std::cout, std::cerr, formula_names, exprs, clex::SymbolTable(), options);
+            return 0;
+        }
+        clex::Parser parser(clex::tokenize(expr_text));
+        auto statement = parser.parse_next_statement();
+        if(!statement.is_expression()) {
+            std::cerr << "ERROR: el modo por lotes necesita una expresión, no una asignación\n";
+            return 2;
+        }
+        clex::Expression expr = statement.move_as_expression();
+        clex::SymbolTable symbols;
+        if(sweep && aggregate) {
+            clex::sweep_summary(axes, std::cerr, expr, symbols, options, top_k, maximize).print_to(std::cout, axes);
+        } else if(sweep) {
+            clex::sweep_table(axes, std::cout, std::cerr, expr, symbols, options);
+        } else if(arrow) {
+            std::unique_ptr<clex::ReadAheadBuffer> buffer = input_path.empty()
+                ? std::make_unique<clex::ReadAheadBuffer>(0, false) : clex::ReadAheadBuffer::open(input_path);
+            std::istream input(buffer.get());
+            if(aggregate) {
+                clex::aggregate_arrow(input, std::cerr, expr, symbols, options).print_to(std::cout);
+            } else {
+                clex::evaluate_arrow(input, std::cout, std::cerr, expr, symbols, options);
+            }
+        } else if(!update_path.empty()) {
+            clex::DeltaUpdate update = clex::update_csv_file(input_path, update_path, update_path + ".hash", std::cerr,
+                                                              expr, symbols, options);
+            std::cout << "rows," << update.rows << "\nevaluated," << update.evaluated << "\n";
+        } else if(!input_path.empty() && aggregate) {
+            clex::aggregate_csv_file(input_path, std::cerr, expr, symbols, options).print_to(std::cout);
+        } else if(!input_path.empty()) {
+            clex::evaluate_csv_file(input_path, std::cout, std::cerr, expr, symbols, options);
+        } else {
+            // la entrada estándar se lee por adelantado en otro hilo, igual que los ficheros de `--input`
+            clex::ReadAheadBuffer stdin_buffer(0, false);
+            std::istream input(&stdin_buffer);
+            if(aggregate) {
+                clex::aggregate_csv(input, std::cerr, expr, symbols, options).print_to(std::cout);
+            } else {
+                clex::evaluate_csv(input, std::cout, std::cerr, expr, symbols, options);
+            }
+        }
+    } catch (const clex::ParserError& e) {
+        std::cerr << "ERROR DE SINTAXIS: ";
+        e.print_to(std::cerr);
+        std::cerr << "\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Lee dos enteros sin signo separados por `:`, como `100:10000`.
+bool parse_pair(const std::string& text, uint64_t& first, uint64_t& second) {
+    size_t colon = text.find(':');
+    if(colon == std::string::npos || colon == 0 || colon + 1 == text.size()) {
+        return false;
+    }
+    char* end_first = nullptr;
+    char* end_second = nullptr;
+    std::string first_text = text.substr(0, colon), second_text = text.substr(colon + 1);
+    first = std::strtoull(first_text.c_str(), &end_first, 10);
+    second = std::strtoull(second_text.c_str(), &end_second, 10);
+    return std::isdigit(static_cast<unsigned char>(first_text[0])) && std::isdigit(static_cast<unsigned char>(second_text[0]))
+           && *end_first == '\0' && *end_second == '\0';
+}
+
+// Lee los umbrales de promoción `optimizar:compilar`, como `100:10000`.
+bool parse_tiers(const std::string& text, clex::TierThresholds& thresholds) {
+    return parse_pair(text, thresholds.optimize, thresholds.native);
+}
+
+// Lee las opciones de los lotes `tamaño:espera`, con la espera en microsegundos, como `64:50`.
+bool parse_batching(const std::string& text, clex::ShmBatching& batching) {
+    uint64_t size = 0;
+    if(!parse_pair(text, size, batching.max_delay_us) || size == 0 || size > clex::ShmBatching().max_size) {
+        return false;
+    }
+    batching.max_size = static_cast<uint32_t>(size);
+    return true;
+}
+
+const char* tier_name(clex::ExecutionTier tier) {
+    switch(tier) {
+      case clex::ExecutionTier::INTERPRETED: return "interpretada";
+      case clex::ExecutionTier::OPTIMIZED: return "optimizada";
+      case clex::ExecutionTier::NATIVE: return "nativa";
+    }
+    return "";
+}
+
+// Servidor por memoria compartida: `calculexdora --serve-shm /nombre [--native dir] [--tiers optimizar:compilar] 
+// [--batch tamaño:espera] "<expresión>" ...` escribe una línea `identificador: variables` por expresión y atiende 
+// peticiones de `clex::ShmClient` hasta que un cliente lo detiene. Cada expresión pasa a optimizarse y a compilarse 
+// (con `--native`) tras el número de peticiones indicado en `--tiers`, y mientras no se compila, se especializa para
+// las variables que repiten valor en muchas peticiones seguidas. Las peticiones se evalúan en lotes de hasta 
+// `tamaño` (64 por defecto), esperando como mucho `espera` microsegundos (0 por defecto) a que se completen; al 
+// terminar, se escriben en la salida de errores las estadísticas de cada expresión y de los lotes.
+int run_shm_server(const std::vector<std::string>& args) {
+    std::string native_dir;
+    clex::TierThresholds thresholds;
+    clex::ShmBatching batching;
+    std::vector<std::string> expr_texts;
+    for(size_t i = 2; i < args.size(); i++) {
+        if(args[i] == "--native" && i + 1 < args.size()) {
+            native_dir = args[++i];
+        } else if(args[i] == "--tiers") {
+            if(i + 1 == args.size() || !parse_tiers(args[i + 1], thresholds)) {
+                std::cerr << "Umbrales inválidos, el formato es --tiers optimizar:compilar\n";
+                return 2;
+            }
+            i++;
+        } else if(args[i] == "--batch") {
+            if(i + 1 == args.size() || !parse_batching(args[i + 1], batching)) {
+                std::cerr << "Lotes inválidos, el formato es --batch tamaño:microsegundos, con un tamaño entre 1 y "
+                          << clex::ShmBatching().max_size << "\n";
+                return 2;
+            }
+            i++;
+        } else {
+            expr_texts.push_back(args[i]);
+        }
+    }
+    if(args.size() < 2 || expr_texts.empty()) {
+        std::cerr << "Uso: calculexdora --serve-shm /nombre [--native directorio] [--tiers optimizar:compilar] "
+                  << "[--batch tamaño:microsegundos] \"<expresión>\" ...\n";
+        return 2;
+    }
+    try {
+        std::vector<clex::Expression> exprs;
+        for(const std::string& text : expr_texts) {
+            clex::Parser parser(clex::tokenize(text));
+            auto statement = parser.parse_next_statement();
+            if(!statement.is_expression()) {
+                std::cerr << "ERROR: el servidor necesita expresiones, no asignaciones\n";
+                return 2;
+            }
+            exprs.push_back(statement.move_as_expression());
+        }
+        clex::ShmServer server(args[1], exprs, clex::SymbolTable(), native_dir, thresholds, batching);
+        for(size_t id = 0; id < server.formulas().size(); id++) {
+            std::cout << id << ":";
+            for(const clex::Token& var : server.formulas()[id].variables) {
+                std::cout << " " << *var.get_ident();
+            }
+            std::cout << (server.formulas()[id].engine->tier() == clex::ExecutionTier::NATIVE ? " (nativa)" : "") << "\n";
+        }
+        std::cout.flush();
+        server.serve();
+        for(size_t id = 0; id < server.formulas().size(); id++) {
+            clex::TierStatistics stats = server.formulas()[id].engine->statistics();
+            std::cerr << id << ": " << tier_name(stats.tier) << ", peticiones " << stats.evaluations[0] << " interpretadas, "
+                      << stats.evaluations[1] << " optimizadas y " << stats.evaluations[2] << " nativas"
+                      << (stats.native_failed ? ", no se ha podido compilar" : "");
+            if(stats.tier == clex::ExecutionTier::NATIVE) {
+                std::cerr << ", compilada en " << stats.build_seconds[2] << " s";
+            }
+            if(stats.speculation.specializations > 0) {
+                std::cerr << ", especializada " << stats.speculation.specializations << " veces para "
+                          << stats.speculation.specialized_evaluations << " peticiones";
+            }
+            std::cerr << "\n";
+        }
+        clex::ShmBatchStatistics batches = server.batch_statistics();
+        std::cerr << "Lotes: " << batches.batches << " con " << batches.requests << " peticiones (media "
+                  << (batches.batches > 0 ? static_cast<double>(batches.requests) / static_cast<double>(batches.batches) : 0.0)
+                  << ", mayor " << batches.largest << "), " << batches.grouped << " evaluadas junto con otras de la misma "
+                  << "expresión, " << batches.wait_seconds << " s esperando a completar lotes\n";
+    } catch (const clex::ParserError& e) {
+        std::cerr << "ERROR DE SINTAXIS: ";
+        e.print_to(std::cerr);
+        std::cerr << "\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Lee un valor inicial `nombre=valor`, como `y=1.5`.
+bool parse_state(const std::string& text, std::string& name, double& value) {
+    size_t eq = text.find('=');
+    if(eq == std::string::npos || eq == 0 || eq + 1 == text.size()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str() + eq + 1, &end);
+    name = text.substr(0, eq);
+    return *end == '\0';
+}
+
+// Integración de ecuaciones diferenciales: `calculexdora --ode --time t=t0:t1:puntos --state y=y0 "<derivada de y>" ...
+// [--step h] [--rtol r] [--atol a] [--native dir]` integra el sistema con RK45 (o con RK4 de paso `h`, con `--step`) y 
+// escribe una tabla CSV con el tiempo y el estado en `puntos` tiempos equiespaciados entre `t0` y `t1`, fila a fila.
+int run_ode(const std::vector<std::string>& args) {
+    std::vector<clex::SweepAxis> time_axis;
+    std::vector<std::string> names, rhs_texts;
+    std::vector<double> initial;
+    std::string native_dir;
+    clex::OdeOptions options;
+    bool valid = true;
+    for(size_t i = 1; i < args.size() && valid; i++) {
+        const std::string& arg = args[i];
+        char* end = nullptr;
+        double number = i + 1 < args.size() ? std::strtod(args[i + 1].c_str(), &end) : 0.0;
+        bool positive_number = i + 1 < args.size() && number > 0.0 && *end == '\0';
+        if(arg == "--time") {
+            valid = time_axis.empty() && i + 1 < args.size() && parse_axis(args[++i], time_axis);
+        } else if(arg == "--state") {
+            std::string name;
+            double value = 0.0;
+            valid = i + 2 < args.size() && parse_state(args[i + 1], name, value);
+            names.push_back(name);
+            initial.push_back(value);
+            if(valid) {
+                rhs_texts.push_back(args[i + 2]);
+            }
+            i += 2;
+        } else if(arg == "--step" && positive_number) {
+            options.method = clex::OdeMethod::RK4;
+            options.step = number;
+            i++;
+        } else if(arg == "--rtol" && positive_number) {
+            options.relative_tolerance = number;
+            i++;
+        } else if(arg == "--atol" && positive_number) {
+            options.absolute_tolerance = number;
+            i++;
+        } else if(arg == "--native" && i + 1 < args.size()) {
+            native_dir = args[++i];
+        } else {
+            valid = false;
+        }
+    }
+    if(!valid || time_axis.empty() || names.empty()) {
+        std::cerr << "Uso: calculexdora --ode --time t=inicio:fin:puntos --state y=valor_inicial \"<derivada de y>\" ... "
+                     "[--step h] [--rtol r] [--atol a] [--native directorio]\n";
+        return 2;
+    }
+    try {
+        std::vector<clex::Expression> rhs;
+        std::vector<clex::Token> states;
+        for(size_t i = 0; i < names.size(); i++) {
+            clex::Parser parser(clex::tokenize(rhs_texts[i]));
+            auto statement = parser.parse_next_statement();
+            if(!statement.is_expression()) {
+                std::cerr << "ERROR: las derivadas deben ser expresiones, no asignaciones\n";
+                return 2;
+            }
+            rhs.push_back(statement.move_as_expression());
+            states.push_back(clex::Token::identifier(names[i]));
+        }
+        const clex::SweepAxis& axis = time_axis.front();
+        clex::OdeSystem system(rhs, states, clex::Token::identifier(axis.name), clex::SymbolTable(), native_dir);
+        if(!native_dir.empty() && !system.is_native()) {
+            std::cerr << "Aviso: alguna derivada no se ha podido compilar; se usa el intérprete para ella\n";
+        }
+        std::vector<double> times(axis.points);
+        for(uint64_t i = 0; i < axis.points; i++) {
+            times[i] = axis.value(i);
+        }
+        std::cout << axis.name;
+        for(const std::string& name : names) {
+            std::cout << "," << name;
+        }
+        std::cout << "\n";
+        std::cout.precision(std::numeric_limits<double>::max_digits10);
+        clex::integrate_ode(system, axis.lo, initial, times, options, [](double t, const std::vector<double>& y) {
+            std::cout << t;
+            for(double value : y) {
+                std::cout << "," << value;
+            }
+            std::cout << "\n";
+        });
+    } catch (const clex::ParserError& e) {
+        std::cerr << "ERROR DE SINTAXIS: ";
+        e.print_to(std::cerr);
+        std::cerr << "\n";
+        return 1;
+    } catch (const clex::EvalError& e) {
+        std::cerr << "ERROR DE EVALUACIÓN: ";
+        e.print_to(std::cerr);
+        std::cerr << "\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && std::string(argv[1]) == "--serve-shm") {
+        return run_shm_server(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    if(argc > 1 && std::string(argv[1]) == "--ode") {
+        return run_ode(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    if(argc > 1) {
+        return run_batch(std::vector<std::string>(argv + 1, argv + argc));
+    }
+
     clex::SymbolTable symbols; 
     std::string input_line;
 
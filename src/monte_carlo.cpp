@@ -0,0 +1,85 @@
+#include "monte_carlo.hpp"
+#include "random.hpp"
+#include "statistics.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr uint64_t BLOCK_SIZE = 4096; // muestras por bloque; no depende del número de hilos
+
+thread_local bool t_inside_worker = false; // evita lanzar hilos desde un `mc` anidado dentro de otro
+
+}
+
+MonteCarloResult monte_carlo(const Expression& body, const SymbolTable& symbols, uint64_t samples) {
+    uint64_t key = current_random_stream().next_u64();
+    uint64_t n_blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<RunningStats> block_stats(n_blocks);
+    std::atomic<uint64_t> next_block{0};
+
+    unsigned n_threads = t_inside_worker ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    n_threads = static_cast<unsigned>(std::min<uint64_t>(n_threads, n_blocks));
+    std::vector<std::exception_ptr> errors(n_threads);
+    // `body` puede usar nombres definidos por un `let` de fuera, que los demás hilos tienen que ver igual
+    std::vector<double> locals = current_local_slots();
+
+    auto worker = [&](unsigned thread_idx) {
+        bool was_inside_worker = t_inside_worker;
+        t_inside_worker = true;
+        if(thread_idx != 0) {
+            current_local_slots() = locals;
+        }
+        try {
+            uint64_t block;
+            while((block = next_block.fetch_add(1)) < n_blocks) {
+                uint64_t first = block * BLOCK_SIZE;
+                uint64_t last = std::min(first + BLOCK_SIZE, samples);
+                RunningStats stats;
+                for(uint64_t i = first; i < last; i++) {
+                    ScopedRandomStream stream(RandomStream(key, i));
+                    stats.push(body.evaluate(symbols));
+                }
+                block_stats[block] = stats;
+            }
+        } catch(...) {
+            errors[thread_idx] = std::current_exception();
+            next_block.store(n_blocks); // el resto de hilos deja de coger bloques
+        }
+        t_inside_worker = was_inside_worker;
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < n_threads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    for(std::exception_ptr& error : errors) {
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    RunningStats total;
+    for(const RunningStats& stats : block_stats) {
+        total.merge(stats);
+    }
+    return MonteCarloResult {
+        total.mean(),
+        std::sqrt(total.variance() / static_cast<double>(total.count()))
+    };
+}
+
+} // namespace clex
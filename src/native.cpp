@@ -0,0 +1,887 @@
+#include "native.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+// Se incluye en el código generado, así que cambiarla invalida todas las bibliotecas de la caché.
+constexpr int NATIVE_FORMAT_VERSION = 1;
+
+constexpr const char* KERNEL_FLAGS = "-O3 -fno-math-errno -fno-trapping-math";
+#if defined(__x86_64__) && defined(__GLIBC__)
+constexpr const char* KERNEL_LIBS = " -lmvec"; // variantes vectoriales de las funciones matemáticas
+#else
+constexpr const char* KERNEL_LIBS = "";
+#endif
+
+// Evaluación de polinomios idéntica a `PolynomialExpression::evaluate()`, para obtener los mismos resultados. La
+// versión para `float` la usa el núcleo de precisión simple.
+constexpr const char* NATIVE_PRELUDE = R"(#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+inline double mul_add(double a, double b, double c) noexcept {
+#ifdef FP_FAST_FMA
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+inline float mul_add(float a, float b, float c) noexcept {
+#ifdef FP_FAST_FMAF
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+template<typename T>
+inline T polynomial(T* c, std::size_t n, T x, std::size_t estrin_min_degree) noexcept {
+    if(n - 1 < estrin_min_degree) {
+        T result = c[n - 1];
+        for(std::size_t k = n - 1; k-- > 0;) {
+            result = mul_add(result, x, c[k]);
+        }
+        return result;
+    }
+    T power = x;
+    while(n > 1) {
+        for(std::size_t i = 0; i < n / 2; i++) {
+            c[i] = mul_add(c[2 * i + 1], power, c[2 * i]);
+        }
+        if(n % 2 == 1) {
+            c[n / 2] = c[n - 1];
+        }
+        n = (n + 1) / 2;
+        power *= power;
+    }
+    return c[0];
+}
+
+}
+)";
+
+/**
+ * Se añade al código generado cuando incluye alguno de los núcleos por columnas. `select` elige sin saltos, que el
+ * compilador no siempre consigue con `?:`, salvo en precisión doble: con SSE2 las máscaras de 64 bits de las
+ * comparaciones no se pueden pasar a enteros, y con `?:` el compilador las usa directamente. Las declaraciones de las funciones matemáticas de `float` con `simd`
+ * permiten vectorizarlas con las variantes de libmvec (glibc 2.35 o posterior en x86-64). Las de `double` no se
+ * declaran así, porque sus variantes vectoriales no dan exactamente los mismos resultados que las escalares.
+ */
+constexpr const char* KERNEL_PRELUDE = R"(#include <cstring>
+
+#if defined(__x86_64__) && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 35)
+extern "C" {
+__attribute__((simd("notinbranch"))) float sinf(float) noexcept;
+__attribute__((simd("notinbranch"))) float cosf(float) noexcept;
+__attribute__((simd("notinbranch"))) float tanf(float) noexcept;
+__attribute__((simd("notinbranch"))) float asinf(float) noexcept;
+__attribute__((simd("notinbranch"))) float acosf(float) noexcept;
+__attribute__((simd("notinbranch"))) float atanf(float) noexcept;
+__attribute__((simd("notinbranch"))) float logf(float) noexcept;
+__attribute__((simd("notinbranch"))) float powf(float, float) noexcept;
+}
+#endif
+
+namespace {
+
+inline float select(bool condition, float if_true, float if_false) noexcept {
+    std::uint32_t a, b;
+    std::memcpy(&a, &if_true, sizeof(a));
+    std::memcpy(&b, &if_false, sizeof(b));
+    std::uint32_t mask = -static_cast<std::uint32_t>(condition);
+    std::uint32_t bits = (a & mask) | (b & ~mask);
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+inline double select(bool condition, double if_true, double if_false) noexcept {
+    return condition ? if_true : if_false;
+}
+
+}
+)";
+
+// Literal de C++ que representa exactamente `value`.
+std::string literal(double value) {
+    if(value != value) {
+        return "__builtin_nan(\"\")";
+    }
+    if(std::isinf(value)) {
+        return value > 0.0 ? "__builtin_inf()" : "(-__builtin_inf())";
+    }
+    std::ostringstream out;
+    out << std::hexfloat << value;
+    return value < 0.0 ? "(" + out.str() + ")" : out.str();
+}
+
+// Literal de C++ de tipo `float` que representa exactamente `value` redondeado a `float`.
+std::string float_literal(double value) {
+    float rounded = static_cast<float>(value);
+    if(rounded != rounded) {
+        return "__builtin_nanf(\"\")";
+    }
+    if(std::isinf(rounded)) {
+        return rounded > 0.0f ? "__builtin_inff()" : "(-__builtin_inff())";
+    }
+    std::ostringstream out;
+    out << std::hexfloat << static_cast<double>(rounded) << "f";
+    return rounded < 0.0f ? "(" + out.str() + ")" : out.str();
+}
+
+// FNV-1a de 64 bits.
+uint64_t checksum(const std::string& text) noexcept {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string shell_quoted(const std::string& path) {
+    std::string result = "'";
+    for(char c : path) {
+        result += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return result + "'";
+}
+
+/**
+ * Traduce una expresión a una secuencia de sentencias de C++, con un temporal por nodo. Las comprobaciones
+ * de dominio que fallan, y las variables que no están definidas, terminan la función con `return 1`.
+ *
+ * Para los núcleos por columnas (`vectorized`), el código se calcula para una fila dentro de un bucle sobre todas,
+ * en `float` o en `double` según `single`, sin saltos para que el compilador lo pueda vectorizar: las dos ramas de
+ * los condicionales y de `&&` y `||` se calculan siempre, y una comprobación que falla marca la fila en `failed`
+ * solo si la rama en la que está es la que se usa (la máscara `m_mask`).
+ */
+class SourceEmitter {
+  private:
+    std::unordered_map<std::string, size_t> m_slots;
+    const SymbolTable& m_constants;
+    bool m_vectorized;
+    bool m_single;
+    std::ostringstream m_body;
+    size_t m_temporaries = 0;
+    size_t m_depth = 1;
+    std::string m_mask; // condición para que la rama actual se use, o vacía si se usa siempre
+    std::string m_fail = "fail"; // en los núcleos por columnas, indicador de fallo de la expresión actual
+    std::unordered_map<std::string, std::string> m_values; // en los núcleos por columnas, temporal de cada valor ya calculado
+    size_t m_reused = 0;
+    std::vector<std::string> m_locals; // valor de cada posición local de los `let` que contienen el nodo actual
+
+    std::ostream& line() {
+        return m_body << std::string(4 * m_depth, ' ');
+    }
+
+    std::string temporary() {
+        return "t" + std::to_string(m_temporaries++);
+    }
+
+    const char* type() const noexcept {
+        return m_single ? "float" : "double";
+    }
+
+    std::string number(double value) const {
+        return m_single ? float_literal(value) : literal(value);
+    }
+
+    // `condition ? if_true : if_false`, sin saltos en el núcleo vectorizado.
+    std::string choose(const std::string& condition, const std::string& if_true, const std::string& if_false) const {
+        if(m_vectorized) {
+            return "select(" + condition + ", " + if_true + ", " + if_false + ")";
+        }
+        return condition + " ? " + if_true + " : " + if_false;
+    }
+
+    std::string identifier(const Token& tok) {
+        std::string name = *tok.get_ident();
+        auto slot = m_slots.find(name);
+        if(slot != m_slots.end()) {
+            return m_vectorized ? "c" + std::to_string(slot->second) + "[row]" : "slots[" + std::to_string(slot->second) + "]";
+        }
+        std::optional<double> value = m_constants.get(tok);
+        if(!value.has_value()) {
+            if(m_vectorized) {
+                fail_if("true"); // variable no definida
+            } else {
+                line() << "return 1; // variable '" << name << "' no definida\n";
+            }
+            return number(0.0);
+        }
+        return number(*value);
+    }
+
+    // En los núcleos por columnas no hay bloques, así que un valor que ya se ha calculado en la fila, en esta o en
+    // otra expresión, se reutiliza; las comprobaciones de dominio se emiten igualmente en cada uso.
+    std::string declare(const std::string& value) {
+        if(m_vectorized) {
+            auto [it, inserted] = m_values.try_emplace(value);
+            if(!inserted) {
+                m_reused++;
+                return it->second;
+            }
+            it->second = temporary();
+            line() << type() << " " << it->second << " = " << value << ";\n";
+            return it->second;
+        }
+        std::string name = temporary();
+        line() << type() << " " << name << " = " << value << ";\n";
+        return name;
+    }
+
+    void fail_if(const std::string& condition) {
+        if(!m_vectorized) {
+            line() << "if(" << condition << ") return 1;\n";
+        } else if(m_mask.empty()) {
+            line() << m_fail << " |= " << condition << ";\n";
+        } else {
+            line() << m_fail << " |= " << m_mask << " & (" << condition << ");\n";
+        }
+    }
+
+    // Máscara de la rama actual restringida a las filas en las que `condition` es cierta.
+    std::string restrict_mask(const std::string& condition) {
+        std::string mask = temporary();
+        line() << "bool " << mask << " = " << (m_mask.empty() ? condition : m_mask + " & " + condition) << ";\n";
+        return mask;
+    }
+
+    // Emite `expr` dentro de un bloque y asigna su valor a `target`, declarado fuera del bloque.
+    void emit_into(const std::string& target, const Expression& expr) {
+        m_depth++;
+        std::string value = emit(expr);
+        line() << target << " = " << value << ";\n";
+        m_depth--;
+    }
+
+    // Emite `expr` sin saltos, con las comprobaciones limitadas a las filas en las que `condition` es cierta.
+    std::string emit_masked(const std::string& condition, const Expression& expr) {
+        std::string saved = m_mask;
+        m_mask = restrict_mask(condition);
+        std::string value = emit(expr);
+        m_mask = saved;
+        return value;
+    }
+
+    std::string emit_bin_op(const BinOpExpression& bin_op) {
+        auto [lhs_expr, rhs_expr] = bin_op.get_operands();
+        TokenType oper = bin_op.get_operator().type();
+        std::string lhs = emit(lhs_expr);
+        std::string zero = number(0.0), one = number(1.0);
+        if((oper == TokenType::OP_AND || oper == TokenType::OP_OR) && m_vectorized) {
+            std::string uses_rhs = temporary();
+            line() << "bool " << uses_rhs << " = " << lhs << (oper == TokenType::OP_AND ? " != " : " == ") << zero << ";\n";
+            std::string rhs = emit_masked(uses_rhs, rhs_expr);
+            std::string rhs_value = choose(rhs + " != " + zero, one, zero);
+            return declare(choose(uses_rhs, rhs_value, oper == TokenType::OP_AND ? zero : one));
+        }
+        if(oper == TokenType::OP_AND || oper == TokenType::OP_OR) {
+            // cortocircuito, como en `BinOpExpression::evaluate()`
+            std::string result = declare(oper == TokenType::OP_AND ? zero : one);
+            std::string rhs = temporary();
+            line() << "if(" << lhs << (oper == TokenType::OP_AND ? " != " : " == ") << zero << ") {\n";
+            m_depth++;
+            line() << type() << " " << rhs << ";\n";
+            m_depth--;
+            emit_into(rhs, rhs_expr);
+            m_depth++;
+            line() << result << " = " << rhs << " != " << zero << " ? " << one << " : " << zero << ";\n";
+            m_depth--;
+            line() << "}\n";
+            return result;
+        }
+        std::string rhs = emit(rhs_expr);
+        auto boolean = [&](const char* comparison) { return choose(lhs + comparison + rhs, one, zero); };
+        switch(oper) {
+          case TokenType::OP_PLUS: return declare(lhs + " + " + rhs);
+          case TokenType::OP_MINUS: return declare(lhs + " - " + rhs);
+          case TokenType::OP_ASTERISK: return declare(lhs + " * " + rhs);
+          case TokenType::OP_SLASH: {
+            if(bin_op.is_domain_checked()) {
+                fail_if(rhs + " == " + zero);
+            }
+            return declare(lhs + " / " + rhs);
+          }
+          case TokenType::OP_CARET: {
+            std::string result = declare("std::pow(" + lhs + ", " + rhs + ")");
+            if(bin_op.is_domain_checked()) {
+                fail_if(result + " != " + result);
+            }
+            return result;
+          }
+          case TokenType::OP_LESS: return declare(boolean(" < "));
+          case TokenType::OP_LESS_EQ: return declare(boolean(" <= "));
+          case TokenType::OP_GREATER: return declare(boolean(" > "));
+          case TokenType::OP_GREATER_EQ: return declare(boolean(" >= "));
+          case TokenType::OP_EQUAL: return declare(boolean(" == "));
+          case TokenType::OP_NOT_EQUAL: return declare(boolean(" != "));
+          default: __builtin_unreachable();
+        }
+    }
+
+    std::string emit_unary_op(const UnaryOpExpression& unary) {
+        std::string arg = emit(unary.get_operand());
+        bool checked = unary.is_domain_checked();
+        std::string zero = number(0.0), one = number(1.0), minus_one = number(-1.0);
+        switch(unary.get_operator().type()) {
+          case TokenType::OP_MINUS: return declare("-" + arg);
+          case TokenType::OP_PLUS: return arg;
+          case TokenType::OP_NOT: return declare(choose(arg + " == " + zero, one, zero));
+          case TokenType::OP_FUNC_SQRT: {
+            if(checked) fail_if(arg + " < " + zero);
+            return declare("std::sqrt(" + arg + ")");
+          }
+          case TokenType::OP_FUNC_LOG: {
+            if(checked) fail_if(arg + " <= " + zero);
+            return declare("std::log(" + arg + ")");
+          }
+          case TokenType::OP_FUNC_SIN: return declare("std::sin(" + arg + ")");
+          case TokenType::OP_FUNC_COS: return declare("std::cos(" + arg + ")");
+          case TokenType::OP_FUNC_TAN: return declare("std::tan(" + arg + ")");
+          case TokenType::OP_FUNC_ARCSIN: {
+            if(checked) fail_if(arg + " < " + minus_one + " || " + arg + " > " + one);
+            return declare("std::asin(" + arg + ")");
+          }
+          case TokenType::OP_FUNC_ARCCOS: {
+            if(checked) fail_if(arg + " < " + minus_one + " || " + arg + " > " + one);
+            return declare("std::acos(" + arg + ")");
+          }
+          case TokenType::OP_FUNC_ARCTAN: return declare("std::atan(" + arg + ")");
+          default: __builtin_unreachable();
+        }
+    }
+
+    std::string emit_conditional(const ConditionalExpression& conditional) {
+        auto [if_true, if_false] = conditional.get_branches();
+        std::string condition = emit(conditional.get_condition());
+        if(m_vectorized) {
+            std::string taken = temporary();
+            line() << "bool " << taken << " = " << condition << " != " << number(0.0) << ";\n";
+            std::string true_value = emit_masked(taken, if_true);
+            std::string false_value = emit_masked("!" + taken, if_false);
+            return declare(choose(taken, true_value, false_value));
+        }
+        std::string result = temporary();
+        line() << "double " << result << ";\n";
+        line() << "if(" << condition << " != 0.0) {\n";
+        emit_into(result, if_true);
+        line() << "} else {\n";
+        emit_into(result, if_false);
+        line() << "}\n";
+        return result;
+    }
+
+    // En el núcleo vectorizado, el polinomio se desarrolla con los mismos pasos que `polynomial()`, ya que el
+    // compilador no vectoriza bien un vector local por fila.
+    std::string emit_unrolled_polynomial(const PolynomialExpression& polynomial, const std::string& x) {
+        std::vector<std::string> c;
+        for(double coefficient : polynomial.get_coefficients()) {
+            c.push_back(number(coefficient));
+        }
+        for(const auto& [degree, coefficient] : polynomial.get_symbolic_coefficients()) {
+            std::string value = emit(*coefficient);
+            c[degree] = declare(c[degree] + " + " + value);
+        }
+        size_t n = c.size();
+        if(n - 1 < PolynomialExpression::ESTRIN_MIN_DEGREE) {
+            std::string result = c[n - 1];
+            for(size_t k = n - 1; k-- > 0;) {
+                result = declare("mul_add(" + result + ", " + x + ", " + c[k] + ")");
+            }
+            return result;
+        }
+        std::string power = x;
+        while(n > 1) {
+            for(size_t i = 0; i < n / 2; i++) {
+                c[i] = declare("mul_add(" + c[2 * i + 1] + ", " + power + ", " + c[2 * i] + ")");
+            }
+            if(n % 2 == 1) {
+                c[n / 2] = c[n - 1];
+            }
+            n = (n + 1) / 2;
+            if(n > 1) {
+                power = declare(power + " * " + power);
+            }
+        }
+        return c[0];
+    }
+
+    std::string emit_polynomial(const PolynomialExpression& polynomial) {
+        std::string x = identifier(polynomial.get_variable());
+        if(m_vectorized) {
+            std::string result = emit_unrolled_polynomial(polynomial, x);
+            fail_if(result + " != " + result);
+            return result;
+        }
+        const std::vector<double>& coefficients = polynomial.get_coefficients();
+        std::string c = temporary();
+        line() << type() << " " << c << "[] = {";
+        for(size_t k = 0; k < coefficients.size(); k++) {
+            m_body << (k > 0 ? ", " : "") << number(coefficients[k]);
+        }
+        m_body << "};\n";
+        for(const auto& [degree, coefficient] : polynomial.get_symbolic_coefficients()) {
+            std::string value = emit(*coefficient);
+            line() << c << "[" << degree << "] += " << value << ";\n";
+        }
+        std::string result = declare(
+            "polynomial(" + c + ", " + std::to_string(coefficients.size()) + ", " + x + ", "
+            + std::to_string(PolynomialExpression::ESTRIN_MIN_DEGREE) + ")"
+        );
+        fail_if(result + " != " + result); // el intérprete evalúa la expresión original
+        return result;
+    }
+    // La tabla se emite como un vector estático y se evalúa con las mismas operaciones que 
+    // `PiecewisePolynomial::evaluate()`. Fuera de su intervalo, el intérprete evalúa la expresión original.
+    std::string emit_approximation(const ApproximationExpression& approximation) {
+        if(m_vectorized && m_single) { // el acceso a la tabla por fila no se vectoriza, así que se calcula la expresión original
+            return emit(approximation.get_original());
+        }
+        if(m_vectorized) { // en precisión doble se debe dar lo mismo que con la tabla, así que la fila se evalúa aparte
+            fail_if("true");
+            return number(0.0);
+        }
+        const PiecewisePolynomial& table = approximation.get_table();
+        std::string x = identifier(approximation.get_variable());
+        fail_if("!(" + x + " >= " + number(table.lo()) + " && " + x + " <= " + number(table.hi()) + ")");
+        const std::vector<double>& coefficients = table.coefficients();
+        std::string c = temporary();
+        line() << "static const double " << c << "[] = {";
+        for(size_t k = 0; k < coefficients.size(); k++) {
+            m_body << (k > 0 ? ", " : "") << number(coefficients[k]);
+        }
+        m_body << "};\n";
+        std::string u = declare("(" + x + " - " + number(table.lo()) + ") * " + number(table.scale()));
+        std::string piece = temporary();
+        line() << "std::size_t " << piece << " = static_cast<std::size_t>(" << u << ");\n";
+        line() << "if(" << piece << " > " << table.pieces() - 1 << "u) " << piece << " = " << table.pieces() - 1 << "u;\n";
+        std::string t = declare(number(2.0) + " * (" + u + " - static_cast<double>(" + piece + ")) - " + number(1.0));
+        std::string first = temporary();
+        size_t degree = table.degree();
+        line() << "const double* " << first << " = " << c << " + " << piece << " * " << degree + 1 << ";\n";
+        std::string result = first + "[" + std::to_string(degree) + "]";
+        for(size_t k = degree; k-- > 0;) {
+            result = declare("mul_add(" + result + ", " + t + ", " + first + "[" + std::to_string(k) + "])");
+        }
+        return result;
+    }
+  public:
+    SourceEmitter(const std::vector<Token>& slots, const SymbolTable& constants, bool vectorized = false,
+                  bool single = false, size_t depth = 1)
+        : m_slots(), m_constants(constants), m_vectorized(vectorized), m_single(single), m_depth(depth) {
+        for(size_t i = 0; i < slots.size(); i++) {
+            m_slots.emplace(*slots[i].get_ident(), i);
+        }
+    }
+
+    std::string emit(const Expression& expr) {
+        switch(expr.type()) {
+          case ExpressionType::OPERAND: {
+            const Token& tok = expr.get_token();
+            return tok.type() == TokenType::NUMBER ? number(*tok.get_num()) : identifier(tok);
+          }
+          case ExpressionType::BIN_OP: return emit_bin_op(expr.as_bin_op());
+          case ExpressionType::UNARY_OP: return emit_unary_op(expr.as_unary_op());
+          case ExpressionType::CONDITIONAL: return emit_conditional(expr.as_conditional());
+          case ExpressionType::CALL: {
+            throw std::runtime_error("Las expresiones con rand, randn, mc o mcerr no se pueden compilar");
+          }
+          case ExpressionType::POLYNOMIAL: return emit_polynomial(expr.as_polynomial());
+          case ExpressionType::APPROXIMATION: return emit_approximation(expr.as_approximation());
+          case ExpressionType::LET: {
+            // el valor queda en un temporal (o es una constante o una columna), que el cuerpo usa directamente
+            const LetExpression& let = expr.as_let();
+            std::string value = emit(let.get_value());
+            if(let.get_slot() >= m_locals.size()) {
+                m_locals.resize(let.get_slot() + 1);
+            }
+            m_locals[let.get_slot()] = value;
+            return emit(let.get_body());
+          }
+          case ExpressionType::LOCAL: {
+            size_t slot = expr.as_local().get_slot();
+            if(slot >= m_locals.size() || m_locals[slot].empty()) {
+                throw std::runtime_error("Los nombres locales definidos fuera de la expresión no se pueden compilar");
+            }
+            return m_locals[slot];
+          }
+        }
+        __builtin_unreachable();
+    }
+
+    // En los núcleos por columnas, emite una de las expresiones que se calculan en cada fila, con su propio
+    // indicador de fallo `fail`; si `expr` es nula, la expresión falla siempre.
+    std::string emit_output(const Expression* expr, const std::string& fail) {
+        line() << "bool " << fail << " = " << (expr == nullptr ? "true" : "false") << ";\n";
+        m_fail = fail;
+        m_mask.clear();
+        return expr == nullptr ? number(0.0) : emit(*expr);
+    }
+
+    std::string body() const {
+        return m_body.str();
+    }
+
+    // Número de valores que se han reutilizado en lugar de volver a calcularlos.
+    size_t reused() const noexcept {
+        return m_reused;
+    }
+};
+
+// Abre una biblioteca compilada y comprueba su suma; devuelve `nullptr` si no existe o no es la esperada.
+void* open_library(const std::string& path, uint64_t expected) {
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(handle == nullptr) {
+        return nullptr;
+    }
+    const uint64_t* stored = static_cast<const uint64_t*>(dlsym(handle, "clex_checksum"));
+    if(stored == nullptr || *stored != expected) {
+        dlclose(handle);
+        return nullptr;
+    }
+    return handle;
+}
+
+// Busca en la biblioteca la función `name`, que debe existir porque su suma coincide con la del código generado.
+template<typename Function>
+Function library_function(void* handle, const char* name) {
+    Function function = reinterpret_cast<Function>(dlsym(handle, name));
+    if(function == nullptr) {
+        dlclose(handle);
+        throw std::runtime_error(std::string("La biblioteca compilada no contiene ") + name);
+    }
+    return function;
+}
+
+/**
+ * Carga la biblioteca de `source` de la caché o, si no está o su suma no es la esperada, la compila. `vectorized`
+ * indica si el código tiene núcleos por columnas, y `float_kernel` si alguno es de precisión simple.
+ */
+void* load_library(const std::string& source, const std::string& cache_dir, bool vectorized, bool float_kernel) {
+    uint64_t sum = checksum(source);
+    std::ostringstream name;
+    name << cache_dir << "/clex_" << std::hex << std::setw(16) << std::setfill('0') << sum;
+    std::string source_path = name.str() + ".cpp", library_path = name.str() + ".so";
+    if(void* handle = open_library(library_path, sum)) {
+        return handle;
+    }
+
+    std::ofstream source_file(source_path);
+    source_file << source << "extern \"C\" const uint64_t clex_checksum = " << sum << "ULL;\n";
+    source_file.close();
+    if(!source_file) {
+        throw std::runtime_error("No se ha podido escribir " + source_path);
+    }
+    // Se compila a un fichero temporal y se renombra, para que otro proceso nunca abra una biblioteca a medias.
+    // Los núcleos por columnas necesitan -O3 para que se vectorice el bucle, y -fno-math-errno y
+    // -fno-trapping-math para que `std::sqrt` y las elecciones sin saltos no lo impidan; ninguna de estas opciones
+    // cambia los resultados, solo `errno` y las excepciones de coma flotante.
+    std::string temporary_path = library_path + ".tmp" + std::to_string(getpid());
+    const char* compiler = std::getenv("CXX");
+    std::string command = std::string(compiler != nullptr ? compiler : "c++") + " -std=c++17 " 
+        + (vectorized ? KERNEL_FLAGS : "-O2") + " -shared -fPIC -o "
+        + shell_quoted(temporary_path) + " " + shell_quoted(source_path) + (float_kernel ? KERNEL_LIBS : "")
+        + " 2> " + shell_quoted(name.str() + ".log");
+    if(std::system(command.c_str()) != 0 || std::rename(temporary_path.c_str(), library_path.c_str()) != 0) {
+        std::remove(temporary_path.c_str());
+        throw std::runtime_error("No se ha podido compilar " + source_path + ", los errores están en " + name.str() + ".log");
+    }
+    void* handle = open_library(library_path, sum);
+    if(handle == nullptr) {
+        const char* reason = dlerror();
+        throw std::runtime_error("No se ha podido cargar " + library_path + (reason != nullptr ? std::string(": ") + reason : std::string()));
+    }
+    return handle;
+}
+
+/**
+ * Emite el bucle de un núcleo por columnas que calcula todas las expresiones de `exprs` en cada fila, en `float` o
+ * en `double` según `single`. El resultado y el fallo de la expresión `k` en la fila `row` se guardan en
+ * `results[row * n + k]` y `failed[row * n + k]`, siendo `n` el número de expresiones: con un solo puntero para
+ * todas, el compilador sabe que las escrituras no se solapan y no tiene que comprobarlo para vectorizar. Las
+ * expresiones nulas fallan en todas las filas. Devuelve el número de valores que se reutilizan en cada fila.
+ */
+size_t emit_rows(std::ostream& source, bool single, const std::vector<const Expression*>& exprs,
+                 const std::vector<Token>& slots, const SymbolTable& constants) {
+    SourceEmitter kernel(slots, constants, true, single, single ? 2 : 3);
+    std::vector<std::string> values;
+    for(size_t k = 0; k < exprs.size(); k++) {
+        values.push_back(kernel.emit_output(exprs[k], "fail" + std::to_string(k)));
+    }
+    size_t n = exprs.size();
+    auto index = [&](const char* row, size_t k) {
+        return n == 1 ? std::string(row) : std::string(row) + " * " + std::to_string(n) + " + " + std::to_string(k);
+    };
+    if(single) {
+        source << "    for(std::size_t row = 0; row < rows; row++) {\n";
+        source << kernel.body();
+        for(size_t k = 0; k < n; k++) {
+            source << "        results[" << index("row", k) << "] = " << values[k] << ";\n";
+            source << "        failed[" << index("row", k) << "] = fail" << k << ";\n";
+        }
+        source << "    }\n";
+        return kernel.reused();
+    }
+    // Con SSE2 las máscaras de las comparaciones en precisión doble no se pueden pasar a bytes dentro del bucle
+    // vectorizado, así que las filas fallidas se marcan primero con `double` en bloques, y se copian después. Con
+    // muchas expresiones, los bloques se acortan para que los indicadores no ocupen demasiado.
+    size_t block = std::max<size_t>(32, 256 / n);
+    source << "    double flags[" << block * n << "];\n";
+    source << "    for(std::size_t first = 0; first < rows; first += " << block << ") {\n";
+    source << "        std::size_t last = rows - first < " << block << " ? rows : first + " << block << ";\n";
+    source << "        for(std::size_t row = first; row < last; row++) {\n";
+    source << kernel.body();
+    for(size_t k = 0; k < n; k++) {
+        source << "            results[" << index("row", k) << "] = " << values[k] << ";\n";
+        source << "            flags[" << index("(row - first)", k) << "] = fail" << k << " ? 1.0 : 0.0;\n";
+    }
+    source << "        }\n";
+    source << "        for(std::size_t i = " << index("first", 0) << "; i < " << index("last", 0) << "; i++) {\n";
+    source << "            failed[i] = flags[i - " << index("first", 0) << "] != 0.0;\n";
+    source << "        }\n";
+    source << "    }\n";
+    return kernel.reused();
+}
+
+// Emite las declaraciones de los punteros a las columnas de entrada, `c0`, `c1`, ...
+void emit_columns(std::ostream& source, const char* type, size_t n_columns) {
+    for(size_t i = 0; i < n_columns; i++) {
+        source << "    const " << type << "* __restrict c" << i << " = columns[" << i << "];\n";
+    }
+}
+
+// Emite la función `name`, que evalúa `expr` sobre columnas de `float` o de `double` (según `single`).
+void emit_kernel(std::ostream& source, const char* name, bool single, const Expression& expr,
+                 const std::vector<Token>& slots, const SymbolTable& constants) {
+    const char* type = single ? "float" : "double";
+    source << "\nextern \"C\" void " << name << "(const " << type << "* const* columns, std::size_t rows, " << type
+           << "* __restrict results, unsigned char* __restrict failed) {\n";
+    emit_columns(source, type, slots.size());
+    emit_rows(source, single, {&expr}, slots, constants);
+    source << "}\n";
+}
+
+// Si `expr` tiene alguna llamada a función, que no se puede compilar.
+bool has_call(const Expression& expr) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: return false;
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        return has_call(lhs) || has_call(rhs);
+      }
+      case ExpressionType::UNARY_OP: return has_call(expr.as_unary_op().get_operand());
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        return has_call(conditional.get_condition()) || has_call(if_true) || has_call(if_false);
+      }
+      case ExpressionType::CALL: return true;
+      case ExpressionType::POLYNOMIAL: {
+        for(const auto& [degree, coefficient] : expr.as_polynomial().get_symbolic_coefficients()) {
+            if(has_call(*coefficient)) {
+                return true;
+            }
+        }
+        return false;
+      }
+      case ExpressionType::APPROXIMATION: return has_call(expr.as_approximation().get_original());
+      case ExpressionType::LET: return has_call(expr.as_let().get_value()) || has_call(expr.as_let().get_body());
+      case ExpressionType::LOCAL: return false;
+    }
+    return false;
+}
+
+}
+
+std::string native_source(const Expression& expr, const std::vector<Token>& slots, const SymbolTable& constants, 
+                          bool float_kernel, bool double_kernel) {
+    SourceEmitter emitter(slots, constants);
+    std::string result = emitter.emit(expr);
+    std::ostringstream source;
+    source << "// Generado por calculexdora (formato " << NATIVE_FORMAT_VERSION << ")\n" << NATIVE_PRELUDE << "\n";
+    source << "extern \"C\" int clex_formula(const double* slots, double* result) {\n";
+    source << emitter.body();
+    source << "    *result = " << result << ";\n";
+    source << "    return 0;\n";
+    source << "}\n";
+    if(float_kernel || double_kernel) {
+        source << "\n" << KERNEL_PRELUDE;
+    }
+    if(float_kernel) {
+        emit_kernel(source, "clex_kernel_f32", true, expr, slots, constants);
+    }
+    if(double_kernel) {
+        emit_kernel(source, "clex_kernel_f64", false, expr, slots, constants);
+    }
+    return source.str();
+}
+
+NativeFormula::NativeFormula(void* handle, Function function, FloatKernel kernel, DoubleKernel double_kernel) noexcept
+    : m_handle(handle), m_function(function), m_kernel(kernel), m_double_kernel(double_kernel) {};
+
+NativeFormula NativeFormula::build(const Expression& expr, const std::vector<Token>& slots, const SymbolTable& constants,
+                                   const std::string& cache_dir, bool float_kernel, bool double_kernel) {
+    std::string source = native_source(expr, slots, constants, float_kernel, double_kernel);
+    void* handle = load_library(source, cache_dir, float_kernel || double_kernel, float_kernel);
+    Function function = library_function<Function>(handle, "clex_formula");
+    FloatKernel kernel = float_kernel ? library_function<FloatKernel>(handle, "clex_kernel_f32") : nullptr;
+    DoubleKernel double_kernel_function = double_kernel ? library_function<DoubleKernel>(handle, "clex_kernel_f64") : nullptr;
+    return NativeFormula(handle, function, kernel, double_kernel_function);
+}
+
+NativeFormula::NativeFormula(NativeFormula&& other) noexcept 
+    : m_handle(other.m_handle), m_function(other.m_function), m_kernel(other.m_kernel), m_double_kernel(other.m_double_kernel) {
+    other.m_handle = nullptr;
+    other.m_function = nullptr;
+    other.m_kernel = nullptr;
+    other.m_double_kernel = nullptr;
+}
+
+NativeFormula& NativeFormula::operator=(NativeFormula&& other) noexcept {
+    std::swap(m_handle, other.m_handle);
+    std::swap(m_function, other.m_function);
+    std::swap(m_kernel, other.m_kernel);
+    std::swap(m_double_kernel, other.m_double_kernel);
+    return *this;
+}
+
+NativeFormula::~NativeFormula() {
+    if(m_handle != nullptr) {
+        dlclose(m_handle);
+    }
+}
+
+bool NativeFormula::evaluate(const double* slots, double& result) const noexcept {
+    return m_function(slots, &result) == 0;
+}
+
+bool NativeFormula::has_float_kernel() const noexcept {
+    return m_kernel != nullptr;
+}
+
+void NativeFormula::evaluate_float(const float* const* columns, size_t rows, float* results, uint8_t* failed) const noexcept {
+    m_kernel(columns, rows, results, failed);
+}
+
+bool NativeFormula::has_double_kernel() const noexcept {
+    return m_double_kernel != nullptr;
+}
+
+void NativeFormula::evaluate_columns(const double* const* columns, size_t rows, double* results, uint8_t* failed) const noexcept {
+    m_double_kernel(columns, rows, results, failed);
+}
+
+std::string native_program_source(const std::vector<Expression>& exprs, const std::vector<Token>& slots,
+                                  const SymbolTable& constants, bool single, size_t* reused) {
+    const char* type = single ? "float" : "double";
+    std::vector<const Expression*> compiled;
+    for(const Expression& expr : exprs) {
+        compiled.push_back(has_call(expr) ? nullptr : &expr);
+    }
+    std::ostringstream source;
+    source << "// Generado por calculexdora (formato " << NATIVE_FORMAT_VERSION << ")\n" << NATIVE_PRELUDE << "\n";
+    source << KERNEL_PRELUDE;
+    source << "\nextern \"C\" void " << (single ? "clex_program_f32" : "clex_program_f64") << "(const " << type 
+           << "* const* columns, std::size_t rows, " << type << "* __restrict results, unsigned char* __restrict failed) {\n";
+    emit_columns(source, type, slots.size());
+    size_t count = emit_rows(source, single, compiled, slots, constants);
+    source << "}\n";
+    if(reused != nullptr) {
+        *reused = count;
+    }
+    return source.str();
+}
+
+NativeProgram::NativeProgram(void* handle, FloatKernel kernel, DoubleKernel double_kernel, std::vector<uint8_t>&& compiled,
+                             size_t reused) noexcept
+    : m_handle(handle), m_kernel(kernel), m_double_kernel(double_kernel), m_compiled(std::move(compiled)), m_reused(reused) {};
+
+NativeProgram NativeProgram::build(const std::vector<Expression>& exprs, const std::vector<Token>& slots,
+                                   const SymbolTable& constants, const std::string& cache_dir, bool single) {
+    if(exprs.empty()) {
+        throw std::invalid_argument("A native program needs at least one expression");
+    }
+    size_t reused = 0;
+    std::string source = native_program_source(exprs, slots, constants, single, &reused);
+    std::vector<uint8_t> compiled;
+    for(const Expression& expr : exprs) {
+        compiled.push_back(!has_call(expr));
+    }
+    void* handle = load_library(source, cache_dir, true, single);
+    FloatKernel kernel = single ? library_function<FloatKernel>(handle, "clex_program_f32") : nullptr;
+    DoubleKernel double_kernel = single ? nullptr : library_function<DoubleKernel>(handle, "clex_program_f64");
+    return NativeProgram(handle, kernel, double_kernel, std::move(compiled), reused);
+}
+
+NativeProgram::NativeProgram(NativeProgram&& other) noexcept 
+    : m_handle(other.m_handle), m_kernel(other.m_kernel), m_double_kernel(other.m_double_kernel),
+      m_compiled(std::move(other.m_compiled)), m_reused(other.m_reused) {
+    other.m_handle = nullptr;
+    other.m_kernel = nullptr;
+    other.m_double_kernel = nullptr;
+}
+
+NativeProgram& NativeProgram::operator=(NativeProgram&& other) noexcept {
+    std::swap(m_handle, other.m_handle);
+    std::swap(m_kernel, other.m_kernel);
+    std::swap(m_double_kernel, other.m_double_kernel);
+    std::swap(m_compiled, other.m_compiled);
+    std::swap(m_reused, other.m_reused);
+    return *this;
+}
+
+NativeProgram::~NativeProgram() {
+    if(m_handle != nullptr) {
+        dlclose(m_handle);
+    }
+}
+
+size_t NativeProgram::size() const noexcept {
+    return m_compiled.size();
+}
+
+bool NativeProgram::is_compiled(size_t k) const noexcept {
+    return m_compiled[k] != 0;
+}
+
+size_t NativeProgram::reused_values() const noexcept {
+    return m_reused;
+}
+
+bool NativeProgram::has_float_kernel() const noexcept {
+    return m_kernel != nullptr;
+}
+
+void NativeProgram::evaluate_float(const float* const* columns, size_t rows, float* results, uint8_t* failed) const noexcept {
+    m_kernel(columns, rows, results, failed);
+}
+
+void NativeProgram::evaluate_columns(const double* const* columns, size_t rows, double* results, uint8_t* failed) const noexcept {
+    m_double_kernel(columns, rows, results, failed);
+}
+
+} // namespace clex
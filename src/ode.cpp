@@ -0,0 +1,310 @@
+#include "ode.hpp"
+#include "eval_errors.hpp"
+#include "native.hpp"
+#include "polynomial.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+OdeSystem::OdeSystem(const std::vector<Expression>& rhs, const std::vector<Token>& states, const Token& time,
+                     const SymbolTable& symbols, const std::string& native_dir)
+    : m_rhs(), m_native(), m_slots(states), m_slot_values(states.size() + 1), m_symbols(symbols) {
+    if(rhs.empty() || rhs.size() != states.size()) {
+        throw std::invalid_argument("An ODE system needs one right-hand side per state variable");
+    }
+    m_slots.push_back(time);
+    for(const Expression& expr : rhs) {
+        m_rhs.push_back(rewrite_polynomials(expr));
+        m_native.emplace_back(std::nullopt);
+        if(!native_dir.empty()) {
+            try {
+                m_native.back().emplace(NativeFormula::build(m_rhs.back(), m_slots, symbols, native_dir));
+            } catch(const std::runtime_error&) {
+                // se usa el intérprete
+            }
+        }
+    }
+}
+
+size_t OdeSystem::dimension() const noexcept {
+    return m_rhs.size();
+}
+
+bool OdeSystem::is_native() const noexcept {
+    return std::all_of(m_native.begin(), m_native.end(), [](const std::optional<NativeFormula>& native) { return native.has_value(); });
+}
+
+void OdeSystem::derivatives(double t, const double* y, double* dy) {
+    size_t n = m_rhs.size();
+    std::copy(y, y + n, m_slot_values.begin());
+    m_slot_values[n] = t;
+    bool symbols_ready = false;
+    for(size_t i = 0; i < n; i++) {
+        if(m_native[i].has_value() && m_native[i]->evaluate(m_slot_values.data(), dy[i])) {
+            continue;
+        }
+        // el intérprete da el mismo error que el código nativo, o el resultado si éste no lo ha podido calcular
+        if(!symbols_ready) {
+            for(size_t j = 0; j <= n; j++) {
+                m_symbols.set(m_slots[j], m_slot_values[j]);
+            }
+            symbols_ready = true;
+        }
+        dy[i] = m_rhs[i].evaluate(m_symbols);
+    }
+}
+
+namespace {
+
+// Coeficientes de Dormand–Prince 5(4), con los de la salida densa de Hairer, Nørsett y Wanner.
+constexpr double C2 = 1.0 / 5.0, C3 = 3.0 / 10.0, C4 = 4.0 / 5.0, C5 = 8.0 / 9.0;
+constexpr double A21 = 1.0 / 5.0;
+constexpr double A31 = 3.0 / 40.0, A32 = 9.0 / 40.0;
+constexpr double A41 = 44.0 / 45.0, A42 = -56.0 / 15.0, A43 = 32.0 / 9.0;
+constexpr double A51 = 19372.0 / 6561.0, A52 = -25360.0 / 2187.0, A53 = 64448.0 / 6561.0, A54 = -212.0 / 729.0;
+constexpr double A61 = 9017.0 / 3168.0, A62 = -355.0 / 33.0, A63 = 46732.0 / 5247.0, A64 = 49.0 / 176.0,
+                 A65 = -5103.0 / 18656.0;
+constexpr double A71 = 35.0 / 384.0, A73 = 500.0 / 1113.0, A74 = 125.0 / 192.0, A75 = -2187.0 / 6784.0, A76 = 11.0 / 84.0;
+constexpr double E1 = 71.0 / 57600.0, E3 = -71.0 / 16695.0, E4 = 71.0 / 1920.0, E5 = -17253.0 / 339200.0,
+                 E6 = 22.0 / 525.0, E7 = -1.0 / 40.0;
+constexpr double D1 = -12715105075.0 / 11282082432.0, D3 = 87487479700.0 / 32700410799.0,
+                 D4 = -10690763975.0 / 1880347072.0, D5 = 701980252875.0 / 199316789632.0,
+                 D6 = -1453857185.0 / 822651844.0, D7 = 69997945.0 / 29380423.0;
+
+constexpr double SAFETY = 0.9;
+constexpr double MIN_FACTOR = 0.2;
+constexpr double MAX_FACTOR = 10.0;
+
+using OutputFunction = std::function<void(double, const std::vector<double>&)>;
+
+[[noreturn]] void throw_too_many_steps(const OdeOptions& options) {
+    throw std::runtime_error("Se ha superado el número máximo de pasos de integración ("
+                             + std::to_string(options.max_steps) + ")");
+}
+
+void count_step(uint64_t& steps, const OdeOptions& options) {
+    if(++steps > options.max_steps) {
+        throw_too_many_steps(options);
+    }
+}
+
+// Media cuadrática de `v[i] / scale[i]`.
+double rms_norm(const std::vector<double>& v, const std::vector<double>& scale) {
+    double sum = 0.0;
+    for(size_t i = 0; i < v.size(); i++) {
+        double ratio = v[i] / scale[i];
+        sum += ratio * ratio;
+    }
+    return std::sqrt(sum / static_cast<double>(v.size()));
+}
+
+// Tamaño del primer paso de RK45, estimado a partir de las dos primeras derivadas (Hairer, Nørsett y Wanner, II.4).
+double initial_step(OdeSystem& system, double t0, const std::vector<double>& y0, const std::vector<double>& f0,
+                    double span, const OdeOptions& options) {
+    size_t n = y0.size();
+    std::vector<double> scale(n), y1(n), f1(n), diff(n);
+    for(size_t i = 0; i < n; i++) {
+        scale[i] = options.absolute_tolerance + options.relative_tolerance * std::abs(y0[i]);
+    }
+    double d0 = rms_norm(y0, scale), d1 = rms_norm(f0, scale);
+    double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+    h0 = std::min(h0, std::abs(span));
+    double direction = span >= 0.0 ? 1.0 : -1.0;
+    for(size_t i = 0; i < n; i++) {
+        y1[i] = y0[i] + direction * h0 * f0[i];
+    }
+    try {
+        system.derivatives(t0 + direction * h0, y1.data(), f1.data());
+    } catch(const EvalError&) {
+        return direction * h0; // el paso de prueba ha salido del dominio; el control de paso se encarga del resto
+    }
+    for(size_t i = 0; i < n; i++) {
+        diff[i] = f1[i] - f0[i];
+    }
+    double d2 = rms_norm(diff, scale) / h0;
+    double max_d = std::max(d1, d2);
+    double h1 = max_d <= 1e-15 ? std::max(1e-6, h0 * 1e-3) : std::pow(0.01 / max_d, 1.0 / 5.0);
+    double h = std::min({100.0 * h0, h1, std::abs(span)});
+    return direction * (std::isfinite(h) && h > 0.0 ? h : h0);
+}
+
+void integrate_rk45(OdeSystem& system, double t, std::vector<double> y, const std::vector<double>& times, size_t next,
+                    const OdeOptions& options, const OutputFunction& on_output) {
+    size_t n = y.size();
+    double t_end = times.back();
+    double direction = t_end >= t ? 1.0 : -1.0;
+    std::array<std::vector<double>, 7> k;
+    for(std::vector<double>& stage : k) {
+        stage.resize(n);
+    }
+    std::vector<double> stage_y(n), y1(n), output(n);
+    system.derivatives(t, y.data(), k[0].data());
+    double h = initial_step(system, t, y, k[0], t_end - t, options);
+    bool rejected_last = false;
+    uint64_t steps = 0;
+
+    auto stage = [&](size_t index, double c, std::initializer_list<double> a) {
+        for(size_t i = 0; i < n; i++) {
+            double sum = 0.0;
+            size_t j = 0;
+            for(double coefficient : a) {
+                sum += coefficient * k[j++][i];
+            }
+            stage_y[i] = y[i] + h * sum;
+        }
+        system.derivatives(t + c * h, stage_y.data(), k[index].data());
+    };
+
+    while(next < times.size()) {
+        count_step(steps, options);
+        bool last = std::abs(h) >= std::abs(t_end - t);
+        if(last) {
+            h = t_end - t;
+        }
+        double t1 = last ? t_end : t + h;
+        double error = std::numeric_limits<double>::quiet_NaN();
+        std::string failure;
+        try {
+            stage(1, C2, {A21});
+            stage(2, C3, {A31, A32});
+            stage(3, C4, {A41, A42, A43});
+            stage(4, C5, {A51, A52, A53, A54});
+            stage(5, 1.0, {A61, A62, A63, A64, A65});
+            for(size_t i = 0; i < n; i++) {
+                y1[i] = y[i] + h * (A71 * k[0][i] + A73 * k[2][i] + A74 * k[3][i] + A75 * k[4][i] + A76 * k[5][i]);
+            }
+            system.derivatives(t1, y1.data(), k[6].data());
+            error = 0.0;
+            for(size_t i = 0; i < n; i++) {
+                double local = h * (E1 * k[0][i] + E3 * k[2][i] + E4 * k[3][i] + E5 * k[4][i] + E6 * k[5][i] + E7 * k[6][i]);
+                double scale = options.absolute_tolerance + options.relative_tolerance * std::max(std::abs(y[i]), std::abs(y1[i]));
+                error += (local / scale) * (local / scale);
+            }
+            error = std::sqrt(error / static_cast<double>(n));
+        } catch(const EvalError& e) {
+            failure = e.what(); // un paso demasiado largo puede salirse del dominio de los lados derechos
+        }
+
+        if(!(error <= 1.0)) { // la negación también rechaza los pasos con valores no finitos
+            h *= std::isfinite(error) ? std::max(MIN_FACTOR, SAFETY * std::pow(error, -0.2)) : MIN_FACTOR;
+            rejected_last = true;
+            if(std::abs(h) <= 16.0 * std::numeric_limits<double>::epsilon() * std::max(std::abs(t), 1.0)) {
+                throw std::runtime_error("El paso de integración se ha hecho demasiado pequeño en t = " + std::to_string(t)
+                                         + (failure.empty() ? "" : " (último error: " + failure + ")"));
+            }
+            continue;
+        }
+
+        for(; next < times.size() && (times[next] - t1) * direction <= 0.0; next++) {
+            if(times[next] == t1) {
+                on_output(t1, y1);
+                continue;
+            }
+            double theta = (times[next] - t) / h, theta1 = 1.0 - theta;
+            for(size_t i = 0; i < n; i++) {
+                double diff = y1[i] - y[i];
+                double bspl = h * k[0][i] - diff;
+                double r4 = diff - h * k[6][i] - bspl;
+                double r5 = h * (D1 * k[0][i] + D3 * k[2][i] + D4 * k[3][i] + D5 * k[4][i] + D6 * k[5][i] + D7 * k[6][i]);
+                output[i] = y[i] + theta * (diff + theta1 * (bspl + theta * (r4 + theta1 * r5)));
+            }
+            on_output(times[next], output);
+        }
+        t = t1;
+        y.swap(y1);
+        k[0].swap(k[6]); // el método es FSAL: la última etapa es la primera del paso siguiente
+        double factor = error == 0.0 ? MAX_FACTOR : std::clamp(SAFETY * std::pow(error, -0.2), MIN_FACTOR, MAX_FACTOR);
+        h *= rejected_last ? std::min(factor, 1.0) : factor;
+        rejected_last = false;
+    }
+}
+
+void integrate_rk4(OdeSystem& system, double t, std::vector<double> y, const std::vector<double>& times, size_t next,
+                   const OdeOptions& options, const OutputFunction& on_output) {
+    size_t n = y.size();
+    std::vector<double> k1(n), k2(n), k3(n), k4(n), stage_y(n);
+    uint64_t steps = 0;
+    for(; next < times.size(); next++) {
+        double span = times[next] - t;
+        double substeps = span == 0.0 ? 0.0
+                          : (options.step > 0.0 ? std::max(1.0, std::ceil(std::abs(span) / options.step)) : 1.0);
+        if(substeps > static_cast<double>(options.max_steps - steps)) {
+            throw_too_many_steps(options);
+        }
+        uint64_t m = static_cast<uint64_t>(substeps);
+        for(uint64_t j = 0; j < m; j++) {
+            count_step(steps, options);
+            double ta = t + span * static_cast<double>(j) / substeps;
+            double tb = j + 1 == m ? times[next] : t + span * static_cast<double>(j + 1) / substeps;
+            double h = tb - ta;
+            system.derivatives(ta, y.data(), k1.data());
+            for(size_t i = 0; i < n; i++) {
+                stage_y[i] = y[i] + 0.5 * h * k1[i];
+            }
+            system.derivatives(ta + 0.5 * h, stage_y.data(), k2.data());
+            for(size_t i = 0; i < n; i++) {
+                stage_y[i] = y[i] + 0.5 * h * k2[i];
+            }
+            system.derivatives(ta + 0.5 * h, stage_y.data(), k3.data());
+            for(size_t i = 0; i < n; i++) {
+                stage_y[i] = y[i] + h * k3[i];
+            }
+            system.derivatives(tb, stage_y.data(), k4.data());
+            for(size_t i = 0; i < n; i++) {
+                y[i] += h / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+            }
+        }
+        t = times[next];
+        on_output(t, y);
+    }
+}
+
+}
+
+void integrate_ode(OdeSystem& system, double t0, const std::vector<double>& y0, const std::vector<double>& times,
+                   const OdeOptions& options, const std::function<void(double, const std::vector<double>&)>& on_output) {
+    if(y0.size() != system.dimension()) {
+        throw std::runtime_error("El estado inicial no tiene tantos valores como variables de estado");
+    }
+    if(!std::isfinite(t0) || !std::all_of(y0.begin(), y0.end(), [](double value) { return std::isfinite(value); })) {
+        throw std::runtime_error("El tiempo y el estado iniciales deben ser finitos");
+    }
+    if(times.empty()) {
+        return;
+    }
+    double direction = times.back() >= t0 ? 1.0 : -1.0;
+    double previous = t0;
+    for(double t : times) {
+        if(!std::isfinite(t) || (t - previous) * direction < 0.0) {
+            throw std::runtime_error("Los tiempos de salida deben ser finitos y estar ordenados en el sentido de la integración");
+        }
+        previous = t;
+    }
+    size_t next = 0;
+    for(; next < times.size() && times[next] == t0; next++) {
+        on_output(t0, y0);
+    }
+    if(next == times.size()) {
+        return;
+    }
+    if(options.method == OdeMethod::RK4) {
+        integrate_rk4(system, t0, y0, times, next, options, on_output);
+    } else {
+        integrate_rk45(system, t0, y0, times, next, options, on_output);
+    }
+}
+
+} // namespace clex
@@ -0,0 +1,498 @@
+#include "optimize.hpp"
+#include "eval_errors.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr size_t NO_CHILD = SIZE_MAX;
+
+constexpr size_t LBFGS_HISTORY = 8;
+constexpr size_t LBFGS_MAX_ITERATIONS = 1000;
+constexpr size_t LINE_SEARCH_MAX_STEPS = 60;
+constexpr double ARMIJO_C1 = 1e-4;
+constexpr double GRADIENT_TOLERANCE = 1e-10; // relativa a max(1, |f|)
+constexpr double VALUE_TOLERANCE = 1e-15;    // relativa a max(1, |f|)
+
+constexpr size_t NELDER_MEAD_ITERATIONS_PER_VARIABLE = 500;
+constexpr size_t NELDER_MEAD_MAX_RESTARTS = 2;
+constexpr double SIMPLEX_VALUE_TOLERANCE = 1e-12; // relativa a max(1, |f|)
+constexpr double SIMPLEX_SIZE_TOLERANCE = 1e-10;  // relativa a max(1, |x|)
+
+constexpr double DIVERGENCE_FACTOR = 1e100; // distancia, relativa a max(1, |x0|), a partir de la que la búsqueda diverge
+
+// Expresiones con derivada definida en casi todo punto y sin saltos: las únicas que se minimizan con L-BFGS.
+bool is_smooth(const Expression& expr) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: return true;
+      case ExpressionType::BIN_OP: {
+        switch(expr.get_token().type()) {
+          case TokenType::OP_PLUS: case TokenType::OP_MINUS: case TokenType::OP_ASTERISK:
+          case TokenType::OP_SLASH: case TokenType::OP_CARET: break;
+          default: return false; // comparaciones y operadores lógicos
+        }
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        return is_smooth(lhs) && is_smooth(rhs);
+      }
+      case ExpressionType::UNARY_OP: {
+        return expr.get_token().type() != TokenType::OP_NOT && is_smooth(expr.as_unary_op().get_operand());
+      }
+      case ExpressionType::POLYNOMIAL: return is_smooth(expr.as_polynomial().get_original());
+      case ExpressionType::LET: return is_smooth(expr.as_let().get_value()) && is_smooth(expr.as_let().get_body());
+      case ExpressionType::LOCAL: return true;
+      default: return false;
+    }
+}
+
+// Nodo de la cinta de diferenciación automática: valor y derivadas parciales respecto de sus (hasta dos) operandos.
+struct TapeNode {
+    double value;
+    size_t lhs, rhs;
+    double d_lhs, d_rhs;
+};
+
+/**
+ * Evalúa una expresión suave y su gradiente en modo inverso: una pasada hacia delante graba en la cinta cada
+ * operación con sus derivadas locales, y otra hacia atrás acumula las adjuntas. Los primeros nodos de la cinta
+ * son las variables, en orden.
+ */
+class GradientTape {
+  private:
+    const Expression& m_expr;
+    const SymbolTable& m_symbols;
+    const std::vector<Token>& m_variables;
+    std::vector<TapeNode> m_nodes;
+    std::vector<double> m_adjoints;
+    std::vector<size_t> m_locals; // nodo del valor de cada `let` de la expresión, por posición local
+
+    size_t push(double value, size_t lhs = NO_CHILD, double d_lhs = 0.0, size_t rhs = NO_CHILD, double d_rhs = 0.0) {
+        m_nodes.push_back(TapeNode{value, lhs, rhs, d_lhs, d_rhs});
+        return m_nodes.size() - 1;
+    }
+
+    size_t record(const Expression& expr) {
+        switch(expr.type()) {
+          case ExpressionType::OPERAND: {
+            const Token& tok = expr.get_token();
+            if(tok.type() == TokenType::NUMBER) {
+                return push(*tok.get_num());
+            }
+            for(size_t k = 0; k < m_variables.size(); k++) {
+                if(m_variables[k] == tok) {
+                    return k;
+                }
+            }
+            // solo puede faltar en puntos distintos del inicial si el nombre también falta en éste, que ya ha fallado
+            return push(m_symbols.get(tok).value_or(std::numeric_limits<double>::quiet_NaN()));
+          }
+          case ExpressionType::BIN_OP: {
+            auto [lhs_expr, rhs_expr] = expr.as_bin_op().get_operands();
+            size_t lhs = record(lhs_expr), rhs = record(rhs_expr);
+            double a = m_nodes[lhs].value, b = m_nodes[rhs].value;
+            switch(expr.get_token().type()) {
+              case TokenType::OP_PLUS: return push(a + b, lhs, 1.0, rhs, 1.0);
+              case TokenType::OP_MINUS: return push(a - b, lhs, 1.0, rhs, -1.0);
+              case TokenType::OP_ASTERISK: return push(a * b, lhs, b, rhs, a);
+              case TokenType::OP_SLASH: return push(a / b, lhs, 1.0 / b, rhs, -a / (b * b));
+              case TokenType::OP_CARET: {
+                double value = std::pow(a, b);
+                double d_lhs = b == 0.0 ? 0.0 : b * std::pow(a, b - 1.0);
+                double d_rhs = a > 0.0 ? value * std::log(a) : 0.0; // con base no positiva, solo hay valor real para exponentes enteros
+                return push(value, lhs, d_lhs, rhs, d_rhs);
+              }
+              default: __builtin_unreachable();
+            }
+          }
+          case ExpressionType::UNARY_OP: {
+            size_t arg = record(expr.as_unary_op().get_operand());
+            double x = m_nodes[arg].value;
+            switch(expr.get_token().type()) {
+              case TokenType::OP_PLUS: return arg;
+              case TokenType::OP_MINUS: return push(-x, arg, -1.0);
+              case TokenType::OP_FUNC_SQRT: {
+                double value = std::sqrt(x);
+                return push(value, arg, 0.5 / value);
+              }
+              case TokenType::OP_FUNC_LOG: return push(std::log(x), arg, 1.0 / x);
+              case TokenType::OP_FUNC_SIN: return push(std::sin(x), arg, std::cos(x));
+              case TokenType::OP_FUNC_COS: return push(std::cos(x), arg, -std::sin(x));
+              case TokenType::OP_FUNC_TAN: {
+                double value = std::tan(x);
+                return push(value, arg, 1.0 + value * value);
+              }
+              case TokenType::OP_FUNC_ARCSIN: return push(std::asin(x), arg, 1.0 / std::sqrt(1.0 - x * x));
+              case TokenType::OP_FUNC_ARCCOS: return push(std::acos(x), arg, -1.0 / std::sqrt(1.0 - x * x));
+              case TokenType::OP_FUNC_ARCTAN: return push(std::atan(x), arg, 1.0 / (1.0 + x * x));
+              default: __builtin_unreachable();
+            }
+          }
+          case ExpressionType::POLYNOMIAL: {
+            return record(expr.as_polynomial().get_original());
+          }
+          case ExpressionType::LET: {
+            const LetExpression& let = expr.as_let();
+            size_t value = record(let.get_value());
+            if(let.get_slot() >= m_locals.size()) {
+                m_locals.resize(let.get_slot() + 1, NO_CHILD);
+            }
+            m_locals[let.get_slot()] = value;
+            return record(let.get_body());
+          }
+          case ExpressionType::LOCAL: {
+            // los nombres definidos fuera de la expresión minimizada no dependen de las variables
+            size_t slot = expr.as_local().get_slot();
+            if(slot < m_locals.size() && m_locals[slot] != NO_CHILD) {
+                return m_locals[slot];
+            }
+            return push(current_local_slots()[slot]);
+          }
+          default: __builtin_unreachable(); // descartado por `is_smooth`
+        }
+    }
+
+  public:
+    GradientTape(const Expression& expr, const SymbolTable& symbols, const std::vector<Token>& variables)
+        : m_expr(expr), m_symbols(symbols), m_variables(variables) {};
+
+    // Devuelve el valor de la expresión en `x` y escribe su gradiente en `gradient`.
+    double operator()(const std::vector<double>& x, std::vector<double>& gradient) {
+        m_nodes.clear();
+        m_locals.clear();
+        for(double value : x) {
+            push(value);
+        }
+        size_t root = record(m_expr);
+        m_adjoints.assign(m_nodes.size(), 0.0);
+        m_adjoints[root] = 1.0;
+        for(size_t i = m_nodes.size(); i-- > x.size(); ) {
+            const TapeNode& node = m_nodes[i];
+            if(node.lhs != NO_CHILD) {
+                m_adjoints[node.lhs] += m_adjoints[i] * node.d_lhs;
+            }
+            if(node.rhs != NO_CHILD) {
+                m_adjoints[node.rhs] += m_adjoints[i] * node.d_rhs;
+            }
+        }
+        gradient.assign(m_adjoints.begin(), m_adjoints.begin() + static_cast<std::ptrdiff_t>(x.size()));
+        return m_nodes[root].value;
+    }
+};
+
+// Evalúa la expresión con el intérprete; los errores de evaluación y los valores no finitos cuentan como infinito.
+class ValueFunction {
+  private:
+    const Expression& m_expr;
+    SymbolTable m_symbols;
+    const std::vector<Token>& m_variables;
+  public:
+    ValueFunction(const Expression& expr, const SymbolTable& symbols, const std::vector<Token>& variables)
+        : m_expr(expr), m_symbols(symbols), m_variables(variables) {};
+
+    // Evalúa la expresión en `x`, dejando pasar los errores de evaluación.
+    double evaluate(const std::vector<double>& x) {
+        for(size_t k = 0; k < x.size(); k++) {
+            m_symbols.set(m_variables[k], x[k]);
+        }
+        return m_expr.evaluate(m_symbols);
+    }
+
+    double operator()(const std::vector<double>& x) {
+        try {
+            double value = evaluate(x);
+            return std::isfinite(value) ? value : INF;
+        } catch(const EvalError&) {
+            return INF;
+        }
+    }
+};
+
+struct Search {
+    std::vector<double> x;
+    double value;
+    size_t iterations;
+    bool converged;
+};
+
+double dot(const std::vector<double>& a, const std::vector<double>& b) {
+    double result = 0.0;
+    for(size_t k = 0; k < a.size(); k++) {
+        result += a[k] * b[k];
+    }
+    return result;
+}
+
+double max_abs(const std::vector<double>& v) {
+    double result = 0.0;
+    for(double value : v) {
+        result = std::max(result, std::abs(value));
+    }
+    return result;
+}
+
+bool all_finite(const std::vector<double>& v) {
+    return std::all_of(v.begin(), v.end(), [](double value) { return std::isfinite(value); });
+}
+
+struct Correction {
+    std::vector<double> s, y;
+    double rho;
+};
+
+// Dirección de L-BFGS, `-H g`, con la recursión de dos bucles sobre las últimas correcciones.
+std::vector<double> lbfgs_direction(const std::deque<Correction>& history, const std::vector<double>& gradient) {
+    std::vector<double> q = gradient;
+    std::vector<double> alpha(history.size());
+    for(size_t i = history.size(); i-- > 0; ) {
+        alpha[i] = history[i].rho * dot(history[i].s, q);
+        for(size_t k = 0; k < q.size(); k++) {
+            q[k] -= alpha[i] * history[i].y[k];
+        }
+    }
+    if(!history.empty()) {
+        const Correction& last = history.back();
+        double gamma = dot(last.s, last.y) / dot(last.y, last.y);
+        for(double& value : q) {
+            value *= gamma;
+        }
+    }
+    for(size_t i = 0; i < history.size(); i++) {
+        double beta = history[i].rho * dot(history[i].y, q);
+        for(size_t k = 0; k < q.size(); k++) {
+            q[k] += (alpha[i] - beta) * history[i].s[k];
+        }
+    }
+    for(double& value : q) {
+        value = -value;
+    }
+    return q;
+}
+
+/**
+ * L-BFGS con búsqueda lineal con retroceso (condición de Armijo). Los puntos con valor no finito se tratan como
+ * peores que cualquier otro. Termina sin converger si el gradiente no es finito o si ni siquiera la dirección de
+ * máximo descenso consigue bajar el valor.
+ */
+Search lbfgs(GradientTape& f, std::vector<double> x) {
+    size_t n = x.size();
+    std::vector<double> gradient(n), next_gradient(n), next_x(n);
+    double value = f(x, gradient);
+    std::deque<Correction> history;
+    for(size_t iteration = 0; iteration < LBFGS_MAX_ITERATIONS; iteration++) {
+        if(!std::isfinite(value) || !all_finite(gradient)) {
+            return Search{std::move(x), value, iteration, false};
+        }
+        double scale = std::max(1.0, std::abs(value));
+        if(max_abs(gradient) <= GRADIENT_TOLERANCE * scale) {
+            return Search{std::move(x), value, iteration, true};
+        }
+        std::vector<double> direction = lbfgs_direction(history, gradient);
+        double slope = dot(gradient, direction);
+        if(!(slope < 0.0)) { // la aproximación de la inversa de la hessiana se ha degradado
+            history.clear();
+            direction = lbfgs_direction(history, gradient);
+            slope = dot(gradient, direction);
+        }
+        double step = history.empty() ? 1.0 / std::max(1.0, max_abs(gradient)) : 1.0;
+        double next_value = INF;
+        bool accepted = false;
+        for(size_t trial = 0; trial < LINE_SEARCH_MAX_STEPS && !accepted; trial++, step *= 0.5) {
+            for(size_t k = 0; k < n; k++) {
+                next_x[k] = x[k] + step * direction[k];
+            }
+            next_value = f(next_x, next_gradient);
+            accepted = std::isfinite(next_value) && next_value <= value + ARMIJO_C1 * step * slope;
+        }
+        if(!accepted) {
+            if(history.empty()) {
+                return Search{std::move(x), value, iteration, false};
+            }
+            history.clear(); // se repite la iteración con máximo descenso
+            continue;
+        }
+        Correction correction{std::vector<double>(n), std::vector<double>(n), 0.0};
+        for(size_t k = 0; k < n; k++) {
+            correction.s[k] = next_x[k] - x[k];
+            correction.y[k] = next_gradient[k] - gradient[k];
+        }
+        double curvature = dot(correction.s, correction.y);
+        if(curvature > 0.0 && std::isfinite(curvature)) { // si no, la corrección estropearía la aproximación
+            correction.rho = 1.0 / curvature;
+            history.push_back(std::move(correction));
+            if(history.size() > LBFGS_HISTORY) {
+                history.pop_front();
+            }
+        }
+        bool stalled = value - next_value <= VALUE_TOLERANCE * scale;
+        x.swap(next_x);
+        gradient.swap(next_gradient);
+        value = next_value;
+        if(stalled && all_finite(gradient)) {
+            return Search{std::move(x), value, iteration + 1, true};
+        }
+    }
+    return Search{std::move(x), value, LBFGS_MAX_ITERATIONS, false};
+}
+
+/**
+ * Nelder–Mead con los coeficientes clásicos (reflexión 1, expansión 2, contracción y encogimiento 1/2), partiendo
+ * de un símplice con lados del 5% de cada coordenada. Al converger se reinicia desde el mejor vértice, hasta
+ * `NELDER_MEAD_MAX_RESTARTS` veces, mientras el reinicio siga mejorando el valor.
+ */
+Search nelder_mead(ValueFunction& f, std::vector<double> start) {
+    size_t n = start.size();
+    size_t max_iterations = NELDER_MEAD_ITERATIONS_PER_VARIABLE * n;
+    size_t total_iterations = 0;
+    Search best{start, f(start), 0, false};
+    for(size_t restart = 0; restart <= NELDER_MEAD_MAX_RESTARTS; restart++) {
+        std::vector<std::vector<double>> simplex(n + 1, best.x);
+        std::vector<double> values(n + 1, best.value);
+        for(size_t k = 0; k < n; k++) {
+            simplex[k + 1][k] += best.x[k] != 0.0 ? 0.05 * best.x[k] : 0.00025;
+            values[k + 1] = f(simplex[k + 1]);
+        }
+        std::vector<size_t> order(n + 1);
+        std::vector<double> centroid(n), reflected(n), candidate(n);
+        bool converged = false;
+        size_t iteration = 0;
+        for(; iteration < max_iterations; iteration++) {
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+            const std::vector<double>& lowest = simplex[order[0]];
+            double value_spread = 0.0, size = 0.0;
+            for(size_t i = 1; i <= n; i++) {
+                value_spread = std::max(value_spread, values[order[i]] - values[order[0]]);
+                for(size_t k = 0; k < n; k++) {
+                    size = std::max(size, std::abs(simplex[order[i]][k] - lowest[k]));
+                }
+            }
+            if(value_spread <= SIMPLEX_VALUE_TOLERANCE * std::max(1.0, std::abs(values[order[0]]))
+               && size <= SIMPLEX_SIZE_TOLERANCE * std::max(1.0, max_abs(lowest))) {
+                converged = true;
+                break;
+            }
+
+            size_t worst = order[n];
+            std::fill(centroid.begin(), centroid.end(), 0.0);
+            for(size_t i = 0; i < n; i++) {
+                for(size_t k = 0; k < n; k++) {
+                    centroid[k] += simplex[order[i]][k] / static_cast<double>(n);
+                }
+            }
+            auto towards = [&](std::vector<double>& out, const std::vector<double>& target, double factor) {
+                for(size_t k = 0; k < n; k++) {
+                    out[k] = centroid[k] + factor * (target[k] - centroid[k]);
+                }
+            };
+            towards(reflected, simplex[worst], -1.0);
+            double reflected_value = f(reflected);
+            if(reflected_value < values[order[0]]) {
+                towards(candidate, simplex[worst], -2.0);
+                double expanded_value = f(candidate);
+                if(expanded_value < reflected_value) {
+                    simplex[worst] = candidate;
+                    values[worst] = expanded_value;
+                } else {
+                    simplex[worst] = reflected;
+                    values[worst] = reflected_value;
+                }
+                continue;
+            }
+            if(reflected_value < values[order[n - 1]]) {
+                simplex[worst] = reflected;
+                values[worst] = reflected_value;
+                continue;
+            }
+            bool outside = reflected_value < values[worst];
+            towards(candidate, outside ? reflected : simplex[worst], 0.5);
+            double contracted_value = f(candidate);
+            if(outside ? contracted_value <= reflected_value : contracted_value < values[worst]) {
+                simplex[worst] = candidate;
+                values[worst] = contracted_value;
+                continue;
+            }
+            for(size_t i = 1; i <= n; i++) { // encogimiento hacia el mejor vértice
+                std::vector<double>& vertex = simplex[order[i]];
+                for(size_t k = 0; k < n; k++) {
+                    vertex[k] = lowest[k] + 0.5 * (vertex[k] - lowest[k]);
+                }
+                values[order[i]] = f(vertex);
+            }
+        }
+        total_iterations += iteration;
+        size_t lowest = static_cast<size_t>(std::min_element(values.begin(), values.end()) - values.begin());
+        bool improved = values[lowest] < best.value;
+        if(improved || restart == 0) {
+            best.x = simplex[lowest];
+            best.value = std::min(values[lowest], best.value);
+        }
+        best.converged = converged;
+        if(!converged || !improved) {
+            break;
+        }
+    }
+    best.iterations = total_iterations;
+    return best;
+}
+
+}
+
+MinimizationResult minimize(const Expression& objective, const SymbolTable& symbols, const std::vector<Token>& variables) {
+    size_t n = variables.size();
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return *variables[a].get_ident() < *variables[b].get_ident();
+    });
+    std::vector<Token> sorted_variables;
+    std::vector<double> start;
+    for(size_t index : order) {
+        sorted_variables.push_back(variables[index]);
+        start.push_back(symbols.get(variables[index]).value_or(0.0));
+    }
+
+    ValueFunction value_function(objective, symbols, sorted_variables);
+    value_function.evaluate(start); // lanza el error de evaluación del punto inicial, si lo hay
+
+    Search search{start, INF, 0, false};
+    MinimizationMethod method = MinimizationMethod::NELDER_MEAD;
+    if(is_smooth(objective)) {
+        GradientTape tape(objective, symbols, sorted_variables);
+        search = lbfgs(tape, start);
+        method = MinimizationMethod::LBFGS;
+    }
+    // si el punto inicial ya tiene gradiente nulo puede ser un punto de silla, así que se explora con Nelder–Mead
+    if(!search.converged || search.iterations == 0) {
+        size_t lbfgs_iterations = search.iterations;
+        search = nelder_mead(value_function, std::move(search.x));
+        search.iterations += lbfgs_iterations;
+        method = MinimizationMethod::NELDER_MEAD;
+    }
+
+    // unas variables tan lejos del punto inicial solo se alcanzan siguiendo una dirección en la que la expresión
+    // decrece sin límite, y el "mínimo" sería únicamente el punto en que se ha agotado la búsqueda
+    if(max_abs(search.x) > DIVERGENCE_FACTOR * std::max(1.0, max_abs(start))) {
+        throw std::runtime_error("La expresión no está acotada inferiormente: decrece sin límite al alejarse del punto inicial");
+    }
+    MinimizationResult result{std::vector<double>(n), value_function.evaluate(search.x), method, search.iterations, search.converged};
+    for(size_t i = 0; i < n; i++) {
+        result.point[order[i]] = search.x[i];
+    }
+    return result;
+}
+
+} // namespace clex
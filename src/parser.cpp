@@ -4,6 +4,7 @@
 #include "token_list.hpp"
 #include "tokens.hpp"
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -29,11 +30,20 @@ Expression Parser::parse_expression_recursive(int minimal_binding_power) {
     Token first_tok = m_tokens.next();
     Expression lhs = [&]() -> Expression { // Tengo que usar una lambda aquí porque no existe el constructor por defecto de Expression
         switch(first_tok.type()) {
-          case TokenType::NUMBER:
-          case TokenType::IDENTIFIER: {
+          case TokenType::NUMBER: {
             return Expression::operand(std::move(first_tok));
             break;
           }
+          case TokenType::IDENTIFIER: {
+            // los nombres definidos por un `let` que contiene a la expresión se leen de su posición local,
+            // empezando por el más interior
+            for(size_t slot = m_locals.size(); slot-- > 0;) {
+                if(m_locals[slot] == *first_tok.get_ident()) {
+                    return Expression::local(std::move(first_tok), slot);
+                }
+            }
+            return Expression::operand(std::move(first_tok));
+          }
           case TokenType::PAREN_L: {
             Expression tmp = this->parse_expression_recursive(0); // reseteamos el binding power por los paréntesis
             Token after_paren = m_tokens.next();
@@ -42,8 +52,16 @@ Expression Parser::parse_expression_recursive(int minimal_binding_power) {
             }
             return tmp;
           }
+          case TokenType::FUNC_IF: {
+            return this->parse_conditional(std::move(first_tok));
+          }
+          case TokenType::LET: {
+            return this->parse_let();
+          }
           default: {
-            if(first_tok.is_unary_operator_token()) {
+            if(first_tok.get_call_arity().has_value()) {
+                return this->parse_call(std::move(first_tok));
+            } else if(first_tok.is_unary_operator_token()) {
                 int op_binding_power = *first_tok.get_unary_binding_power();
                 Expression operand = this->parse_expression_recursive(op_binding_power);
                 return Expression::unary_op(
@@ -64,7 +82,9 @@ Expression Parser::parse_expression_recursive(int minimal_binding_power) {
         switch(operator_tok.type()) {
           case TokenType::END_OF_FILE:
           case TokenType::NEWLINE: 
-          case TokenType::PAREN_R: {
+          case TokenType::PAREN_R: 
+          case TokenType::COMMA:
+          case TokenType::IN: {
             return lhs; // hemos llegado al final de la expresión, no hace falta operador
           } 
           default: {
@@ -99,6 +119,79 @@ Expression Parser::parse_expression() {
     return parse_expression_recursive(-1);
 }
 
+std::vector<std::unique_ptr<Expression>> Parser::parse_argument_list(size_t arg_count, bool variadic) {
+    Token paren_tok = m_tokens.next();
+    if(paren_tok.type() != TokenType::PAREN_L) {
+        throw ExpectedToken({TokenType::PAREN_L}, paren_tok);
+    }
+    std::vector<std::unique_ptr<Expression>> args;
+    if(arg_count == 0) {
+        Token after_paren = m_tokens.next();
+        if(after_paren.type() != TokenType::PAREN_R) {
+            throw MismatchedParentheses(paren_tok, after_paren);
+        }
+        return args;
+    }
+    while(true) {
+        args.push_back(std::make_unique<Expression>(this->parse_expression_recursive(0)));
+        Token separator = m_tokens.next();
+        bool missing_args = args.size() < arg_count;
+        if(separator.type() == TokenType::COMMA && (missing_args || variadic)) {
+            continue;
+        } else if(missing_args) {
+            throw ExpectedToken({TokenType::COMMA}, separator);
+        } else if(separator.type() != TokenType::PAREN_R) {
+            throw MismatchedParentheses(paren_tok, separator);
+        }
+        return args;
+    }
+}
+
+Expression Parser::parse_call(Token&& consumed_func_token) {
+    std::vector<std::unique_ptr<Expression>> args = parse_argument_list(
+        *consumed_func_token.get_call_arity(),
+        consumed_func_token.is_variadic_call()
+    );
+    return Expression::call(std::move(consumed_func_token), std::move(args));
+}
+
+Expression Parser::parse_conditional(Token&& consumed_if_token) {
+    std::vector<std::unique_ptr<Expression>> args = parse_argument_list(3);
+    return Expression::conditional(
+        std::move(consumed_if_token),
+        std::move(args[0]),
+        std::move(args[1]),
+        std::move(args[2])
+    );
+}
+
+Expression Parser::parse_let() {
+    Token name = m_tokens.next();
+    if(name.type() != TokenType::IDENTIFIER) {
+        throw ExpectedToken({TokenType::IDENTIFIER}, name);
+    }
+    Token assign_tok = m_tokens.next();
+    if(assign_tok.type() != TokenType::ASSIGN) {
+        throw ExpectedToken({TokenType::ASSIGN}, assign_tok);
+    }
+    // el valor se analiza antes de definir el nombre, así que `let x = x + 1 in ...` usa el `x` de fuera
+    Expression value = this->parse_expression_recursive(0);
+    Token in_tok = m_tokens.next();
+    if(in_tok.type() != TokenType::IN) {
+        throw ExpectedToken({TokenType::IN}, in_tok);
+    }
+    size_t slot = m_locals.size();
+    m_locals.push_back(*name.get_ident());
+    Expression body = this->parse_expression_recursive(0); // el cuerpo llega tan a la derecha como pueda
+    m_locals.pop_back();
+    return Expression::let(
+        std::move(name),
+        slot,
+        std::make_unique<Expression>(std::move(value)),
+        std::make_unique<Expression>(std::move(body))
+    );
+}
+
 Assignment Parser::parse_assignment(Token&& consumed_var_token) {
     if(m_tokens.peek().type() != TokenType::ASSIGN) {
         throw ExpectedToken({TokenType::ASSIGN}, m_tokens.peek().type());
@@ -112,18 +205,32 @@ Assignment Parser::parse_assignment(Token&& consumed_var_token) {
     };
 }
 
+void Parser::expect_end_of_statement() {
+    // `,`, `in` y `)` también terminan una expresión, pero fuera de una llamada, un `let` o un paréntesis son tokens
+    // sobrantes que no se pueden ignorar sin cambiar el significado de la sentencia
+    Token tok = m_tokens.next();
+    if(tok.type() != TokenType::END_OF_FILE && tok.type() != TokenType::NEWLINE) {
+        throw ExpectedToken({TokenType::END_OF_FILE}, tok);
+    }
+}
+
 Statement Parser::parse_next_statement() {
-    if (m_tokens.peek().type() != TokenType::IDENTIFIER) {
-        return Statement::expression(parse_expression());
-    } else {
-        Token first_tok = m_tokens.next();
-        if(m_tokens.peek().type() != TokenType::ASSIGN) {
-            m_tokens.give_back(std::move(first_tok));
+    m_locals.clear(); // por si la sentencia anterior se quedó a medias con un error dentro de un `let`
+    Statement statement = [&]() -> Statement {
+        if (m_tokens.peek().type() != TokenType::IDENTIFIER) {
             return Statement::expression(parse_expression());
         } else {
-            return Statement::assignment(parse_assignment(std::move(first_tok)));
+            Token first_tok = m_tokens.next();
+            if(m_tokens.peek().type() != TokenType::ASSIGN) {
+                m_tokens.give_back(std::move(first_tok));
+                return Statement::expression(parse_expression());
+            } else {
+                return Statement::assignment(parse_assignment(std::move(first_tok)));
+            }
         }
-    }
+    }();
+    expect_end_of_statement();
+    return statement;
 }
 
 }
\ No newline at end of file
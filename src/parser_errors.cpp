@@ -52,6 +52,14 @@ ExpectedOperator::ExpectedOperator(Token actual_token) noexcept :
             TokenType::OP_ASTERISK,
             TokenType::OP_SLASH,
             TokenType::OP_CARET,
+            TokenType::OP_LESS,
+            TokenType::OP_LESS_EQ,
+            TokenType::OP_GREATER,
+            TokenType::OP_GREATER_EQ,
+            TokenType::OP_EQUAL,
+            TokenType::OP_NOT_EQUAL,
+            TokenType::OP_AND,
+            TokenType::OP_OR,
         }, 
         actual_token
     ) {};
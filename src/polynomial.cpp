@@ -0,0 +1,408 @@
+#include "polynomial.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+/**
+ * Coeficiente de un polinomio durante el análisis: parte numérica más, opcionalmente, una subexpresión
+ * que no depende de la variable.
+ */
+struct Coefficient {
+    double numeric = 0.0;
+    std::unique_ptr<Expression> symbolic; // nulo si el coeficiente es solo numérico
+};
+
+using Polynomial = std::vector<Coefficient>; // `p[k]` es el coeficiente de x^k
+
+template<typename F>
+void for_each_child(const Expression& expr, F&& func) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: {
+        return;
+      }
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        func(lhs);
+        func(rhs);
+        return;
+      }
+      case ExpressionType::UNARY_OP: {
+        func(expr.as_unary_op().get_operand());
+        return;
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        func(conditional.get_condition());
+        func(if_true);
+        func(if_false);
+        return;
+      }
+      case ExpressionType::CALL: {
+        for(const std::unique_ptr<Expression>& arg : expr.as_call().get_args()) {
+            func(*arg);
+        }
+        return;
+      }
+      case ExpressionType::POLYNOMIAL: {
+        func(expr.as_polynomial().get_original());
+        return;
+      }
+      case ExpressionType::APPROXIMATION: {
+        func(expr.as_approximation().get_original());
+        return;
+      }
+      case ExpressionType::LET: {
+        func(expr.as_let().get_value());
+        func(expr.as_let().get_body());
+        return;
+      }
+      case ExpressionType::LOCAL: {
+        return;
+      }
+    }
+}
+
+void collect_identifiers(const Expression& expr, std::set<std::string>& idents) {
+    if(expr.type() == ExpressionType::OPERAND && expr.get_token().type() == TokenType::IDENTIFIER) {
+        idents.insert(*expr.get_token().get_ident());
+    }
+    for_each_child(expr, [&idents](const Expression& child) { collect_identifiers(child, idents); });
+}
+
+bool depends_on(const Expression& expr, const std::string& var) {
+    if(expr.type() == ExpressionType::OPERAND) {
+        return expr.get_token().get_ident() == var;
+    }
+    bool result = false;
+    for_each_child(expr, [&](const Expression& child) { result = result || depends_on(child, var); });
+    return result;
+}
+
+// Todas las funciones con lista de argumentos (`rand`, `randn`, `mc`, `mcerr`) consumen números aleatorios,
+// así que evaluarlas más o menos veces cambia el resultado.
+bool is_pure(const Expression& expr) {
+    if(expr.type() == ExpressionType::CALL) {
+        return false;
+    }
+    bool result = true;
+    for_each_child(expr, [&result](const Expression& child) { result = result && is_pure(child); });
+    return result;
+}
+
+std::unique_ptr<Expression> make_number(double value) {
+    return std::make_unique<Expression>(Expression::operand(Token::number(value)));
+}
+
+std::unique_ptr<Expression> make_bin_op(TokenType oper, std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs) {
+    return std::make_unique<Expression>(Expression::bin_op(Token(oper), std::move(lhs), std::move(rhs)));
+}
+
+std::unique_ptr<Expression> clone_ptr(const std::unique_ptr<Expression>& expr) {
+    return expr ? std::make_unique<Expression>(expr->clone()) : nullptr;
+}
+
+// Suma (o resta, si `subtract`) dos partes simbólicas, cualquiera de las cuales puede ser nula.
+std::unique_ptr<Expression> add_symbolic(std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs, bool subtract) {
+    if(rhs == nullptr) {
+        return std::move(lhs);
+    }
+    if(lhs == nullptr) {
+        return subtract ? std::make_unique<Expression>(Expression::unary_op(Token(TokenType::OP_MINUS), std::move(rhs))) : std::move(rhs);
+    }
+    return make_bin_op(subtract ? TokenType::OP_MINUS : TokenType::OP_PLUS, std::move(lhs), std::move(rhs));
+}
+
+// Producto de una parte numérica por una parte simbólica no nula.
+std::unique_ptr<Expression> scale_symbolic(double factor, const std::unique_ptr<Expression>& symbolic) {
+    if(factor == 1.0) {
+        return clone_ptr(symbolic);
+    }
+    return make_bin_op(TokenType::OP_ASTERISK, make_number(factor), clone_ptr(symbolic));
+}
+
+// (a + A) * (b + B) = ab + aB + bA + AB, con a y b numéricos y A y B simbólicos.
+Coefficient multiply(const Coefficient& lhs, const Coefficient& rhs) {
+    Coefficient result{lhs.numeric * rhs.numeric, nullptr};
+    if(rhs.symbolic && lhs.numeric != 0.0) {
+        result.symbolic = scale_symbolic(lhs.numeric, rhs.symbolic);
+    }
+    if(lhs.symbolic && rhs.numeric != 0.0) {
+        result.symbolic = add_symbolic(std::move(result.symbolic), scale_symbolic(rhs.numeric, lhs.symbolic), false);
+    }
+    if(lhs.symbolic && rhs.symbolic) {
+        result.symbolic = add_symbolic(
+            std::move(result.symbolic),
+            make_bin_op(TokenType::OP_ASTERISK, clone_ptr(lhs.symbolic), clone_ptr(rhs.symbolic)),
+            false
+        );
+    }
+    return result;
+}
+
+bool is_numeric(const Polynomial& p) noexcept {
+    for(const Coefficient& c : p) {
+        if(c.symbolic) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Un monomio tiene como mucho un término no nulo, como `3*x^2` ó `a*x`.
+bool is_monomial(const Polynomial& p) noexcept {
+    size_t terms = 0;
+    for(const Coefficient& c : p) {
+        if(c.numeric != 0.0 || c.symbolic) {
+            terms++;
+        }
+    }
+    return terms <= 1;
+}
+
+size_t degree(const Polynomial& p) noexcept {
+    return p.size() - 1;
+}
+
+void trim(Polynomial& p) noexcept {
+    while(p.size() > 1 && p.back().numeric == 0.0 && !p.back().symbolic) {
+        p.pop_back();
+    }
+}
+
+Polynomial add(Polynomial&& lhs, Polynomial&& rhs, bool subtract) {
+    if(lhs.size() < rhs.size()) {
+        lhs.resize(rhs.size());
+    }
+    for(size_t k = 0; k < rhs.size(); k++) {
+        lhs[k].numeric += subtract ? -rhs[k].numeric : rhs[k].numeric;
+        lhs[k].symbolic = add_symbolic(std::move(lhs[k].symbolic), std::move(rhs[k].symbolic), subtract);
+    }
+    trim(lhs);
+    return std::move(lhs);
+}
+
+Polynomial multiply(const Polynomial& lhs, const Polynomial& rhs) {
+    Polynomial result(lhs.size() + rhs.size() - 1);
+    for(size_t i = 0; i < lhs.size(); i++) {
+        for(size_t j = 0; j < rhs.size(); j++) {
+            Coefficient term = multiply(lhs[i], rhs[j]);
+            result[i + j].numeric += term.numeric;
+            result[i + j].symbolic = add_symbolic(std::move(result[i + j].symbolic), std::move(term.symbolic), false);
+        }
+    }
+    trim(result);
+    return result;
+}
+
+Polynomial numeric_constant(double value) {
+    Polynomial p(1);
+    p[0].numeric = value;
+    return p;
+}
+
+Polynomial constant(const Expression& expr) {
+    Polynomial p(1);
+    if(expr.type() == ExpressionType::OPERAND && expr.get_token().type() == TokenType::NUMBER) {
+        p[0].numeric = *expr.get_token().get_num();
+    } else {
+        p[0].symbolic = std::make_unique<Expression>(expr.clone());
+    }
+    return p;
+}
+
+std::optional<Polynomial> as_polynomial(const Expression& expr, const std::string& var) {
+    if(!is_pure(expr)) {
+        return std::nullopt;
+    }
+    if(!depends_on(expr, var)) {
+        return constant(expr);
+    }
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: { // depende de `var`, así que es la propia variable
+        Polynomial p(2);
+        p[1].numeric = 1.0;
+        return p;
+      }
+      case ExpressionType::UNARY_OP: {
+        const UnaryOpExpression& unary = expr.as_unary_op();
+        TokenType oper = unary.get_operator().type();
+        if(oper != TokenType::OP_MINUS && oper != TokenType::OP_PLUS) {
+            return std::nullopt;
+        }
+        std::optional<Polynomial> operand = as_polynomial(unary.get_operand(), var);
+        if(!operand.has_value() || oper == TokenType::OP_PLUS) {
+            return operand;
+        }
+        return add(Polynomial(1), std::move(*operand), true);
+      }
+      case ExpressionType::BIN_OP: {
+        const BinOpExpression& bin_op = expr.as_bin_op();
+        auto [lhs_expr, rhs_expr] = bin_op.get_operands();
+        TokenType oper = bin_op.get_operator().type();
+        if(oper == TokenType::OP_CARET) {
+            // solo exponentes enteros literales: x^3 sí, x^n ó x^0.5 no
+            if(rhs_expr.type() != ExpressionType::OPERAND || rhs_expr.get_token().type() != TokenType::NUMBER) {
+                return std::nullopt;
+            }
+            double exponent = *rhs_expr.get_token().get_num();
+            if(!(exponent >= 1.0 && exponent <= PolynomialExpression::MAX_DEGREE) || exponent != std::floor(exponent)) {
+                return std::nullopt;
+            }
+            std::optional<Polynomial> base = as_polynomial(lhs_expr, var);
+            if(!base.has_value() || degree(*base) * static_cast<size_t>(exponent) > PolynomialExpression::MAX_DEGREE) {
+                return std::nullopt;
+            }
+            if(!is_monomial(*base)) { // (x - 1)^3 desarrollado pierde precisión cerca de x = 1
+                return std::nullopt;
+            }
+            Polynomial result = multiply(*base, numeric_constant(1.0));
+            for(int i = 1; i < static_cast<int>(exponent); i++) {
+                result = multiply(result, *base);
+            }
+            return result;
+        }
+        if(oper != TokenType::OP_PLUS && oper != TokenType::OP_MINUS && oper != TokenType::OP_ASTERISK && oper != TokenType::OP_SLASH) {
+            return std::nullopt;
+        }
+        std::optional<Polynomial> lhs = as_polynomial(lhs_expr, var);
+        std::optional<Polynomial> rhs = as_polynomial(rhs_expr, var);
+        if(!lhs.has_value() || !rhs.has_value()) {
+            return std::nullopt;
+        }
+        switch(oper) {
+          case TokenType::OP_PLUS:
+          case TokenType::OP_MINUS: {
+            return add(std::move(*lhs), std::move(*rhs), oper == TokenType::OP_MINUS);
+          }
+          case TokenType::OP_ASTERISK: {
+            if(degree(*lhs) + degree(*rhs) > PolynomialExpression::MAX_DEGREE) {
+                return std::nullopt;
+            }
+            // solo se reconocen polinomios ya desarrollados: desarrollar productos como (x - 1)*(x - 2) cambiaría 
+            // el condicionamiento de la expresión y perdería precisión cerca de las raíces
+            if(degree(*lhs) > 0 && degree(*rhs) > 0 && !(is_monomial(*lhs) && is_monomial(*rhs))) {
+                return std::nullopt;
+            }
+            return multiply(*lhs, *rhs);
+          }
+          case TokenType::OP_SLASH: {
+            // solo divisiones entre constantes numéricas no nulas, para no cambiar los errores de división entre cero
+            if(degree(*rhs) > 0 || !is_numeric(*rhs) || (*rhs)[0].numeric == 0.0) {
+                return std::nullopt;
+            }
+            return multiply(*lhs, numeric_constant(1.0 / (*rhs)[0].numeric));
+          }
+          default: return std::nullopt;
+        }
+      }
+      default: return std::nullopt;
+    }
+}
+
+std::optional<Expression> try_polynomial(const Expression& expr) {
+    if(!is_pure(expr)) {
+        return std::nullopt;
+    }
+    std::set<std::string> idents;
+    collect_identifiers(expr, idents);
+    std::optional<Polynomial> best;
+    std::string best_var;
+    for(const std::string& var : idents) {
+        std::optional<Polynomial> p = as_polynomial(expr, var);
+        if(p.has_value() && degree(*p) >= 2 && (!best.has_value() || degree(*p) > degree(*best))) {
+            best = std::move(p);
+            best_var = var;
+        }
+    }
+    if(!best.has_value()) {
+        return std::nullopt;
+    }
+    std::vector<double> coefficients;
+    std::vector<std::pair<size_t, std::unique_ptr<Expression>>> symbolic;
+    for(size_t k = 0; k < best->size(); k++) {
+        coefficients.push_back((*best)[k].numeric);
+        if((*best)[k].symbolic) {
+            symbolic.emplace_back(k, std::make_unique<Expression>(rewrite_polynomials(*(*best)[k].symbolic)));
+        }
+    }
+    return Expression::polynomial(
+        Token::identifier(best_var),
+        std::move(coefficients),
+        std::move(symbolic),
+        std::make_unique<Expression>(expr.clone())
+    );
+}
+
+}
+
+Expression rewrite_polynomials(const Expression& expr) {
+    switch(expr.type()) {
+      case ExpressionType::BIN_OP: {
+        if(std::optional<Expression> polynomial = try_polynomial(expr)) {
+            return std::move(*polynomial);
+        }
+        const BinOpExpression& bin_op = expr.as_bin_op();
+        auto [lhs, rhs] = bin_op.get_operands();
+        return Expression::bin_op(
+            Token(bin_op.get_operator()),
+            std::make_unique<Expression>(rewrite_polynomials(lhs)),
+            std::make_unique<Expression>(rewrite_polynomials(rhs)),
+            bin_op.is_domain_checked()
+        );
+      }
+      case ExpressionType::UNARY_OP: {
+        if(std::optional<Expression> polynomial = try_polynomial(expr)) {
+            return std::move(*polynomial);
+        }
+        const UnaryOpExpression& unary = expr.as_unary_op();
+        return Expression::unary_op(
+            Token(unary.get_operator()),
+            std::make_unique<Expression>(rewrite_polynomials(unary.get_operand())),
+            unary.is_domain_checked()
+        );
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        return Expression::conditional(
+            Token(expr.get_token()),
+            std::make_unique<Expression>(rewrite_polynomials(conditional.get_condition())),
+            std::make_unique<Expression>(rewrite_polynomials(if_true)),
+            std::make_unique<Expression>(rewrite_polynomials(if_false))
+        );
+      }
+      case ExpressionType::CALL: {
+        const CallExpression& call = expr.as_call();
+        std::vector<std::unique_ptr<Expression>> args;
+        for(const std::unique_ptr<Expression>& arg : call.get_args()) {
+            args.push_back(std::make_unique<Expression>(rewrite_polynomials(*arg)));
+        }
+        return Expression::call(Token(call.get_function()), std::move(args));
+      }
+      case ExpressionType::LET: {
+        const LetExpression& let = expr.as_let();
+        return Expression::let(
+            Token(let.get_name()),
+            let.get_slot(),
+            std::make_unique<Expression>(rewrite_polynomials(let.get_value())),
+            std::make_unique<Expression>(rewrite_polynomials(let.get_body()))
+        );
+      }
+      default: {
+        return expr.clone();
+      }
+    }
+}
+
+} // namespace clex
@@ -0,0 +1,76 @@
+#include "random.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace clex {
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9; // constante de Weyl (parte fraccionaria de la razón áurea)
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85; // constante de Weyl (parte fraccionaria de sqrt(3) - 1)
+constexpr int PHILOX_ROUNDS = 10;
+
+constexpr uint64_t SESSION_KEY = 0x63616C63756C6578; // "calculex"
+
+thread_local RandomStream t_current_stream(SESSION_KEY, 0);
+
+}
+
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> key) noexcept {
+    for(int round = 0; round < PHILOX_ROUNDS; round++) {
+        if(round > 0) {
+            key[0] += PHILOX_W0;
+            key[1] += PHILOX_W1;
+        }
+        uint64_t prod0 = static_cast<uint64_t>(PHILOX_M0) * ctr[0];
+        uint64_t prod1 = static_cast<uint64_t>(PHILOX_M1) * ctr[2];
+        ctr = {
+            static_cast<uint32_t>(prod1 >> 32) ^ ctr[1] ^ key[0],
+            static_cast<uint32_t>(prod1),
+            static_cast<uint32_t>(prod0 >> 32) ^ ctr[3] ^ key[1],
+            static_cast<uint32_t>(prod0),
+        };
+    }
+    return ctr;
+}
+
+RandomStream::RandomStream(uint64_t key, uint64_t stream) noexcept : m_key(key), m_stream(stream), m_counter(0) {};
+
+uint64_t RandomStream::next_u64() noexcept {
+    std::array<uint32_t, 4> block = philox4x32(
+        {
+            static_cast<uint32_t>(m_counter), static_cast<uint32_t>(m_counter >> 32),
+            static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32),
+        },
+        {static_cast<uint32_t>(m_key), static_cast<uint32_t>(m_key >> 32)}
+    );
+    m_counter++;
+    return (static_cast<uint64_t>(block[0]) << 32) | block[1];
+}
+
+double RandomStream::uniform() noexcept {
+    return static_cast<double>(next_u64() >> 11) * 0x1.0p-53; // los 53 bits altos llenan exactamente la mantisa
+}
+
+double RandomStream::normal() noexcept {
+    double u1 = 1.0 - uniform(); // en (0, 1], para que el logaritmo esté definido
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+RandomStream& current_random_stream() noexcept {
+    return t_current_stream;
+}
+
+ScopedRandomStream::ScopedRandomStream(RandomStream stream) noexcept : m_previous(t_current_stream) {
+    t_current_stream = stream;
+}
+
+ScopedRandomStream::~ScopedRandomStream() {
+    t_current_stream = m_previous;
+}
+
+} // namespace clex
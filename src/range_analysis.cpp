@@ -0,0 +1,391 @@
+#include "range_analysis.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+constexpr double RANDN_BOUND = 9.0; // Box-Muller con 53 bits nunca pasa de sqrt(-2*log(2^-53)) ≈ 8.57
+
+/**
+ * Resultado de analizar una subexpresión: la subexpresión transformada y su intervalo de valores.
+ */
+struct Analysis {
+    Expression expr;
+    Interval range;
+};
+
+// Los extremos calculados con funciones de <cmath> se amplían un ulp hacia fuera, porque estas funciones no
+// siempre están correctamente redondeadas. El cero se deja tal cual: las funciones usadas conservan el signo.
+double down(double value) noexcept {
+    return (value == 0.0 || std::isinf(value)) ? value : std::nextafter(value, -INF);
+}
+
+double up(double value) noexcept {
+    return (value == 0.0 || std::isinf(value)) ? value : std::nextafter(value, INF);
+}
+
+Interval make_interval(double lo, double hi, bool maybe_nan) noexcept {
+    if(lo != lo || hi != hi) { // algún extremo indeterminado, como inf - inf
+        return Interval::unbounded();
+    }
+    return Interval{lo, hi, maybe_nan};
+}
+
+bool contains_zero(const Interval& a) noexcept {
+    return a.lo <= 0.0 && a.hi >= 0.0;
+}
+
+bool is_unbounded(const Interval& a) noexcept {
+    return std::isinf(a.lo) || std::isinf(a.hi);
+}
+
+bool is_integer_point(const Interval& a) noexcept {
+    return !a.maybe_nan && a.lo == a.hi && a.lo == std::floor(a.lo) && std::isfinite(a.lo);
+}
+
+Interval hull(const Interval& a, const Interval& b) noexcept {
+    return Interval{std::min(a.lo, b.lo), std::max(a.hi, b.hi), a.maybe_nan || b.maybe_nan};
+}
+
+// Producto de extremos con 0 * inf = 0: los extremos son límites de valores reales, y el posible NaN se
+// tiene en cuenta aparte.
+double bound_product(double a, double b) noexcept {
+    return (a == 0.0 || b == 0.0) ? 0.0 : a * b;
+}
+
+Interval add(const Interval& a, const Interval& b) noexcept {
+    bool nan = a.maybe_nan || b.maybe_nan || (a.hi == INF && b.lo == -INF) || (a.lo == -INF && b.hi == INF);
+    return make_interval(a.lo + b.lo, a.hi + b.hi, nan);
+}
+
+Interval subtract(const Interval& a, const Interval& b) noexcept {
+    bool nan = a.maybe_nan || b.maybe_nan || (a.hi == INF && b.hi == INF) || (a.lo == -INF && b.lo == -INF);
+    return make_interval(a.lo - b.hi, a.hi - b.lo, nan);
+}
+
+Interval multiply(const Interval& a, const Interval& b) noexcept {
+    bool nan = a.maybe_nan || b.maybe_nan || (contains_zero(a) && is_unbounded(b)) || (contains_zero(b) && is_unbounded(a));
+    double products[] = {
+        bound_product(a.lo, b.lo), bound_product(a.lo, b.hi),
+        bound_product(a.hi, b.lo), bound_product(a.hi, b.hi)
+    };
+    return make_interval(*std::min_element(products, products + 4), *std::max_element(products, products + 4), nan);
+}
+
+Interval divide(const Interval& a, const Interval& b) noexcept {
+    if(contains_zero(b) || b.maybe_nan || (is_unbounded(a) && is_unbounded(b))) {
+        return Interval::unbounded();
+    }
+    double quotients[] = {a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi};
+    return make_interval(*std::min_element(quotients, quotients + 4), *std::max_element(quotients, quotients + 4), a.maybe_nan);
+}
+
+// `^` con comprobación de dominio lanza un error si el resultado es NaN, así que su resultado nunca es NaN.
+Interval power(const Interval& base, const Interval& exponent) noexcept {
+    if(is_integer_point(exponent)) {
+        double n = exponent.lo;
+        if(n == 0.0) {
+            return Interval::point(1.0);
+        }
+        bool even = std::fmod(n, 2.0) == 0.0;
+        if(n > 0.0 && even) {
+            double smallest = contains_zero(base) ? 0.0 : std::min(std::abs(base.lo), std::abs(base.hi));
+            double largest = std::max(std::abs(base.lo), std::abs(base.hi));
+            return make_interval(down(std::pow(smallest, n)), up(std::pow(largest, n)), false);
+        }
+        if(n > 0.0) {
+            return make_interval(down(std::pow(base.lo, n)), up(std::pow(base.hi, n)), false);
+        }
+        if(!contains_zero(base)) { // x^n es monótona a cada lado del cero
+            double at_lo = std::pow(base.lo, n), at_hi = std::pow(base.hi, n);
+            return make_interval(down(std::min(at_lo, at_hi)), up(std::max(at_lo, at_hi)), false);
+        }
+        return Interval{-INF, INF, false};
+    }
+    if(base.lo >= 0.0) {
+        if(base.maybe_nan || exponent.maybe_nan || is_unbounded(base) || is_unbounded(exponent)) {
+            return Interval{0.0, INF, false};
+        }
+        // con base no negativa, x^y es monótona en cada argumento, así que los extremos están en las esquinas
+        double corners[] = {
+            std::pow(base.lo, exponent.lo), std::pow(base.lo, exponent.hi),
+            std::pow(base.hi, exponent.lo), std::pow(base.hi, exponent.hi)
+        };
+        return make_interval(down(*std::min_element(corners, corners + 4)), up(*std::max_element(corners, corners + 4)), false);
+    }
+    return Interval{-INF, INF, false};
+}
+
+bool is_power_safe(const Interval& base, const Interval& exponent) noexcept {
+    return !base.maybe_nan && !exponent.maybe_nan && (base.lo >= 0.0 || is_integer_point(exponent));
+}
+
+Interval unary_range(TokenType oper, const Interval& a) noexcept {
+    switch(oper) {
+      case TokenType::OP_MINUS: {
+        return Interval{-a.hi, -a.lo, a.maybe_nan};
+      }
+      case TokenType::OP_PLUS: {
+        return a;
+      }
+      case TokenType::OP_NOT: {
+        return Interval{0.0, 1.0, false};
+      }
+      case TokenType::OP_FUNC_SQRT: {
+        return make_interval(std::sqrt(std::max(a.lo, 0.0)), std::sqrt(std::max(a.hi, 0.0)), a.maybe_nan);
+      }
+      case TokenType::OP_FUNC_LOG: {
+        return make_interval(down(std::log(std::max(a.lo, 0.0))), up(std::log(std::max(a.hi, 0.0))), a.maybe_nan);
+      }
+      case TokenType::OP_FUNC_SIN:
+      case TokenType::OP_FUNC_COS: {
+        return Interval{-1.0, 1.0, a.maybe_nan || is_unbounded(a)}; // sin(inf) es NaN
+      }
+      case TokenType::OP_FUNC_TAN: {
+        return Interval{-INF, INF, a.maybe_nan || is_unbounded(a)};
+      }
+      case TokenType::OP_FUNC_ARCSIN: {
+        return make_interval(
+            down(std::asin(std::clamp(a.lo, -1.0, 1.0))), up(std::asin(std::clamp(a.hi, -1.0, 1.0))), a.maybe_nan
+        );
+      }
+      case TokenType::OP_FUNC_ARCCOS: {
+        return make_interval(
+            down(std::acos(std::clamp(a.hi, -1.0, 1.0))), up(std::acos(std::clamp(a.lo, -1.0, 1.0))), a.maybe_nan
+        );
+      }
+      case TokenType::OP_FUNC_ARCTAN: {
+        return make_interval(down(std::atan(a.lo)), up(std::atan(a.hi)), a.maybe_nan);
+      }
+      default: return Interval::unbounded();
+    }
+}
+
+bool is_unary_safe(TokenType oper, const Interval& a) noexcept {
+    if(a.maybe_nan) {
+        return false;
+    }
+    switch(oper) {
+      case TokenType::OP_FUNC_SQRT: return a.lo >= 0.0;
+      case TokenType::OP_FUNC_LOG: return a.lo > 0.0;
+      case TokenType::OP_FUNC_ARCSIN:
+      case TokenType::OP_FUNC_ARCCOS: return a.lo >= -1.0 && a.hi <= 1.0;
+      default: return false;
+    }
+}
+
+class RangeAnalyzer {
+  private:
+    const SymbolTable& m_constants;
+    const VariableRanges& m_ranges;
+    std::vector<Interval> m_locals; // rango del valor de cada `let` que contiene la subexpresión analizada
+    std::vector<std::string> m_rebound; // variables a las que una llamada que contiene la subexpresión da otros valores
+
+    Interval identifier_range(const Token& ident) const noexcept {
+        if(std::find(m_rebound.begin(), m_rebound.end(), *ident.get_ident()) != m_rebound.end()) {
+            return Interval::unbounded();
+        }
+        auto it = m_ranges.find(*ident.get_ident());
+        if(it != m_ranges.end()) {
+            return it->second;
+        }
+        std::optional<double> value = m_constants.get(ident);
+        return value.has_value() ? Interval::point(*value) : Interval::unbounded();
+    }
+
+    std::unique_ptr<Expression> boxed(Expression&& expr) const {
+        return std::make_unique<Expression>(std::move(expr));
+    }
+  public:
+    RangeAnalyzer(const SymbolTable& constants, const VariableRanges& ranges) noexcept : m_constants(constants), m_ranges(ranges) {};
+
+    Analysis analyze(const Expression& expr) {
+        switch(expr.type()) {
+          case ExpressionType::OPERAND: {
+            const Token& tok = expr.get_token();
+            Interval range = tok.type() == TokenType::NUMBER ? Interval::point(*tok.get_num()) : identifier_range(tok);
+            return Analysis{expr.clone(), range};
+          }
+          case ExpressionType::BIN_OP: {
+            const BinOpExpression& bin_op = expr.as_bin_op();
+            auto [lhs_expr, rhs_expr] = bin_op.get_operands();
+            Analysis lhs = analyze(lhs_expr);
+            Analysis rhs = analyze(rhs_expr);
+            TokenType oper = bin_op.get_operator().type();
+            Interval range{0.0, 1.0, false}; // comparaciones y operadores lógicos
+            bool checked = bin_op.is_domain_checked();
+            switch(oper) {
+              case TokenType::OP_PLUS: range = add(lhs.range, rhs.range); break;
+              case TokenType::OP_MINUS: range = subtract(lhs.range, rhs.range); break;
+              case TokenType::OP_ASTERISK: range = multiply(lhs.range, rhs.range); break;
+              case TokenType::OP_SLASH: {
+                range = divide(lhs.range, rhs.range);
+                checked = checked && (rhs.range.maybe_nan || contains_zero(rhs.range));
+                break;
+              }
+              case TokenType::OP_CARET: {
+                range = power(lhs.range, rhs.range);
+                checked = checked && !is_power_safe(lhs.range, rhs.range);
+                break;
+              }
+              default: break;
+            }
+            return Analysis{
+                Expression::bin_op(Token(bin_op.get_operator()), boxed(std::move(lhs.expr)), boxed(std::move(rhs.expr)), checked),
+                range
+            };
+          }
+          case ExpressionType::UNARY_OP: {
+            const UnaryOpExpression& unary = expr.as_unary_op();
+            Analysis operand = analyze(unary.get_operand());
+            TokenType oper = unary.get_operator().type();
+            bool checked = unary.is_domain_checked() && !is_unary_safe(oper, operand.range);
+            return Analysis{
+                Expression::unary_op(Token(unary.get_operator()), boxed(std::move(operand.expr)), checked),
+                unary_range(oper, operand.range)
+            };
+          }
+          case ExpressionType::CONDITIONAL: {
+            const ConditionalExpression& conditional = expr.as_conditional();
+            auto [if_true_expr, if_false_expr] = conditional.get_branches();
+            Analysis condition = analyze(conditional.get_condition());
+            Analysis if_true = analyze(if_true_expr);
+            Analysis if_false = analyze(if_false_expr);
+            Interval range = hull(if_true.range, if_false.range);
+            if(!condition.range.maybe_nan && !contains_zero(condition.range)) {
+                range = if_true.range; // la condición siempre es cierta
+            } else if(condition.range.lo == 0.0 && condition.range.hi == 0.0 && !condition.range.maybe_nan) {
+                range = if_false.range; // la condición siempre es falsa
+            }
+            return Analysis{
+                Expression::conditional(
+                    Token(expr.get_token()), boxed(std::move(condition.expr)),
+                    boxed(std::move(if_true.expr)), boxed(std::move(if_false.expr))
+                ),
+                range
+            };
+          }
+          case ExpressionType::CALL: {
+            const CallExpression& call = expr.as_call();
+            // `minimize` y `argmin` evalúan la expresión con cualquier valor real de sus variables, y `ode` evalúa los
+            // lados derechos con los valores del estado y del tiempo durante la integración, no con los de fuera
+            const std::vector<std::unique_ptr<Expression>>& call_args = call.get_args();
+            size_t rebinding_args = 0;
+            size_t names_begin = 0;
+            size_t names_end = 0;
+            if(call.get_function().type() == TokenType::FUNC_MINIMIZE || call.get_function().type() == TokenType::FUNC_ARGMIN) {
+                rebinding_args = 1;
+                names_begin = 1;
+                names_end = call_args.size();
+            } else if(call.get_function().type() == TokenType::FUNC_ODE) {
+                rebinding_args = (call_args.size() - 2) / 2;
+                names_begin = rebinding_args;
+                names_end = call_args.size() - 1;
+            }
+            size_t rebound_size = m_rebound.size();
+            for(size_t i = names_begin; i < names_end; i++) {
+                if(call_args[i]->type() == ExpressionType::OPERAND && call_args[i]->get_token().type() == TokenType::IDENTIFIER) {
+                    m_rebound.push_back(*call_args[i]->get_token().get_ident());
+                }
+            }
+            std::vector<std::unique_ptr<Expression>> args;
+            std::vector<Interval> arg_ranges;
+            for(size_t i = 0; i < call_args.size(); i++) {
+                if(i == rebinding_args) {
+                    m_rebound.resize(rebound_size);
+                }
+                Analysis analysis = analyze(*call_args[i]);
+                args.push_back(boxed(std::move(analysis.expr)));
+                arg_ranges.push_back(analysis.range);
+            }
+            m_rebound.resize(rebound_size);
+            Interval range = Interval::unbounded();
+            switch(call.get_function().type()) {
+              case TokenType::FUNC_RAND: range = Interval{0.0, 1.0, false}; break;
+              case TokenType::FUNC_RANDN: range = Interval{-RANDN_BOUND, RANDN_BOUND, false}; break;
+              case TokenType::FUNC_MC: range = Interval{-INF, INF, arg_ranges[0].maybe_nan}; break;
+              case TokenType::FUNC_MCERR: range = Interval{0.0, INF, arg_ranges[0].maybe_nan}; break;
+              default: break;
+            }
+            return Analysis{Expression::call(Token(call.get_function()), std::move(args)), range};
+          }
+          case ExpressionType::POLYNOMIAL: {
+            return Analysis{expr.clone(), analyze(expr.as_polynomial().get_original()).range};
+          }
+          case ExpressionType::APPROXIMATION: {
+            // la expresión original solo se evalúa fuera del intervalo de la tabla, así que conserva sus comprobaciones
+            const ApproximationExpression& approximation = expr.as_approximation();
+            const PiecewisePolynomial& table = approximation.get_table();
+            auto [lo, hi] = table.bounds();
+            Interval range{lo, hi, false};
+            Interval var_range = identifier_range(approximation.get_variable());
+            if(var_range.maybe_nan || var_range.lo < table.lo() || var_range.hi > table.hi()) {
+                range = hull(range, analyze(approximation.get_original()).range);
+            }
+            return Analysis{expr.clone(), range};
+          }
+          case ExpressionType::LET: {
+            const LetExpression& let = expr.as_let();
+            Analysis value = analyze(let.get_value());
+            if(let.get_slot() >= m_locals.size()) {
+                m_locals.resize(let.get_slot() + 1, Interval::unbounded());
+            }
+            m_locals[let.get_slot()] = value.range;
+            Analysis body = analyze(let.get_body());
+            return Analysis{
+                Expression::let(Token(let.get_name()), let.get_slot(), boxed(std::move(value.expr)), boxed(std::move(body.expr))),
+                body.range
+            };
+          }
+          case ExpressionType::LOCAL: {
+            // fuera del `let` que la define (al analizar solo una parte de su cuerpo) puede valer cualquier cosa
+            size_t slot = expr.as_local().get_slot();
+            return Analysis{expr.clone(), slot < m_locals.size() ? m_locals[slot] : Interval::unbounded()};
+          }
+        }
+        __builtin_unreachable();
+    }
+};
+
+}
+
+Interval Interval::point(double value) noexcept {
+    if(value != value) {
+        return unbounded();
+    }
+    return Interval{value, value, false};
+}
+
+Interval Interval::unbounded() noexcept {
+    return Interval{-INF, INF, true};
+}
+
+bool Interval::contains(double value) const noexcept {
+    if(value != value) {
+        return maybe_nan;
+    }
+    return lo <= value && value <= hi;
+}
+
+Interval range_of(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges) {
+    return RangeAnalyzer(constants, ranges).analyze(expr).range;
+}
+
+Expression elide_domain_checks(const Expression& expr, const SymbolTable& constants, const VariableRanges& ranges) {
+    return RangeAnalyzer(constants, ranges).analyze(expr).expr;
+}
+
+} // namespace clex
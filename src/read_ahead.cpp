@@ -0,0 +1,166 @@
+#include "read_ahead.hpp"
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+enum class Readiness { READY, EMPTY, STOPPED };
+
+// Espera hasta `timeout_ms` milisegundos (sin límite si es negativo) a que se pueda leer `fd` sin bloquear, o a que
+// se pueda leer `wake_fd`, que indica que hay que parar.
+Readiness wait_readable(int fd, int wake_fd, int timeout_ms) {
+    pollfd fds[2] = {{fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+    int ready;
+    while((ready = poll(fds, 2, timeout_ms)) < 0) {
+        if(errno != EINTR) {
+            return Readiness::READY; // el error, si lo hay, lo dará el propio `read`
+        }
+    }
+    if(fds[1].revents != 0) {
+        return Readiness::STOPPED;
+    }
+    return ready > 0 ? Readiness::READY : Readiness::EMPTY;
+}
+
+}
+
+ReadAheadBuffer::ReadAheadBuffer(int fd, bool owns_fd, uint64_t offset, size_t block_size, size_t depth) 
+  : m_fd(fd), m_owns_fd(owns_fd), m_mutex(), m_changed(), m_ready(), m_free(depth, std::vector<char>(block_size)), 
+    m_current(), m_finished(false), m_failed(false), m_stop(false), m_wake{-1, -1}, m_reader() {
+    setg(nullptr, nullptr, nullptr);
+    if(pipe2(m_wake, O_CLOEXEC) < 0) {
+        if(owns_fd) {
+            close(fd);
+        }
+        throw std::runtime_error("No se ha podido crear la tubería del hilo lector");
+    }
+    m_reader = std::thread(&ReadAheadBuffer::read_loop, this, offset, block_size);
+}
+
+std::unique_ptr<ReadAheadBuffer> ReadAheadBuffer::open(const std::string& path, uint64_t offset) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        throw std::runtime_error("No se ha podido abrir " + path);
+    }
+    return std::make_unique<ReadAheadBuffer>(fd, true, offset);
+}
+
+ReadAheadBuffer::~ReadAheadBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    // despierta al hilo lector si está esperando datos del descriptor
+    [[maybe_unused]] ssize_t written = write(m_wake[1], "", 1);
+    m_reader.join();
+    close(m_wake[0]);
+    close(m_wake[1]);
+    if(m_owns_fd) {
+        close(m_fd);
+    }
+}
+
+void ReadAheadBuffer::read_loop(uint64_t offset, size_t block_size) {
+    bool use_pread = m_owns_fd; // se cambia a `read` si el descriptor no admite posiciones
+    while(true) {
+        std::vector<char> block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this] { return m_stop || !m_free.empty(); });
+            if(m_stop) {
+                return;
+            }
+            block = std::move(m_free.back());
+            m_free.pop_back();
+        }
+        block.resize(block_size);
+        size_t filled = 0;
+        bool ended = false;
+        bool failed = false;
+        // se rellena el bloque entero salvo al final del fichero, o si una tubería se queda sin datos por el momento:
+        // así no se entregan bloques pequeños mientras los datos llegan seguidos, ni se retienen los que ya han llegado
+        while(filled < block_size) {
+            if(!use_pread) {
+                Readiness readiness = wait_readable(m_fd, m_wake[0], filled > 0 ? 0 : -1);
+                if(readiness == Readiness::STOPPED) {
+                    return;
+                }
+                if(readiness == Readiness::EMPTY) {
+                    break;
+                }
+            }
+            ssize_t got = use_pread ? pread(m_fd, block.data() + filled, block_size - filled, static_cast<off_t>(offset))
+                                    : read(m_fd, block.data() + filled, block_size - filled);
+            if(got < 0 && use_pread && errno == ESPIPE) {
+                use_pread = false;
+                continue;
+            }
+            if(got < 0 && errno == EINTR) {
+                continue;
+            }
+            if(got <= 0) {
+                ended = true;
+                failed = got < 0;
+                break;
+            }
+            filled += static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+        block.resize(filled);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(filled > 0) {
+                m_ready.push_back(std::move(block));
+            }
+            if(ended) {
+                m_finished = true;
+                m_failed = failed;
+            }
+        }
+        m_changed.notify_all();
+        if(ended) {
+            return;
+        }
+    }
+}
+
+ReadAheadBuffer::int_type ReadAheadBuffer::underflow() {
+    if(gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_current.capacity() > 0) { // se devuelve el bloque anterior al hilo lector
+        m_free.push_back(std::move(m_current));
+        m_current = std::vector<char>();
+        m_changed.notify_all();
+    }
+    m_changed.wait(lock, [this] { return !m_ready.empty() || m_finished; });
+    if(m_ready.empty()) {
+        setg(nullptr, nullptr, nullptr);
+        if(m_failed) {
+            throw std::runtime_error("Error al leer la entrada"); // el flujo lo recoge y pasa a estado `bad()`
+        }
+        return traits_type::eof();
+    }
+    m_current = std::move(m_ready.front());
+    m_ready.pop_front();
+    setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+} // namespace clex
@@ -0,0 +1,492 @@
+#include "shm_transport.hpp"
+#include "eval_errors.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tiered.hpp"
+#include "tokens.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr uint64_t SHM_MAGIC = 0x636c65785f73686dULL; // "clex_shm"
+constexpr uint32_t SHM_VERSION = 1;
+constexpr uint32_t RING_CAPACITY = 64;
+constexpr uint32_t MAX_ARGS = 16;
+constexpr uint32_t SHUTDOWN_FORMULA = UINT32_MAX;
+constexpr int SPIN_ITERATIONS = 2048; // vueltas antes de dormirse en el futex, si hay más de un núcleo
+
+struct ShmRequest {
+    uint32_t formula;
+    uint32_t n_args;
+    double args[MAX_ARGS];
+};
+
+struct ShmResponse {
+    ShmStatus status;
+    double value;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "los contadores compartidos deben ser atómicos sin bloqueos");
+
+// Con un único núcleo, la otra parte no puede avanzar mientras ésta da vueltas, así que se duerme directamente.
+int spin_iterations() noexcept {
+    static const int iterations = std::thread::hardware_concurrency() > 1 ? SPIN_ITERATIONS : 0;
+    return iterations;
+}
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Los futex se usan sin FUTEX_PRIVATE_FLAG porque la memoria es compartida entre procesos.
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * Contador compartido que solo modifica un proceso y al que el otro puede esperar. `waiters` indica si el otro
+ * proceso está dormido en el futex, para no hacer la llamada al sistema de despertarlo si no hace falta.
+ */
+struct alignas(64) SharedCounter {
+    std::atomic<uint32_t> value{0};
+    std::atomic<uint32_t> waiters{0};
+
+    void publish(uint32_t new_value) noexcept {
+        value.store(new_value, std::memory_order_seq_cst);
+        if(waiters.load(std::memory_order_seq_cst) > 0) {
+            futex_wake(value);
+        }
+    }
+
+    // Espera a que el contador deje de valer `seen` y devuelve su nuevo valor.
+    uint32_t wait_change(uint32_t seen) noexcept {
+        uint32_t current;
+        for(int i = 0; i < spin_iterations(); i++) {
+            if((current = value.load(std::memory_order_acquire)) != seen) {
+                return current;
+            }
+            cpu_relax();
+        }
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        while((current = value.load(std::memory_order_seq_cst)) == seen) {
+            futex_wait(value, seen);
+        }
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return current;
+    }
+};
+
+/**
+ * Cola circular de un productor y un consumidor. Los contadores crecen indefinidamente (con desbordamiento) y
+ * la posición en `slots` es el contador módulo la capacidad.
+ */
+template<typename T>
+struct SpscRing {
+    SharedCounter head; // lo escribe el productor
+    SharedCounter tail; // lo escribe el consumidor
+    T slots[RING_CAPACITY];
+
+    void push(const T& item) noexcept {
+        uint32_t h = head.value.load(std::memory_order_relaxed);
+        uint32_t t = tail.value.load(std::memory_order_acquire);
+        while(h - t == RING_CAPACITY) {
+            t = tail.wait_change(t);
+        }
+        slots[h % RING_CAPACITY] = item;
+        head.publish(h + 1);
+    }
+
+    T pop() noexcept {
+        uint32_t t = tail.value.load(std::memory_order_relaxed);
+        uint32_t h = head.value.load(std::memory_order_acquire);
+        while(h == t) {
+            h = head.wait_change(h);
+        }
+        T item = slots[t % RING_CAPACITY];
+        tail.publish(t + 1);
+        return item;
+    }
+
+    // Saca, sin esperar, hasta `max` de los elementos que ya están en la cola y devuelve cuántos ha sacado.
+    size_t try_pop_many(T* out, size_t max) noexcept {
+        uint32_t t = tail.value.load(std::memory_order_relaxed);
+        uint32_t h = head.value.load(std::memory_order_acquire);
+        size_t n = std::min<size_t>(h - t, max);
+        for(size_t i = 0; i < n; i++) {
+            out[i] = slots[(t + i) % RING_CAPACITY];
+        }
+        if(n > 0) {
+            tail.publish(t + static_cast<uint32_t>(n));
+        }
+        return n;
+    }
+
+    // Mete varios elementos, publicando de una vez todos los que caben en cada momento.
+    void push_many(const T* items, size_t n) noexcept {
+        uint32_t h = head.value.load(std::memory_order_relaxed);
+        size_t done = 0;
+        while(done < n) {
+            uint32_t t = tail.value.load(std::memory_order_acquire);
+            while(h - t == RING_CAPACITY) {
+                t = tail.wait_change(t);
+            }
+            size_t chunk = std::min<size_t>(RING_CAPACITY - (h - t), n - done);
+            for(size_t i = 0; i < chunk; i++) {
+                slots[(h + i) % RING_CAPACITY] = items[done + i];
+            }
+            h += static_cast<uint32_t>(chunk);
+            done += chunk;
+            head.publish(h);
+        }
+    }
+};
+
+// Identificadores de `expr` que no están en `symbols`, en orden de primera aparición.
+void collect_variables(const Expression& expr, const SymbolTable& symbols, std::vector<Token>& variables) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: {
+        const Token& tok = expr.get_token();
+        bool seen = std::any_of(variables.begin(), variables.end(), [&](const Token& var) { return var.get_ident() == tok.get_ident(); });
+        if(tok.type() == TokenType::IDENTIFIER && !seen && !symbols.get(tok).has_value()) {
+            variables.push_back(tok);
+        }
+        return;
+      }
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        collect_variables(lhs, symbols, variables);
+        collect_variables(rhs, symbols, variables);
+        return;
+      }
+      case ExpressionType::UNARY_OP: {
+        collect_variables(expr.as_unary_op().get_operand(), symbols, variables);
+        return;
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        collect_variables(conditional.get_condition(), symbols, variables);
+        collect_variables(if_true, symbols, variables);
+        collect_variables(if_false, symbols, variables);
+        return;
+      }
+      case ExpressionType::CALL: {
+        for(const std::unique_ptr<Expression>& arg : expr.as_call().get_args()) {
+            collect_variables(*arg, symbols, variables);
+        }
+        return;
+      }
+      case ExpressionType::POLYNOMIAL: {
+        collect_variables(expr.as_polynomial().get_original(), symbols, variables);
+        return;
+      }
+      case ExpressionType::APPROXIMATION: {
+        collect_variables(expr.as_approximation().get_original(), symbols, variables);
+        return;
+      }
+      case ExpressionType::LET: {
+        collect_variables(expr.as_let().get_value(), symbols, variables);
+        collect_variables(expr.as_let().get_body(), symbols, variables);
+        return;
+      }
+      case ExpressionType::LOCAL: {
+        return;
+      }
+    }
+}
+
+/**
+ * Memoria reutilizada entre lotes para evaluar juntas las peticiones de una misma expresión.
+ */
+struct GroupBuffers {
+    std::vector<std::vector<double>> columns;
+    std::vector<const double*> column_pointers;
+    std::vector<double> results;
+    std::vector<uint8_t> failed;
+};
+
+// Evalúa juntas las peticiones `rows` de `batch`, que son todas de la expresión `formula` y tienen los argumentos 
+// correctos, y escribe sus respuestas.
+void evaluate_group(const ShmServer::Formula& formula, SymbolTable& symbols, const ShmRequest* batch,
+                    const std::vector<size_t>& rows, ShmResponse* responses, GroupBuffers& buffers) {
+    size_t n_vars = formula.variables.size();
+    if(rows.size() == 1) {
+        ShmResponse& response = responses[rows[0]];
+        try {
+            response.value = formula.engine->evaluate(batch[rows[0]].args, symbols);
+            response.status = ShmStatus::OK;
+        } catch(const EvalError&) {
+            response.status = ShmStatus::EVAL_ERROR;
+        }
+        return;
+    }
+    buffers.columns.resize(std::max(buffers.columns.size(), n_vars));
+    buffers.column_pointers.resize(n_vars);
+    for(size_t i = 0; i < n_vars; i++) {
+        buffers.columns[i].resize(rows.size());
+        for(size_t r = 0; r < rows.size(); r++) {
+            buffers.columns[i][r] = batch[rows[r]].args[i];
+        }
+        buffers.column_pointers[i] = buffers.columns[i].data();
+    }
+    buffers.results.resize(rows.size());
+    buffers.failed.resize(rows.size());
+    formula.engine->evaluate_batch(buffers.column_pointers.data(), rows.size(), symbols, buffers.results.data(), buffers.failed.data());
+    for(size_t r = 0; r < rows.size(); r++) {
+        ShmResponse& response = responses[rows[r]];
+        response.status = buffers.failed[r] ? ShmStatus::EVAL_ERROR : ShmStatus::OK;
+        response.value = buffers.failed[r] ? 0.0 : buffers.results[r];
+    }
+}
+
+}
+
+/**
+ * Contenido del segmento de memoria compartida. `magic` se escribe en último lugar, cuando las colas ya están
+ * inicializadas, así que un cliente que lo lee puede usarlas.
+ */
+struct ShmSegment {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    SpscRing<ShmRequest> requests;
+    SpscRing<ShmResponse> responses;
+};
+
+namespace {
+
+ShmSegment* map_segment(int fd) {
+    void* memory = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED) {
+        throw std::runtime_error("No se ha podido proyectar el segmento de memoria compartida");
+    }
+    return static_cast<ShmSegment*>(memory);
+}
+
+}
+
+ShmServer::ShmServer(const std::string& name, const std::vector<Expression>& exprs, const SymbolTable& symbols,
+                     const std::string& native_dir, const TierThresholds& thresholds, const ShmBatching& batching)
+    : m_name(name), m_segment(nullptr), m_inode(0), m_symbols(symbols), m_formulas(), m_batching(batching), m_statistics{0, 0, 0, 0, 0.0} {
+    if(batching.max_size == 0 || batching.max_size > RING_CAPACITY) {
+        throw std::invalid_argument("Batch size must be between 1 and " + std::to_string(RING_CAPACITY));
+    }
+    for(const Expression& expr : exprs) {
+        std::vector<Token> variables;
+        collect_variables(expr, symbols, variables);
+        if(variables.size() > MAX_ARGS) {
+            throw std::runtime_error("Las expresiones servidas por memoria compartida admiten como mucho "
+                                     + std::to_string(MAX_ARGS) + " variables");
+        }
+        auto engine = std::make_unique<TieredFormula>(expr, variables, symbols, native_dir, thresholds);
+        m_formulas.push_back(Formula{std::move(variables), std::move(engine)});
+    }
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    struct stat info;
+    if(fd < 0 || ftruncate(fd, sizeof(ShmSegment)) != 0 || fstat(fd, &info) != 0) {
+        if(fd >= 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+        }
+        throw std::runtime_error("No se ha podido crear el segmento de memoria compartida " + name);
+    }
+    m_inode = info.st_ino;
+    m_segment = new(map_segment(fd)) ShmSegment{};
+    m_segment->version = SHM_VERSION;
+    m_segment->magic.store(SHM_MAGIC, std::memory_order_release);
+}
+
+ShmServer::~ShmServer() {
+    munmap(m_segment, sizeof(ShmSegment));
+    // si otro servidor ha creado un segmento con el mismo nombre, el nombre ya es suyo y no se elimina
+    int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+    if(fd >= 0) {
+        struct stat info;
+        if(fstat(fd, &info) == 0 && info.st_ino == m_inode) {
+            shm_unlink(m_name.c_str());
+        }
+        close(fd);
+    }
+}
+
+const std::vector<ShmServer::Formula>& ShmServer::formulas() const noexcept {
+    return m_formulas;
+}
+
+ShmBatchStatistics ShmServer::batch_statistics() const noexcept {
+    return m_statistics;
+}
+
+void ShmServer::serve() {
+    std::vector<ShmRequest> batch(m_batching.max_size);
+    std::vector<ShmResponse> responses(m_batching.max_size);
+    std::vector<std::vector<size_t>> groups(m_formulas.size());
+    GroupBuffers buffers;
+    auto is_shutdown = [](const ShmRequest& request) { return request.formula == SHUTDOWN_FORMULA; };
+    bool stop = false;
+    while(!stop) {
+        // se espera a la primera petición del lote y se recogen las que ya hay en la cola o llegan antes del plazo
+        batch[0] = m_segment->requests.pop();
+        size_t n = 1 + m_segment->requests.try_pop_many(batch.data() + 1, batch.size() - 1);
+        if(m_batching.max_delay_us > 0 && n < batch.size() && std::none_of(batch.begin(), batch.begin() + n, is_shutdown)) {
+            auto start = std::chrono::steady_clock::now();
+            auto deadline = start + std::chrono::microseconds(m_batching.max_delay_us);
+            while(n < batch.size() && std::chrono::steady_clock::now() < deadline) {
+                size_t got = m_segment->requests.try_pop_many(batch.data() + n, batch.size() - n);
+                if(std::any_of(batch.begin() + n, batch.begin() + n + got, is_shutdown)) {
+                    n += got;
+                    break;
+                }
+                n += got;
+                cpu_relax();
+            }
+            m_statistics.wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        // el cliente no envía nada después de pedir que el servidor se detenga
+        auto shutdown = std::find_if(batch.begin(), batch.begin() + n, is_shutdown);
+        if(shutdown != batch.begin() + n) {
+            n = shutdown - batch.begin();
+            stop = true;
+        }
+        if(n == 0) {
+            continue;
+        }
+
+        for(std::vector<size_t>& group : groups) {
+            group.clear();
+        }
+        for(size_t i = 0; i < n; i++) {
+            const ShmRequest& request = batch[i];
+            responses[i] = ShmResponse{ShmStatus::INVALID_ARGUMENTS, 0.0};
+            if(request.n_args > MAX_ARGS) {
+                continue;
+            } else if(request.formula >= m_formulas.size()) {
+                responses[i].status = ShmStatus::INVALID_FORMULA;
+            } else if(request.n_args == m_formulas[request.formula].variables.size()) {
+                groups[request.formula].push_back(i);
+            }
+        }
+        for(size_t id = 0; id < groups.size(); id++) {
+            if(!groups[id].empty()) {
+                evaluate_group(m_formulas[id], m_symbols, batch.data(), groups[id], responses.data(), buffers);
+                m_statistics.grouped += groups[id].size() > 1 ? groups[id].size() : 0;
+            }
+        }
+        m_segment->responses.push_many(responses.data(), n);
+        m_statistics.requests += n;
+        m_statistics.batches++;
+        m_statistics.largest = std::max<uint64_t>(m_statistics.largest, n);
+    }
+}
+
+ShmClient::ShmClient(ShmSegment* segment) noexcept : m_segment(segment) {};
+
+ShmClient ShmClient::connect(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0) {
+        throw std::runtime_error("No existe el segmento de memoria compartida " + name);
+    }
+    ShmSegment* segment = map_segment(fd);
+    if(segment->magic.load(std::memory_order_acquire) != SHM_MAGIC || segment->version != SHM_VERSION) {
+        munmap(segment, sizeof(ShmSegment));
+        throw std::runtime_error("El segmento " + name + " no es de un servidor compatible");
+    }
+    return ShmClient(segment);
+}
+
+ShmClient::ShmClient(ShmClient&& other) noexcept : m_segment(other.m_segment) {
+    other.m_segment = nullptr;
+}
+
+ShmClient::~ShmClient() {
+    if(m_segment != nullptr) {
+        munmap(m_segment, sizeof(ShmSegment));
+    }
+}
+
+ShmStatus ShmClient::evaluate(uint32_t formula, const double* args, size_t n_args, double& result) {
+    if(n_args > MAX_ARGS) {
+        return ShmStatus::INVALID_ARGUMENTS;
+    }
+    ShmRequest request;
+    request.formula = formula;
+    request.n_args = static_cast<uint32_t>(n_args);
+    std::copy(args, args + n_args, request.args);
+    m_segment->requests.push(request);
+    ShmResponse response = m_segment->responses.pop();
+    result = response.value;
+    return response.status;
+}
+
+namespace {
+
+// Envía `count` peticiones, la `i`-ésima de la expresión `formula_of(i)`, manteniendo varias en vuelo.
+template<typename FormulaOf>
+void evaluate_requests(ShmSegment* segment, FormulaOf&& formula_of, const double* args, size_t n_args, size_t count,
+                       double* results, ShmStatus* statuses) {
+    if(n_args > MAX_ARGS) {
+        std::fill(statuses, statuses + count, ShmStatus::INVALID_ARGUMENTS);
+        return;
+    }
+    // como mucho una cola llena de peticiones sin responder, para que la cola de respuestas nunca se llene
+    size_t sent = 0;
+    for(size_t received = 0; received < count; received++) {
+        for(; sent < count && sent - received < RING_CAPACITY; sent++) {
+            ShmRequest request;
+            request.formula = formula_of(sent);
+            request.n_args = static_cast<uint32_t>(n_args);
+            std::copy(args + sent * n_args, args + (sent + 1) * n_args, request.args);
+            segment->requests.push(request);
+        }
+        ShmResponse response = segment->responses.pop();
+        results[received] = response.value;
+        statuses[received] = response.status;
+    }
+}
+
+}
+
+void ShmClient::evaluate_many(uint32_t formula, const double* args, size_t n_args, size_t count, double* results, ShmStatus* statuses) {
+    evaluate_requests(m_segment, [formula](size_t) { return formula; }, args, n_args, count, results, statuses);
+}
+
+void ShmClient::evaluate_mixed(const uint32_t* formulas, const double* args, size_t n_args, size_t count, double* results,
+                               ShmStatus* statuses) {
+    evaluate_requests(m_segment, [formulas](size_t i) { return formulas[i]; }, args, n_args, count, results, statuses);
+}
+
+void ShmClient::shutdown() {
+    ShmRequest request{};
+    request.formula = SHUTDOWN_FORMULA;
+    m_segment->requests.push(request);
+}
+
+} // namespace clex
@@ -0,0 +1,321 @@
+#include "speculation.hpp"
+#include "eval_errors.hpp"
+#include "polynomial.hpp"
+#include "range_analysis.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+// Añade a `out` los identificadores de `expr` que no están dentro de una llamada a función, sin repetir.
+void collect_variables(const Expression& expr, std::vector<Token>& out) {
+    switch(expr.type()) {
+      case ExpressionType::OPERAND: {
+        const Token& tok = expr.get_token();
+        if(tok.type() == TokenType::IDENTIFIER) {
+            for(const Token& seen : out) {
+                if(*seen.get_ident() == *tok.get_ident()) {
+                    return;
+                }
+            }
+            out.push_back(tok);
+        }
+        return;
+      }
+      case ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        collect_variables(lhs, out);
+        collect_variables(rhs, out);
+        return;
+      }
+      case ExpressionType::UNARY_OP: {
+        collect_variables(expr.as_unary_op().get_operand(), out);
+        return;
+      }
+      case ExpressionType::CONDITIONAL: {
+        const ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        collect_variables(conditional.get_condition(), out);
+        collect_variables(if_true, out);
+        collect_variables(if_false, out);
+        return;
+      }
+      case ExpressionType::LET: {
+        collect_variables(expr.as_let().get_value(), out);
+        collect_variables(expr.as_let().get_body(), out);
+        return;
+      }
+      case ExpressionType::POLYNOMIAL: {
+        collect_variables(expr.as_polynomial().get_original(), out);
+        return;
+      }
+      case ExpressionType::CALL:
+      case ExpressionType::APPROXIMATION:
+      case ExpressionType::LOCAL: return;
+    }
+}
+
+bool is_number(const Expression& expr) noexcept {
+    return expr.type() == ExpressionType::OPERAND && expr.get_token().type() == TokenType::NUMBER;
+}
+
+bool is_number(const Expression& expr, double value) noexcept {
+    return is_number(expr) && *expr.get_token().get_num() == value && !std::signbit(*expr.get_token().get_num());
+}
+
+// Si `value` es una potencia de dos cuyo inverso también se puede representar de forma exacta
+bool has_exact_reciprocal(double value) noexcept {
+    int exponent;
+    double mantissa = std::frexp(value, &exponent);
+    double reciprocal = 1.0 / value;
+    return std::isfinite(value) && std::fabs(mantissa) == 0.5 && reciprocal != 0.0 && std::isfinite(reciprocal);
+}
+
+class Specializer {
+  private:
+    std::unordered_map<std::string, double> m_values;
+
+    std::unique_ptr<Expression> boxed(Expression&& expr) const {
+        return std::make_unique<Expression>(std::move(expr));
+    }
+
+    // Sustituye una subexpresión sin variables por su valor, salvo si da un error al evaluarla
+    Expression folded(Expression&& expr) const {
+        try {
+            return Expression::operand(Token::number(expr.evaluate(SymbolTable())));
+        } catch(const EvalError&) {
+            return std::move(expr);
+        }
+    }
+
+    Expression simplify_bin_op(const BinOpExpression& bin_op, Expression&& lhs, Expression&& rhs) const {
+        TokenType oper = bin_op.get_operator().type();
+        bool checked = bin_op.is_domain_checked();
+        switch(oper) {
+          case TokenType::OP_AND: {
+            if(is_number(lhs) && *lhs.get_token().get_num() == 0.0) {
+                return Expression::operand(Token::number(0.0));
+            }
+            break;
+          }
+          case TokenType::OP_OR: {
+            if(is_number(lhs) && *lhs.get_token().get_num() != 0.0) {
+                return Expression::operand(Token::number(1.0));
+            }
+            break;
+          }
+          case TokenType::OP_ASTERISK: {
+            if(is_number(rhs, 1.0)) {
+                return std::move(lhs);
+            } else if(is_number(lhs, 1.0)) {
+                return std::move(rhs);
+            }
+            break;
+          }
+          case TokenType::OP_SLASH: {
+            if(is_number(rhs, 1.0)) {
+                return std::move(lhs);
+            } else if(is_number(rhs) && !is_number(lhs) && has_exact_reciprocal(*rhs.get_token().get_num())) {
+                // x/2^k y x*2^-k son el mismo valor redondeado, y el divisor nunca es cero
+                return Expression::bin_op(
+                    Token(TokenType::OP_ASTERISK), boxed(std::move(lhs)),
+                    boxed(Expression::operand(Token::number(1.0 / *rhs.get_token().get_num()))), false
+                );
+            }
+            break;
+          }
+          case TokenType::OP_MINUS: {
+            if(is_number(rhs, 0.0)) { // x - (+0) es x incluso para x = -0, al contrario que x + 0
+                return std::move(lhs);
+            }
+            break;
+          }
+          case TokenType::OP_CARET: {
+            if(!checked && is_number(rhs, 1.0)) { // con la comprobación, NaN^1 da un error y NaN no
+                return std::move(lhs);
+            }
+            break;
+          }
+          default: break;
+        }
+        Expression result = Expression::bin_op(Token(bin_op.get_operator()), boxed(std::move(lhs)), boxed(std::move(rhs)), checked);
+        if(is_number(result.as_bin_op().get_operands().first) && is_number(result.as_bin_op().get_operands().second)) {
+            return folded(std::move(result));
+        }
+        return result;
+    }
+  public:
+    Specializer(const SymbolTable& symbols, const std::vector<Token>& fixed) {
+        for(const Token& var : fixed) {
+            std::optional<double> value = symbols.get(var);
+            if(value.has_value()) {
+                m_values.emplace(*var.get_ident(), *value);
+            }
+        }
+    }
+
+    Expression specialize(const Expression& expr) const {
+        switch(expr.type()) {
+          case ExpressionType::OPERAND: {
+            const Token& tok = expr.get_token();
+            if(tok.type() == TokenType::IDENTIFIER) {
+                auto it = m_values.find(*tok.get_ident());
+                if(it != m_values.end()) {
+                    return Expression::operand(Token::number(it->second));
+                }
+            }
+            return expr.clone();
+          }
+          case ExpressionType::BIN_OP: {
+            const BinOpExpression& bin_op = expr.as_bin_op();
+            auto [lhs, rhs] = bin_op.get_operands();
+            return simplify_bin_op(bin_op, specialize(lhs), specialize(rhs));
+          }
+          case ExpressionType::UNARY_OP: {
+            const UnaryOpExpression& unary = expr.as_unary_op();
+            Expression operand = specialize(unary.get_operand());
+            if(unary.get_operator().type() == TokenType::OP_PLUS) {
+                return operand;
+            }
+            bool constant = is_number(operand);
+            Expression result = Expression::unary_op(Token(unary.get_operator()), boxed(std::move(operand)), unary.is_domain_checked());
+            return constant ? folded(std::move(result)) : std::move(result);
+          }
+          case ExpressionType::CONDITIONAL: {
+            const ConditionalExpression& conditional = expr.as_conditional();
+            auto [if_true, if_false] = conditional.get_branches();
+            Expression condition = specialize(conditional.get_condition());
+            if(is_number(condition)) {
+                return specialize(*condition.get_token().get_num() != 0.0 ? if_true : if_false);
+            }
+            return Expression::conditional(
+                Token(expr.get_token()), boxed(std::move(condition)), boxed(specialize(if_true)), boxed(specialize(if_false))
+            );
+          }
+          case ExpressionType::LET: {
+            const LetExpression& let = expr.as_let();
+            return Expression::let(
+                Token(let.get_name()), let.get_slot(), boxed(specialize(let.get_value())), boxed(specialize(let.get_body()))
+            );
+          }
+          case ExpressionType::POLYNOMIAL: {
+            // `rewrite_polynomials()` vuelve a formar el polinomio con lo que quede de la expresión original
+            return specialize(expr.as_polynomial().get_original());
+          }
+          case ExpressionType::CALL:
+          case ExpressionType::APPROXIMATION:
+          case ExpressionType::LOCAL: return expr.clone();
+        }
+        __builtin_unreachable();
+    }
+};
+
+bool same_value(const std::optional<double>& a, const std::optional<double>& b) noexcept {
+    if(!a.has_value() || !b.has_value()) {
+        return false;
+    }
+    // se comparan los bits, para distinguir 0 de -0 y que un NaN sea igual a sí mismo
+    uint64_t a_bits, b_bits;
+    std::memcpy(&a_bits, &*a, sizeof(a_bits));
+    std::memcpy(&b_bits, &*b, sizeof(b_bits));
+    return a_bits == b_bits;
+}
+
+}
+
+Expression specialize(const Expression& expr, const SymbolTable& symbols, const std::vector<Token>& fixed) {
+    Expression specialized = rewrite_polynomials(Specializer(symbols, fixed).specialize(expr));
+    // las variables que quedan pueden tomar cualquier valor, aunque estén definidas en `symbols`
+    std::vector<Token> remaining;
+    collect_variables(specialized, remaining);
+    VariableRanges ranges;
+    for(const Token& var : remaining) {
+        ranges.emplace(*var.get_ident(), Interval::unbounded());
+    }
+    return elide_domain_checks(specialized, symbols, ranges);
+}
+
+SpeculativeFormula::SpeculativeFormula(const Expression& expr, uint64_t threshold)
+    : m_source(expr.clone()), m_threshold(threshold), m_table(nullptr), m_epoch(0), m_statistics{0, 0, 0, 0} {
+    collect_variables(m_source, m_variables);
+    m_values.assign(m_variables.size(), std::nullopt);
+    m_stable.assign(m_variables.size(), 0);
+}
+
+void SpeculativeFormula::deoptimize() noexcept {
+    m_specialized.reset();
+    m_fixed.clear();
+    m_table = nullptr;
+    m_stable.assign(m_stable.size(), 0); // hay que volver a esperar `m_threshold` evaluaciones
+    m_statistics.deoptimizations++;
+}
+
+void SpeculativeFormula::observe(SymbolTable& symbols) {
+    bool ready = false;
+    for(size_t i = 0; i < m_variables.size(); i++) {
+        std::optional<double> value = symbols.get(m_variables[i]);
+        if(same_value(value, m_values[i])) {
+            m_stable[i]++;
+        } else {
+            m_values[i] = value;
+            m_stable[i] = value.has_value() ? 1 : 0;
+        }
+        ready = ready || (value.has_value() && m_stable[i] >= m_threshold);
+    }
+    if(!ready) {
+        return;
+    }
+    std::vector<Token> fixed;
+    for(size_t i = 0; i < m_variables.size(); i++) {
+        if(m_values[i].has_value() && m_stable[i] >= m_threshold) {
+            fixed.push_back(m_variables[i]);
+        }
+    }
+    m_specialized.emplace(specialize(m_source, symbols, fixed));
+    for(const Token& var : fixed) {
+        symbols.watch(var);
+    }
+    m_fixed = std::move(fixed);
+    m_table = &symbols;
+    m_epoch = symbols.epoch();
+    m_statistics.specializations++;
+}
+
+double SpeculativeFormula::evaluate(SymbolTable& symbols) {
+    if(m_specialized.has_value()) {
+        if(m_table == &symbols && symbols.epoch() == m_epoch) {
+            m_statistics.specialized_evaluations++;
+            return m_specialized->evaluate(symbols);
+        }
+        deoptimize();
+    }
+    m_statistics.generic_evaluations++;
+    double result = m_source.evaluate(symbols);
+    observe(symbols);
+    return result;
+}
+
+bool SpeculativeFormula::is_specialized() const noexcept {
+    return m_specialized.has_value();
+}
+
+const std::vector<Token>& SpeculativeFormula::specialized_on() const noexcept {
+    return m_fixed;
+}
+
+SpeculationStatistics SpeculativeFormula::statistics() const noexcept {
+    return m_statistics;
+}
+
+} // namespace clex
@@ -0,0 +1,275 @@
+#include "statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace clex {
+
+RunningStats::RunningStats() noexcept : 
+  m_count(0), m_mean(0.0), m_m2(0.0), 
+  m_min(std::numeric_limits<double>::infinity()), m_max(-std::numeric_limits<double>::infinity()) {};
+
+void RunningStats::push(double value) noexcept {
+    m_count++;
+    double delta = value - m_mean;
+    m_mean += delta / static_cast<double>(m_count);
+    m_m2 += delta * (value - m_mean);
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+}
+
+void RunningStats::merge(const RunningStats& other) noexcept {
+    if(other.m_count == 0) {
+        return;
+    }
+    if(m_count == 0) {
+        *this = other;
+        return;
+    }
+    double n_a = static_cast<double>(m_count);
+    double n_b = static_cast<double>(other.m_count);
+    double n = n_a + n_b;
+    double delta = other.m_mean - m_mean;
+    m_mean += delta * (n_b / n);
+    m_m2 += other.m_m2 + delta * delta * (n_a * n_b / n);
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+uint64_t RunningStats::count() const noexcept {
+    return m_count;
+}
+
+double RunningStats::mean() const noexcept {
+    return m_mean;
+}
+
+double RunningStats::variance() const noexcept {
+    if(m_count < 2) {
+        return 0.0;
+    }
+    return m_m2 / static_cast<double>(m_count - 1);
+}
+
+double RunningStats::min() const noexcept {
+    return m_min;
+}
+
+double RunningStats::max() const noexcept {
+    return m_max;
+}
+
+namespace {
+
+// Los números se escriben en hexadecimal (o `inf`, `nan`) para leerlos sin pérdida con `std::strtod`.
+void write_number(std::ostream& os, double value) {
+    std::ios::fmtflags old_flags = os.flags();
+    os << ' ' << std::hexfloat << value;
+    os.flags(old_flags);
+}
+
+double read_number(std::istream& is) {
+    std::string text;
+    if(!(is >> text)) {
+        return 0.0;
+    }
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if(*end != '\0') {
+        is.setstate(std::ios::failbit);
+    }
+    return value;
+}
+
+// Comprueba que la siguiente palabra del flujo es `tag`.
+bool read_tag(std::istream& is, const char* tag) {
+    std::string text;
+    if(is >> text && text != tag) {
+        is.setstate(std::ios::failbit);
+    }
+    return static_cast<bool>(is);
+}
+
+}
+
+void RunningStats::write_to(std::ostream& os) const {
+    os << "stats " << m_count;
+    write_number(os, m_mean);
+    write_number(os, m_m2);
+    write_number(os, m_min);
+    write_number(os, m_max);
+    os << '\n';
+}
+
+RunningStats RunningStats::read_from(std::istream& is) {
+    RunningStats stats;
+    if(read_tag(is, "stats") && is >> stats.m_count) {
+        stats.m_mean = read_number(is);
+        stats.m_m2 = read_number(is);
+        stats.m_min = read_number(is);
+        stats.m_max = read_number(is);
+    }
+    return stats;
+}
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Función de escala k1 del t-digest: un centroide puede abarcar como mucho una unidad de k, 
+// lo que hace que los centroides cerca de q = 0 y q = 1 sean pequeños.
+double scale_k(double q, double compression) noexcept {
+    return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+double scale_k_inverse(double k, double compression) noexcept {
+    if(k >= compression / 4.0) {
+        return 1.0;
+    }
+    return (std::sin(k * 2.0 * PI / compression) + 1.0) / 2.0;
+}
+
+}
+
+TDigest::TDigest(double compression) noexcept : 
+  m_compression(compression), m_centroids(), m_buffer(),
+  m_min(std::numeric_limits<double>::infinity()), m_max(-std::numeric_limits<double>::infinity()) {};
+
+void TDigest::push(double value) noexcept {
+    if(std::isnan(value)) {
+        return; // sin orden, un NaN rompería la ordenación de los centroides
+    }
+    m_buffer.push_back(Centroid{value, 1.0});
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    if(m_buffer.size() >= static_cast<size_t>(5.0 * m_compression)) {
+        compress();
+    }
+}
+
+void TDigest::merge(const TDigest& other) noexcept {
+    m_buffer.insert(m_buffer.end(), other.m_centroids.begin(), other.m_centroids.end());
+    m_buffer.insert(m_buffer.end(), other.m_buffer.begin(), other.m_buffer.end());
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    compress();
+}
+
+void TDigest::compress() noexcept {
+    if(m_buffer.empty()) {
+        return;
+    }
+    std::vector<Centroid> all = std::move(m_centroids);
+    all.insert(all.end(), m_buffer.begin(), m_buffer.end());
+    m_buffer.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    double total = 0.0;
+    for(const Centroid& c : all) {
+        total += c.weight;
+    }
+
+    std::vector<Centroid> result;
+    Centroid current = all[0];
+    double weight_before = 0.0; // peso de todos los centroides anteriores a `current`
+    double weight_limit = total * scale_k_inverse(scale_k(0.0, m_compression) + 1.0, m_compression);
+    for(size_t i = 1; i < all.size(); i++) {
+        if(weight_before + current.weight + all[i].weight <= weight_limit) {
+            current.weight += all[i].weight;
+            current.mean += (all[i].mean - current.mean) * all[i].weight / current.weight;
+        } else {
+            result.push_back(current);
+            weight_before += current.weight;
+            weight_limit = total * scale_k_inverse(scale_k(weight_before / total, m_compression) + 1.0, m_compression);
+            current = all[i];
+        }
+    }
+    result.push_back(current);
+    m_centroids = std::move(result);
+}
+
+double TDigest::quantile(double q) const noexcept {
+    if(!m_buffer.empty()) {
+        TDigest compressed = *this;
+        compressed.compress();
+        return compressed.quantile(q);
+    }
+    if(m_centroids.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if(m_centroids.size() == 1) {
+        return m_centroids[0].mean;
+    }
+    double total = 0.0;
+    for(const Centroid& c : m_centroids) {
+        total += c.weight;
+    }
+    double index = std::clamp(q, 0.0, 1.0) * total;
+
+    // Cada centroide representa su peso repartido alrededor de su media, así que entre medias consecutivas
+    // se interpola linealmente; en los extremos se interpola con el mínimo y el máximo exactos.
+    const Centroid& first = m_centroids.front();
+    if(index < first.weight / 2.0) {
+        return m_min + (first.mean - m_min) * index / (first.weight / 2.0);
+    }
+    double weight_so_far = first.weight / 2.0;
+    for(size_t i = 0; i + 1 < m_centroids.size(); i++) {
+        double step = (m_centroids[i].weight + m_centroids[i + 1].weight) / 2.0;
+        if(weight_so_far + step > index) {
+            double t = (index - weight_so_far) / step;
+            return m_centroids[i].mean + t * (m_centroids[i + 1].mean - m_centroids[i].mean);
+        }
+        weight_so_far += step;
+    }
+    const Centroid& last = m_centroids.back();
+    double remaining = total - weight_so_far;
+    if(remaining <= 0.0) {
+        return m_max;
+    }
+    return last.mean + (m_max - last.mean) * std::min(1.0, (index - weight_so_far) / remaining);
+}
+
+void TDigest::write_to(std::ostream& os) const {
+    os << "tdigest";
+    write_number(os, m_compression);
+    write_number(os, m_min);
+    write_number(os, m_max);
+    os << ' ' << m_centroids.size() + m_buffer.size();
+    for(const std::vector<Centroid>* centroids : {&m_centroids, &m_buffer}) {
+        for(const Centroid& c : *centroids) {
+            write_number(os, c.mean);
+            write_number(os, c.weight);
+        }
+    }
+    os << '\n';
+}
+
+TDigest TDigest::read_from(std::istream& is) {
+    TDigest digest;
+    size_t n = 0;
+    if(!read_tag(is, "tdigest")) {
+        return digest;
+    }
+    digest.m_compression = read_number(is);
+    digest.m_min = read_number(is);
+    digest.m_max = read_number(is);
+    if(!(is >> n)) {
+        return digest;
+    }
+    for(size_t i = 0; i < n && is; i++) {
+        double mean = read_number(is);
+        double weight = read_number(is);
+        digest.m_buffer.push_back(Centroid{mean, weight});
+    }
+    digest.compress();
+    return digest;
+}
+
+} // namespace clex
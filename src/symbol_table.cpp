@@ -1,22 +1,53 @@
 #include "symbol_table.hpp"
 #include "tokens.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string>
 
 namespace clex {
 
+namespace {
+
+// Las épocas se reparten desde un contador global para que ninguna se repita, ni siquiera entre tablas distintas
+uint64_t new_epoch() noexcept {
+    static std::atomic<uint64_t> next_epoch{1};
+    return next_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
 SymbolTable::SymbolTable() : m_vars { // Constructor por defecto que incluye valores para constantes utilizadas
-    {"pi", 3.14159265358979323846},
-    {"euler", 2.71828182845904523536},
-    {"phi", 1.61803398874989484820},
-    {"eulerMascheroni", 0.57721566490153286060},
-} {};
+    {"pi", {3.14159265358979323846, false}},
+    {"euler", {2.71828182845904523536, false}},
+    {"phi", {1.61803398874989484820, false}},
+    {"eulerMascheroni", {0.57721566490153286060, false}},
+}, m_epoch(new_epoch()) {};
+
+SymbolTable::SymbolTable(const SymbolTable& other) : m_vars(other.m_vars), m_epoch(new_epoch()) {};
+
+SymbolTable::SymbolTable(SymbolTable&& other) noexcept : m_vars(std::move(other.m_vars)), m_epoch(new_epoch()) {};
+
+SymbolTable& SymbolTable::operator=(const SymbolTable& other) {
+    m_vars = other.m_vars;
+    m_epoch = new_epoch();
+    return *this;
+}
+
+SymbolTable& SymbolTable::operator=(SymbolTable&& other) noexcept {
+    m_vars = std::move(other.m_vars);
+    m_epoch = new_epoch();
+    return *this;
+}
 
 SymbolTable SymbolTable::from_map(std::unordered_map<std::string, double>&& map) noexcept {
     SymbolTable output;
-    map.merge(output.m_vars); // hacemos un merge de las variables declaradas con las constantes predefinidas 
-                              // (manteniendo prioridad de las variables declaradas, por si, por ejemplo, `pi` tiene otro valor)
-    output.m_vars = std::move(map);
+    for(auto& [name, value] : map) {
+        // las variables declaradas tienen prioridad sobre las constantes predefinidas, 
+        // por si, por ejemplo, `pi` tiene otro valor
+        output.m_vars.insert_or_assign(name, Variable{value, false});
+    }
     return output;
 }
 
@@ -26,18 +57,34 @@ std::optional<double> SymbolTable::get(const Token& ident) const noexcept {
     if(itr == m_vars.end()) {
         return {};
     } else {
-        return itr->second;
+        return itr->second.value;
     }
 }
 
 void SymbolTable::set(const Token& ident, double value) noexcept {
     std::string var_name = *ident.get_ident();
-    m_vars[var_name] = value; // En este caso el operador [] hace exactamente lo que buscamos, 
-                              // ya que puede tanto crear variables como cambiar su valor
+    Variable& var = m_vars[var_name]; // En este caso el operador [] hace exactamente lo que buscamos, 
+                                      // ya que puede tanto crear variables como cambiar su valor
+    if(var.watched && std::memcmp(&var.value, &value, sizeof(value)) != 0) {
+        m_epoch = new_epoch();
+    }
+    var.value = value;
 }
 
 void SymbolTable::reset() noexcept {
     m_vars = std::move(SymbolTable().m_vars); // resetea las variables a ser las constantes normales
+    m_epoch = new_epoch();
+}
+
+void SymbolTable::watch(const Token& ident) noexcept {
+    auto itr = m_vars.find(*ident.get_ident());
+    if(itr != m_vars.end()) {
+        itr->second.watched = true;
+    }
+}
+
+uint64_t SymbolTable::epoch() const noexcept {
+    return m_epoch;
 }
 
 }
\ No newline at end of file
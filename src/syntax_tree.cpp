@@ -1,16 +1,25 @@
 #include "syntax_tree.hpp"
 #include "eval_errors.hpp"
+#include "monte_carlo.hpp"
+#include "ode.hpp"
+#include "optimize.hpp"
+#include "random.hpp"
 #include "symbol_table.hpp"
 #include "tokens.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace clex {
 
@@ -32,8 +41,8 @@ Expression OperandExpression::clone() const noexcept {
     return Expression::operand(Token{m_tok});
 }
 
-BinOpExpression::BinOpExpression(Token&& oper, std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs) :
-  m_operator(oper), m_lhs(std::move(lhs)), m_rhs(std::move(rhs)) {
+BinOpExpression::BinOpExpression(Token&& oper, std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs, bool domain_checked) :
+  m_operator(oper), m_lhs(std::move(lhs)), m_rhs(std::move(rhs)), m_domain_checked(domain_checked) {
     if(!oper.is_operator_token()) {
         throw std::invalid_argument("Invalid token for binary operation");
     }
@@ -54,6 +63,10 @@ std::pair<const Expression&, const Expression&> BinOpExpression::get_operands()
     return {*m_lhs, *m_rhs};
 }
 
+bool BinOpExpression::is_domain_checked() const noexcept {
+    return m_domain_checked;
+}
+
 std::ostream& operator<<(std::ostream& out, const BinOpExpression& expr) {
     return out << "<Bin-op " << *expr.m_lhs << ' ' << expr.m_operator << ' ' << *expr.m_rhs << '>';
 }
@@ -62,12 +75,13 @@ Expression BinOpExpression::clone() const noexcept {
     return Expression::bin_op(
         Token(m_operator), 
         std::make_unique<Expression>(m_lhs->clone()), 
-        std::make_unique<Expression>(m_rhs->clone())
+        std::make_unique<Expression>(m_rhs->clone()),
+        m_domain_checked
     );
 }
 
-UnaryOpExpression::UnaryOpExpression(Token&& oper, std::unique_ptr<Expression>&& operand) :
-  m_operator(oper), m_operand(std::move(operand)) {
+UnaryOpExpression::UnaryOpExpression(Token&& oper, std::unique_ptr<Expression>&& operand, bool domain_checked) :
+  m_operator(oper), m_operand(std::move(operand)), m_domain_checked(domain_checked) {
     if(!oper.is_operator_token()) {
         throw std::invalid_argument("Invalid token for unary operation");
     }
@@ -84,6 +98,10 @@ const Expression& UnaryOpExpression::get_operand() const noexcept {
     return *m_operand;
 }
 
+bool UnaryOpExpression::is_domain_checked() const noexcept {
+    return m_domain_checked;
+}
+
 std::ostream& operator<<(std::ostream& out, const UnaryOpExpression& expr) {
     return out << "<Unary-op " << expr.m_operator << ' ' << *expr.m_operand << '>';
 }
@@ -91,31 +109,400 @@ std::ostream& operator<<(std::ostream& out, const UnaryOpExpression& expr) {
 Expression UnaryOpExpression::clone() const noexcept {
     return Expression::unary_op(
         Token(m_operator), 
-        std::make_unique<Expression>(m_operand->clone())
+        std::make_unique<Expression>(m_operand->clone()),
+        m_domain_checked
+    );
+}
+
+ConditionalExpression::ConditionalExpression(Token&& if_tok, std::unique_ptr<Expression>&& condition, 
+                                             std::unique_ptr<Expression>&& if_true, std::unique_ptr<Expression>&& if_false) :
+  m_tok(if_tok), m_condition(std::move(condition)), m_if_true(std::move(if_true)), m_if_false(std::move(if_false)) {
+    if(m_tok.type() != TokenType::FUNC_IF) {
+        throw std::invalid_argument("Invalid token for conditional expression");
+    }
+    if(m_condition == nullptr || m_if_true == nullptr || m_if_false == nullptr) {
+        throw std::invalid_argument("Invalid expression pointer(s) for conditional expression");
+    }
+}
+
+const Expression& ConditionalExpression::get_condition() const noexcept {
+    return *m_condition;
+}
+
+std::pair<const Expression&, const Expression&> ConditionalExpression::get_branches() const noexcept {
+    return {*m_if_true, *m_if_false};
+}
+
+std::ostream& operator<<(std::ostream& out, const ConditionalExpression& expr) {
+    return out << "<Conditional " << *expr.m_condition << " ? " << *expr.m_if_true << " : " << *expr.m_if_false << '>';
+}
+
+Expression ConditionalExpression::clone() const noexcept {
+    return Expression::conditional(
+        Token(m_tok),
+        std::make_unique<Expression>(m_condition->clone()),
+        std::make_unique<Expression>(m_if_true->clone()),
+        std::make_unique<Expression>(m_if_false->clone())
+    );
+}
+
+CallExpression::CallExpression(Token&& func, std::vector<std::unique_ptr<Expression>>&& args) :
+  m_func(func), m_args(std::move(args)) {
+    std::optional<size_t> arity = m_func.get_call_arity();
+    if(!arity.has_value() || m_func.type() == TokenType::FUNC_IF) { // `if` tiene su propio tipo de expresión
+        throw std::invalid_argument("Invalid token for function call");
+    }
+    if(m_args.size() < *arity || (m_args.size() > *arity && !m_func.is_variadic_call())) {
+        throw std::invalid_argument("Wrong number of arguments for function call");
+    }
+    for(const std::unique_ptr<Expression>& arg : m_args) {
+        if(arg == nullptr) {
+            throw std::invalid_argument("Invalid expression pointer(s) for function call");
+        }
+    }
+}
+
+const Token& CallExpression::get_function() const noexcept {
+    return m_func;
+}
+
+const std::vector<std::unique_ptr<Expression>>& CallExpression::get_args() const noexcept {
+    return m_args;
+}
+
+std::ostream& operator<<(std::ostream& out, const CallExpression& expr) {
+    out << "<Call " << expr.m_func;
+    for(const std::unique_ptr<Expression>& arg : expr.m_args) {
+        out << ' ' << *arg;
+    }
+    return out << '>';
+}
+
+Expression CallExpression::clone() const noexcept {
+    std::vector<std::unique_ptr<Expression>> args;
+    args.reserve(m_args.size());
+    for(const std::unique_ptr<Expression>& arg : m_args) {
+        args.push_back(std::make_unique<Expression>(arg->clone()));
+    }
+    return Expression::call(Token(m_func), std::move(args));
+}
+
+PolynomialExpression::PolynomialExpression(Token&& var, std::vector<double>&& coefficients,
+                                           std::vector<std::pair<size_t, std::unique_ptr<Expression>>>&& symbolic_coefficients,
+                                           std::unique_ptr<Expression>&& original) :
+  m_var(var), m_coefficients(std::move(coefficients)), 
+  m_symbolic_coefficients(std::move(symbolic_coefficients)), m_original(std::move(original)) {
+    if(m_var.type() != TokenType::IDENTIFIER) {
+        throw std::invalid_argument("Invalid token for polynomial variable");
+    }
+    if(m_coefficients.empty() || m_coefficients.size() > MAX_DEGREE + 1) {
+        throw std::invalid_argument("Invalid number of coefficients for polynomial");
+    }
+    for(const auto& [degree, coefficient] : m_symbolic_coefficients) {
+        if(degree >= m_coefficients.size() || coefficient == nullptr) {
+            throw std::invalid_argument("Invalid symbolic coefficient for polynomial");
+        }
+    }
+    if(m_original == nullptr) {
+        throw std::invalid_argument("Invalid expression pointer for polynomial (original == nullptr)");
+    }
+}
+
+const Token& PolynomialExpression::get_variable() const noexcept {
+    return m_var;
+}
+
+const std::vector<double>& PolynomialExpression::get_coefficients() const noexcept {
+    return m_coefficients;
+}
+
+const std::vector<std::pair<size_t, std::unique_ptr<Expression>>>& PolynomialExpression::get_symbolic_coefficients() const noexcept {
+    return m_symbolic_coefficients;
+}
+
+const Expression& PolynomialExpression::get_original() const noexcept {
+    return *m_original;
+}
+
+std::ostream& operator<<(std::ostream& out, const PolynomialExpression& expr) {
+    out << "<Polynomial " << expr.m_var << " [";
+    for(size_t k = 0; k < expr.m_coefficients.size(); k++) {
+        out << (k == 0 ? "" : ", ") << expr.m_coefficients[k];
+    }
+    out << ']';
+    for(const auto& [degree, coefficient] : expr.m_symbolic_coefficients) {
+        out << " <Coefficient " << degree << ' ' << *coefficient << '>';
+    }
+    return out << '>';
+}
+
+Expression PolynomialExpression::clone() const noexcept {
+    std::vector<std::pair<size_t, std::unique_ptr<Expression>>> symbolic;
+    symbolic.reserve(m_symbolic_coefficients.size());
+    for(const auto& [degree, coefficient] : m_symbolic_coefficients) {
+        symbolic.emplace_back(degree, std::make_unique<Expression>(coefficient->clone()));
+    }
+    return Expression::polynomial(
+        Token(m_var),
+        std::vector<double>(m_coefficients),
+        std::move(symbolic),
+        std::make_unique<Expression>(m_original->clone())
+    );
+}
+
+PiecewisePolynomial::PiecewisePolynomial(double lo, double hi, size_t degree, std::vector<double>&& coefficients) :
+  m_lo(lo), m_hi(hi), m_scale(0.0), m_degree(degree), m_coefficients(std::move(coefficients)), 
+  m_min(INFINITY), m_max(-INFINITY) {
+    if(!(std::isfinite(lo) && std::isfinite(hi) && lo < hi)) {
+        throw std::invalid_argument("Invalid interval for piecewise polynomial");
+    }
+    size_t stride = m_degree + 1;
+    if(m_coefficients.empty() || m_coefficients.size() % stride != 0) {
+        throw std::invalid_argument("Invalid number of coefficients for piecewise polynomial");
+    }
+    m_scale = static_cast<double>(pieces()) / (hi - lo);
+    // Con |t| <= 1, cada tramo vale a0 + Σ a_k t^k ∈ [a0 - S, a0 + S] con S = Σ |a_k|. El margen cubre el 
+    // redondeo de las `degree` FMA y de t, que puede pasarse de 1 en muy poco al evaluar en `hi`.
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+    for(size_t first = 0; first < m_coefficients.size(); first += stride) {
+        double a0 = m_coefficients[first];
+        double sum = 0.0;
+        for(size_t k = 1; k < stride; k++) {
+            sum += std::abs(m_coefficients[first + k]);
+        }
+        if(!std::isfinite(a0) || !std::isfinite(sum)) {
+            throw std::invalid_argument("Non-finite coefficient for piecewise polynomial");
+        }
+        double radius = sum + 8.0 * static_cast<double>(stride + 1) * eps * (std::abs(a0) + sum) + std::numeric_limits<double>::denorm_min();
+        m_min = std::min(m_min, a0 - radius);
+        m_max = std::max(m_max, a0 + radius);
+    }
+}
+
+double PiecewisePolynomial::lo() const noexcept {
+    return m_lo;
+}
+
+double PiecewisePolynomial::hi() const noexcept {
+    return m_hi;
+}
+
+double PiecewisePolynomial::scale() const noexcept {
+    return m_scale;
+}
+
+size_t PiecewisePolynomial::degree() const noexcept {
+    return m_degree;
+}
+
+size_t PiecewisePolynomial::pieces() const noexcept {
+    return m_coefficients.size() / (m_degree + 1);
+}
+
+const std::vector<double>& PiecewisePolynomial::coefficients() const noexcept {
+    return m_coefficients;
+}
+
+std::pair<double, double> PiecewisePolynomial::bounds() const noexcept {
+    return {m_min, m_max};
+}
+
+ApproximationExpression::ApproximationExpression(Token&& var, PiecewisePolynomial&& table, std::unique_ptr<Expression>&& original) :
+  m_var(var), m_table(std::move(table)), m_original(std::move(original)) {
+    if(m_var.type() != TokenType::IDENTIFIER) {
+        throw std::invalid_argument("Invalid token for approximation variable");
+    }
+    if(m_original == nullptr) {
+        throw std::invalid_argument("Invalid expression pointer for approximation (original == nullptr)");
+    }
+}
+
+const Token& ApproximationExpression::get_variable() const noexcept {
+    return m_var;
+}
+
+const PiecewisePolynomial& ApproximationExpression::get_table() const noexcept {
+    return m_table;
+}
+
+const Expression& ApproximationExpression::get_original() const noexcept {
+    return *m_original;
+}
+
+std::ostream& operator<<(std::ostream& out, const ApproximationExpression& expr) {
+    const PiecewisePolynomial& table = expr.m_table;
+    return out << "<Approximation " << expr.m_var << " [" << table.lo() << ", " << table.hi() << "] <Pieces " 
+               << table.pieces() << "> <Degree " << table.degree() << "> " << *expr.m_original << '>';
+}
+
+Expression ApproximationExpression::clone() const noexcept {
+    return Expression::approximation(
+        Token(m_var),
+        PiecewisePolynomial(m_table),
+        std::make_unique<Expression>(m_original->clone())
     );
 }
 
+LetExpression::LetExpression(Token&& name, size_t slot, std::unique_ptr<Expression>&& value, std::unique_ptr<Expression>&& body) :
+  m_name(name), m_slot(slot), m_value(std::move(value)), m_body(std::move(body)) {
+    if(m_name.type() != TokenType::IDENTIFIER) {
+        throw std::invalid_argument("Invalid token for let expression name");
+    }
+    if(m_value == nullptr || m_body == nullptr) {
+        throw std::invalid_argument("Invalid expression pointer(s) for let expression");
+    }
+}
+
+const Token& LetExpression::get_name() const noexcept {
+    return m_name;
+}
+
+size_t LetExpression::get_slot() const noexcept {
+    return m_slot;
+}
+
+const Expression& LetExpression::get_value() const noexcept {
+    return *m_value;
+}
+
+const Expression& LetExpression::get_body() const noexcept {
+    return *m_body;
+}
+
+std::ostream& operator<<(std::ostream& out, const LetExpression& expr) {
+    return out << "<Let " << expr.m_name << " #" << expr.m_slot << " = " << *expr.m_value << " in " << *expr.m_body << '>';
+}
+
+Expression LetExpression::clone() const noexcept {
+    return Expression::let(
+        Token(m_name),
+        m_slot,
+        std::make_unique<Expression>(m_value->clone()),
+        std::make_unique<Expression>(m_body->clone())
+    );
+}
+
+LocalExpression::LocalExpression(Token&& name, size_t slot) : m_name(name), m_slot(slot) {
+    if(m_name.type() != TokenType::IDENTIFIER) {
+        throw std::invalid_argument("Invalid token for local expression name");
+    }
+}
+
+const Token& LocalExpression::get_name() const noexcept {
+    return m_name;
+}
+
+size_t LocalExpression::get_slot() const noexcept {
+    return m_slot;
+}
+
+std::ostream& operator<<(std::ostream& out, const LocalExpression& expr) {
+    return out << "<Local " << expr.m_name << " #" << expr.m_slot << '>';
+}
+
+Expression LocalExpression::clone() const noexcept {
+    return Expression::local(Token(m_name), m_slot);
+}
+
 Expression::Expression(BinOpExpression&& bin_op) noexcept : m_data(std::move(bin_op)), m_type(ExpressionType::BIN_OP) {};
 
 Expression::Expression(OperandExpression&& operand) noexcept : m_data(std::move(operand)), m_type(ExpressionType::OPERAND) {};
 
 Expression::Expression(UnaryOpExpression&& unary_op) noexcept : m_data(std::move(unary_op)), m_type(ExpressionType::UNARY_OP) {};
 
-Expression Expression::bin_op(Token&& oper, std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs) {
+Expression::Expression(ConditionalExpression&& conditional) noexcept : m_data(std::move(conditional)), m_type(ExpressionType::CONDITIONAL) {};
+
+Expression::Expression(CallExpression&& call) noexcept : m_data(std::move(call)), m_type(ExpressionType::CALL) {};
+
+Expression::Expression(PolynomialExpression&& polynomial) noexcept : m_data(std::move(polynomial)), m_type(ExpressionType::POLYNOMIAL) {};
+
+Expression::Expression(ApproximationExpression&& approximation) noexcept : m_data(std::move(approximation)), m_type(ExpressionType::APPROXIMATION) {};
+
+Expression::Expression(LetExpression&& let) noexcept : m_data(std::move(let)), m_type(ExpressionType::LET) {};
+
+Expression::Expression(LocalExpression&& local) noexcept : m_data(std::move(local)), m_type(ExpressionType::LOCAL) {};
+
+Expression Expression::bin_op(Token&& oper, std::unique_ptr<Expression>&& lhs, std::unique_ptr<Expression>&& rhs, bool domain_checked) {
     return Expression(
         BinOpExpression(
             std::move(oper),
             std::move(lhs),
-            std::move(rhs)
+            std::move(rhs),
+            domain_checked
         )
     );
 }
 
-Expression Expression::unary_op(Token&& oper, std::unique_ptr<Expression>&& operand) {
+Expression Expression::unary_op(Token&& oper, std::unique_ptr<Expression>&& operand, bool domain_checked) {
     return Expression(
         UnaryOpExpression(
             std::move(oper),
-            std::move(operand)
+            std::move(operand),
+            domain_checked
+        )
+    );
+}
+
+Expression Expression::conditional(Token&& if_tok, std::unique_ptr<Expression>&& condition, 
+                                   std::unique_ptr<Expression>&& if_true, std::unique_ptr<Expression>&& if_false) {
+    return Expression(
+        ConditionalExpression(
+            std::move(if_tok),
+            std::move(condition),
+            std::move(if_true),
+            std::move(if_false)
+        )
+    );
+}
+
+Expression Expression::call(Token&& func, std::vector<std::unique_ptr<Expression>>&& args) {
+    return Expression(
+        CallExpression(
+            std::move(func),
+            std::move(args)
+        )
+    );
+}
+
+Expression Expression::polynomial(Token&& var, std::vector<double>&& coefficients,
+                                  std::vector<std::pair<size_t, std::unique_ptr<Expression>>>&& symbolic_coefficients,
+                                  std::unique_ptr<Expression>&& original) {
+    return Expression(
+        PolynomialExpression(
+            std::move(var),
+            std::move(coefficients),
+            std::move(symbolic_coefficients),
+            std::move(original)
+        )
+    );
+}
+
+Expression Expression::approximation(Token&& var, PiecewisePolynomial&& table, std::unique_ptr<Expression>&& original) {
+    return Expression(
+        ApproximationExpression(
+            std::move(var),
+            std::move(table),
+            std::move(original)
+        )
+    );
+}
+
+Expression Expression::let(Token&& name, size_t slot, std::unique_ptr<Expression>&& value, std::unique_ptr<Expression>&& body) {
+    return Expression(
+        LetExpression(
+            std::move(name),
+            slot,
+            std::move(value),
+            std::move(body)
+        )
+    );
+}
+
+Expression Expression::local(Token&& name, size_t slot) {
+    return Expression(
+        LocalExpression(
+            std::move(name),
+            slot
         )
     );
 }
@@ -134,14 +521,25 @@ ExpressionType Expression::type() const noexcept {
 
 const Token& Expression::get_token() const noexcept {
     auto visit_func = [](const auto& expr) -> const Token& {
-        if constexpr(std::is_same_v<decltype(expr), BinOpExpression>) {
+        using ExprT = std::remove_cvref_t<decltype(expr)>;
+        if constexpr(std::is_same_v<ExprT, BinOpExpression>) {
             return expr.m_operator;
-        } else if constexpr(std::is_same_v<decltype(expr), OperandExpression>) {
+        } else if constexpr(std::is_same_v<ExprT, OperandExpression>) {
             return expr.m_tok;
-        } else if constexpr(std::is_same_v<decltype(expr), UnaryOpExpression>) {
+        } else if constexpr(std::is_same_v<ExprT, UnaryOpExpression>) {
             return expr.m_operator;
+        } else if constexpr(std::is_same_v<ExprT, ConditionalExpression>) {
+            return expr.m_tok;
+        } else if constexpr(std::is_same_v<ExprT, CallExpression>) {
+            return expr.m_func;
+        } else if constexpr(std::is_same_v<ExprT, PolynomialExpression>) {
+            return expr.m_var;
+        } else if constexpr(std::is_same_v<ExprT, ApproximationExpression>) {
+            return expr.m_var;
+        } else if constexpr(std::is_same_v<ExprT, LetExpression> || std::is_same_v<ExprT, LocalExpression>) {
+            return expr.m_name;
         } else {
-            std::abort(); // no se puede llegar a esto, expr siempre será o BinOpExpression u OperandExpression
+            std::abort(); // no se puede llegar a esto, expr siempre será uno de los tipos de la variante
         }
     };
     return std::visit(visit_func, m_data);
@@ -155,6 +553,34 @@ const BinOpExpression& Expression::as_bin_op() const {
     return std::get<BinOpExpression>(m_data);
 }
 
+const UnaryOpExpression& Expression::as_unary_op() const {
+    return std::get<UnaryOpExpression>(m_data);
+}
+
+const ConditionalExpression& Expression::as_conditional() const {
+    return std::get<ConditionalExpression>(m_data);
+}
+
+const CallExpression& Expression::as_call() const {
+    return std::get<CallExpression>(m_data);
+}
+
+const PolynomialExpression& Expression::as_polynomial() const {
+    return std::get<PolynomialExpression>(m_data);
+}
+
+const ApproximationExpression& Expression::as_approximation() const {
+    return std::get<ApproximationExpression>(m_data);
+}
+
+const LetExpression& Expression::as_let() const {
+    return std::get<LetExpression>(m_data);
+}
+
+const LocalExpression& Expression::as_local() const {
+    return std::get<LocalExpression>(m_data);
+}
+
 std::ostream& operator<<(std::ostream& out, const Expression& expr) {
     auto visit_func = [&out](const auto& expr) -> std::ostream& {
         return out << expr;
@@ -184,6 +610,14 @@ double OperandExpression::evaluate(const SymbolTable& symbols) const {
 
 double BinOpExpression::evaluate(const SymbolTable& symbols) const {
     double lhs_value = m_lhs->evaluate(symbols);
+    // `and` y `or` cortocircuitan: el lado derecho solo se evalúa si hace falta, para que 
+    // expresiones como `x != 0 and 1/x > 2` no den error de evaluación
+    if(m_operator.type() == TokenType::OP_AND) {
+        return (lhs_value != 0.0 && m_rhs->evaluate(symbols) != 0.0) ? 1.0 : 0.0;
+    }
+    if(m_operator.type() == TokenType::OP_OR) {
+        return (lhs_value != 0.0 || m_rhs->evaluate(symbols) != 0.0) ? 1.0 : 0.0;
+    }
     double rhs_value = m_rhs->evaluate(symbols);
     switch(m_operator.type()) {
       case TokenType::OP_PLUS: {
@@ -196,18 +630,36 @@ double BinOpExpression::evaluate(const SymbolTable& symbols) const {
         return lhs_value * rhs_value;
       }
       case TokenType::OP_SLASH: {
-        if(rhs_value == 0.0 || rhs_value == -0.0) {
+        if(m_domain_checked && (rhs_value == 0.0 || rhs_value == -0.0)) {
             throw DivideByZeroError(std::make_unique<Expression>(this->clone()));
         }
         return lhs_value / rhs_value;
       }
       case TokenType::OP_CARET: {
         double result = std::pow(lhs_value, rhs_value);
-        if(result != result) { // std::pow puede devolver NaN para valores complejos (como std::pow(-1.0, 0.5))
+        if(m_domain_checked && result != result) { // std::pow puede devolver NaN para valores complejos (como std::pow(-1.0, 0.5))
             throw ComplexResultError(std::make_unique<Expression>(this->clone()));
         }
         return result;
       }
+      case TokenType::OP_LESS: {
+        return lhs_value < rhs_value ? 1.0 : 0.0;
+      }
+      case TokenType::OP_LESS_EQ: {
+        return lhs_value <= rhs_value ? 1.0 : 0.0;
+      }
+      case TokenType::OP_GREATER: {
+        return lhs_value > rhs_value ? 1.0 : 0.0;
+      }
+      case TokenType::OP_GREATER_EQ: {
+        return lhs_value >= rhs_value ? 1.0 : 0.0;
+      }
+      case TokenType::OP_EQUAL: {
+        return lhs_value == rhs_value ? 1.0 : 0.0;
+      }
+      case TokenType::OP_NOT_EQUAL: {
+        return lhs_value != rhs_value ? 1.0 : 0.0;
+      }
       default: __builtin_unreachable();
     }
 }
@@ -221,14 +673,17 @@ double UnaryOpExpression::evaluate(const SymbolTable& symbols) const {
       case TokenType::OP_PLUS: {
         return arg_value;
       }
+      case TokenType::OP_NOT: {
+        return arg_value == 0.0 ? 1.0 : 0.0;
+      }
       case TokenType::OP_FUNC_SQRT: {
-        if(arg_value < 0.0) {
+        if(m_domain_checked && arg_value < 0.0) {
             throw ComplexResultError(std::make_unique<Expression>(this->clone()));
         }
         return std::sqrt(arg_value);
       }
       case TokenType::OP_FUNC_LOG: {
-        if(arg_value <= 0.0) {
+        if(m_domain_checked && arg_value <= 0.0) {
             throw ComplexResultError(std::make_unique<Expression>(this->clone()));
         }
         return std::log(arg_value);
@@ -244,13 +699,13 @@ double UnaryOpExpression::evaluate(const SymbolTable& symbols) const {
                                     // así que tampoco podemos hacer mucho para comprobar errores aquí
       }
       case TokenType::OP_FUNC_ARCSIN: {
-        if(arg_value < -1.0 || arg_value > 1.0) {
+        if(m_domain_checked && (arg_value < -1.0 || arg_value > 1.0)) {
             throw ComplexResultError(std::make_unique<Expression>(this->clone()));
         }
         return std::asin(arg_value);
       }
       case TokenType::OP_FUNC_ARCCOS: {
-        if(arg_value < -1.0 || arg_value > 1.0) {
+        if(m_domain_checked && (arg_value < -1.0 || arg_value > 1.0)) {
             throw ComplexResultError(std::make_unique<Expression>(this->clone()));
         }
         return std::acos(arg_value);
@@ -262,6 +717,212 @@ double UnaryOpExpression::evaluate(const SymbolTable& symbols) const {
     }
 }
 
+double ConditionalExpression::evaluate(const SymbolTable& symbols) const {
+    if(m_condition->evaluate(symbols) != 0.0) {
+        return m_if_true->evaluate(symbols);
+    } else {
+        return m_if_false->evaluate(symbols);
+    }
+}
+
+double CallExpression::evaluate(const SymbolTable& symbols) const {
+    switch(m_func.type()) {
+      case TokenType::FUNC_RAND: {
+        return current_random_stream().uniform();
+      }
+      case TokenType::FUNC_RANDN: {
+        return current_random_stream().normal();
+      }
+      case TokenType::FUNC_MC:
+      case TokenType::FUNC_MCERR: {
+        double samples = m_args[1]->evaluate(symbols);
+        if(!(samples >= 1.0 && samples <= 0x1.0p53) || samples != std::floor(samples)) { // la negación también descarta NaN
+            throw InvalidArgument(
+                "El número de muestras de Monte Carlo debe ser un entero positivo",
+                std::make_unique<Expression>(this->clone())
+            );
+        }
+        MonteCarloResult result = monte_carlo(*m_args[0], symbols, static_cast<uint64_t>(samples));
+        return m_func.type() == TokenType::FUNC_MC ? result.mean : result.std_error;
+      }
+      case TokenType::FUNC_MINIMIZE:
+      case TokenType::FUNC_ARGMIN: {
+        std::vector<Token> variables;
+        for(size_t i = 1; i < m_args.size(); i++) {
+            const Expression& arg = *m_args[i];
+            if(arg.type() != ExpressionType::OPERAND || arg.get_token().type() != TokenType::IDENTIFIER) {
+                throw InvalidArgument(
+                    "Los argumentos de minimize y argmin a partir del segundo deben ser nombres de variable",
+                    std::make_unique<Expression>(this->clone())
+                );
+            }
+            if(std::find(variables.begin(), variables.end(), arg.get_token()) != variables.end()) {
+                throw InvalidArgument(
+                    "Variable repetida en la lista de variables de minimize o argmin",
+                    std::make_unique<Expression>(this->clone())
+                );
+            }
+            variables.push_back(arg.get_token());
+        }
+        try {
+            MinimizationResult result = minimize(*m_args[0], symbols, variables);
+            return m_func.type() == TokenType::FUNC_MINIMIZE ? result.value : result.point[0];
+        } catch(const std::runtime_error& e) {
+            throw InvalidArgument(e.what(), std::make_unique<Expression>(this->clone()));
+        }
+      }
+      case TokenType::FUNC_ODE: {
+        size_t n = (m_args.size() - 2) / 2;
+        std::vector<Token> names;
+        for(size_t i = n; i < m_args.size() - 1; i++) {
+            const Expression& arg = *m_args[i];
+            bool is_name = arg.type() == ExpressionType::OPERAND && arg.get_token().type() == TokenType::IDENTIFIER;
+            if(m_args.size() % 2 != 0 || !is_name || std::find(names.begin(), names.end(), arg.get_token()) != names.end()) {
+                throw InvalidArgument(
+                    "ode recibe los lados derechos, tantas variables de estado distintas como lados derechos, "
+                    "la variable de tiempo y el tiempo final",
+                    std::make_unique<Expression>(this->clone())
+                );
+            }
+            names.push_back(arg.get_token());
+        }
+        // las ecuaciones se ordenan por nombre para que el resultado no dependa del orden en que se escriben
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return *names[a].get_ident() < *names[b].get_ident(); });
+        std::vector<Expression> rhs;
+        std::vector<Token> states;
+        std::vector<double> initial;
+        for(size_t i : order) {
+            rhs.push_back(m_args[i]->clone());
+            states.push_back(names[i]);
+            initial.push_back(m_args[n + i]->evaluate(symbols)); // lanza `UndefinedVariable` si no tiene valor inicial
+        }
+        double t0 = m_args[2 * n]->evaluate(symbols);
+        double t1 = m_args[2 * n + 1]->evaluate(symbols);
+        size_t first = static_cast<size_t>(std::find(order.begin(), order.end(), 0) - order.begin());
+        double result = initial[first];
+        try {
+            OdeSystem system(rhs, states, names[n], symbols);
+            integrate_ode(system, t0, initial, {t1}, OdeOptions{}, [&](double, const std::vector<double>& y) { result = y[first]; });
+        } catch(const std::runtime_error& e) {
+            throw InvalidArgument(e.what(), std::make_unique<Expression>(this->clone()));
+        }
+        return result;
+      }
+      case TokenType::FUNC_ROLLING_SUM:
+      case TokenType::FUNC_ROLLING_MEAN:
+      case TokenType::FUNC_ROLLING_MIN:
+      case TokenType::FUNC_ROLLING_MAX:
+      case TokenType::FUNC_EMA:
+      case TokenType::FUNC_LAG: {
+        // solo tienen sentido sobre una secuencia de filas; el modo por lotes las sustituye por columnas
+        throw InvalidArgument(
+            "Las funciones de ventana solo se pueden usar al evaluar las filas de un CSV o de un flujo Arrow",
+            std::make_unique<Expression>(this->clone())
+        );
+      }
+      default: __builtin_unreachable();
+    }
+}
+
+namespace {
+
+inline double mul_add(double a, double b, double c) noexcept {
+#ifdef FP_FAST_FMA
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+}
+
+double PolynomialExpression::evaluate(const SymbolTable& symbols) const {
+    std::optional<double> maybe_x = symbols.get(m_var);
+    if(!maybe_x.has_value()) {
+        return m_original->evaluate(symbols); // lanza el mismo `UndefinedVariable` que la expresión original
+    }
+    double x = *maybe_x;
+    double c[MAX_DEGREE + 1];
+    size_t n = m_coefficients.size();
+    std::copy(m_coefficients.begin(), m_coefficients.end(), c);
+    for(const auto& [degree, coefficient] : m_symbolic_coefficients) {
+        c[degree] += coefficient->evaluate(symbols);
+    }
+
+    double result;
+    if(n - 1 < ESTRIN_MIN_DEGREE) {
+        // Horner: c0 + x*(c1 + x*(c2 + ...))
+        result = c[n - 1];
+        for(size_t k = n - 1; k-- > 0;) {
+            result = mul_add(result, x, c[k]);
+        }
+    } else {
+        // Estrin: se combinan parejas de coeficientes con x, luego parejas de parejas con x^2, etc.
+        // Las operaciones de cada nivel son independientes entre sí.
+        double power = x;
+        while(n > 1) {
+            for(size_t i = 0; i < n / 2; i++) {
+                c[i] = mul_add(c[2 * i + 1], power, c[2 * i]);
+            }
+            if(n % 2 == 1) {
+                c[n / 2] = c[n - 1];
+            }
+            n = (n + 1) / 2;
+            power *= power;
+        }
+        result = c[0];
+    }
+    if(result != result) { // la expresión original puede dar un error de evaluación donde el polinomio da NaN
+        return m_original->evaluate(symbols);
+    }
+    return result;
+}
+
+double PiecewisePolynomial::evaluate(double x) const noexcept {
+    double u = (x - m_lo) * m_scale;
+    size_t piece = std::min(static_cast<size_t>(u), pieces() - 1);
+    double t = 2.0 * (u - static_cast<double>(piece)) - 1.0;
+    const double* c = m_coefficients.data() + piece * (m_degree + 1);
+    double result = c[m_degree];
+    for(size_t k = m_degree; k-- > 0;) {
+        result = mul_add(result, t, c[k]);
+    }
+    return result;
+}
+
+double ApproximationExpression::evaluate(const SymbolTable& symbols) const {
+    std::optional<double> x = symbols.get(m_var);
+    if(!x.has_value() || !(*x >= m_table.lo() && *x <= m_table.hi())) { // también si x es NaN
+        return m_original->evaluate(symbols);
+    }
+    return m_table.evaluate(*x);
+}
+
+namespace {
+
+thread_local std::vector<double> t_local_slots; // valores de los `let` que se están evaluando en este hilo
+
+}
+
+std::vector<double>& current_local_slots() noexcept {
+    return t_local_slots;
+}
+
+double LetExpression::evaluate(const SymbolTable& symbols) const {
+    double value = m_value->evaluate(symbols);
+    if(m_slot >= t_local_slots.size()) {
+        t_local_slots.resize(m_slot + 1);
+    }
+    t_local_slots[m_slot] = value; // el valor se evalúa antes, porque puede usar esta misma posición en sus `let`
+    return m_body->evaluate(symbols);
+}
+
+double LocalExpression::evaluate(const SymbolTable&) const {
+    return t_local_slots[m_slot];
+}
+
 double Expression::evaluate(const SymbolTable& symbols) const {
     auto visit_func = [&symbols](const auto& expr) -> double {
         return expr.evaluate(symbols);
@@ -1,15 +1,44 @@
+#include "approximation.hpp"
+#include "arrow_ipc.hpp"
+#include "batch.hpp"
 #include "parser_errors.hpp"
 #include "eval_errors.hpp"
+#include "native.hpp"
 #include "symbol_table.hpp"
 #include "syntax_tree.hpp"
 #include "tokens.hpp"
 #include "parser.hpp"
+#include "polynomial.hpp"
+#include "random.hpp"
+#include "read_ahead.hpp"
+#include "shm_transport.hpp"
+#include "range_analysis.hpp"
+#include "speculation.hpp"
+#include "tiered.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <optional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <fcntl.h>
+#include <unistd.h>
 #include <vector>
 
 namespace clex {
@@ -101,6 +130,470 @@ class Test {
     }
 };
 
+/*
+ * Test que no se puede escribir como una expresión con su valor esperado: compara alguna parte de la biblioteca (el
+ * análisis de rangos, el modo por lotes...) con el intérprete. La comprobación devuelve el motivo del fallo, si lo hay.
+ */
+class Check {
+  private:
+    std::string m_name;
+    std::function<std::optional<std::string>()> m_check;
+  public:
+    Check(std::string&& name, std::function<std::optional<std::string>()>&& check)
+      : m_name(std::move(name)), m_check(std::move(check)) {};
+
+    void run() noexcept {
+        std::cout << ">>> EJECUTANDO TEST: " << m_name << '\n';
+        std::optional<std::string> failure;
+        try {
+            failure = m_check();
+        } catch(const std::exception& err) {
+            std::cerr << "\tERROR INESPERADO DETECTADO\n"
+                      << "\tLa comprobación ha lanzado una excepción. El mensaje de error es:\n\t\t" << err.what() << '\n'
+                      << "\tDeteniendo ejecución del test.\n";
+            return;
+        }
+        if(failure.has_value()) {
+            std::cout << "Test ejecutado y fallado: " << *failure << ".\n";
+        } else {
+            std::cout << "Test ejecutado con éxito: El resultado coincide con el del intérprete.\n";
+        }
+    }
+};
+
+namespace {
+
+clex::Expression parse_expression(const std::string& input) {
+    clex::Parser parser(clex::tokenize(input));
+    clex::Statement stmt = parser.parse_next_statement();
+    return stmt.move_as_expression();
+}
+
+// Resultado de una evaluación: su valor con 12 cifras significativas (para no distinguir los errores de redondeo de
+// las reescrituras) o `error` si da un error de evaluación
+std::string outcome(const std::function<double()>& evaluate) {
+    try {
+        std::ostringstream out;
+        out << std::setprecision(12) << evaluate();
+        return out.str();
+    } catch(const clex::EvalError&) {
+        return "error";
+    }
+}
+
+std::string outcome(const clex::Expression& expr, const clex::SymbolTable& symbols) {
+    return outcome([&] { return expr.evaluate(symbols); });
+}
+
+// El árbol sin las comprobaciones que `ranges` hace innecesarias debe dar lo mismo que el original con cada valor de `x`
+// (y de las demás variables de `others`)
+std::optional<std::string> same_with_ranges(const std::string& input, const clex::VariableRanges& ranges,
+                                            const std::vector<double>& xs,
+                                            const std::unordered_map<std::string, double>& others = {}) {
+    clex::Expression expr = parse_expression(input);
+    clex::Expression elided = clex::elide_domain_checks(expr, clex::SymbolTable(), ranges);
+    for(double x : xs) {
+        std::unordered_map<std::string, double> values = others;
+        values["x"] = x;
+        clex::SymbolTable symbols = clex::SymbolTable::from_map(std::move(values));
+        std::string expected = outcome(expr, symbols);
+        std::string actual = outcome(elided, symbols);
+        if(expected != actual) {
+            return "`" + input + "` con x = " + std::to_string(x) + " da " + actual + " en lugar de " + expected;
+        }
+    }
+    return std::nullopt;
+}
+
+// `rewrite_polynomials()` debe convertir `input` en un polinomio que dé lo mismo que el árbol original (salvo en los
+// últimos bits) con los valores de cada elemento de `cases`
+std::optional<std::string> same_after_rewrite(const std::string& input,
+                                              const std::vector<std::unordered_map<std::string, double>>& cases) {
+    clex::Expression expr = parse_expression(input);
+    clex::Expression rewritten = clex::rewrite_polynomials(expr);
+    if(rewritten.type() != clex::ExpressionType::POLYNOMIAL) {
+        return "`" + input + "` no se ha reescrito como un polinomio";
+    }
+    for(size_t i = 0; i < cases.size(); i++) {
+        clex::SymbolTable symbols = clex::SymbolTable::from_map(std::unordered_map<std::string, double>(cases[i]));
+        std::string expected = outcome(expr, symbols);
+        std::string actual = outcome(rewritten, symbols);
+        if(expected != actual) {
+            return "`" + input + "` da " + actual + " en lugar de " + expected + " con los valores número " + std::to_string(i);
+        }
+    }
+    return std::nullopt;
+}
+
+// Salida de `evaluate_csv()` para la entrada CSV `input`
+// Flujo aleatorio con una clave fija, para que dos ejecuciones por lotes con `rand()` den los mismos valores
+clex::RandomStream fixed_random_stream() {
+    return clex::RandomStream(0x5eed, 0);
+}
+
+std::string run_csv(const std::string& input, const std::string& expr, const clex::BatchOptions& options = {}) {
+    clex::ScopedRandomStream random(fixed_random_stream());
+    std::istringstream in(input);
+    std::ostringstream out, err;
+    clex::evaluate_csv(in, out, err, parse_expression(expr), clex::SymbolTable(), options);
+    return out.str();
+}
+
+// Filas de prueba del modo por lotes, con columnas `x` e `y`. Hay nulos en las dos columnas y filas en las que `y` no
+// es positiva, para que `log(y)` falle.
+struct BatchRows {
+    std::vector<std::optional<double>> x, y;
+};
+
+BatchRows batch_rows(size_t n) {
+    BatchRows rows;
+    for(size_t i = 0; i < n; i++) {
+        double x = static_cast<double>(static_cast<long>(i * 7919 % 2001) - 1000) / 100.0;
+        double y = static_cast<double>(static_cast<long>(i * 104729 % 997) - 50) / 10.0;
+        rows.x.push_back(i % 41 == 5 ? std::nullopt : std::optional<double>(x));
+        rows.y.push_back(i % 53 == 7 ? std::nullopt : std::optional<double>(y));
+    }
+    return rows;
+}
+
+std::string to_csv(const BatchRows& rows) {
+    std::ostringstream out;
+    out << std::setprecision(17) << "x,y\n";
+    for(size_t i = 0; i < rows.x.size(); i++) {
+        if(rows.x[i].has_value()) {
+            out << *rows.x[i];
+        }
+        out << ',';
+        if(rows.y[i].has_value()) {
+            out << *rows.y[i];
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+// Resultado de cada fila con el intérprete: nulo si `x` o `y` son nulas o la fila no cumple `filter`, y NaN si la
+// evaluación falla. Las expresiones de estos tests usan siempre las dos columnas.
+std::vector<std::optional<double>> interpreter_results(const BatchRows& rows, const std::string& input,
+                                                       const std::string& filter = "") {
+    clex::Expression expr = parse_expression(input);
+    std::optional<clex::Expression> predicate;
+    if(!filter.empty()) {
+        predicate.emplace(parse_expression(filter));
+    }
+    std::vector<std::optional<double>> results;
+    for(size_t i = 0; i < rows.x.size(); i++) {
+        if(!rows.x[i].has_value() || !rows.y[i].has_value()) {
+            results.push_back(std::nullopt);
+            continue;
+        }
+        clex::SymbolTable symbols = clex::SymbolTable::from_map({{"x", *rows.x[i]}, {"y", *rows.y[i]}});
+        if(predicate.has_value() && predicate->evaluate(symbols) == 0.0) {
+            results.push_back(std::nullopt);
+            continue;
+        }
+        try {
+            results.push_back(expr.evaluate(symbols));
+        } catch(const clex::EvalError&) {
+            results.push_back(std::nan(""));
+        }
+    }
+    return results;
+}
+
+// Resultados de una salida de `evaluate_csv()`, una línea por fila: nulo en las vacías
+std::vector<std::optional<double>> parse_results(const std::string& output) {
+    std::vector<std::optional<double>> results;
+    std::istringstream in(output);
+    std::string line;
+    while(std::getline(in, line)) {
+        results.push_back(line.empty() ? std::nullopt : std::optional<double>(std::strtod(line.c_str(), nullptr)));
+    }
+    return results;
+}
+
+std::string show(const std::optional<double>& value) {
+    if(!value.has_value()) {
+        return "nulo";
+    }
+    std::ostringstream out;
+    out << std::setprecision(17) << *value;
+    return out.str();
+}
+
+// Compara los resultados fila a fila: mismos nulos, mismos NaN y el resto con un error relativo de hasta `tolerance`
+std::optional<std::string> compare_results(const std::vector<std::optional<double>>& actual,
+                                           const std::vector<std::optional<double>>& expected, double tolerance) {
+    if(actual.size() != expected.size()) {
+        return "hay " + std::to_string(actual.size()) + " resultados en lugar de " + std::to_string(expected.size());
+    }
+    for(size_t i = 0; i < actual.size(); i++) {
+        bool same;
+        if(!actual[i].has_value() || !expected[i].has_value()) {
+            same = actual[i].has_value() == expected[i].has_value();
+        } else if(std::isnan(*actual[i]) || std::isnan(*expected[i])) {
+            same = std::isnan(*actual[i]) && std::isnan(*expected[i]);
+        } else {
+            same = std::abs(*actual[i] - *expected[i]) <= tolerance * std::max(1.0, std::abs(*expected[i]));
+        }
+        if(!same) {
+            return "la fila " + std::to_string(i + 1) + " da " + show(actual[i]) + " en lugar de " + show(expected[i]);
+        }
+    }
+    return std::nullopt;
+}
+
+// Resultado de una función de ventana calculado directamente sobre la ventana de cada fila
+std::vector<std::optional<double>> window_results(const std::vector<std::optional<double>>& values,
+                                                  const std::string& function, double parameter) {
+    std::vector<std::optional<double>> results;
+    std::optional<double> average;
+    size_t n = static_cast<size_t>(parameter);
+    for(size_t i = 0; i < values.size(); i++) {
+        if(function == "ema") {
+            if(values[i].has_value()) {
+                average = average.has_value() ? parameter * *values[i] + (1.0 - parameter) * *average : *values[i];
+            }
+            results.push_back(values[i].has_value() ? average : std::nullopt);
+            continue;
+        } else if(function == "lag") {
+            results.push_back(i >= n ? values[i - n] : std::nullopt);
+            continue;
+        }
+        std::vector<double> window;
+        for(size_t j = i + 1 >= n ? i + 1 - n : 0; j <= i && values[j].has_value(); j++) {
+            window.push_back(*values[j]);
+        }
+        if(window.size() < n) {
+            results.push_back(std::nullopt);
+        } else if(function == "rolling_sum" || function == "rolling_mean") {
+            double sum = std::accumulate(window.begin(), window.end(), 0.0);
+            results.push_back(function == "rolling_sum" ? sum : sum / parameter);
+        } else {
+            results.push_back(function == "rolling_min" ? *std::min_element(window.begin(), window.end())
+                                                        : *std::max_element(window.begin(), window.end()));
+        }
+    }
+    return results;
+}
+
+// Ruta de un fichero temporal para los tests, distinta en cada proceso
+std::string temporary_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("calculexdora-test-" + std::to_string(getpid()) + "-" + name)).string();
+}
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+// Contenido de un fichero de resultados de `update_csv_file()`, sin los espacios que completan cada línea
+std::string read_results_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string line, content;
+    while(std::getline(in, line)) {
+        content += line.substr(0, line.find_last_not_of(' ') + 1) + '\n';
+    }
+    return content;
+}
+
+// Expresión de los tests del código nativo: tiene una elección y falla cuando `x == 0` o `y == 0`
+const std::string NATIVE_EXPR = "if(x > 0, sqrt(x), log(-x)) + y^3 - 2*x*y + 1 / y";
+
+// Filas de los tests del código nativo: todas las combinaciones de una rejilla que pasa por `x == 0` e `y == 0`
+BatchRows native_rows() {
+    BatchRows rows;
+    for(int i = -12; i <= 12; i++) {
+        for(double y : {-1.5, 0.0, 0.5, 2.0}) {
+            rows.x.push_back(i / 4.0);
+            rows.y.push_back(y);
+        }
+    }
+    return rows;
+}
+
+// Si está el compilador de `NativeFormula::build()`: sin él, los tests del código nativo se omiten
+bool native_compiler_available() {
+    const char* compiler = std::getenv("CXX");
+    std::string command = std::string(compiler != nullptr ? compiler : "c++") + " --version > /dev/null 2>&1";
+    if(std::system(command.c_str()) != 0) {
+        std::cout << "No hay compilador de C++: se omite el test.\n";
+        return false;
+    }
+    return true;
+}
+
+// Directorio temporal vacío para la caché del código nativo
+std::string native_cache_dir(const std::string& name) {
+    std::string dir = temporary_path(name);
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    return dir;
+}
+
+// Bibliotecas compiladas de la caché del código nativo
+std::vector<std::string> native_libraries(const std::string& dir) {
+    std::vector<std::string> libraries;
+    for(const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if(entry.path().extension() == ".so") {
+            libraries.push_back(entry.path().string());
+        }
+    }
+    return libraries;
+}
+
+// Resultados de un núcleo por columnas de `n` expresiones para la expresión `k`, con NaN en las filas que fallan.
+// En precisión simple, una fila también puede fallar sin que falle el intérprete; entonces se toma `fallback`, el
+// resultado que daría la vía por la que se vuelve a evaluar.
+template<typename Real>
+std::vector<std::optional<double>> kernel_results(const std::vector<Real>& results, const std::vector<uint8_t>& failed,
+                                                  size_t n, size_t k, const std::vector<std::optional<double>>& fallback) {
+    std::vector<std::optional<double>> column;
+    for(size_t row = 0; row * n < results.size(); row++) {
+        if(!failed[row * n + k]) {
+            column.push_back(static_cast<double>(results[row * n + k]));
+        } else {
+            column.push_back(std::is_same_v<Real, float> ? fallback[row] : std::nan(""));
+        }
+    }
+    return column;
+}
+
+// Número de tablas de aproximación de una expresión
+size_t count_approximations(const clex::Expression& expr) {
+    switch(expr.type()) {
+      case clex::ExpressionType::BIN_OP: {
+        auto [lhs, rhs] = expr.as_bin_op().get_operands();
+        return count_approximations(lhs) + count_approximations(rhs);
+      }
+      case clex::ExpressionType::UNARY_OP: return count_approximations(expr.as_unary_op().get_operand());
+      case clex::ExpressionType::CONDITIONAL: {
+        const clex::ConditionalExpression& conditional = expr.as_conditional();
+        auto [if_true, if_false] = conditional.get_branches();
+        return count_approximations(conditional.get_condition()) + count_approximations(if_true)
+               + count_approximations(if_false);
+      }
+      case clex::ExpressionType::CALL: {
+        size_t count = 0;
+        for(const std::unique_ptr<clex::Expression>& arg : expr.as_call().get_args()) {
+            count += count_approximations(*arg);
+        }
+        return count;
+      }
+      case clex::ExpressionType::LET:
+        return count_approximations(expr.as_let().get_value()) + count_approximations(expr.as_let().get_body());
+      case clex::ExpressionType::APPROXIMATION: return 1;
+      default: return 0;
+    }
+}
+
+// `approximate_univariate()` de `input`, con `x` en `[lo, hi]`, debe sustituir `tables` subexpresiones y dar lo mismo que
+// la expresión original, salvo dentro del rango, donde solo se puede alejar de ella en `tolerance`. Se prueba en una
+// malla densa del rango y en `outside`, que son valores fuera del rango.
+std::optional<std::string> same_with_approximation(const std::string& input, double lo, double hi, double tolerance,
+                                                   size_t tables, const std::vector<double>& outside = {}) {
+    clex::Expression expr = parse_expression(input);
+    clex::SymbolTable constants = clex::SymbolTable::from_map({{"a", 2.0}});
+    clex::Expression approximated = clex::approximate_univariate(expr, constants, {{"x", clex::Interval{lo, hi, false}}},
+                                                                 tolerance);
+    if(count_approximations(approximated) != tables) {
+        return "`" + input + "` tiene " + std::to_string(count_approximations(approximated)) + " tablas en lugar de "
+               + std::to_string(tables);
+    }
+    for(size_t i = 0; i <= 10000; i++) {
+        double x = lo + (hi - lo) * static_cast<double>(i) / 10000.0;
+        clex::SymbolTable symbols = clex::SymbolTable::from_map({{"a", 2.0}, {"x", x}});
+        std::string expected = outcome(expr, symbols), actual = outcome(approximated, symbols);
+        if(expected == "error" || actual == "error") {
+            if(expected != actual) {
+                return "`" + input + "` con x = " + std::to_string(x) + " da " + actual + " en lugar de " + expected;
+            }
+        } else if(std::abs(approximated.evaluate(symbols) - expr.evaluate(symbols)) > tolerance) {
+            return "`" + input + "` con x = " + std::to_string(x) + " se sale de la tolerancia: " + actual + " en lugar de "
+                   + expected;
+        }
+    }
+    // fuera del rango, con `x` NaN o sin definir se evalúa la expresión original, con sus mismos errores
+    std::vector<clex::SymbolTable> tables_outside{clex::SymbolTable::from_map({{"a", 2.0}, {"x", std::nan("")}}),
+                                                  clex::SymbolTable::from_map({{"a", 2.0}})};
+    for(double x : outside) {
+        tables_outside.push_back(clex::SymbolTable::from_map({{"a", 2.0}, {"x", x}}));
+    }
+    for(const clex::SymbolTable& symbols : tables_outside) {
+        std::string expected = outcome(expr, symbols), actual = outcome(approximated, symbols);
+        if(expected != actual) {
+            return "`" + input + "` fuera del rango da " + actual + " en lugar de " + expected;
+        }
+    }
+    return std::nullopt;
+}
+
+// Nombre de un segmento de memoria compartida de los tests
+std::string shm_name(const std::string& name) {
+    return "/calculexdora-test-" + std::to_string(getpid()) + "-" + name;
+}
+
+// Resultado de una petición por memoria compartida, escrito como `outcome()`, o el nombre del estado si no es `OK`
+std::string shm_outcome(clex::ShmStatus status, double value) {
+    switch(status) {
+      case clex::ShmStatus::OK: return outcome([&] { return value; });
+      case clex::ShmStatus::EVAL_ERROR: return "error";
+      case clex::ShmStatus::INVALID_FORMULA: return "expresión inválida";
+      case clex::ShmStatus::INVALID_ARGUMENTS: return "argumentos inválidos";
+    }
+    return "estado desconocido";
+}
+
+// Resultado de una petición suelta por memoria compartida, escrito como en `shm_outcome()`
+std::string shm_single(clex::ShmClient& client, uint32_t formula, const double* args, size_t n_args) {
+    double result = 0.0;
+    clex::ShmStatus status = client.evaluate(formula, args, n_args, result);
+    return shm_outcome(status, result);
+}
+
+// Lee todo lo que da un búfer. `bad` indica si el flujo ha terminado en estado `bad()`.
+std::string read_all(std::streambuf& buffer, bool& bad) {
+    std::istream in(&buffer);
+    std::string content;
+    char c;
+    while(in.get(c)) {
+        content += c;
+    }
+    bad = in.bad();
+    return content;
+}
+
+// Texto de prueba de la lectura anticipada, con líneas de longitudes distintas para no coincidir con los bloques
+std::string read_ahead_text() {
+    std::string text;
+    for(size_t i = 0; text.size() < 100000; i++) {
+        text += std::to_string(i * 7919 % 100003) + std::string(i % 13, '-') + '\n';
+    }
+    return text;
+}
+
+// Expresión de los tests del modo por lotes: usa las dos columnas, tiene un polinomio y falla cuando `y <= 0`
+const std::string BATCH_EXPR = "x^3 - 2*x*y + log(y) / 4 + if(x > 0, sqrt(x), x)";
+
+// `formula`, creada a partir de `input`, debe dar lo mismo que el intérprete con cada valor de `x` (y el resto de
+// variables de `symbols`)
+std::optional<std::string> same_with_speculation(const std::string& input, clex::SpeculativeFormula& formula,
+                                                  clex::SymbolTable& symbols, const std::vector<double>& xs) {
+    clex::Expression expr = parse_expression(input);
+    for(double x : xs) {
+        symbols.set(clex::Token::identifier("x"), x);
+        std::string expected = outcome(expr, symbols);
+        std::string actual = outcome([&] { return formula.evaluate(symbols); });
+        if(expected != actual) {
+            return "`" + input + "` con x = " + std::to_string(x) + " da " + actual + " en lugar de " + expected
+                   + (formula.is_specialized() ? " con la especialización" : " sin la especialización");
+        }
+    }
+    return std::nullopt;
+}
+
+}
+
 int main(int argc, char** argv) {
     std::vector<Test> tests {
         Test {
@@ -160,9 +653,1123 @@ int main(int argc, char** argv) {
         Test {
             "Error 5: Resultado no real",
             "i = (-1) ^ 0.5"
+        },
+        Test {
+            "Comparaciones",
+            "(1 < 2) + (2 <= 2) + (3 > 4) + (4 >= 5) + (5 == 5) + (5 != 5)",
+            3
+        },
+        Test {
+            "Operadores lógicos",
+            "not a < b and (b > 0 or 1 / a > 0)",
+            clex::SymbolTable::from_map({{"a", 2}, {"b", 1}}),
+            1
+        },
+        Test {
+            "Condicional",
+            "if(x > 0, log(x), 0) + if(x <= 0 and x != 0, 10, 20)",
+            clex::SymbolTable::from_map({{"x", -1}}),
+            10
+        },
+        Test {
+            "Números aleatorios",
+            "(rand() >= 0 and rand() < 1) + mc(randn() * 0 + 3, 5000) + mcerr(2, 100)",
+            4
+        },
+        Test {
+            "Monte Carlo",
+            "(mc(rand(), 100000) - 0.5)^2 < (5 * mcerr(rand(), 100000))^2",
+            1
+        },
+        Test {
+            "Error 6: Número de muestras inválido",
+            "mc(rand(), 0.5)",
+            0
+        },
+        Test {
+            "Let anidados",
+            "let a = 2 in let b = a * 3 in a + b",
+            8
+        },
+        Test {
+            "Let que oculta otro let",
+            "let x = 1 in (let x = x + 10 in x) + x",
+            12
+        },
+        Test {
+            "Let que lee la variable que oculta",
+            "let x = x + 1 in x * 10 + x",
+            clex::SymbolTable::from_map({{"x", 2}}),
+            33
+        },
+        Test {
+            "Let dentro de mc",
+            "let k = 3 in mc(let r = rand() in k + r * 0, 1000) + mcerr(k, 10)",
+            3
+        },
+        Test {
+            "Error 7: Let sin in",
+            "let x = 1 + 2"
+        },
+        Test {
+            "Error 8: Let sin =",
+            "let x 1 in x"
+        },
+        Test {
+            "Función de Rosenbrock (L-BFGS)",
+            "argmin((1 - x)^2 + 100 * (y - x^2)^2, y, x) + minimize((1 - x)^2 + 100 * (y - x^2)^2, x, y)",
+            clex::SymbolTable::from_map({{"x", -1.2}, {"y", 1}}),
+            1
+        },
+        Test {
+            "Mínimo de una expresión no suave (Nelder-Mead)",
+            "argmin(if(x < 2, 2 - x, (x - 2) * 3), x) + minimize(if(x < 2, 2 - x, (x - 2) * 3), x)",
+            2
+        },
+        Test {
+            "Error 9: Variable repetida en minimize",
+            "minimize(x^2 + y^2, x, y, x)",
+            0
+        },
+        Test {
+            "Error 10: Argumento de argmin que no es una variable",
+            "argmin(x^2, 2)",
+            0
+        },
+        Test {
+            "Error 11: Expresión sin mínimo",
+            "minimize(x, x)",
+            0
+        },
+        Test {
+            "Ecuación diferencial y' = y",
+            "ode(y, y, t, 1)",
+            clex::SymbolTable::from_map({{"y", 1}, {"t", 0}}),
+            2.718281828459045
+        },
+        Test {
+            "Oscilador armónico",
+            "ode(v, -y, y, v, t, pi) + ode(-y, v, v, y, t, pi / 2)",
+            clex::SymbolTable::from_map({{"y", 1}, {"v", 0}, {"t", 0}}),
+            -2
+        },
+        Test {
+            "Error 12: Argumentos de ode",
+            "ode(y, 2 * y, y, t, 1)",
+            clex::SymbolTable::from_map({{"y", 1}, {"t", 0}}),
+            0
+        },
+        Test {
+            "Error 13: Tokens sobrantes tras la expresión",
+            "1 + 2, 5"
+        },
+        Test {
+            "Error 14: In fuera de un let",
+            "x in 99"
         }
     };
-    
+
+    std::vector<Check> checks {
+        Check {
+            "Rangos de las variables de minimize y argmin",
+            [] {
+                clex::VariableRanges ranges{{"x", clex::Interval{0.0, 4.0, false}}};
+                std::optional<std::string> failure = same_with_ranges("minimize(if(sqrt(x) >= 0, (x-1)^2, -5), x)", ranges, {2, 3});
+                return failure.has_value() ? failure : same_with_ranges("argmin(if(log(x) > -1000, (x-1)^2, -5), x)", ranges, {2, 3});
+            }
+        },
+        Check {
+            "Rangos de las variables de ode",
+            [] {
+                clex::VariableRanges ranges{{"x", clex::Interval{0.0, 2.0, false}}, {"t", clex::Interval{0.0, 0.0, false}}};
+                std::optional<std::string> failure = same_with_ranges("ode(if(sqrt(x) >= 0, -1, 0), x, t, 3)", ranges, {1}, {{"t", 0}});
+                return failure.has_value() ? failure : same_with_ranges("ode(if(log(t + 1) > -1000, 1, 0), x, t, -3)", ranges, {1}, {{"t", 0}});
+            }
+        },
+        Check {
+            "Especialización y desespecialización",
+            [] () -> std::optional<std::string> {
+                std::string input = "a * x^2 + b / 4 + if(b > 0, sqrt(b), a)";
+                clex::SymbolTable symbols = clex::SymbolTable::from_map({{"a", 2}, {"b", -1}});
+                clex::SpeculativeFormula formula(parse_expression(input), 3);
+                std::optional<std::string> failure = same_with_speculation(input, formula, symbols, {1, 2, 3, 4, 5});
+                if(failure.has_value()) {
+                    return failure;
+                }
+                if(!formula.is_specialized() || formula.specialized_on().size() != 2 || formula.statistics().specialized_evaluations != 2) {
+                    return std::string("la expresión no se ha especializado en `a` y `b` tras tres evaluaciones");
+                }
+                symbols.set(clex::Token::identifier("a"), 2);
+                failure = same_with_speculation(input, formula, symbols, {6});
+                if(failure.has_value() || formula.statistics().deoptimizations != 0) {
+                    return failure.has_value() ? failure : "escribir el mismo valor de `a` ha descartado la especialización";
+                }
+                symbols.set(clex::Token::identifier("a"), 3);
+                failure = same_with_speculation(input, formula, symbols, {7, 8});
+                if(failure.has_value() || formula.statistics().deoptimizations != 1 || formula.is_specialized()) {
+                    return failure.has_value() ? failure : "cambiar el valor de `a` no ha descartado la especialización";
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Error en una subexpresión especializada",
+            [] () -> std::optional<std::string> {
+                std::string input = "if(x > 0, x, sqrt(a))";
+                clex::SymbolTable symbols = clex::SymbolTable::from_map({{"a", -1}});
+                clex::SpeculativeFormula formula(parse_expression(input), 2);
+                std::optional<std::string> failure = same_with_speculation(input, formula, symbols, {1, 2, 3, -1});
+                if(!failure.has_value() && (!formula.is_specialized() || formula.statistics().specialized_evaluations != 2)) {
+                    return std::string("la expresión no se ha especializado en `a`");
+                }
+                return failure;
+            }
+        },
+        Check {
+            "Especialización en la ejecución por niveles",
+            [] () -> std::optional<std::string> {
+                clex::Expression expr = parse_expression("a * x + sqrt(a) / 4");
+                clex::TierThresholds thresholds;
+                thresholds.optimize = 20;
+                thresholds.speculate = 5;
+                clex::TieredFormula formula(expr, {clex::Token::identifier("a"), clex::Token::identifier("x")}, clex::SymbolTable(), "", thresholds);
+                clex::SymbolTable symbols;
+                for(int i = 0; i < 60; i++) {
+                    // el servidor escribe todas las variables en cada petición, aunque `a` no cambie hasta la 40
+                    double args[2] = {i < 40 ? 2.0 : -1.0, static_cast<double>(i)};
+                    std::string expected = outcome(expr, clex::SymbolTable::from_map({{"a", args[0]}, {"x", args[1]}}));
+                    std::string actual = outcome([&] { return formula.evaluate(args, symbols); });
+                    if(expected != actual) {
+                        return "la petición " + std::to_string(i) + " da " + actual + " en lugar de " + expected;
+                    }
+                }
+                clex::SpeculationStatistics speculation = formula.statistics().speculation;
+                if(speculation.specialized_evaluations == 0 || speculation.deoptimizations == 0) {
+                    return std::string("la expresión no se ha especializado, o no se ha descartado la especialización al cambiar `a`");
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Ejecución por niveles desde varios hilos",
+            [] () -> std::optional<std::string> {
+                if(!native_compiler_available()) {
+                    return std::nullopt;
+                }
+                // con los dos umbrales iguales, cada evaluación en el nivel optimizado intenta empezar la compilación,
+                // incluso mientras el hilo que ha preparado ese nivel aún se está guardando
+                std::string dir = native_cache_dir("niveles-hilos");
+                std::string input = "sqrt(x) * log(y) + x / y";
+                clex::Expression expr = parse_expression(input);
+                clex::TierThresholds thresholds;
+                thresholds.optimize = 100;
+                thresholds.native = 100;
+                std::vector<clex::Token> variables{clex::Token::identifier("x"), clex::Token::identifier("y")};
+                std::vector<std::optional<std::string>> failures(4);
+                {
+                    clex::TieredFormula formula(expr, variables, clex::SymbolTable(), dir, thresholds);
+                    std::vector<std::thread> threads;
+                    for(size_t t = 0; t < failures.size(); t++) {
+                        threads.emplace_back([&, t] {
+                            clex::SymbolTable symbols;
+                            // hasta que la expresión llega al nivel nativo, y unas evaluaciones más con él, o un minuto
+                            auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+                            for(int i = 0; i < 2000 || (formula.tier() != clex::ExecutionTier::NATIVE
+                                                        && std::chrono::steady_clock::now() < deadline); i++) {
+                                double args[2] = {static_cast<double>(i % 17) - 3.0, static_cast<double>(t) + 0.5 + i % 5};
+                                std::string expected = outcome(expr, clex::SymbolTable::from_map({{"x", args[0]}, {"y", args[1]}}));
+                                std::string actual = outcome([&] { return formula.evaluate(args, symbols); });
+                                if(expected != actual) {
+                                    failures[t] = "`" + input + "` da " + actual + " en lugar de " + expected;
+                                    return;
+                                }
+                            }
+                        });
+                    }
+                    for(std::thread& thread : threads) {
+                        thread.join();
+                    }
+                    if(!failures[0].has_value() && formula.tier() != clex::ExecutionTier::NATIVE) {
+                        failures[0] = "la expresión no ha llegado al nivel nativo";
+                    }
+                }
+                std::filesystem::remove_all(dir);
+                for(const std::optional<std::string>& failure : failures) {
+                    if(failure.has_value()) {
+                        return failure;
+                    }
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Polinomios por el método de Horner",
+            [] {
+                return same_after_rewrite("3*x^3 - x^2/2 + 5 - x", {{{"x", -3}}, {{"x", -0.5}}, {{"x", 0}}, {{"x", 0.7}}, {{"x", 12}}});
+            }
+        },
+        Check {
+            "Polinomios por el método de Estrin",
+            [] {
+                return same_after_rewrite(
+                    "x^12 - 3*x^11/7 + x^9 - 2*x^8 + x^7*5 - x^5 + 2*x^4 - x^3 + x^2/2 - x + 1",
+                    {{{"x", -1.5}}, {{"x", -0.3}}, {{"x", 0}}, {{"x", 0.6}}, {{"x", 2.25}}}
+                );
+            }
+        },
+        Check {
+            "Polinomios con coeficientes simbólicos",
+            [] {
+                return same_after_rewrite(
+                    "a*x^2 + b*x + c - x^3*sqrt(a)",
+                    {{{"x", 2}, {"a", 4}, {"b", -1}, {"c", 0.5}}, {{"x", -0.25}, {"a", 9}, {"b", 3}, {"c", -2}}}
+                );
+            }
+        },
+        Check {
+            "Polinomios que vuelven a la expresión original",
+            [] {
+                // sin valor de `x`, o con `a` negativo o `x` NaN, la expresión original da un error y el polinomio no
+                return same_after_rewrite(
+                    "x^3 - sqrt(a)*x^2 + 1",
+                    {{{"a", 1}}, {{"x", 2}, {"a", -1}}, {{"x", std::nan("")}, {"a", 1}}, {{"x", 0}, {"a", 1}}}
+                );
+            }
+        },
+        Check {
+            "Lectura anticipada: ficheros y tuberías",
+            [] () -> std::optional<std::string> {
+                std::string text = read_ahead_text();
+                std::string path = temporary_path("lectura.txt");
+                write_file(path, text);
+                bool bad;
+                std::optional<std::string> failure;
+                {
+                    // un descriptor propio se lee con `pread` desde la posición indicada
+                    clex::ReadAheadBuffer buffer(::open(path.c_str(), O_RDONLY | O_CLOEXEC), true, 5, 4096, 2);
+                    if(read_all(buffer, bad) != text.substr(5) || bad) {
+                        failure = "la lectura de un fichero desde una posición no coincide con su contenido";
+                    }
+                }
+                {
+                    // uno ajeno, desde su posición actual, que avanza con lo que se lee
+                    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                    char header[10];
+                    ssize_t skipped = read(fd, header, sizeof(header));
+                    {
+                        clex::ReadAheadBuffer buffer(fd, false, 0, 4096, 2);
+                        if(skipped != 10 || read_all(buffer, bad) != text.substr(10) || bad) {
+                            failure = "la lectura de un descriptor ajeno no empieza en su posición actual";
+                        }
+                    }
+                    if(lseek(fd, 0, SEEK_CUR) != static_cast<off_t>(text.size())) {
+                        failure = "la lectura de un descriptor ajeno no avanza su posición";
+                    }
+                    close(fd);
+                }
+                {
+                    // una tubería que recibe los datos a trozos
+                    int fds[2];
+                    if(pipe(fds) < 0) {
+                        return std::string("no se ha podido crear la tubería");
+                    }
+                    std::thread writer([&] {
+                        for(size_t at = 0; at < text.size(); at += 30000) {
+                            std::string piece = text.substr(at, 30000);
+                            for(size_t done = 0; done < piece.size();) {
+                                done += static_cast<size_t>(std::max<ssize_t>(0, write(fds[1], piece.data() + done, piece.size() - done)));
+                            }
+                            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                        }
+                        close(fds[1]);
+                    });
+                    {
+                        clex::ReadAheadBuffer buffer(fds[0], true, 0, 4096, 2);
+                        if(read_all(buffer, bad) != text || bad) {
+                            failure = "la lectura de una tubería no coincide con lo escrito";
+                        }
+                    }
+                    writer.join();
+                }
+                std::filesystem::remove(path);
+                return failure;
+            }
+        },
+        Check {
+            "Lectura anticipada: error de lectura",
+            [] () -> std::optional<std::string> {
+                // leer un directorio falla con EISDIR
+                int fd = ::open(std::filesystem::temp_directory_path().c_str(), O_RDONLY | O_CLOEXEC);
+                if(fd < 0) {
+                    return std::string("no se ha podido abrir el directorio temporal");
+                }
+                clex::ReadAheadBuffer buffer(fd, true);
+                bool bad;
+                read_all(buffer, bad);
+                return bad ? std::nullopt : std::optional<std::string>("el flujo no ha pasado a estado bad()");
+            }
+        },
+        Check {
+            "Lectura anticipada: destruir el búfer con una tubería abierta",
+            [] () -> std::optional<std::string> {
+                int fds[2];
+                if(pipe(fds) < 0) {
+                    return std::string("no se ha podido crear la tubería");
+                }
+                ssize_t written = write(fds[1], "x\n1\n", 4);
+                // si el destructor se queda esperando, se cierra la tubería al cabo de 3 s para no bloquear los tests
+                std::thread closer([&] {
+                    std::this_thread::sleep_for(std::chrono::seconds(3));
+                    close(fds[1]);
+                });
+                // la cabecera debe llegar sin esperar a que la tubería se cierre, y destruir el búfer no debe esperar tampoco
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                {
+                    clex::ReadAheadBuffer buffer(fds[0], false);
+                    std::istream in(&buffer);
+                    std::string header;
+                    std::getline(in, header);
+                    if(written != 4 || header != "x") {
+                        closer.join();
+                        close(fds[0]);
+                        return "se ha leído la cabecera `" + header + "`";
+                    }
+                }
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                closer.join();
+                close(fds[0]);
+                if(elapsed > 1.0) {
+                    return "leer la cabecera y destruir el búfer ha tardado " + std::to_string(elapsed) + " s";
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Código nativo: evaluación escalar y por columnas",
+            [] () -> std::optional<std::string> {
+                if(!native_compiler_available()) {
+                    return std::nullopt;
+                }
+                std::string dir = native_cache_dir("nativo");
+                BatchRows rows = native_rows();
+                std::vector<std::optional<double>> expected = interpreter_results(rows, NATIVE_EXPR);
+                std::vector<double> x, y;
+                std::vector<float> x_float, y_float;
+                for(size_t i = 0; i < rows.x.size(); i++) {
+                    x.push_back(*rows.x[i]);
+                    y.push_back(*rows.y[i]);
+                    x_float.push_back(static_cast<float>(x.back()));
+                    y_float.push_back(static_cast<float>(y.back()));
+                }
+                size_t n = x.size();
+                std::vector<std::optional<double>> scalar;
+                std::vector<double> results(n);
+                std::vector<float> float_results(n);
+                std::vector<uint8_t> failed(n), float_failed(n);
+                {
+                    std::vector<clex::Token> slots{clex::Token::identifier("x"), clex::Token::identifier("y")};
+                    clex::NativeFormula formula = clex::NativeFormula::build(parse_expression(NATIVE_EXPR), slots,
+                                                                             clex::SymbolTable(), dir, true, true);
+                    for(size_t i = 0; i < n; i++) {
+                        double values[2] = {x[i], y[i]}, result;
+                        scalar.push_back(formula.evaluate(values, result) ? result : std::nan(""));
+                    }
+                    const double* columns[2] = {x.data(), y.data()};
+                    formula.evaluate_columns(columns, n, results.data(), failed.data());
+                    const float* float_columns[2] = {x_float.data(), y_float.data()};
+                    formula.evaluate_float(float_columns, n, float_results.data(), float_failed.data());
+                }
+                // las filas que fallan deben ser las mismas que en el intérprete, y el núcleo por columnas en precisión
+                // doble debe dar exactamente lo mismo que la evaluación escalar
+                std::vector<std::pair<std::string, std::optional<std::string>>> comparisons{
+                    {"escalar", compare_results(scalar, expected, 1e-12)},
+                    {"por columnas", compare_results(kernel_results(results, failed, 1, 0, expected), scalar, 0.0)},
+                    {"en precisión simple", compare_results(kernel_results(float_results, float_failed, 1, 0, expected), expected, 1e-4)}
+                };
+                // el modo por lotes usa los núcleos y vuelve al intérprete en las filas que fallan
+                for(bool float32 : {false, true}) {
+                    clex::BatchOptions options;
+                    options.native_dir = dir;
+                    options.float32 = float32;
+                    comparisons.emplace_back(float32 ? "por lotes en precisión simple" : "por lotes",
+                        compare_results(parse_results(run_csv(to_csv(rows), NATIVE_EXPR, options)), expected, float32 ? 1e-4 : 1e-12));
+                }
+                std::filesystem::remove_all(dir);
+                for(const auto& [name, failure] : comparisons) {
+                    if(failure.has_value()) {
+                        return name + ": " + *failure;
+                    }
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Código nativo: varias expresiones juntas",
+            [] () -> std::optional<std::string> {
+                if(!native_compiler_available()) {
+                    return std::nullopt;
+                }
+                std::string dir = native_cache_dir("nativo-programa");
+                BatchRows rows = native_rows();
+                // `rand()` no se puede compilar, así que esa expresión falla en todas las filas
+                std::vector<std::string> texts{NATIVE_EXPR, "x * y + rand()", "sqrt(x) + 1 / y + y^3"};
+                std::vector<clex::Expression> exprs;
+                for(const std::string& text : texts) {
+                    exprs.push_back(parse_expression(text));
+                }
+                std::vector<double> x, y;
+                std::vector<float> x_float, y_float;
+                for(size_t i = 0; i < rows.x.size(); i++) {
+                    x.push_back(*rows.x[i]);
+                    y.push_back(*rows.y[i]);
+                    x_float.push_back(static_cast<float>(x.back()));
+                    y_float.push_back(static_cast<float>(y.back()));
+                }
+                size_t n = x.size(), m = texts.size();
+                std::vector<double> results(n * m);
+                std::vector<float> float_results(n * m);
+                std::vector<uint8_t> failed(n * m), float_failed(n * m);
+                std::vector<clex::Token> slots{clex::Token::identifier("x"), clex::Token::identifier("y")};
+                bool compiled;
+                {
+                    clex::NativeProgram program = clex::NativeProgram::build(exprs, slots, clex::SymbolTable(), dir);
+                    const double* columns[2] = {x.data(), y.data()};
+                    program.evaluate_columns(columns, n, results.data(), failed.data());
+                    compiled = program.is_compiled(0) && !program.is_compiled(1) && program.is_compiled(2);
+                }
+                {
+                    clex::NativeProgram program = clex::NativeProgram::build(exprs, slots, clex::SymbolTable(), dir, true);
+                    const float* columns[2] = {x_float.data(), y_float.data()};
+                    program.evaluate_float(columns, n, float_results.data(), float_failed.data());
+                }
+                std::filesystem::remove_all(dir);
+                if(!compiled) {
+                    return std::string("las expresiones compiladas no son la primera y la tercera");
+                }
+                for(size_t k = 0; k < m; k++) {
+                    std::vector<std::optional<double>> expected(n, std::nan(""));
+                    if(k != 1) {
+                        expected = interpreter_results(rows, texts[k]);
+                    }
+                    std::optional<std::string> failure = compare_results(kernel_results(results, failed, m, k, expected), expected, 1e-12);
+                    if(!failure.has_value()) {
+                        failure = compare_results(kernel_results(float_results, float_failed, m, k, expected), expected, 1e-4);
+                    }
+                    if(failure.has_value()) {
+                        return "`" + texts[k] + "`: " + *failure;
+                    }
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Código nativo: caché y compilación fallida",
+            [] () -> std::optional<std::string> {
+                if(!native_compiler_available()) {
+                    return std::nullopt;
+                }
+                std::string dir = native_cache_dir("nativo-cache");
+                std::vector<clex::Token> slots{clex::Token::identifier("x"), clex::Token::identifier("y")};
+                auto native_value = [&](const std::string& text) {
+                    clex::NativeFormula formula = clex::NativeFormula::build(parse_expression(text), slots, clex::SymbolTable(), dir);
+                    double values[2] = {2.0, 3.0}, result;
+                    return outcome([&] { return formula.evaluate(values, result) ? result : std::nan(""); });
+                };
+                auto interpreted_value = [&](const std::string& text) {
+                    return outcome(parse_expression(text), clex::SymbolTable::from_map({{"x", 2.0}, {"y", 3.0}}));
+                };
+                std::optional<std::string> failure;
+                // una biblioteca de la caché con otra suma de comprobación se descarta y se vuelve a compilar
+                native_value("x * y + 1");
+                std::vector<std::string> first = native_libraries(dir);
+                native_value("x - y");
+                std::vector<std::string> both = native_libraries(dir);
+                if(first.size() != 1 || both.size() != 2) {
+                    failure = "la caché tiene " + std::to_string(both.size()) + " bibliotecas en lugar de 2";
+                } else {
+                    std::string other = both[0] == first[0] ? both[1] : both[0];
+                    std::filesystem::remove(first[0]);
+                    std::filesystem::copy_file(other, first[0]);
+                    if(native_value("x * y + 1") != interpreted_value("x * y + 1")) {
+                        failure = "se ha usado una biblioteca de la caché con otra suma de comprobación";
+                    }
+                }
+                // sin compilador, lo que ya está en la caché se sigue cargando, lo demás falla y los lotes usan el intérprete
+                const char* compiler = std::getenv("CXX");
+                std::optional<std::string> previous = compiler != nullptr ? std::optional<std::string>(compiler) : std::nullopt;
+                setenv("CXX", "false", 1);
+                if(!failure.has_value() && native_value("x - y") != interpreted_value("x - y")) {
+                    failure = "no se ha cargado una biblioteca de la caché";
+                }
+                if(!failure.has_value()) {
+                    try {
+                        native_value("x / y");
+                        failure = "se ha compilado una expresión sin compilador";
+                    } catch(const std::runtime_error&) {
+                    }
+                }
+                if(!failure.has_value()) {
+                    BatchRows rows = native_rows();
+                    clex::BatchOptions options;
+                    options.native_dir = dir;
+                    failure = compare_results(parse_results(run_csv(to_csv(rows), NATIVE_EXPR, options)),
+                                              interpreter_results(rows, NATIVE_EXPR), 1e-12);
+                }
+                if(previous.has_value()) {
+                    setenv("CXX", previous->c_str(), 1);
+                } else {
+                    unsetenv("CXX");
+                }
+                std::filesystem::remove_all(dir);
+                return failure;
+            }
+        },
+        Check {
+            "Memoria compartida: lotes de varias expresiones",
+            [] () -> std::optional<std::string> {
+                std::vector<std::string> texts{"x / y", "sqrt(x - y) + x^2", "log(x)"};
+                std::vector<clex::Expression> exprs;
+                for(const std::string& text : texts) {
+                    exprs.push_back(parse_expression(text));
+                }
+                // con un umbral bajo, las expresiones pasan al nivel optimizado a mitad del test
+                clex::TierThresholds thresholds;
+                thresholds.optimize = 50;
+                clex::ShmServer server(shm_name("lotes"), exprs, clex::SymbolTable(), "", thresholds);
+                std::thread serving([&] { server.serve(); });
+                clex::ShmClient client = clex::ShmClient::connect(shm_name("lotes"));
+
+                // muchas más peticiones que la capacidad de las colas, de varias expresiones mezcladas, con errores de
+                // evaluación, una expresión que no existe y otra con un número de valores distinto del de sus variables
+                size_t count = 1000;
+                std::vector<uint32_t> formulas;
+                std::vector<double> args;
+                std::vector<std::string> expected;
+                for(size_t i = 0; i < count; i++) {
+                    uint32_t formula = std::vector<uint32_t>{0, 1, 2, 0, 7}[i % 5];
+                    double x = static_cast<double>(i % 37) - 10.0, y = static_cast<double>(i % 11) - 5.0;
+                    formulas.push_back(formula);
+                    args.insert(args.end(), {x, y});
+                    if(formula == 7) {
+                        expected.push_back("expresión inválida");
+                    } else if(formula == 2) {
+                        expected.push_back("argumentos inválidos");
+                    } else {
+                        expected.push_back(outcome(exprs[formula], clex::SymbolTable::from_map({{"x", x}, {"y", y}})));
+                    }
+                }
+                std::vector<double> results(count);
+                std::vector<clex::ShmStatus> statuses(count);
+                client.evaluate_mixed(formulas.data(), args.data(), 2, count, results.data(), statuses.data());
+                std::optional<std::string> failure;
+                for(size_t i = 0; i < count && !failure.has_value(); i++) {
+                    std::string actual = shm_outcome(statuses[i], results[i]);
+                    if(actual != expected[i]) {
+                        failure = "la petición " + std::to_string(i) + " da `" + actual + "` en lugar de `" + expected[i] + "`";
+                    }
+                }
+                // peticiones sueltas, incluida una con más valores de los que caben en una petición
+                double log_args[17] = {2.0};
+                std::vector<std::pair<std::string, std::string>> singles{
+                    {shm_single(client, 2, log_args, 1), outcome([] { return std::log(2.0); })},
+                    {shm_single(client, 0, log_args, 1), "argumentos inválidos"},
+                    {shm_single(client, 9, log_args, 1), "expresión inválida"},
+                    {shm_single(client, 2, log_args, 17), "argumentos inválidos"}
+                };
+                client.shutdown();
+                serving.join();
+                for(const auto& [actual, wanted] : singles) {
+                    if(!failure.has_value() && actual != wanted) {
+                        failure = "una petición suelta da `" + actual + "` en lugar de `" + wanted + "`";
+                    }
+                }
+                clex::ShmBatchStatistics statistics = server.batch_statistics();
+                if(!failure.has_value() && (statistics.requests != count + 3 || statistics.largest > 64)) {
+                    failure = "el servidor ha atendido " + std::to_string(statistics.requests) + " peticiones, con un lote de "
+                              + std::to_string(statistics.largest);
+                }
+                if(!failure.has_value() && server.formulas()[0].engine->statistics().tier != clex::ExecutionTier::OPTIMIZED) {
+                    failure = "la primera expresión no ha pasado al nivel optimizado";
+                }
+                return failure;
+            }
+        },
+        Check {
+            "Memoria compartida: espera para completar lotes y parada a mitad de lote",
+            [] () -> std::optional<std::string> {
+                std::vector<clex::Expression> exprs;
+                exprs.push_back(parse_expression("x * y + 1 / x"));
+                std::optional<std::string> failure;
+                {
+                    // los lotes esperan hasta 2 ms a completarse, pero no pasan de 16 peticiones
+                    clex::ShmServer server(shm_name("espera"), exprs, clex::SymbolTable(), "", {}, clex::ShmBatching{16, 2000});
+                    std::thread serving([&] { server.serve(); });
+                    clex::ShmClient client = clex::ShmClient::connect(shm_name("espera"));
+                    size_t count = 500;
+                    std::vector<double> args, results(count);
+                    std::vector<clex::ShmStatus> statuses(count);
+                    for(size_t i = 0; i < count; i++) {
+                        args.insert(args.end(), {static_cast<double>(i % 9) - 4.0, static_cast<double>(i)});
+                    }
+                    client.evaluate_many(0, args.data(), 2, count, results.data(), statuses.data());
+                    client.shutdown();
+                    serving.join();
+                    for(size_t i = 0; i < count && !failure.has_value(); i++) {
+                        clex::SymbolTable symbols = clex::SymbolTable::from_map({{"x", args[2 * i]}, {"y", args[2 * i + 1]}});
+                        if(shm_outcome(statuses[i], results[i]) != outcome(exprs[0], symbols)) {
+                            failure = "la petición " + std::to_string(i) + " da `" + shm_outcome(statuses[i], results[i]) + "`";
+                        }
+                    }
+                    clex::ShmBatchStatistics statistics = server.batch_statistics();
+                    if(!failure.has_value() && (statistics.requests != count || statistics.largest > 16 || statistics.grouped == 0)) {
+                        failure = "el servidor ha atendido " + std::to_string(statistics.requests) + " peticiones, "
+                                  + std::to_string(statistics.grouped) + " en grupo, con un lote de " + std::to_string(statistics.largest);
+                    }
+                }
+                if(failure.has_value()) {
+                    return failure;
+                }
+                // con un plazo de 5 s, el servidor se detiene en cuanto recibe la parada, tras responder a lo que tiene
+                clex::ShmServer server(shm_name("parada"), exprs, clex::SymbolTable(), "", {}, clex::ShmBatching{64, 5000000});
+                auto start = std::chrono::steady_clock::now();
+                std::thread serving([&] { server.serve(); });
+                clex::ShmClient client = clex::ShmClient::connect(shm_name("parada"));
+                double args[2] = {2.0, 3.0}, result = 0.0;
+                clex::ShmStatus status = clex::ShmStatus::EVAL_ERROR;
+                std::thread waiting([&] { status = client.evaluate(0, args, 2, result); });
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                client.shutdown();
+                waiting.join();
+                serving.join();
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                clex::ShmBatchStatistics statistics = server.batch_statistics();
+                if(shm_outcome(status, result) != "6.5") {
+                    return "la petición del lote detenido da `" + shm_outcome(status, result) + "`";
+                }
+                if(elapsed > 2.0 || statistics.batches != 1 || statistics.requests != 1) {
+                    return "el servidor ha tardado " + std::to_string(elapsed) + " s en detenerse, con "
+                           + std::to_string(statistics.batches) + " lotes";
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Memoria compartida: reconexión a un segmento reemplazado",
+            [] () -> std::optional<std::string> {
+                std::string name = shm_name("reemplazo");
+                auto connect_fails = [&] {
+                    try {
+                        clex::ShmClient::connect(name);
+                        return false;
+                    } catch(const std::runtime_error&) {
+                        return true;
+                    }
+                };
+                auto single = [](clex::ShmClient& client, double x) {
+                    return shm_single(client, 0, &x, 1);
+                };
+                if(!connect_fails()) {
+                    return std::string("se ha conectado a un segmento que no existe");
+                }
+                std::vector<clex::Expression> first, second;
+                first.push_back(parse_expression("x + 1"));
+                second.push_back(parse_expression("x * 10"));
+                std::optional<std::string> failure;
+                auto old_server = std::make_unique<clex::ShmServer>(name, first, clex::SymbolTable());
+                std::thread old_serving([&] { old_server->serve(); });
+                clex::ShmClient old_client = clex::ShmClient::connect(name);
+                // un servidor nuevo con el mismo nombre reemplaza el segmento; el cliente que ya estaba conectado sigue
+                // hablando con el servidor anterior, y los que se conectan después, con el nuevo
+                clex::ShmServer new_server(name, second, clex::SymbolTable());
+                std::thread new_serving([&] { new_server.serve(); });
+                clex::ShmClient new_client = clex::ShmClient::connect(name);
+                if(single(old_client, 2.0) != "3" || single(new_client, 2.0) != "20") {
+                    failure = "tras reemplazar el segmento, los clientes obtienen " + single(old_client, 2.0) + " y " + single(new_client, 2.0);
+                }
+                // detener y destruir el servidor anterior no elimina el segmento del nuevo
+                old_client.shutdown();
+                old_serving.join();
+                old_server.reset();
+                if(!failure.has_value()) {
+                    if(connect_fails()) {
+                        failure = "al destruir el servidor anterior ha desaparecido el segmento del nuevo";
+                    } else {
+                        clex::ShmClient reconnected = clex::ShmClient::connect(name);
+                        if(single(reconnected, 4.0) != "40") {
+                            failure = "al reconectar se obtiene " + single(reconnected, 4.0);
+                        }
+                    }
+                }
+                new_client.shutdown();
+                new_serving.join();
+                return failure;
+            }
+        },
+        Check {
+            "Aproximación: error dentro de la tolerancia",
+            [] () -> std::optional<std::string> {
+                std::optional<std::string> failure = same_with_approximation("sin(x) * log(x + 2) + cos(x) / 3", 0.5, 4.0, 1e-6, 1);
+                if(!failure.has_value()) {
+                    failure = same_with_approximation("sin(a * x) * atan(x) + cos(x) / sqrt(x + 1)", 0.0, 10.0, 1e-9, 1);
+                }
+                return failure;
+            }
+        },
+        Check {
+            "Aproximación: fuera del rango",
+            [] {
+                // en -1.5 la expresión original tiene valor, en -3 y en 8 da un error (fuera de su dominio), y en 1e300
+                // da infinito
+                return same_with_approximation("log(x + 2) * sin(x) + sqrt(5 - x) * cos(x)", 0.0, 4.0, 1e-7, 1,
+                                               {-1.5, -3.0, 8.0, -1e300, 1e300});
+            }
+        },
+        Check {
+            "Aproximación: subexpresiones que fallan en la malla",
+            [] () -> std::optional<std::string> {
+                // `log(x - 1)` falla en la parte del rango con `x <= 1`, así que no se sustituye; la otra subexpresión
+                // sí, porque no falla en ningún punto
+                std::optional<std::string> failure = same_with_approximation("log(x - 1) * sin(x)", 0.0, 3.0, 1e-6, 0);
+                if(!failure.has_value()) {
+                    failure = same_with_approximation("log(x - 1) * sin(x) + (sin(x) * cos(x) + log(x + 5))", 0.0, 3.0, 1e-6, 1);
+                }
+                if(!failure.has_value()) {
+                    // `1 / sin(x)` no es finita en `x = 0`, que está en la malla
+                    failure = same_with_approximation("cos(x) / sin(x) + log(x + 1)", 0.0, 3.0, 1e-6, 0);
+                }
+                if(!failure.has_value()) {
+                    // `log(x)` solo falla en `x = 0`, un extremo de la malla; el resto de la subexpresión tiende a 0
+                    // y se podría ajustar sin problemas
+                    failure = same_with_approximation("log(x) * sin(x)^3 + cos(x)", 0.0, 3.0, 1e-3, 0);
+                }
+                return failure;
+            }
+        },
+        Check {
+            "Modo por lotes: CSV",
+            [] {
+                BatchRows rows = batch_rows(3000);
+                return compare_results(parse_results(run_csv(to_csv(rows), BATCH_EXPR)), interpreter_results(rows, BATCH_EXPR), 1e-12);
+            }
+        },
+        Check {
+            "Modo por lotes: agregado",
+            [] () -> std::optional<std::string> {
+                BatchRows rows = batch_rows(3000);
+                std::istringstream in(to_csv(rows));
+                std::ostringstream err;
+                clex::BatchAggregate aggregate = clex::aggregate_csv(in, err, parse_expression(BATCH_EXPR), clex::SymbolTable());
+                clex::RunningStats expected;
+                uint64_t errors = 0;
+                for(const std::optional<double>& result : interpreter_results(rows, BATCH_EXPR)) {
+                    if(result.has_value() && std::isnan(*result)) {
+                        errors++;
+                    } else if(result.has_value()) {
+                        expected.push(*result);
+                    }
+                }
+                const clex::RunningStats& actual = aggregate.stats();
+                if(actual.count() != expected.count() || aggregate.errors() != errors) {
+                    return "el agregado tiene " + std::to_string(actual.count()) + " valores y " + std::to_string(aggregate.errors())
+                           + " errores en lugar de " + std::to_string(expected.count()) + " y " + std::to_string(errors);
+                }
+                return compare_results({actual.mean(), actual.min(), actual.max()}, {expected.mean(), expected.min(), expected.max()}, 1e-9);
+            }
+        },
+        Check {
+            "Modo por lotes: agregado con resultados NaN",
+            [] () -> std::optional<std::string> {
+                // `nan` en un campo y `inf - inf` dan NaN sin ningún error de evaluación
+                std::istringstream in("x,y\n1,0\nnan,0\n2,0\ninf,inf\n3,0\n");
+                std::ostringstream err;
+                clex::BatchAggregate aggregate = clex::aggregate_csv(in, err, parse_expression("x - y"), clex::SymbolTable());
+                const clex::RunningStats& stats = aggregate.stats();
+                if(stats.count() != 3 || aggregate.nans() != 2 || aggregate.errors() != 0) {
+                    return "el agregado tiene " + std::to_string(stats.count()) + " valores, " + std::to_string(aggregate.nans())
+                           + " NaN y " + std::to_string(aggregate.errors()) + " errores en lugar de 3, 2 y 0";
+                }
+                // el resumen de un proceso hijo debe conservar la cuenta de NaN
+                std::stringstream serialized;
+                aggregate.write_to(serialized);
+                if(clex::BatchAggregate::read_from(serialized).nans() != 2) {
+                    return std::string("la cuenta de NaN se pierde al serializar el agregado");
+                }
+                return compare_results(
+                    {stats.min(), stats.max(), stats.mean(), aggregate.quantile(0.25), aggregate.quantile(0.5)},
+                    {1.0, 3.0, 2.0, 1.25, 2.0}, 1e-12
+                );
+            }
+        },
+        Check {
+            "Modo por lotes: reparto entre procesos",
+            [] () -> std::optional<std::string> {
+                // con `rand()`, para comprobar también que cada fila usa su propio flujo aleatorio en cualquier proceso;
+                // en la entrada de una columna, las líneas en blanco son filas nulas que también hay que contar
+                std::ostringstream one_column("x\n", std::ios::ate);
+                for(size_t i = 0; i < 3000; i++) {
+                    one_column << (i % 5 == 4 ? "" : std::to_string(i % 17 - 8.5)) << '\n';
+                }
+                std::vector<std::pair<std::string, std::string>> inputs{
+                    {to_csv(batch_rows(3000)), "x * y + rand() + log(y)"},
+                    {one_column.str(), "x + rand()"}
+                };
+                std::string path = temporary_path("procesos.csv");
+                std::optional<std::string> failure;
+                for(const auto& [input, expr] : inputs) {
+                    std::string expected = run_csv(input, expr);
+                    write_file(path, input);
+                    for(size_t processes : {1, 2, 3, 7}) {
+                        clex::BatchOptions options;
+                        options.processes = processes;
+                        clex::ScopedRandomStream random(fixed_random_stream());
+                        std::ostringstream out, err;
+                        clex::evaluate_csv_file(path, out, err, parse_expression(expr), clex::SymbolTable(), options);
+                        if(out.str() != expected && !failure.has_value()) {
+                            failure = "la salida de `" + expr + "` con " + std::to_string(processes)
+                                      + " procesos es distinta de la leída de un flujo";
+                        }
+                    }
+                }
+                std::filesystem::remove(path);
+                return failure;
+            }
+        },
+        Check {
+            "Modo por lotes: Arrow",
+            [] () -> std::optional<std::string> {
+                BatchRows rows = batch_rows(3000);
+                std::vector<double> x, y;
+                std::vector<uint8_t> x_valid, y_valid;
+                for(size_t i = 0; i < rows.x.size(); i++) {
+                    x.push_back(rows.x[i].value_or(0.0));
+                    y.push_back(rows.y[i].value_or(0.0));
+                    x_valid.push_back(rows.x[i].has_value());
+                    y_valid.push_back(rows.y[i].has_value());
+                }
+                std::stringstream in, out;
+                clex::ArrowStreamWriter writer(in, {"x", "y"});
+                writer.write_batch(1000, {x.data(), y.data()}, {x_valid.data(), y_valid.data()});
+                writer.write_batch(2000, {x.data() + 1000, y.data() + 1000}, {x_valid.data() + 1000, y_valid.data() + 1000});
+                writer.finish();
+                std::ostringstream err;
+                clex::evaluate_arrow(in, out, err, parse_expression(BATCH_EXPR), clex::SymbolTable());
+                std::vector<std::optional<double>> actual;
+                clex::ArrowStreamReader reader(out);
+                clex::ArrowRecordBatch batch;
+                while(reader.next(batch)) {
+                    for(int64_t r = 0; r < batch.length; r++) {
+                        size_t row = static_cast<size_t>(r);
+                        actual.push_back(batch.columns[0].is_valid(row) ? std::optional<double>(batch.columns[0].value(row)) : std::nullopt);
+                    }
+                }
+                // en Arrow, las filas que fallan también son nulas
+                std::vector<std::optional<double>> expected = interpreter_results(rows, BATCH_EXPR);
+                for(std::optional<double>& result : expected) {
+                    if(result.has_value() && std::isnan(*result)) {
+                        result.reset();
+                    }
+                }
+                return compare_results(actual, expected, 1e-12);
+            }
+        },
+        Check {
+            "Arrow: longitudes más largas que el flujo",
+            [] () -> std::optional<std::string> {
+                std::vector<double> x(1000, 1.5);
+                std::ostringstream stream;
+                clex::ArrowStreamWriter writer(stream, {"x"});
+                writer.write_batch(x.size(), {x.data()});
+                std::string bytes = stream.str();
+                // el lote es el segundo mensaje, y su cuerpo va justo tras sus metadatos
+                auto metadata_size = [&](size_t at) {
+                    uint32_t size;
+                    std::memcpy(&size, bytes.data() + at + 4, 4);
+                    return static_cast<size_t>(size);
+                };
+                size_t batch_at = 8 + metadata_size(0);
+                size_t body_at = batch_at + 8 + metadata_size(batch_at);
+                int64_t body_length = static_cast<int64_t>(bytes.size() - body_at);
+                size_t field = bytes.find(std::string(reinterpret_cast<const char*>(&body_length), 8), batch_at);
+                if(field == std::string::npos || field >= body_at) {
+                    return std::string("no se encuentra la longitud del cuerpo en los metadatos del lote");
+                }
+                // lee el lote de `patched` y comprueba que falla con `expected`, sin reservar antes toda la longitud
+                auto fails_with = [](const std::string& patched, const std::string& expected) -> std::optional<std::string> {
+                    std::istringstream in(patched);
+                    clex::ArrowStreamReader reader(in);
+                    clex::ArrowRecordBatch batch;
+                    try {
+                        reader.next(batch);
+                    } catch(const std::runtime_error& err) {
+                        if(std::string(err.what()).find(expected) != std::string::npos) {
+                            return std::nullopt;
+                        }
+                        return "error inesperado: " + std::string(err.what());
+                    }
+                    return "se ha leído un lote en lugar de dar el error `" + expected + "`";
+                };
+                std::string long_body = bytes;
+                int64_t huge_length = int64_t(1) << 62;
+                long_body.replace(field, 8, std::string(reinterpret_cast<const char*>(&huge_length), 8));
+                std::optional<std::string> failure = fails_with(long_body, "cuerpo cortado");
+                if(!failure.has_value()) {
+                    std::string long_metadata = bytes;
+                    uint32_t huge_size = 0xFFFFFFF0;
+                    long_metadata.replace(batch_at + 4, 4, std::string(reinterpret_cast<const char*>(&huge_size), 4));
+                    failure = fails_with(long_metadata, "metadatos cortados");
+                }
+                return failure;
+            }
+        },
+        Check {
+            "Modo por lotes: precisión simple",
+            [] {
+                BatchRows rows = batch_rows(3000);
+                clex::BatchOptions options;
+                options.float32 = true;
+                std::string expr = "x^2 + y^2 / 4 + sqrt(x^2 + 1)";
+                return compare_results(parse_results(run_csv(to_csv(rows), expr, options)), interpreter_results(rows, expr), 1e-6);
+            }
+        },
+        Check {
+            "Modo por lotes: malla de parámetros",
+            [] () -> std::optional<std::string> {
+                std::vector<clex::SweepAxis> axes{{"x", -2.0, 2.0, 5}, {"y", -0.5, 3.0, 8}};
+                std::ostringstream out, err;
+                clex::sweep_table(axes, out, err, parse_expression(BATCH_EXPR), clex::SymbolTable());
+                BatchRows points;
+                std::ostringstream results;
+                std::istringstream table(out.str());
+                std::string line;
+                std::getline(table, line); // cabecera
+                for(uint64_t i = 0; std::getline(table, line); i++) {
+                    points.x.push_back(axes[0].value(i / axes[1].points));
+                    points.y.push_back(axes[1].value(i % axes[1].points));
+                    results << line.substr(line.rfind(',') + 1) << '\n';
+                }
+                if(points.x.size() != axes[0].points * axes[1].points) {
+                    return "la tabla tiene " + std::to_string(points.x.size()) + " puntos";
+                }
+                return compare_results(parse_results(results.str()), interpreter_results(points, BATCH_EXPR), 1e-12);
+            }
+        },
+        Check {
+            "Modo por lotes: varias expresiones juntas",
+            [] () -> std::optional<std::string> {
+                std::string input = to_csv(batch_rows(3000));
+                std::vector<std::string> names{"f", "g"};
+                // cada expresión toma su clave aleatoria en orden, así que solo la primera puede usar `rand()`
+                std::vector<std::string> texts{"x * y + rand()", BATCH_EXPR};
+                std::vector<clex::Expression> exprs;
+                for(const std::string& text : texts) {
+                    exprs.push_back(parse_expression(text));
+                }
+                clex::ScopedRandomStream random(fixed_random_stream());
+                std::istringstream in(input);
+                std::ostringstream out, err;
+                clex::evaluate_csv_fused(in, out, err, names, exprs, clex::SymbolTable());
+                // cada columna de la tabla debe ser exactamente la salida de su expresión sola
+                std::istringstream table(out.str()), f(run_csv(input, texts[0])), g(run_csv(input, texts[1]));
+                std::string line, f_line, g_line;
+                std::getline(table, line);
+                if(line != "f,g") {
+                    return "la cabecera es `" + line + "`";
+                }
+                for(size_t row = 1; std::getline(table, line); row++) {
+                    if(!std::getline(f, f_line) || !std::getline(g, g_line) || line != f_line + "," + g_line) {
+                        return "la fila " + std::to_string(row) + " es `" + line + "` en lugar de `" + f_line + "," + g_line + "`";
+                    }
+                }
+                if(std::getline(f, f_line)) {
+                    return std::string("a la tabla le faltan filas");
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Modo por lotes: filtro de filas",
+            [] {
+                BatchRows rows = batch_rows(3000);
+                std::string filter = "x > 0 and y > 1 or x < -5";
+                clex::Expression predicate = parse_expression(filter);
+                clex::BatchOptions options;
+                options.filter = &predicate;
+                return compare_results(parse_results(run_csv(to_csv(rows), BATCH_EXPR, options)), interpreter_results(rows, BATCH_EXPR, filter), 1e-12);
+            }
+        },
+        Check {
+            "Modo por lotes: funciones de ventana",
+            [] () -> std::optional<std::string> {
+                BatchRows rows = batch_rows(3000);
+                std::string input = to_csv(rows);
+                std::vector<std::pair<std::string, double>> windows{
+                    {"rolling_sum", 5}, {"rolling_mean", 3}, {"rolling_min", 4}, {"rolling_max", 7}, {"ema", 0.25}, {"lag", 2}
+                };
+                for(const auto& [function, parameter] : windows) {
+                    std::ostringstream expr;
+                    expr << function << "(x - y, " << parameter << ")";
+                    std::vector<std::optional<double>> values;
+                    for(size_t i = 0; i < rows.x.size(); i++) {
+                        values.push_back(rows.x[i].has_value() && rows.y[i].has_value() ? std::optional<double>(*rows.x[i] - *rows.y[i]) : std::nullopt);
+                    }
+                    std::optional<std::string> failure = compare_results(parse_results(run_csv(input, expr.str())), window_results(values, function, parameter), 1e-9);
+                    if(failure.has_value()) {
+                        return expr.str() + ": " + *failure;
+                    }
+                }
+                return std::nullopt;
+            }
+        },
+        Check {
+            "Modo por lotes: actualización de resultados",
+            [] () -> std::optional<std::string> {
+                std::string input_path = temporary_path("entrada.csv");
+                std::string result_path = temporary_path("resultados.txt");
+                std::string hash_path = result_path + ".hash";
+                std::string expr = "log(y) + x * rand()";
+                BatchRows rows = batch_rows(3000);
+                std::optional<std::string> failure;
+                auto update = [&](uint64_t expected_evaluated) {
+                    write_file(input_path, to_csv(rows));
+                    clex::ScopedRandomStream random(fixed_random_stream());
+                    std::ostringstream err;
+                    clex::DeltaUpdate delta = clex::update_csv_file(input_path, result_path, hash_path, err, parse_expression(expr), clex::SymbolTable());
+                    if(delta.rows != rows.x.size() || delta.evaluated != expected_evaluated) {
+                        failure = "se han evaluado " + std::to_string(delta.evaluated) + " de " + std::to_string(delta.rows)
+                                  + " filas en lugar de " + std::to_string(expected_evaluated) + " de " + std::to_string(rows.x.size());
+                    } else if(read_results_file(result_path) != run_csv(to_csv(rows), expr)) {
+                        failure = "el fichero de resultados no coincide con una evaluación completa";
+                    }
+                    return !failure.has_value();
+                };
+                if(update(3000) && update(0)) {
+                    rows.x[10] = 1.25;
+                    rows.y[500] = 2.5;
+                    rows.x[2999].reset();
+                    rows.x.insert(rows.x.end(), {3.0, std::nullopt});
+                    rows.y.insert(rows.y.end(), {-1.0, 4.0});
+                    update(5);
+                }
+                std::filesystem::remove(input_path);
+                std::filesystem::remove(result_path);
+                std::filesystem::remove(hash_path);
+                return failure;
+            }
+        },
+        Check {
+            "Nulos en una entrada de una columna",
+            [] () -> std::optional<std::string> {
+                // la línea en blanco es un nulo, y las filas siguientes no se mueven
+                std::string output = run_csv("x\n1\n\n3\n", "x * 2");
+                if(output != "2\n\n6\n") {
+                    return "la salida es `" + output + "` en lugar de `2\\n\\n6\\n`";
+                }
+                return std::nullopt;
+            }
+        }
+    };
+    size_t total = tests.size() + checks.size();
+
     if(argc > 1) {
         if(std::string(argv[1]) == "all") {
             std::cout << "===== EJECUTANDO TODOS LOS TESTS =====\n";
@@ -170,15 +1777,23 @@ int main(int argc, char** argv) {
                 test.run();
                 std::cout << "======================================\n";
             }
+            for(Check& check : checks) {
+                check.run();
+                std::cout << "======================================\n";
+            }
         } else {
             for(int i = 1; i < argc; i++) {
                 size_t test_idx = std::atoll(argv[i]);
-                if(test_idx >= tests.size()) {
-                    std::cerr << "Número de test " << test_idx << " inválido. Por favor, introduzca un número de 0 a " << tests.size() - 1 << ".\n";
+                if(test_idx >= total) {
+                    std::cerr << "Número de test " << test_idx << " inválido. Por favor, introduzca un número de 0 a " << total - 1 << ".\n";
                     exit(-1);
                 }
                 std::cout << "===== EJECUTANDO TEST " << test_idx << " =====\n";
-                tests[test_idx].run();
+                if(test_idx < tests.size()) {
+                    tests[test_idx].run();
+                } else {
+                    checks[test_idx - tests.size()].run();
+                }
             }
             std::cout << "=============================\n";
         }
@@ -0,0 +1,194 @@
+#include "tiered.hpp"
+#include "eval_errors.hpp"
+#include "native.hpp"
+#include "polynomial.hpp"
+#include "range_analysis.hpp"
+#include "speculation.hpp"
+#include "symbol_table.hpp"
+#include "syntax_tree.hpp"
+#include "tokens.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace clex {
+
+namespace {
+
+constexpr size_t tier_index(ExecutionTier tier) noexcept {
+    return static_cast<size_t>(tier);
+}
+
+}
+
+TieredFormula::TieredFormula(const Expression& expr, const std::vector<Token>& variables, const SymbolTable& constants,
+                             const std::string& native_dir, const TierThresholds& thresholds)
+    : m_source(expr.clone()), m_variables(variables), m_constants(constants), m_native_dir(native_dir),
+      m_budgets{thresholds.optimize, thresholds.native > thresholds.optimize ? thresholds.native - thresholds.optimize : 0, 0},
+      m_speculate(thresholds.speculate), m_engines(), m_tier(tier_index(ExecutionTier::INTERPRETED)), m_evaluations(),
+      m_build_nanoseconds(), m_native_failed(false), m_promoting(false), m_worker(), m_worker_mutex(),
+      m_speculation_mutex() {
+    m_engines[tier_index(ExecutionTier::INTERPRETED)] = make_engine(expr.clone(), std::nullopt);
+    if(thresholds.optimize == 0) {
+        promote(ExecutionTier::INTERPRETED);
+        if(thresholds.native == 0 && !m_native_dir.empty()) {
+            promote(ExecutionTier::OPTIMIZED);
+        }
+    }
+}
+
+TieredFormula::~TieredFormula() {
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    if(m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+const std::vector<Token>& TieredFormula::variables() const noexcept {
+    return m_variables;
+}
+
+std::unique_ptr<TieredFormula::Engine> TieredFormula::make_engine(Expression&& expr, std::optional<NativeFormula>&& native) const {
+    std::unique_ptr<SpeculativeFormula> speculative;
+    if(!native.has_value() && m_speculate > 0) {
+        speculative = std::make_unique<SpeculativeFormula>(expr, m_speculate);
+    }
+    return std::make_unique<Engine>(Engine{std::move(expr), std::move(native), std::move(speculative)});
+}
+
+// Asigna las variables y evalúa el árbol de `engine`, con su especialización si ningún otro hilo la está usando
+double TieredFormula::interpret(const Engine& engine, const double* args, SymbolTable& symbols) {
+    for(size_t i = 0; i < m_variables.size(); i++) {
+        symbols.set(m_variables[i], args[i]);
+    }
+    if(engine.speculative != nullptr) {
+        std::unique_lock<std::mutex> lock(m_speculation_mutex, std::try_to_lock);
+        if(lock.owns_lock()) {
+            return engine.speculative->evaluate(symbols);
+        }
+    }
+    return engine.expr.evaluate(symbols);
+}
+
+// Prepara el nivel siguiente a `from` y lo publica. Solo se ejecuta en un hilo a la vez.
+void TieredFormula::promote(ExecutionTier from) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Engine> engine;
+    if(from == ExecutionTier::INTERPRETED) {
+        engine = make_engine(elide_domain_checks(rewrite_polynomials(m_source), m_constants, {}), std::nullopt);
+    } else {
+        const Expression& optimized = m_engines[tier_index(ExecutionTier::OPTIMIZED)]->expr;
+        try {
+            engine = make_engine(optimized.clone(), NativeFormula::build(optimized, m_variables, m_constants, m_native_dir, false, true));
+        } catch(const std::runtime_error&) {
+            m_native_failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    size_t next = tier_index(from) + 1;
+    m_build_nanoseconds[next].store(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    m_engines[next] = std::move(engine);
+    m_tier.store(static_cast<uint8_t>(next), std::memory_order_release); // publica `m_engines[next]`
+}
+
+void TieredFormula::maybe_promote(ExecutionTier from) {
+    if(from == ExecutionTier::OPTIMIZED && (m_native_dir.empty() || m_native_failed.load(std::memory_order_relaxed))) {
+        return;
+    }
+    bool idle = false;
+    if(m_promoting.load(std::memory_order_relaxed) || !m_promoting.compare_exchange_strong(idle, true, std::memory_order_acq_rel)) {
+        return; // ya hay otra preparación en marcha
+    }
+    if(m_tier.load(std::memory_order_acquire) != tier_index(from)) {
+        m_promoting.store(false, std::memory_order_release); // otra evaluación ya ha subido de nivel la expresión
+        return;
+    }
+    // el hilo de la preparación anterior deja libre `m_promoting` al terminar, quizá antes de que quien lo creó lo haya
+    // guardado en `m_worker`
+    std::lock_guard<std::mutex> lock(m_worker_mutex);
+    if(m_worker.joinable()) {
+        m_worker.join(); // la preparación anterior ya ha terminado, solo falta recoger su hilo
+    }
+    m_worker = std::thread([this, from]() {
+        promote(from);
+        m_promoting.store(false, std::memory_order_release);
+    });
+}
+
+double TieredFormula::evaluate(const double* args, SymbolTable& symbols) {
+    size_t tier = m_tier.load(std::memory_order_acquire);
+    uint64_t count = m_evaluations[tier].fetch_add(1, std::memory_order_relaxed) + 1;
+    if(tier != tier_index(ExecutionTier::NATIVE) && count >= m_budgets[tier]) {
+        maybe_promote(static_cast<ExecutionTier>(tier));
+    }
+    const Engine& engine = *m_engines[tier];
+    double result;
+    if(engine.native.has_value() && engine.native->evaluate(args, result)) {
+        return result;
+    }
+    // el intérprete da el mismo error que el código nativo, o el resultado si éste no lo ha podido calcular
+    return interpret(engine, args, symbols);
+}
+
+void TieredFormula::evaluate_batch(const double* const* columns, size_t rows, SymbolTable& symbols, double* results, uint8_t* failed) {
+    size_t tier = m_tier.load(std::memory_order_acquire);
+    uint64_t count = m_evaluations[tier].fetch_add(rows, std::memory_order_relaxed) + rows;
+    if(tier != tier_index(ExecutionTier::NATIVE) && count >= m_budgets[tier]) {
+        maybe_promote(static_cast<ExecutionTier>(tier));
+    }
+    const Engine& engine = *m_engines[tier];
+    bool columnar = engine.native.has_value() && engine.native->has_double_kernel();
+    if(columnar) {
+        engine.native->evaluate_columns(columns, rows, results, failed);
+    }
+    std::vector<double> args(m_variables.size());
+    for(size_t row = 0; row < rows; row++) {
+        if(columnar && !failed[row]) {
+            continue;
+        }
+        // igual que en `evaluate()`: el código nativo fila a fila y, si falla, el intérprete
+        for(size_t i = 0; i < m_variables.size(); i++) {
+            args[i] = columns[i][row];
+        }
+        failed[row] = 0;
+        if(engine.native.has_value() && engine.native->evaluate(args.data(), results[row])) {
+            continue;
+        }
+        try {
+            results[row] = interpret(engine, args.data(), symbols);
+        } catch(const EvalError&) {
+            failed[row] = 1;
+        }
+    }
+}
+
+ExecutionTier TieredFormula::tier() const noexcept {
+    return static_cast<ExecutionTier>(m_tier.load(std::memory_order_acquire));
+}
+
+TierStatistics TieredFormula::statistics() const {
+    TierStatistics stats{tier(), {}, {}, m_native_failed.load(std::memory_order_relaxed), {0, 0, 0, 0}};
+    size_t published = m_tier.load(std::memory_order_acquire); // solo los niveles publicados están preparados
+    std::lock_guard<std::mutex> lock(m_speculation_mutex);
+    for(size_t i = 0; i < 3; i++) {
+        stats.evaluations[i] = m_evaluations[i].load(std::memory_order_relaxed);
+        stats.build_seconds[i] = static_cast<double>(m_build_nanoseconds[i].load(std::memory_order_relaxed)) * 1e-9;
+        if(i <= published && m_engines[i]->speculative != nullptr) {
+            SpeculationStatistics speculation = m_engines[i]->speculative->statistics();
+            stats.speculation.generic_evaluations += speculation.generic_evaluations;
+            stats.speculation.specialized_evaluations += speculation.specialized_evaluations;
+            stats.speculation.specializations += speculation.specializations;
+            stats.speculation.deoptimizations += speculation.deoptimizations;
+        }
+    }
+    return stats;
+}
+
+} // namespace clex
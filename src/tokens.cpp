@@ -35,6 +35,33 @@ std::ostream& operator<<(std::ostream& out, TokenType token_type) noexcept {
       case TokenType::OP_CARET: {
         return out << "Caret ('^')";
       }
+      case TokenType::OP_LESS: {
+        return out << "Less ('<')";
+      }
+      case TokenType::OP_LESS_EQ: {
+        return out << "Less or equal ('<=')";
+      }
+      case TokenType::OP_GREATER: {
+        return out << "Greater ('>')";
+      }
+      case TokenType::OP_GREATER_EQ: {
+        return out << "Greater or equal ('>=')";
+      }
+      case TokenType::OP_EQUAL: {
+        return out << "Equal ('==')";
+      }
+      case TokenType::OP_NOT_EQUAL: {
+        return out << "Not equal ('!=')";
+      }
+      case TokenType::OP_AND: {
+        return out << "And ('and')";
+      }
+      case TokenType::OP_OR: {
+        return out << "Or ('or')";
+      }
+      case TokenType::OP_NOT: {
+        return out << "Not ('not')";
+      }
       case TokenType::ASSIGN: {
         return out << "Assign ('=')";
       }
@@ -44,6 +71,9 @@ std::ostream& operator<<(std::ostream& out, TokenType token_type) noexcept {
       case TokenType::PAREN_R: {
         return out << "Right Parenthesis (')')";
       }
+      case TokenType::COMMA: {
+        return out << "Comma (',')";
+      }
       case TokenType::OP_FUNC_SQRT: {
         return out << "Sqrt function";
       }
@@ -68,6 +98,54 @@ std::ostream& operator<<(std::ostream& out, TokenType token_type) noexcept {
       case TokenType::OP_FUNC_ARCTAN: {
         return out << "Arctan function";
       }
+      case TokenType::FUNC_IF: {
+        return out << "If function";
+      }
+      case TokenType::FUNC_RAND: {
+        return out << "Rand function";
+      }
+      case TokenType::FUNC_RANDN: {
+        return out << "Randn function";
+      }
+      case TokenType::FUNC_MC: {
+        return out << "Mc function";
+      }
+      case TokenType::FUNC_MCERR: {
+        return out << "Mcerr function";
+      }
+      case TokenType::FUNC_MINIMIZE: {
+        return out << "Minimize function";
+      }
+      case TokenType::FUNC_ARGMIN: {
+        return out << "Argmin function";
+      }
+      case TokenType::FUNC_ODE: {
+        return out << "Ode function";
+      }
+      case TokenType::FUNC_ROLLING_SUM: {
+        return out << "Rolling_sum function";
+      }
+      case TokenType::FUNC_ROLLING_MEAN: {
+        return out << "Rolling_mean function";
+      }
+      case TokenType::FUNC_ROLLING_MIN: {
+        return out << "Rolling_min function";
+      }
+      case TokenType::FUNC_ROLLING_MAX: {
+        return out << "Rolling_max function";
+      }
+      case TokenType::FUNC_EMA: {
+        return out << "Ema function";
+      }
+      case TokenType::FUNC_LAG: {
+        return out << "Lag function";
+      }
+      case TokenType::LET: {
+        return out << "Let ('let')";
+      }
+      case TokenType::IN: {
+        return out << "In ('in')";
+      }
       default: {
         return out << "<Invalid token type (num " << static_cast<int>(token_type) << ")>";
       }
@@ -99,6 +177,13 @@ Token Token::number(const std::string& num) noexcept {
     };
 }
 
+Token Token::number(double value) noexcept {
+    return Token {
+        TokenType::NUMBER,
+        TokenVariant(value)
+    };
+}
+
 TokenType Token::type() const noexcept { return m_type; }
 
 std::optional<std::string> Token::get_ident() const noexcept {
@@ -119,16 +204,30 @@ std::optional<double> Token::get_num() const noexcept {
 
 std::optional<int> Token::get_binary_binding_power() const noexcept {
     switch(m_type) {
+      case TokenType::OP_OR: {
+          return 1;
+      }
+      case TokenType::OP_AND: {
+          return 2;
+      }
+      case TokenType::OP_LESS:
+      case TokenType::OP_LESS_EQ:
+      case TokenType::OP_GREATER:
+      case TokenType::OP_GREATER_EQ:
+      case TokenType::OP_EQUAL:
+      case TokenType::OP_NOT_EQUAL: {
+          return 4;
+      }
       case TokenType::OP_PLUS:
       case TokenType::OP_MINUS: {
-          return 1;
+          return 5;
       }
       case TokenType::OP_ASTERISK:
       case TokenType::OP_SLASH: {
-          return 2;
+          return 6;
       }
       case TokenType::OP_CARET: {
-          return 3;
+          return 7;
       }
       default: return {};
     }
@@ -136,9 +235,12 @@ std::optional<int> Token::get_binary_binding_power() const noexcept {
 
 std::optional<int> Token::get_unary_binding_power() const noexcept {
     switch(m_type) {
+      case TokenType::OP_NOT: {
+          return 3; // menor que el de las comparaciones, para que `not a < b` sea `not (a < b)`
+      }
       case TokenType::OP_PLUS:
       case TokenType::OP_MINUS: {
-          return 5;
+          return 9;
       case TokenType::OP_FUNC_SQRT:
       case TokenType::OP_FUNC_LOG:
       case TokenType::OP_FUNC_SIN:
@@ -147,12 +249,44 @@ std::optional<int> Token::get_unary_binding_power() const noexcept {
       case TokenType::OP_FUNC_ARCSIN:
       case TokenType::OP_FUNC_ARCCOS:
       case TokenType::OP_FUNC_ARCTAN:
-        return 4;
+        return 8;
       }
       default: return {};
     }
 }
 
+std::optional<size_t> Token::get_call_arity() const noexcept {
+    switch(m_type) {
+      case TokenType::FUNC_RAND:
+      case TokenType::FUNC_RANDN: {
+          return 0;
+      }
+      case TokenType::FUNC_MC:
+      case TokenType::FUNC_MCERR:
+      case TokenType::FUNC_MINIMIZE:
+      case TokenType::FUNC_ARGMIN:
+      case TokenType::FUNC_ROLLING_SUM:
+      case TokenType::FUNC_ROLLING_MEAN:
+      case TokenType::FUNC_ROLLING_MIN:
+      case TokenType::FUNC_ROLLING_MAX:
+      case TokenType::FUNC_EMA:
+      case TokenType::FUNC_LAG: {
+          return 2;
+      }
+      case TokenType::FUNC_IF: {
+          return 3;
+      }
+      case TokenType::FUNC_ODE: {
+          return 4;
+      }
+      default: return {};
+    }
+}
+
+bool Token::is_variadic_call() const noexcept {
+    return m_type == TokenType::FUNC_MINIMIZE || m_type == TokenType::FUNC_ARGMIN || m_type == TokenType::FUNC_ODE;
+}
+
 bool Token::operator==(const Token& rhs) const noexcept {
     if(this->m_type != rhs.m_type) {
         return false;
@@ -179,13 +313,20 @@ bool Token::is_unary_operator_token() const noexcept {
     return (
         m_type == TokenType::OP_MINUS
      || m_type == TokenType::OP_PLUS
+     || m_type == TokenType::OP_NOT
      || (m_type >= TokenType::OP_FUNC_SQRT && m_type <= TokenType::OP_FUNC_ARCTAN)
     );
 }
 
 bool Token::is_binary_operator_token() const noexcept {
     return (
-        m_type >= TokenType::OP_PLUS && m_type <= TokenType::OP_CARET
+        m_type >= TokenType::OP_PLUS && m_type <= TokenType::OP_OR
+    );
+}
+
+bool Token::is_comparison_token() const noexcept {
+    return (
+        m_type >= TokenType::OP_LESS && m_type <= TokenType::OP_NOT_EQUAL
     );
 }
 
@@ -232,6 +373,33 @@ std::ostream& operator<<(std::ostream& out, const Token& tok) noexcept {
       case TokenType::OP_CARET: {
         return out << "<Caret>";
       }
+      case TokenType::OP_LESS: {
+        return out << "<Less>";
+      }
+      case TokenType::OP_LESS_EQ: {
+        return out << "<Less or equal>";
+      }
+      case TokenType::OP_GREATER: {
+        return out << "<Greater>";
+      }
+      case TokenType::OP_GREATER_EQ: {
+        return out << "<Greater or equal>";
+      }
+      case TokenType::OP_EQUAL: {
+        return out << "<Equal>";
+      }
+      case TokenType::OP_NOT_EQUAL: {
+        return out << "<Not equal>";
+      }
+      case TokenType::OP_AND: {
+        return out << "<And>";
+      }
+      case TokenType::OP_OR: {
+        return out << "<Or>";
+      }
+      case TokenType::OP_NOT: {
+        return out << "<Not>";
+      }
       case TokenType::ASSIGN: {
         return out << "<Assign>";
       }
@@ -241,6 +409,9 @@ std::ostream& operator<<(std::ostream& out, const Token& tok) noexcept {
       case TokenType::PAREN_R: {
         return out << "<Right Parenthesis>";
       }
+      case TokenType::COMMA: {
+        return out << "<Comma>";
+      }
       case TokenType::OP_FUNC_SQRT: {
         return out << "<Sqrt>";
       }
@@ -265,6 +436,54 @@ std::ostream& operator<<(std::ostream& out, const Token& tok) noexcept {
       case TokenType::OP_FUNC_ARCTAN: {
         return out << "<Arctan>";
       }
+      case TokenType::FUNC_IF: {
+        return out << "<If>";
+      }
+      case TokenType::FUNC_RAND: {
+        return out << "<Rand>";
+      }
+      case TokenType::FUNC_RANDN: {
+        return out << "<Randn>";
+      }
+      case TokenType::FUNC_MC: {
+        return out << "<Mc>";
+      }
+      case TokenType::FUNC_MCERR: {
+        return out << "<Mcerr>";
+      }
+      case TokenType::FUNC_MINIMIZE: {
+        return out << "<Minimize>";
+      }
+      case TokenType::FUNC_ARGMIN: {
+        return out << "<Argmin>";
+      }
+      case TokenType::FUNC_ODE: {
+        return out << "<Ode>";
+      }
+      case TokenType::FUNC_ROLLING_SUM: {
+        return out << "<Rolling_sum>";
+      }
+      case TokenType::FUNC_ROLLING_MEAN: {
+        return out << "<Rolling_mean>";
+      }
+      case TokenType::FUNC_ROLLING_MIN: {
+        return out << "<Rolling_min>";
+      }
+      case TokenType::FUNC_ROLLING_MAX: {
+        return out << "<Rolling_max>";
+      }
+      case TokenType::FUNC_EMA: {
+        return out << "<Ema>";
+      }
+      case TokenType::FUNC_LAG: {
+        return out << "<Lag>";
+      }
+      case TokenType::LET: {
+        return out << "<Let>";
+      }
+      case TokenType::IN: {
+        return out << "<In>";
+      }
       default: {
         return out << "<Invalid token type (num " << static_cast<int>(tok.m_type) << ")>";
       }
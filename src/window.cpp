@@ -0,0 +1,171 @@
+#include "window.hpp"
+#include "tokens.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+namespace clex {
+
+namespace {
+
+// Límite de filas de una ventana, para que un argumento erróneo no reserve memoria sin control
+constexpr double MAX_WINDOW_ROWS = 0x1.0p24;
+
+bool is_count(double value, double min) noexcept {
+    return value >= min && value <= MAX_WINDOW_ROWS && value == std::floor(value); // la comparación descarta NaN
+}
+
+}
+
+std::optional<WindowFunction> window_function(TokenType type) noexcept {
+    switch(type) {
+      case TokenType::FUNC_ROLLING_SUM: return WindowFunction::ROLLING_SUM;
+      case TokenType::FUNC_ROLLING_MEAN: return WindowFunction::ROLLING_MEAN;
+      case TokenType::FUNC_ROLLING_MIN: return WindowFunction::ROLLING_MIN;
+      case TokenType::FUNC_ROLLING_MAX: return WindowFunction::ROLLING_MAX;
+      case TokenType::FUNC_EMA: return WindowFunction::EMA;
+      case TokenType::FUNC_LAG: return WindowFunction::LAG;
+      default: return std::nullopt;
+    }
+}
+
+StreamWindow::StreamWindow(WindowFunction function, double parameter)
+    : m_function(function), m_size(0), m_alpha(0.0), m_rows(0), m_null_end(0), m_nan_end(0),
+      m_sum(0.0), m_nan(0), m_pos_inf(0), m_neg_inf(0) {
+    switch(function) {
+      case WindowFunction::EMA: {
+        if(!(parameter > 0.0 && parameter <= 1.0)) {
+            throw std::invalid_argument("The smoothing factor of an exponential moving average must be in (0, 1]");
+        }
+        m_alpha = parameter;
+        return;
+      }
+      case WindowFunction::LAG: {
+        if(!is_count(parameter, 0.0)) {
+            throw std::invalid_argument("The lag of a stream must be a non-negative integer no larger than 2^24");
+        }
+        m_size = static_cast<size_t>(parameter) + 1;
+        m_values.assign(m_size, 0.0);
+        m_valid.assign(m_size, 0);
+        return;
+      }
+      default: {
+        if(!is_count(parameter, 1.0)) {
+            throw std::invalid_argument("The length of a rolling window must be a positive integer no larger than 2^24");
+        }
+        m_size = static_cast<size_t>(parameter);
+        if(function == WindowFunction::ROLLING_SUM || function == WindowFunction::ROLLING_MEAN) {
+            m_values.assign(m_size, 0.0);
+        }
+        return;
+      }
+    }
+}
+
+std::optional<double> StreamWindow::push_sum(double value, bool valid) noexcept {
+    size_t position = static_cast<size_t>(m_rows % m_size);
+    auto count = [&](double x, int sign) {
+        if(std::isnan(x)) {
+            m_nan += sign;
+        } else if(x == INFINITY) {
+            m_pos_inf += sign;
+        } else if(x == -INFINITY) {
+            m_neg_inf += sign;
+        } else {
+            m_sum += sign * x;
+        }
+    };
+    // las filas nulas se guardan como 0, que no cambia la suma al entrar ni al salir
+    count(m_values[position], -1);
+    m_values[position] = valid ? value : 0.0;
+    count(m_values[position], 1);
+    if(position == m_size - 1) {
+        // se vuelve a sumar la ventana cada `m_size` filas, así que el coste por fila sigue siendo constante
+        m_sum = 0.0;
+        for(double x : m_values) {
+            m_sum += std::isfinite(x) ? x : 0.0;
+        }
+    }
+    if(m_rows + 1 < m_size || m_null_end > m_rows + 1 - m_size) {
+        return std::nullopt;
+    }
+    double sum;
+    if(m_nan > 0 || (m_pos_inf > 0 && m_neg_inf > 0)) {
+        sum = NAN;
+    } else if(m_pos_inf > 0) {
+        sum = INFINITY;
+    } else if(m_neg_inf > 0) {
+        sum = -INFINITY;
+    } else {
+        sum = m_sum;
+    }
+    return m_function == WindowFunction::ROLLING_MEAN ? sum / static_cast<double>(m_size) : sum;
+}
+
+std::optional<double> StreamWindow::push_extremum(double value, bool valid) {
+    bool is_max = m_function == WindowFunction::ROLLING_MAX;
+    if(valid && std::isnan(value)) {
+        m_nan_end = m_rows + 1;
+    } else if(valid) {
+        // se quitan de la cola los valores que el nuevo ya supera, que nunca podrán ser el extremo
+        while(!m_extrema.empty() && (is_max ? m_extrema.back().second <= value : m_extrema.back().second >= value)) {
+            m_extrema.pop_back();
+        }
+        m_extrema.emplace_back(m_rows, value);
+    }
+    while(!m_extrema.empty() && m_extrema.front().first + m_size <= m_rows) {
+        m_extrema.pop_front();
+    }
+    if(m_rows + 1 < m_size || m_null_end > m_rows + 1 - m_size) {
+        return std::nullopt;
+    }
+    if(m_nan_end > m_rows + 1 - m_size) {
+        return NAN;
+    }
+    return m_extrema.front().second;
+}
+
+std::optional<double> StreamWindow::push_lag(double value, bool valid) noexcept {
+    size_t position = static_cast<size_t>(m_rows % m_size);
+    m_values[position] = value;
+    m_valid[position] = valid;
+    if(m_rows + 1 < m_size) {
+        return std::nullopt;
+    }
+    // la fila de `k` posiciones antes ocupa la posición que se sobrescribirá con la siguiente
+    size_t lagged = (position + 1) % m_size;
+    return m_valid[lagged] ? std::optional<double>(m_values[lagged]) : std::nullopt;
+}
+
+std::optional<double> StreamWindow::push_ema(double value, bool valid) noexcept {
+    if(!valid) {
+        return std::nullopt;
+    }
+    m_average = m_average.has_value() ? m_alpha * value + (1.0 - m_alpha) * *m_average : value;
+    return m_average;
+}
+
+std::optional<double> StreamWindow::push(double value, bool valid) {
+    if(!valid) {
+        m_null_end = m_rows + 1;
+    }
+    std::optional<double> result;
+    switch(m_function) {
+      case WindowFunction::ROLLING_SUM:
+      case WindowFunction::ROLLING_MEAN: result = push_sum(value, valid); break;
+      case WindowFunction::ROLLING_MIN:
+      case WindowFunction::ROLLING_MAX: result = push_extremum(value, valid); break;
+      case WindowFunction::EMA: result = push_ema(value, valid); break;
+      case WindowFunction::LAG: result = push_lag(value, valid); break;
+    }
+    m_rows++;
+    return result;
+}
+
+uint64_t StreamWindow::rows() const noexcept {
+    return m_rows;
+}
+
+} // namespace clex